@@ -26,6 +26,7 @@
 #include <exception>
 #include <fstream>
 #include <map>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <type_traits>
@@ -41,7 +42,10 @@
 #include "data/bed/BedCheckIterator.hpp"
 #include "data/bed/BedCheckIterator_minmem.hpp"
 #include "data/bed/BedDistances.hpp"
+#include "data/bed/BinIterator_BED.hpp"
 #include "data/bed/BedTypes.hpp"
+#include "data/bed/BinaryBed.hpp"
+#include "data/starch/starchStdoutArchive.hpp"
 #include "suite/BEDOPS.Version.hpp"
 #include "utility/Assertion.hpp"
 #include "utility/ByLine.hpp"
@@ -60,6 +64,13 @@ namespace BedMap {
   const std::string citation = BEDOPS::citation();
   constexpr std::size_t PoolSz = 8*8*8;
   bool minimumMemory = false;
+  Bed::CoordType binSize = 0; // > 0 when --bins generates the reference elements
+  Bed::CoordType binStagger = 0;
+  std::vector<std::string> batchRefFiles; // --batch-ref: one output file per reference file
+  std::vector<std::string> batchOutFiles;
+  bool regionSpecific = false; // --region restricts <ref-file> elements within --chrom
+  Bed::CoordType regionStart = 0;
+  Bed::CoordType regionEnd = 0;
 
   //======
   // Help
@@ -112,12 +123,32 @@ int main(int argc, char **argv) {
     const int prec = input.precision_;
     const bool sci = input.useScientific_;
     BedMap::minimumMemory = input.useMinMemory_;
+    BedMap::binSize = input.binSize_;
+    BedMap::binStagger = input.binStagger_;
+    BedMap::batchRefFiles = input.batchRefFiles_;
+    BedMap::batchOutFiles = input.batchOutFiles_;
+    BedMap::regionSpecific = input.regionSpecific_;
+    BedMap::regionStart = input.regionStart_;
+    BedMap::regionEnd = input.regionEnd_;
 
     // if all Starch inputs and no nested elements, then can use --faster if the
-    //   overlap criterion allows it.
-    const bool starchFast = !BedMap::checkStarchNesting(input.refFileName_, input.mapFileName_);
+    //   overlap criterion allows it.  Generated bins nest only when staggered by
+    //   less than the bin size.
+    const bool binsNest = (0 < BedMap::binSize && 0 < BedMap::binStagger && BedMap::binStagger < BedMap::binSize);
+    bool starchFast = (0 == BedMap::binSize)
+                        ? !BedMap::checkStarchNesting(input.refFileName_, input.mapFileName_)
+                        : (!binsNest && !BedMap::checkStarchNesting(input.mapFileName_, ""));
+    for ( std::size_t i = 1; starchFast && i < BedMap::batchRefFiles.size(); ++i )
+      starchFast = !BedMap::checkStarchNesting(BedMap::batchRefFiles[i], "");
     const bool nestCheck = input.errorCheck_ && input.fastMode_;
 
+    std::unique_ptr<starch::StdoutArchive> archive;
+    std::unique_ptr<Bed::BinaryStdout> binary;
+    if ( input.starchOutput_ )
+      archive.reset(new starch::StdoutArchive(input.starchGzip_ ? starch::kGzip : starch::kBzip2));
+    else if ( input.binaryOutput_ )
+      binary.reset(new Bed::BinaryStdout());
+
     if ( input.isPercMap_ ) { // % overlap relative to MapType's size (signalmapish)
       Bed::PercentOverlapMapping bedDist(input.percOvr_);
       Bed::Overlapping sweepDist(0); // dist type for sweep different from BedBaseVisitor's
@@ -171,6 +202,10 @@ int main(int argc, char **argv) {
                           input.sweepAll_, input.chrom_, input.skipUnmappedRows_, visitorNames, visitorArgs);
     }
 
+    if ( archive )
+      archive->Finish();
+    else if ( binary )
+      binary->Finish();
     return EXIT_SUCCESS;
   } catch(const BedMap::Help& h) { // show usage and exit success
     std::cout << BedMap::prognm << std::endl;
@@ -306,6 +341,175 @@ namespace BedMap {
     // multiv does cleanup
   }
 
+  //=============
+  // sweepBins(): reference elements are bins generated over regions in refFileName
+  //=============
+  template <typename SweepDistType, typename BedDistType, typename MapIter, typename MVType>
+  void sweepBins(const SweepDistType& st,
+                 const BedDistType& dt,
+                 const std::string& refFileName,
+                 const std::string& chrom,
+                 MapIter mapFileI,
+                 MapIter mapFileEnd,
+                 bool fastMode,
+                 bool sweepAll,
+                 MVType& multiv) {
+
+    typedef typename std::remove_const<typename MVType::RefType>::type RefType;
+
+    Ext::FPWrap<Ext::InvalidFile> refFile(refFileName);
+    Bed::bin_iterator<RefType*> refFileI(refFile, binSize, binStagger, chrom), refFileEnd;
+    if ( !fastMode )
+      WindowSweep::sweep(refFileI, refFileEnd, mapFileI, mapFileEnd, st, multiv, sweepAll);
+    else // no nested elements
+      WindowSweep::sweep(refFileI, refFileEnd, mapFileI, mapFileEnd, dt, multiv, sweepAll);
+  }
+
+  //===============
+  // FileVisitor<> : everything the wrapped visitor prints goes to its own file
+  //===============
+  template <typename VisitorType>
+  struct FileVisitor {
+    typedef typename VisitorType::RefType RefType;
+    typedef typename VisitorType::MapType MapType;
+
+    FileVisitor(VisitorType& v, FILE* out) : v_(v), out_(out) { /* */ }
+
+    // visitors print through stdout; point it at out_ only while they may print
+    inline void OnAdd(MapType* u) { v_.OnAdd(u); }
+    inline void OnDelete(MapType* u) { v_.OnDelete(u); }
+    inline void OnDone() { FILE* orig = stdout; stdout = out_; v_.OnDone(); stdout = orig; }
+    inline void OnEnd() { FILE* orig = stdout; stdout = out_; v_.OnEnd(); stdout = orig; }
+    inline void OnPurge() { v_.OnPurge(); }
+    inline void OnStart(RefType* t) { v_.OnStart(t); }
+
+  private:
+    VisitorType& v_;
+    FILE* out_;
+  };
+
+  //==============
+  // sweepBatch(): many reference files, one pass through the map file
+  //==============
+  template <typename SweepDistType, typename BedDistType, typename RefIter, typename MapIter, typename FVType>
+  void sweepBatch(const SweepDistType& st,
+                  const BedDistType& dt,
+                  std::vector<RefIter>& refFileIs,
+                  MapIter mapFileI,
+                  MapIter mapFileEnd,
+                  bool fastMode,
+                  bool sweepAll,
+                  std::vector<FVType*>& visitors) {
+
+    std::vector<RefIter> refFileEnds(refFileIs.size());
+    if ( !fastMode )
+      WindowSweep::sweep(refFileIs, refFileEnds, mapFileI, mapFileEnd, st, visitors, sweepAll);
+    else // no nested elements
+      WindowSweep::sweep(refFileIs, refFileEnds, mapFileI, mapFileEnd, dt, visitors, sweepAll);
+  }
+
+  //=================
+  // runBatchSweep(): multi-reference batch mode
+  //=================
+  template <typename BaseClass, typename SweepDistType, typename BedDistType>
+  void runBatchSweep(const SweepDistType& st,
+                     const BedDistType& dt,
+                     const std::string& mapFileName,
+                     bool errorCheck,
+                     bool nestCheck,
+                     bool fastMode,
+                     bool sweepAll,
+                     const std::string& columnSep,
+                     const std::string& chrom,
+                     bool skipUnmappedRows,
+                     std::vector< std::vector<BaseClass*> >& visitorGroups) {
+
+    typedef typename std::remove_const<typename BaseClass::RefType>::type RefType;
+    typedef typename std::remove_const<typename BaseClass::MapType>::type MapType;
+    typedef Visitors::Helpers::PrintDelim PrintType;
+    typedef Visitors::MultiVisitor<PrintType, PrintType, BaseClass> MVType;
+    typedef FileVisitor<MVType> FVType;
+    typedef Ext::FPWrap<Ext::InvalidFile> FileType;
+
+    // Set up visitors: one MultiVisitor and one output file per reference file
+    const std::size_t numRefs = batchRefFiles.size();
+    PrintType processFields(columnSep);
+    PrintType processRows("\n");
+    std::vector<FileType*> outFiles;
+    std::vector<MVType*> multivs;
+    std::vector<FVType*> visitors;
+    for ( std::size_t i = 0; i < numRefs; ++i ) {
+      outFiles.push_back(new FileType(batchOutFiles[i], "w"));
+      multivs.push_back(new MVType(visitorGroups[i], dt, processFields, processRows, !skipUnmappedRows));
+      visitors.push_back(new FVType(*multivs.back(), *outFiles.back()));
+    } // for
+
+    if ( !errorCheck ) { // faster iterators
+      std::vector<FileType*> refFiles;
+      for ( std::size_t i = 0; i < numRefs; ++i )
+        refFiles.push_back(new FileType(batchRefFiles[i]));
+      FileType mapFile(mapFileName);
+      if ( !minimumMemory ) {
+        auto& mem1 = get_pool<RefType*>();
+        auto& mem2 = get_pool<MapType*>();
+        std::vector< Bed::allocate_iterator_starch_bed<RefType*, PoolSz> > refFileIs;
+        for ( std::size_t i = 0; i < numRefs; ++i )
+          refFileIs.push_back(Bed::allocate_iterator_starch_bed<RefType*, PoolSz>(*refFiles[i], mem1, chrom));
+        Bed::allocate_iterator_starch_bed<MapType*, PoolSz> mapFileI(mapFile, mem2, chrom), mapFileEnd;
+        sweepBatch(st, dt, refFileIs, mapFileI, mapFileEnd, fastMode, sweepAll, visitors);
+      } else { // old school minimal memory iterator
+        std::vector< Bed::allocate_iterator_starch_bed_mm<RefType*> > refFileIs;
+        for ( std::size_t i = 0; i < numRefs; ++i )
+          refFileIs.push_back(Bed::allocate_iterator_starch_bed_mm<RefType*>(*refFiles[i], chrom));
+        Bed::allocate_iterator_starch_bed_mm<MapType*> mapFileI(mapFile, chrom), mapFileEnd;
+        sweepBatch(st, dt, refFileIs, mapFileI, mapFileEnd, fastMode, sweepAll, visitors);
+      }
+      for ( std::size_t i = 0; i < numRefs; ++i )
+        delete refFiles[i];
+    } else {
+      // Create file handle iterators
+      typedef Ext::UserError EType;
+      std::vector<std::ifstream*> rfins;
+      for ( std::size_t i = 0; i < numRefs; ++i ) {
+        rfins.push_back(new std::ifstream(batchRefFiles[i].c_str()));
+        if ( batchRefFiles[i] != "-" && !*rfins.back() )
+          throw(EType("Unable to find: " + batchRefFiles[i]));
+      } // for
+      bool isStdinMap = (mapFileName == "-");
+      std::ifstream mfin(mapFileName.c_str());
+      if ( !isStdinMap && !mfin )
+        throw(EType("Unable to find: " + mapFileName));
+      std::istream& mapIn = isStdinMap ? std::cin : mfin;
+      if ( !minimumMemory ) {
+        auto& mem1 = get_pool<RefType*>();
+        auto& mem2 = get_pool<MapType*>();
+        std::vector< Bed::bed_check_iterator<RefType*, PoolSz> > refFileIs;
+        for ( std::size_t i = 0; i < numRefs; ++i ) {
+          std::istream& refIn = (batchRefFiles[i] == "-") ? std::cin : *rfins[i];
+          refFileIs.push_back(Bed::bed_check_iterator<RefType*, PoolSz>(refIn, batchRefFiles[i], mem1, chrom, nestCheck));
+        } // for
+        Bed::bed_check_iterator<MapType*, PoolSz> mapFileI(mapIn, mapFileName, mem2, chrom, nestCheck), mapFileEnd;
+        sweepBatch(st, dt, refFileIs, mapFileI, mapFileEnd, fastMode, sweepAll, visitors);
+      } else { // old school minimal memory iterator
+        std::vector< Bed::bed_check_iterator_mm<RefType*> > refFileIs;
+        for ( std::size_t i = 0; i < numRefs; ++i ) {
+          std::istream& refIn = (batchRefFiles[i] == "-") ? std::cin : *rfins[i];
+          refFileIs.push_back(Bed::bed_check_iterator_mm<RefType*>(refIn, batchRefFiles[i], chrom, nestCheck));
+        } // for
+        Bed::bed_check_iterator_mm<MapType*> mapFileI(mapIn, mapFileName, chrom, nestCheck), mapFileEnd;
+        sweepBatch(st, dt, refFileIs, mapFileI, mapFileEnd, fastMode, sweepAll, visitors);
+      }
+      for ( std::size_t i = 0; i < numRefs; ++i )
+        delete rfins[i];
+    }
+
+    for ( std::size_t i = 0; i < numRefs; ++i ) {
+      delete visitors[i];
+      delete multivs[i]; // multiv does cleanup
+      delete outFiles[i];
+    } // for
+  }
+
   //============
   // runSweep(): multi-file mode
   //============
@@ -321,24 +525,63 @@ namespace BedMap {
                 const std::string& columnSep,
                 const std::string& chrom,
                 bool skipUnmappedRows,
-                std::vector<BaseClass*>& visitorGroup) {
+                std::vector< std::vector<BaseClass*> >& visitorGroups) {
 
     typedef typename std::remove_const<typename BaseClass::RefType>::type RefType;
     typedef typename std::remove_const<typename BaseClass::MapType>::type MapType;
     typedef Visitors::Helpers::PrintDelim PrintType;
 
+    if ( !batchRefFiles.empty() ) {
+      runBatchSweep(st, dt, mapFileName, errorCheck, nestCheck, fastMode, sweepAll,
+                    columnSep, chrom, skipUnmappedRows, visitorGroups);
+      return;
+    }
+
     // Set up visitors
     PrintType processFields(columnSep);
     PrintType processRows("\n");
     typedef Visitors::MultiVisitor<PrintType, PrintType, BaseClass> MVType;
-    MVType multiv(visitorGroup, dt, processFields, processRows, !skipUnmappedRows);
+    MVType multiv(visitorGroups[0], dt, processFields, processRows, !skipUnmappedRows);
+
+    if ( 0 < binSize ) { // no reference elements are read; bins are generated instead
+      if ( !errorCheck ) {
+        Ext::FPWrap<Ext::InvalidFile> mapFile(mapFileName);
+        if ( !minimumMemory ) {
+          auto& mem2 = get_pool<MapType*>();
+          Bed::allocate_iterator_starch_bed<MapType*, PoolSz> mapFileI(mapFile, mem2, chrom), mapFileEnd;
+          sweepBins(st, dt, refFileName, chrom, mapFileI, mapFileEnd, fastMode, sweepAll, multiv);
+        } else { // old school minimal memory iterator
+          Bed::allocate_iterator_starch_bed_mm<MapType*> mapFileI(mapFile, chrom), mapFileEnd;
+          sweepBins(st, dt, refFileName, chrom, mapFileI, mapFileEnd, fastMode, sweepAll, multiv);
+        }
+      } else {
+        bool isStdinMap = (mapFileName == "-");
+        std::ifstream mfin(mapFileName.c_str());
+        if ( !isStdinMap && !mfin )
+          throw(Ext::UserError("Unable to find: " + mapFileName));
+        std::istream& mapIn = isStdinMap ? std::cin : mfin;
+        if ( !minimumMemory ) {
+          auto& mem2 = get_pool<MapType*>();
+          Bed::bed_check_iterator<MapType*, PoolSz> mapFileI(mapIn, mapFileName, mem2, chrom, nestCheck), mapFileEnd;
+          sweepBins(st, dt, refFileName, chrom, mapFileI, mapFileEnd, fastMode, sweepAll, multiv);
+        } else { // old school minimal memory iterator
+          Bed::bed_check_iterator_mm<MapType*> mapFileI(mapIn, mapFileName, chrom, nestCheck), mapFileEnd;
+          sweepBins(st, dt, refFileName, chrom, mapFileI, mapFileEnd, fastMode, sweepAll, multiv);
+        }
+      }
+      return; // multiv does cleanup
+    }
 
     if ( !errorCheck ) { // faster iterators
       // Create file handle iterators
       Ext::FPWrap<Ext::InvalidFile> refFile(refFileName);
       if ( !minimumMemory ) {
         auto& mem1 = get_pool<RefType*>();
-        Bed::allocate_iterator_starch_bed<RefType*, PoolSz> refFileI(refFile, mem1, chrom), refFileEnd;
+        typedef Bed::allocate_iterator_starch_bed<RefType*, PoolSz> RefIterType;
+        RefIterType refFileI = regionSpecific
+                                 ? RefIterType(refFile, mem1, chrom, regionStart, regionEnd)
+                                 : RefIterType(refFile, mem1, chrom);
+        RefIterType refFileEnd;
         Ext::FPWrap<Ext::InvalidFile> mapFile(mapFileName);
         auto& mem2 = get_pool<MapType*>();
         Bed::allocate_iterator_starch_bed<MapType*, PoolSz> mapFileI(mapFile, mem2, chrom), mapFileEnd;
@@ -349,7 +592,11 @@ namespace BedMap {
         else // no nested elements
           WindowSweep::sweep(refFileI, refFileEnd, mapFileI, mapFileEnd, dt, multiv, sweepAll);
       } else { // old school minimal memory iterator
-        Bed::allocate_iterator_starch_bed_mm<RefType*> refFileI(refFile, chrom), refFileEnd;
+        typedef Bed::allocate_iterator_starch_bed_mm<RefType*> RefIterType;
+        RefIterType refFileI = regionSpecific
+                                 ? RefIterType(refFile, chrom, regionStart, regionEnd)
+                                 : RefIterType(refFile, chrom);
+        RefIterType refFileEnd;
         Ext::FPWrap<Ext::InvalidFile> mapFile(mapFileName);
         Bed::allocate_iterator_starch_bed_mm<MapType*> mapFileI(mapFile, chrom), mapFileEnd;
 
@@ -673,6 +920,22 @@ namespace BedMap {
     return visitorGroup;
   }
 
+  //====================
+  // getVisitorGroups() : one group per reference file
+  //====================
+  template <typename GV, typename BedDistType>
+  std::vector< std::vector<typename GV::BaseClass*> >
+           getVisitorGroups(GV& gv, const BedDistType& dt, const std::string& multivalColSep,
+                            int precision, bool useScientific, const std::vector<std::string>& visitorNames,
+                            const std::vector< std::vector<std::string> >& visitorArgs) {
+
+    std::vector< std::vector<typename GV::BaseClass*> > visitorGroups;
+    const std::size_t numGroups = std::max(static_cast<std::size_t>(1), batchRefFiles.size());
+    for ( std::size_t i = 0; i < numGroups; ++i )
+      visitorGroups.push_back(getVisitors(gv, dt, multivalColSep, precision, useScientific, visitorNames, visitorArgs));
+    return visitorGroups;
+  }
+
   //==============
   // SelectBED<>
   //==============
@@ -781,19 +1044,19 @@ namespace BedMap {
         typedef RefType MapType;
         typedef typename SelectBase<ProcessMode, BedDistType, RefType, MapType>::BaseClass BaseClass;
         BedMap::GenerateVisitors<BaseClass, 3> gv;
-        std::vector<BaseClass*> visitorGroup = getVisitors(gv, dt, multivalColSep, precision,
-                                                           useScientific, visitorNames, visitorArgs);
+        std::vector< std::vector<BaseClass*> > visitorGroups = getVisitorGroups(gv, dt, multivalColSep, precision,
+                                                                                useScientific, visitorNames, visitorArgs);
         runSweep<BaseClass>(st, dt, refFileName, mapFileName, errorCheck, nestCheck,
-                            ProcessMode, sweepAll, colSep, chrom, skipUnmappedRows, visitorGroup);
+                            ProcessMode, sweepAll, colSep, chrom, skipUnmappedRows, visitorGroups);
       } else { // v2p4p26 and earlier mode
         typedef typename SelectBED<3, NoUseMemPool>::BType RefType;
         typedef RefType MapType;
         typedef typename SelectBase<ProcessMode, BedDistType, RefType, MapType>::BaseClass BaseClass;
         BedMap::GenerateVisitors<BaseClass, 3> gv;
-        std::vector<BaseClass*> visitorGroup = getVisitors(gv, dt, multivalColSep, precision,
-                                                           useScientific, visitorNames, visitorArgs);
+        std::vector< std::vector<BaseClass*> > visitorGroups = getVisitorGroups(gv, dt, multivalColSep, precision,
+                                                                                useScientific, visitorNames, visitorArgs);
         runSweep<BaseClass>(st, dt, refFileName, mapFileName, errorCheck, nestCheck,
-                            ProcessMode, sweepAll, colSep, chrom, skipUnmappedRows, visitorGroup);
+                            ProcessMode, sweepAll, colSep, chrom, skipUnmappedRows, visitorGroups);
       }
     } else if ( minMapFields < 5 ) { // just need Bed4 for Map and Bed3 for Ref
       if ( !BedMap::minimumMemory ) {
@@ -803,10 +1066,10 @@ namespace BedMap {
         typedef typename SelectBED<4, UseMemPool>::BType MapType;
         typedef typename SelectBase<ProcessMode, BedDistType, RefType, MapType>::BaseClass BaseClass;
         BedMap::GenerateVisitors<BaseClass, 4> gv;
-        std::vector<BaseClass*> visitorGroup = getVisitors(gv, dt, multivalColSep, precision,
-                                                           useScientific, visitorNames, visitorArgs);
+        std::vector< std::vector<BaseClass*> > visitorGroups = getVisitorGroups(gv, dt, multivalColSep, precision,
+                                                                                useScientific, visitorNames, visitorArgs);
         runSweep<BaseClass>(st, dt, refFileName, mapFileName, errorCheck, nestCheck,
-                            ProcessMode, sweepAll, colSep, chrom, skipUnmappedRows, visitorGroup);
+                            ProcessMode, sweepAll, colSep, chrom, skipUnmappedRows, visitorGroups);
       } else { // v2p4p26 and earlier mode
         Ext::Assert<Ext::ProgramError>(minRefFields < minMapFields,
                                        "BedMap::callSweep()-2 minimum fields program error detected");
@@ -814,10 +1077,10 @@ namespace BedMap {
         typedef typename SelectBED<4, NoUseMemPool>::BType MapType;
         typedef typename SelectBase<ProcessMode, BedDistType, RefType, MapType>::BaseClass BaseClass;
         BedMap::GenerateVisitors<BaseClass, 4> gv;
-        std::vector<BaseClass*> visitorGroup = getVisitors(gv, dt, multivalColSep, precision,
-                                                           useScientific, visitorNames, visitorArgs);
+        std::vector< std::vector<BaseClass*> > visitorGroups = getVisitorGroups(gv, dt, multivalColSep, precision,
+                                                                                useScientific, visitorNames, visitorArgs);
         runSweep<BaseClass>(st, dt, refFileName, mapFileName, errorCheck, nestCheck,
-                            ProcessMode, sweepAll, colSep, chrom, skipUnmappedRows, visitorGroup);
+                            ProcessMode, sweepAll, colSep, chrom, skipUnmappedRows, visitorGroups);
       }
     } else { // need Bed5 for Map and Bed3 for Ref
       if ( !BedMap::minimumMemory ) {
@@ -827,10 +1090,10 @@ namespace BedMap {
         typedef typename SelectBED<5, UseMemPool>::BType MapType;
         typedef typename SelectBase<ProcessMode, BedDistType, RefType, MapType>::BaseClass BaseClass;
         BedMap::GenerateVisitors<BaseClass, 5> gv;
-        std::vector<BaseClass*> visitorGroup = getVisitors(gv, dt, multivalColSep, precision,
-                                                           useScientific, visitorNames, visitorArgs);
+        std::vector< std::vector<BaseClass*> > visitorGroups = getVisitorGroups(gv, dt, multivalColSep, precision,
+                                                                                useScientific, visitorNames, visitorArgs);
         runSweep<BaseClass>(st, dt, refFileName, mapFileName, errorCheck, nestCheck,
-                            ProcessMode, sweepAll, colSep, chrom, skipUnmappedRows, visitorGroup);
+                            ProcessMode, sweepAll, colSep, chrom, skipUnmappedRows, visitorGroups);
       } else { // v2p4p26 and earlier mode
         Ext::Assert<Ext::ProgramError>(minRefFields == 3,
                                        "BedMap::callSweep()-2 minimum fields program error detected");
@@ -838,10 +1101,10 @@ namespace BedMap {
         typedef typename SelectBED<5, NoUseMemPool>::BType MapType;
         typedef typename SelectBase<ProcessMode, BedDistType, RefType, MapType>::BaseClass BaseClass;
         BedMap::GenerateVisitors<BaseClass, 5> gv;
-        std::vector<BaseClass*> visitorGroup = getVisitors(gv, dt, multivalColSep, precision,
-                                                           useScientific, visitorNames, visitorArgs);
+        std::vector< std::vector<BaseClass*> > visitorGroups = getVisitorGroups(gv, dt, multivalColSep, precision,
+                                                                                useScientific, visitorNames, visitorArgs);
         runSweep<BaseClass>(st, dt, refFileName, mapFileName, errorCheck, nestCheck,
-                            ProcessMode, sweepAll, colSep, chrom, skipUnmappedRows, visitorGroup);
+                            ProcessMode, sweepAll, colSep, chrom, skipUnmappedRows, visitorGroups);
       }
     }
   }
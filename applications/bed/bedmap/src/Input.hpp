@@ -79,7 +79,9 @@ namespace BedMap {
         precision_(6), useScientific_(false), useMinMemory_(false), setPrec_(false), numFiles_(0),
         minRefFields_(0), minMapFields_(0), errorCheck_(false), sweepAll_(false),
         outDelim_("|"), multiDelim_(";"), fastMode_(false), rangeAlias_(false),
-        chrom_("all"), skipUnmappedRows_(false) {
+        chrom_("all"), regionSpecific_(false), regionStart_(0), regionEnd_(0),
+        skipUnmappedRows_(false), binSize_(0), binStagger_(0),
+        starchOutput_(false), starchGzip_(false), binaryOutput_(false) {
 
       // Process user's operation options
       if ( argc <= 1 )
@@ -120,12 +122,69 @@ namespace BedMap {
           chrom_ = argv[argcntr++];
           Ext::Assert<ArgError>(chrom_.find("--") != 0,
                                 "Apparent option: " + std::string(argv[argcntr]) + " where chromosome expected.");
+        } else if ( next == "region" ) {
+          Ext::Assert<ArgError>(!regionSpecific_, "--region specified multiple times");
+          Ext::Assert<ArgError>(argcntr < argc, "No <start>-<end> given for --region");
+          std::string sval = argv[argcntr++];
+          const std::size_t dash = sval.find('-');
+          Ext::Assert<ArgError>(dash != std::string::npos && dash > 0 && dash + 1 < sval.size() &&
+                                sval.find_first_not_of(posIntegers) == dash &&
+                                sval.find_first_not_of(posIntegers, dash + 1) == std::string::npos,
+                                "Expect --region <start>-<end> with non-negative integers");
+          std::stringstream convs(sval.substr(0, dash)), conve(sval.substr(dash + 1));
+          convs >> regionStart_;
+          conve >> regionEnd_;
+          Ext::Assert<ArgError>(regionStart_ < regionEnd_, "--region <start> must be less than <end>");
+          regionSpecific_ = true;
         } else if ( next == "multidelim" ) {
           Ext::Assert<ArgError>(multiDelim_ == ";", "--multidelim specified multiple times");
           Ext::Assert<ArgError>(argcntr < argc, "No multi-value column delimmiter given");
           multiDelim_ = argv[argcntr++];
           Ext::Assert<ArgError>(multiDelim_.find("--") != 0,
                                 "Apparent option: " + std::string(argv[argcntr]) + " where output delimiter expected.");
+        } else if ( next == "bins" ) {
+          Ext::Assert<ArgError>(0 == binSize_, "--bins specified multiple times");
+          Ext::Assert<ArgError>(argcntr < argc, "No bin size given for --bins");
+          std::string sval = argv[argcntr++];
+          std::string stag = "";
+          const std::size_t colon = sval.find(':');
+          if ( colon != std::string::npos ) {
+            stag = sval.substr(colon + 1);
+            sval = sval.substr(0, colon);
+            Ext::Assert<ArgError>(!stag.empty() && stag.find_first_not_of(posIntegers) == std::string::npos,
+                                  "Non-positive-integer stagger: " + stag + " for --bins");
+          }
+          Ext::Assert<ArgError>(!sval.empty() && sval.find_first_not_of(posIntegers) == std::string::npos,
+                                "Non-positive-integer argument: " + sval + " for --bins");
+          std::stringstream conv(sval);
+          conv >> binSize_;
+          Ext::Assert<ArgError>(binSize_ > 0, "--bins size must be > 0");
+          if ( !stag.empty() ) {
+            std::stringstream conv2(stag);
+            conv2 >> binStagger_;
+            Ext::Assert<ArgError>(binStagger_ > 0, "--bins stagger must be > 0");
+          }
+        } else if ( next == "batch-ref" ) {
+          Ext::Assert<ArgError>(argcntr + 1 < argc, "--batch-ref needs a <ref-file> and an <output-file>");
+          const std::string ref = argv[argcntr++];
+          const std::string out = argv[argcntr++];
+          Ext::Assert<ArgError>(ref.find("--") != 0 && out.find("--") != 0,
+                                "Apparent option: " + (ref.find("--") == 0 ? ref : out) + " where --batch-ref file expected.");
+          Ext::Assert<ArgError>(out != "-", "--batch-ref output must be a file, not '-'");
+          Ext::Assert<ArgError>(std::find(batchOutFiles_.begin(), batchOutFiles_.end(), out) == batchOutFiles_.end(),
+                                "--batch-ref output file given multiple times: " + out);
+          batchRefFiles_.push_back(ref);
+          batchOutFiles_.push_back(out);
+        } else if ( next == "starch-output" ) {
+          Ext::Assert<ArgError>(!starchOutput_, "--starch-output specified multiple times");
+          starchOutput_ = true;
+          if ( argcntr < argc && (std::string(argv[argcntr]) == "--bzip2" || std::string(argv[argcntr]) == "--gzip") )
+            starchGzip_ = (std::string(argv[argcntr++]) == "--gzip");
+        } else if ( next == "bzip2" || next == "gzip" ) {
+          throw(ArgError("--" + next + " must directly follow --starch-output"));
+        } else if ( next == "binary-out" ) {
+          Ext::Assert<ArgError>(!binaryOutput_, "--binary-out specified multiple times");
+          binaryOutput_ = true;
         } else if ( next == "skip-unmapped" ) {
           skipUnmappedRows_ = true;
         } else if ( next == "sci" ) {
@@ -355,7 +414,15 @@ namespace BedMap {
       Ext::Assert<ArgError>(0 <= argc - argcntr, "Need [one or] two input files");
       numFiles_ = argc - argcntr + 1;
       Ext::Assert<ArgError>(1 <= numFiles_ && numFiles_ <= 2, "Need [one or] two input files");
-      if ( 2 == numFiles_ ) {
+      if ( !batchRefFiles_.empty() ) { // the only file given is the <map-file>
+        Ext::Assert<ArgError>(1 == numFiles_, "With --batch-ref, give the <map-file> only");
+        Ext::Assert<ArgError>(0 == binSize_, "--batch-ref and --bins detected.  Choose one.");
+        Ext::Assert<ArgError>(std::count(batchRefFiles_.begin(), batchRefFiles_.end(), "-") <= 1,
+                              "Cannot have stdin set for two files");
+        refFileName_ = batchRefFiles_[0];
+        mapFileName_ = argv[argc-1];
+        numFiles_ = 2;
+      } else if ( 2 == numFiles_ ) {
         refFileName_ = argv[argc-2];
         mapFileName_ = argv[argc-1];
       } else { // single-file mode
@@ -366,6 +433,20 @@ namespace BedMap {
       }
       Ext::Assert<ArgError>(refFileName_ != "-" || mapFileName_ != "-",
                             "Cannot have stdin set for two files");
+      Ext::Assert<ArgError>(0 == binSize_ || 2 == numFiles_,
+                            "--bins requires a <ref-file> of regions or chromosome sizes, and a <map-file>");
+      Ext::Assert<ArgError>(!regionSpecific_ || chrom_ != "all", "--region requires --chrom");
+      Ext::Assert<ArgError>(!regionSpecific_ || 2 == numFiles_, "--region requires a <ref-file> and a <map-file>");
+      Ext::Assert<ArgError>(!regionSpecific_ || !errorCheck_, "--region may not be used with --ec or --header");
+      Ext::Assert<ArgError>(!regionSpecific_ || 0 == binSize_, "--region and --bins detected.  Choose one.");
+      Ext::Assert<ArgError>(!regionSpecific_ || batchRefFiles_.empty(), "--region and --batch-ref detected.  Choose one.");
+      Ext::Assert<ArgError>(!starchOutput_ || batchRefFiles_.empty(), "--starch-output and --batch-ref detected.  Choose one.");
+      Ext::Assert<ArgError>(!starchOutput_ || visitorNames_.front() == details::name<typename VT::EchoRefAll>(),
+                            "--starch-output requires --" + details::name<typename VT::EchoRefAll>() + " as the first operation");
+      Ext::Assert<ArgError>(!starchOutput_ || !binaryOutput_, "--starch-output and --binary-out detected.  Choose one.");
+      Ext::Assert<ArgError>(!binaryOutput_ || batchRefFiles_.empty(), "--binary-out and --batch-ref detected.  Choose one.");
+      Ext::Assert<ArgError>(!binaryOutput_ || visitorNames_.front() == details::name<typename VT::EchoRefAll>(),
+                            "--binary-out requires --" + details::name<typename VT::EchoRefAll>() + " as the first operation");
     }
 
 
@@ -398,7 +479,17 @@ namespace BedMap {
     bool fastMode_;
     bool rangeAlias_;
     std::string chrom_;
+    bool regionSpecific_;
+    Bed::CoordType regionStart_;
+    Bed::CoordType regionEnd_;
     bool skipUnmappedRows_;
+    Bed::CoordType binSize_;
+    Bed::CoordType binStagger_;
+    std::vector<std::string> batchRefFiles_;
+    std::vector<std::string> batchOutFiles_;
+    bool starchOutput_;
+    bool starchGzip_;
+    bool binaryOutput_;
 
   private:
     struct MapFields {
@@ -457,6 +548,7 @@ namespace BedMap {
     usage << "     Any input file must be sorted per the sort-bed utility.                                        \n";
     usage << "     The program accepts BED and Starch file formats.                                               \n";
     usage << "     You may use '-' for a BED file to indicate the input comes from stdin.                         \n";
+    usage << "     Binary streams written with --binary-out are recognized on any input.                          \n";
     usage << "                                                                                                    \n";
     usage << "     Traverse <ref-file>, while applying <operation(s)> on qualified, overlapping elements from     \n";
     usage << "       <map-file>.  Output is one line for each line in <ref-file>, sent to standard output.  There \n";
@@ -467,6 +559,13 @@ namespace BedMap {
     usage << "                                                                                                    \n";
     usage << "    Process Flags:                                                                                  \n";
     usage << "     --------                                                                                       \n";
+    usage << "      --batch-ref <ref-file> <out-file>                                                             \n";
+    usage << "                            Map <ref-file> and write results to <out-file>.  Use any number of times\n";
+    usage << "                              and give only <map-file>, which is then read just once.             \n";
+    usage << "      --binary-out          Write a binary stream for another BEDOPS program to read, rather than   \n";
+    usage << "                              text.  Same requirements as --starch-output.  Faster through pipes.   \n";
+    usage << "      --bins <bp>[:<bp>]    Generate bins of the first <bp> size, stepping by the second <bp>      \n";
+    usage << "                              (default: bin size), over <ref-file> regions (BED or chrom sizes).    \n";
     usage << "      --chrom <chromosome>  Jump to and process data for given <chromosome> only.                   \n";
     usage << "      --delim <delim>       Change output delimiter from '|' to <delim> between columns (e.g. \'\\t\').\n";
     usage << "      --ec                  Error check all input files (slower).                                   \n";
@@ -477,8 +576,14 @@ namespace BedMap {
     usage << "      --min-memory          Minimize memory usage (slower).                                         \n";
     usage << "      --multidelim <delim>  Change delimiter of multi-value output columns from ';' to <delim>.     \n";
     usage << "      --prec <int>          Change the post-decimal precision of scores to <int>.  0 <= <int>.      \n";
+    usage << "      --region <start>-<end>                                                                        \n";
+    usage << "                            With --chrom, map only <ref-file> elements that overlap the 0-based,    \n";
+    usage << "                              half-open region [start, end).  Starch archives skip straight to it.  \n";
     usage << "      --sci                 Use scientific notation for score outputs.                              \n";
     usage << "      --skip-unmapped       Print no output for a row with no mapped elements.                      \n";
+    usage << "      --starch-output [--bzip2|--gzip]                                                              \n";
+    usage << "                            Write output as a Starch archive (bzip2 by default).  Requires --echo   \n";
+    usage << "                              first, and --delim '\\t' with 3-column <ref-file>s so rows are BED.   \n";
     usage << "      --sweep-all           Ensure <map-file> is read completely (helps to prevent broken pipes).   \n";
     usage << "      --version             Print program information.                                              \n";
     usage << "                                                                                                    \n";
@@ -25,15 +25,12 @@
 #define BED_PAD_READER_BEDOPS_H
 
 #include <algorithm>
-#include <cmath>
-#include <deque>
-#include <iterator>
-#include <map>
-#include <set>
+#include <cstdlib>
+#include <cstring>
 #include <string>
 #include <utility>
+#include <vector>
 
-#include "data/bed/BedCompare.hpp"
 #include "suite/BEDOPS.Constants.hpp"
 #include "utility/Assertion.hpp"
 #include "utility/ByLine.hpp"
@@ -59,9 +56,13 @@ struct NoPtr<T*> {
     chr1  0  90
  this is no longer in sort-bed order.
 
-  This only is a problem near zero, when lpad_ < 0.  The private member function
-   getFirst() deals with everything, and should ONLY be called from the constructor or
-   during chromosome changes.
+  This only is a problem near zero, when lpad_ < 0.  Every element of a chromosome
+   whose start coordinate is <= |lpad_| gets clamped to 0 after padding, and only
+   those elements may need reordering.  On each chromosome change, fillHeap() moves
+   that (bounded) group into a min-heap keyed on padded coordinates, with an input
+   sequence number to keep ties in input order.  All later elements on the chromosome
+   stream straight through, since their padded starts are > 0 and stay in order.
+   Left and right paddings are applied independently in a single pass.
 */
 
 
@@ -75,18 +76,16 @@ struct BedPadReader {
 
   explicit BedPadReader(IterType iter, int lpadding, int rpadding)
            : iter_(iter), lpad_(lpadding), rpad_(rpadding),
-             lastChr_(""), cache_() {
-    if ( lpad_ < 0 ) {
-      getFirst();
-    }
-  }
+             nopad_(0 == lpadding && 0 == rpadding),
+             lastChr_(""), cache_(), heap_(), seq_(0)
+    { /* */ }
 
   BedPadReader(const BedPadReader& b); // not safe to copy due to iterators in some cases
   BedPadReader& operator=(const BedPadReader& b); // not safe to assign due to iterators in some cases
 
   inline bool HasNext() {
     static const IterType end;
-    if ( !cache_.empty() )
+    if ( !cache_.empty() || !heap_.empty() )
       return(true);
     if ( iter_ == end )
       return(false);
@@ -123,50 +122,35 @@ struct BedPadReader {
     static const IterType end;
 
     // lpad_ may be +, rpad_ may be -.  In either case, padding may cause an element to become
-    //   a non-element (vaporizes).  Nothing in the cache_ is a problem.  Only need to
+    //   a non-element (vaporizes).  Nothing in the cache_ or heap_ is a problem.  Only need to
     //   check when reading something new from iter_.
     while ( !done ) {
-      if ( !cache_.empty() ) { // get from the cache_
+      if ( !cache_.empty() ) { // things given back through PushBack() come first
         tmp = cache_.back();
         cache_.pop_back();
-        if ( lpad_ < 0 ) // else, don't waste time on next unimportant assignment
-          lastChr_ = tmp->chrom();
         return(tmp);
-      } else if ( iter_ == end ) { // && cache_.empty()
+      } else if ( !heap_.empty() ) { // reordered elements near the start of a chromosome
+        std::pop_heap(heap_.begin(), heap_.end(), heapCompare_);
+        tmp = heap_.back().first;
+        heap_.pop_back();
+        return(tmp);
+      } else if ( iter_ == end ) {
         return(static_cast<BedType*>(0));
-      } else { // read from iter_
-        tmp = *iter_; // cannot post-increment here due to lpad_ < 0 && getFirst() possibility
-        if ( rpad_ < 0 || lpad_ > 0 ) { // tmp->end() is an Bed::CoordType; must cast
-          ++iter_;
-          tmp->start(tmp->start() + lpad_);
-          if ( static_cast<double>(tmp->end()) + rpad_ > tmp->start() ) {
-            tmp->end(tmp->end() + rpad_);
-            return(tmp);
-          }
-          else // tmp vaporized by padding
-            Remove(tmp);
-        } else if ( lpad_ < 0 ) {
-          if ( tmp->chrom() != lastChr_ ) { // cache_ is empty && iter_ != end
-            getFirst(); // iter_ increments dealt with in getFirst()
-            tmp = cache_.back(); // next item may have changed after getFirst()
-            cache_.pop_back();
-            lastChr_ = tmp->chrom();
-          } else { // getFirst() already dealt with any padding issues on this chromosome
-            tmp->start(tmp->start() + lpad_);
-            tmp->end(tmp->end() + rpad_);
-            ++iter_;
-          }
-          return(tmp);
-        } else if ( rpad_ > 0 ) {
-          tmp->start(tmp->start() + lpad_);
-          tmp->end(tmp->end() + rpad_);
-          ++iter_;
-          return(tmp);
-        } else {
-          ++iter_;
-          return(tmp);
-        }
+      } else if ( nopad_ ) {
+        return(*iter_++);
+      }
+
+      tmp = *iter_; // cannot post-increment here due to fillHeap() possibility
+      if ( lpad_ < 0 && 0 != std::strcmp(tmp->chrom(), lastChr_.c_str()) ) {
+        lastChr_ = tmp->chrom();
+        fillHeap(); // iter_ increments dealt with in fillHeap()
+        continue;
       }
+
+      ++iter_;
+      if ( pad(tmp) )
+        return(tmp);
+      Remove(tmp); // tmp vaporized by padding
     } // while
   }
 
@@ -175,6 +159,9 @@ struct BedPadReader {
       Remove(cache_.back());
       cache_.pop_back();
     }
+    for ( std::size_t i = 0; i < heap_.size(); ++i )
+      Remove(heap_[i].first);
+    heap_.clear();
   }
 
   void CleanAll() {
@@ -185,106 +172,66 @@ struct BedPadReader {
   }
 
   ~BedPadReader() {
-    while ( !cache_.empty() ) {
-      Remove(cache_.back());
-      cache_.pop_back();
-    }
+    Clean();
   }
 
 
 private:
+  typedef std::pair<BedType*, std::size_t> HeapEntry; // element, input order
+
+  struct HeapCompare { // std::*_heap() put the greatest element first; invert for a min-heap
+    inline bool operator()(const HeapEntry& a, const HeapEntry& b) const {
+      if ( a.first->start() != b.first->start() )
+        return a.first->start() > b.first->start();
+      if ( a.first->end() != b.first->end() )
+        return a.first->end() > b.first->end();
+      return a.second > b.second;
+    }
+  };
+
+  // Apply lpad_ and rpad_ to bt.  Returns false if bt vaporizes, leaving bt unmodified.
+  inline bool pad(BedType* bt) const {
+    Bed::SignedCoordType s = static_cast<Bed::SignedCoordType>(bt->start()) + lpad_;
+    const Bed::SignedCoordType e = static_cast<Bed::SignedCoordType>(bt->end()) + rpad_;
+    if ( s < 0 )
+      s = 0;
+    if ( e <= s )
+      return(false);
+    bt->start(static_cast<Bed::CoordType>(s));
+    bt->end(static_cast<Bed::CoordType>(e));
+    return(true);
+  }
 
-  // Only called from the constructor or on chrom changes WHEN lpad_ is < 0
-  void getFirst() {
-    // Only for the case where subtracting padding results in a start coordinate
-    //  of zero or less.  Need to keep track of multiple items that are ties to
-    //  ensure the output order is the same as the input order.
-    // After separating lpad_ from rpad_, need to worry about vaporizing elements
-    //  here too for the case when: lpad_ < 0 and rpad_ < lpad_
-    typedef Bed::GenomicCompare<BedType, BedType> CompLess;
-    typedef std::set<BedType*, CompLess> SType;
-    typedef std::multiset<BedType*, CompLess> MType;
-    typedef std::vector<BedType*> TieType; // helps deal with ties after padding
-    MType mset;
-    SType sset;
-    TieType tmap;
-    static BedType* const zero = static_cast<BedType*>(0);
-    BedType* tmp = zero;
+  // Only called on chromosome changes WHEN lpad_ is < 0.  Gathers every element of
+  //  lastChr_ whose padded start gets clamped to 0; these are the only ones that
+  //  may change relative order.  heap_ storage is reused between chromosomes.
+  void fillHeap() {
     static const IterType end;
     const Bed::CoordType lpd = static_cast<Bed::CoordType>(std::abs(lpad_));
-    std::pair<typename SType::iterator, bool> p;
-    while ( iter_ != end && (tmp = *iter_++) ) {
-      if ( tmp->start() > lpd ) { // cannot be >=
-        tmp->start(tmp->start() - lpd);
-        if ( tmp->end() + rpad_ > tmp->start() ) {
-          tmp->end(tmp->end() + rpad_);
-          mset.insert(tmp);
-          break; // all others meet the invariant condition: tmp->start() > lpd
-        } else { // lpad_ < 0 and rpad_ < lpad_
-          Remove(tmp);
-          continue;
-        }
-      }
-      if ( static_cast<double>(tmp->end()) + rpad_ <= 0 ) {
+    BedType* tmp = static_cast<BedType*>(0);
+    while ( iter_ != end ) {
+      tmp = *iter_;
+      if ( tmp->start() > lpd || 0 != std::strcmp(tmp->chrom(), lastChr_.c_str()) )
+        break;
+      ++iter_;
+      if ( pad(tmp) ) {
+        heap_.push_back(std::make_pair(tmp, seq_++));
+        std::push_heap(heap_.begin(), heap_.end(), heapCompare_);
+      } else {
         Remove(tmp);
-        continue;
-      }
-      tmp->start(0);
-      tmp->end(tmp->end() + rpad_);
-      mset.insert(tmp);
-      p = sset.insert(tmp);
-      if ( !p.second ) { // a tie
-        if ( tmap.empty() )
-          tmap.push_back(*sset.find(tmp));
-        else {
-          bool add = true;
-          BedType* tmptr = *sset.find(tmp);
-          for ( std::size_t i = tmap.size(); i > 0; --i ) {
-            if ( tmap[i-1] == tmptr ) { // already in tmap?
-              add = false;
-              break;
-            }
-          } // for
-          if ( add )
-            tmap.push_back(tmptr);
-        }
-        tmap.push_back(tmp);
       }
     } // while
-
-    cache_.clear(); // cache_ better be empty already!
-    sset.clear();
-
-    CompLess cless;
-    std::size_t number = 0;
-    if ( !tmap.empty() ) {
-      for ( typename MType::const_iterator i = mset.begin(); i != mset.end(); ++i ) {
-        if ( number >= tmap.size() ) {
-          cache_.push_front(*i);
-          continue;
-        }
-
-        if ( tmap[number] == *i ) {
-          cache_.push_front(*i);
-          ++number;
-        } else if ( 0 == cless.operator()(tmap[number], *i) && 0 == cless.operator()(*i, tmap[number]) ) { // tie, but not tmap[number]
-          cache_.push_front(tmap[number]); // tmap holds the proper order on ties
-          ++number;
-          --i; // try again - may be more than just 2 in the tie
-        } else {
-          cache_.push_front(*i);
-        }
-      } // for
-    }
-    else // cache_ holds the 'next' item at its back
-      std::copy(mset.rbegin(), mset.rend(), std::back_inserter(cache_));
   }
 
 private:
   IterType iter_;
   int lpad_, rpad_;
+  const bool nopad_;
   std::string lastChr_;
-  std::deque<BedType*> cache_;
+  std::vector<BedType*> cache_;
+  std::vector<HeapEntry> heap_;
+  std::size_t seq_;
+  HeapCompare heapCompare_;
 };
 
 } // namespace BedOperations
@@ -22,6 +22,8 @@
 //
 
 #include <algorithm>
+#include <cinttypes>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <deque>
@@ -37,11 +39,16 @@
 #include <utility>
 #include <vector>
 
+#include <sys/stat.h>
+
 #include "algorithm/visitors/helpers/ProcessBedVisitorRow.hpp"
 #include "data/bed/AllocateIterator_BED_starch.hpp"
 #include "data/bed/BedCheckIterator.hpp"
 #include "data/bed/BedCompare.hpp"
 #include "data/bed/BedTypes.hpp"
+#include "data/bed/BinaryBed.hpp"
+#include "data/starch/starchApi.hpp"
+#include "data/starch/starchStdoutArchive.hpp"
 #include "suite/BEDOPS.Constants.hpp"
 #include "suite/BEDOPS.Version.hpp"
 #include "utility/Exception.hpp"
@@ -98,6 +105,9 @@ namespace { // unnamed
   auto
   get_pool() -> decltype( get_pool_details(Ext::Type2Type<BedTypePtr>()) )
     { return get_pool_details(Ext::Type2Type<BedTypePtr>()); }
+
+  // set for --binary-out
+  Bed::BinaryBedWriter* binaryOut = static_cast<Bed::BinaryBedWriter*>(0);
 } // unnamed
 
 
@@ -121,7 +131,19 @@ int main(int argc, char** argv) {
   try {
     // Check inputs; initialize variables
     BedOperations::Input input(argc, argv);
-    BedOperations::doWork(input);
+    if ( input.StarchOutput() ) {
+      starch::StdoutArchive archive(input.StarchGzip() ? starch::kGzip : starch::kBzip2);
+      BedOperations::doWork(input);
+      archive.Finish();
+    } else if ( input.BinaryOutput() ) {
+      Bed::BinaryBedWriter writer(stdout);
+      binaryOut = &writer;
+      BedOperations::doWork(input);
+      writer.flush();
+      binaryOut = static_cast<Bed::BinaryBedWriter*>(0);
+    }
+    else
+      BedOperations::doWork(input);
     return(EXIT_SUCCESS);
   } catch(BedOperations::HelpException& h) {
     std::cout << BedOperations::prognm << std::endl;
@@ -187,7 +209,10 @@ void clean(Cont& c) {
 template <typename BedType>
 inline void record(BedType* b) {
   static Visitors::BedHelpers::Println printer;
-  printer.operator()(b);
+  if ( binaryOut )
+    binaryOut->write(b);
+  else
+    printer.operator()(b);
 }
 
 //===================
@@ -285,7 +310,10 @@ struct createWork {
       nextFilePtr = new FPType(input.GetFileName(i));
       filePointers.push_back(nextFilePtr);
       if ( 0 == i ) {
-        IterType1 fileI(*nextFilePtr, mem1, input.Chrom());
+        // --region restricts the reference file only; elements overlapping it may lie outside
+        IterType1 fileI = input.RegionSpecific()
+                            ? IterType1(*nextFilePtr, mem1, input.Chrom(), input.RegionStart(), input.RegionEnd())
+                            : IterType1(*nextFilePtr, mem1, input.Chrom());
         refFile = new BedReaderType1(fileI, 0, 0); // never pad sole reference file
       } else {
         IterType2 t(*nextFilePtr, mem2, input.Chrom());
@@ -326,7 +354,9 @@ struct createWork<IterType, IterType> {
     for ( int i = 0; i < input.NumberFiles(); ++i ) {
       nextFilePtr = new FPType(input.GetFileName(i));
       filePointers.push_back(nextFilePtr);
-      IterType t(*nextFilePtr, mem, input.Chrom());
+      IterType t = input.RegionSpecific()
+                     ? IterType(*nextFilePtr, mem, input.Chrom(), input.RegionStart(), input.RegionEnd())
+                     : IterType(*nextFilePtr, mem, input.Chrom());
       bedFiles.push_back(new BedReaderType(t, input.GetLeftPad(), input.GetRightPad()));
     } // for
 
@@ -458,6 +488,105 @@ struct createWork< Bed::bed_check_iterator<BedType*, Sz>, Bed::bed_check_iterato
   }
 };
 
+//=================
+// allStarchFiles()
+//=================
+bool allStarchFiles(const Input& input) {
+  // regular files only: named pipes and stdin cannot be positioned by the Starch API
+  for ( int i = 0; i < input.NumberFiles(); ++i ) {
+    const std::string fn = input.GetFileName(i);
+    struct stat st;
+    if ( fn == "-" || stat(fn.c_str(), &st) == -1 || S_ISFIFO(st.st_mode) )
+      return(false);
+    FILE* fp = std::fopen(fn.c_str(), "r");
+    if ( !fp )
+      return(false); // let the general path report the problem
+    const bool isStarch = !Bed::binary_details::leadsWithNull(fp) && starch::Starch::isStarch(fp);
+    std::fclose(fp);
+    if ( !isStarch )
+      return(false);
+  } // for
+  return(true);
+}
+
+//==============
+// StarchRecord
+//==============
+struct StarchRecord {
+  StarchRecord() : archive_(static_cast<starch::Starch*>(0)), idx_(0),
+                   chrom_(""), start_(0), end_(0), rest_("")
+    { /* */ }
+
+  inline bool next()
+    { return archive_->extractBEDRecord(chrom_, start_, end_, rest_); }
+
+  starch::Starch* archive_;
+  std::size_t idx_;
+  const char* chrom_;
+  Bed::CoordType start_, end_;
+  const char* rest_;
+};
+
+struct InvertStarchRecordCompare { // min element first in a std::priority_queue<>
+  inline bool operator()(const StarchRecord* a, const StarchRecord* b) const {
+    static int v = 0;
+    if ( (v = std::strcmp(a->chrom_, b->chrom_)) != 0 )
+      return v > 0;
+    if ( a->start_ != b->start_ )
+      return a->start_ > b->start_;
+    if ( a->end_ != b->end_ )
+      return a->end_ > b->end_;
+    if ( (v = std::strcmp(a->rest_, b->rest_)) != 0 )
+      return v > 0;
+    return a->idx_ > b->idx_;
+  }
+};
+
+//====================
+// doStarchUnionAll()
+//====================
+void doStarchUnionAll(const Input& input) {
+  /* k-way merge of decoded Starch records.  Unlike the general path, records are
+       never formatted to text, re-parsed into Bed objects and compared there. */
+  typedef std::priority_queue<StarchRecord*, std::vector<StarchRecord*>, InvertStarchRecordCompare> PQ;
+  std::vector<StarchRecord> records(input.NumberFiles());
+  PQ pq;
+  try {
+    for ( std::size_t i = 0; i < records.size(); ++i ) {
+      const std::string fn = input.GetFileName(static_cast<int>(i));
+      FILE* fp = std::fopen(fn.c_str(), "r");
+      if ( !fp )
+        throw(Ext::InvalidFile("Unable to find file: " + fn));
+      if ( input.RegionSpecific() )
+        records[i].archive_ = new starch::Starch(fp, input.Chrom(), input.RegionStart(), input.RegionEnd()); // owns fp
+      else
+        records[i].archive_ = new starch::Starch(fp, input.Chrom(), true); // owns fp
+      records[i].idx_ = i;
+      if ( records[i].next() )
+        pq.push(&records[i]);
+    } // for
+
+    while ( !pq.empty() ) {
+      StarchRecord* r = pq.top();
+      pq.pop();
+      if ( binaryOut )
+        binaryOut->write(r->chrom_, r->start_, r->end_, r->rest_, std::strlen(r->rest_));
+      else if ( *r->rest_ != '\0' )
+        std::printf("%s\t%" PRIu64 "\t%" PRIu64 "\t%s\n", r->chrom_, r->start_, r->end_, r->rest_);
+      else
+        std::printf("%s\t%" PRIu64 "\t%" PRIu64 "\n", r->chrom_, r->start_, r->end_);
+      if ( r->next() )
+        pq.push(r);
+    } // while
+  } catch(...) {
+    for ( std::size_t i = 0; i < records.size(); ++i )
+      delete records[i].archive_;
+    throw;
+  }
+  for ( std::size_t i = 0; i < records.size(); ++i )
+    delete records[i].archive_;
+}
+
 //==========
 // doWork()
 //==========
@@ -466,7 +595,9 @@ void doWork(const Input& input) {
   const bool errorCheck = input.ErrorCheck();
   if ( mode == UNIONALL ) { // Keep all columns in all files
     typedef Bed::B3Rest BedType;
-    if ( errorCheck )
+    if ( !errorCheck && 0 == input.GetLeftPad() && 0 == input.GetRightPad() && allStarchFiles(input) )
+      doStarchUnionAll(input);
+    else if ( errorCheck )
       createWork< Bed::bed_check_iterator<BedType*, PoolSz> >::run(input);
     else
       createWork< Bed::allocate_iterator_starch_bed<BedType*, PoolSz> >::run(input);
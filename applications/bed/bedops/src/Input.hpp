@@ -31,6 +31,7 @@
 #include <string>
 #include <vector>
 
+#include "suite/BEDOPS.Constants.hpp"
 #include "utility/Assertion.hpp"
 #include "utility/Exception.hpp"
 
@@ -58,7 +59,8 @@ struct Input {
                                  subsetPerc_(1), useSubsetPerc_(true), chopBP_(1),
                                  chopStaggerBP_(0), chopCutShort_(false), errorCheck_(false),
                                  lpad_(0), rpad_(0), leftMost_(0), chrSpecific_(false),
-                                 chr_("all") {
+                                 chr_("all"), regionSpecific_(false), regionStart_(0), regionEnd_(0),
+                                 starchOutput_(false), starchGzip_(false), binaryOutput_(false) {
 
     typedef Ext::UserError UE;
 
@@ -78,11 +80,35 @@ struct Input {
           errorCheck_ = true;
         } else if ( next == "--header" ) {
           errorCheck_ = true;
+        } else if ( next == "--starch-output" ) {
+          Ext::Assert<UE>(!starchOutput_, "--starch-output specified multiple times.");
+          starchOutput_ = true;
+          if ( argcntr + 1 < argc && (std::string(argv[argcntr+1]) == "--bzip2" || std::string(argv[argcntr+1]) == "--gzip") )
+            starchGzip_ = (std::string(argv[++argcntr]) == "--gzip");
+        } else if ( next == "--bzip2" || next == "--gzip" ) {
+          throw(UE(next + " must directly follow --starch-output"));
+        } else if ( next == "--binary-out" ) {
+          Ext::Assert<UE>(!binaryOutput_, "--binary-out specified multiple times.");
+          binaryOutput_ = true;
         } else if ( next == "--chrom" ) {
           Ext::Assert<UE>(!chrSpecific_, "--chrom specified multiple times.");
           Ext::Assert<UE>(++argcntr < argc, "No value for --chrom given.");
           chr_ = argv[argcntr];
           chrSpecific_ = (chr_ != "all");
+        } else if ( next == "--region" ) {
+          Ext::Assert<UE>(!regionSpecific_, "--region specified multiple times.");
+          Ext::Assert<UE>(++argcntr < argc, "No value for --region given.");
+          next = argv[argcntr];
+          std::string::size_type pos = next.find("-");
+          Ext::Assert<UE>(pos != std::string::npos && pos > 0 && pos + 1 < next.size() &&
+                          next.find_first_not_of(plusints) == pos &&
+                          next.find_first_not_of(plusints, pos + 1) == std::string::npos,
+                          "Expect --region <start>-<end> with non-negative integers.");
+          std::stringstream convs(next.substr(0, pos)), conve(next.substr(pos + 1));
+          convs >> regionStart_;
+          conve >> regionEnd_;
+          Ext::Assert<UE>(regionStart_ < regionEnd_, "--region <start> must be less than <end>.");
+          regionSpecific_ = true;
         } else if ( next == "--range" ) {
           Ext::Assert<UE>(!hasRange, "--range specified multiple times.");
           Ext::Assert<UE>(++argcntr < argc, "No value for --range given.");
@@ -266,6 +292,9 @@ struct Input {
       // More basic error checking
       Ext::Assert<UE>(argcntr < argc, "No input file given.");
       Ext::Assert<UE>(hasOption, "No operation argument given.");
+      Ext::Assert<UE>(!starchOutput_ || !binaryOutput_, "--starch-output and --binary-out detected.  Choose one.");
+      Ext::Assert<UE>(!regionSpecific_ || chrSpecific_, "--region requires --chrom.");
+      Ext::Assert<UE>(!regionSpecific_ || !errorCheck_, "--region may not be used with --ec or --header.");
 
       // Check file input(s); ensure minimum number of files is met
       bool onlyOne = true;
@@ -313,6 +342,15 @@ struct Input {
   bool ChrSpecific() const {
     return(chrSpecific_);
   }
+  bool RegionSpecific() const {
+    return(regionSpecific_);
+  }
+  Bed::CoordType RegionStart() const {
+    return(regionStart_);
+  }
+  Bed::CoordType RegionEnd() const {
+    return(regionEnd_);
+  }
   bool ComplementFullLeft() const {
     return(leftMost_);
   }
@@ -334,6 +372,15 @@ struct Input {
   int NumberFiles() const {
     return(numFiles_);
   }
+  bool StarchOutput() const {
+    return(starchOutput_);
+  }
+  bool StarchGzip() const {
+    return(starchGzip_);
+  }
+  bool BinaryOutput() const {
+    return(binaryOutput_);
+  }
   double Threshold() const {
     return(subsetPerc_);
   }
@@ -448,6 +495,12 @@ private:
   bool leftMost_;
   bool chrSpecific_;
   std::string chr_;
+  bool regionSpecific_;
+  Bed::CoordType regionStart_;
+  Bed::CoordType regionEnd_;
+  bool starchOutput_;
+  bool starchGzip_;
+  bool binaryOutput_;
   std::map<std::string, std::string> options_;
 };
 
@@ -757,20 +810,31 @@ private:
     msg += "          Input files must have at least the first 3 columns of the BED specification.\n";
     msg += "          The program accepts BED and Starch file formats.\n";
     msg += "          May use '-' for a file to indicate reading from standard input (BED format only).\n";
+    msg += "          Binary streams written with --binary-out are recognized on any input.\n";
     msg += "\n";
     msg += "      Process Flags:\n";
+    msg += "          --binary-out         Write a binary stream for another BEDOPS program to read,\n";
+    msg += "                                 rather than BED.  Faster through pipes.\n";
     msg += "          --chrom <chromosome> Jump to and process data for given <chromosome> only.\n";
     msg += "          --ec                 Error check input files (slower).\n";
     msg += "          --header             Accept headers (VCF, GFF, SAM, BED, WIG) in any input file.\n";
     msg += "          --help               Print this message and exit successfully.\n";
     msg += "          --help-<operation>   Detailed help on <operation>.\n";
     msg += "                                 An example is --help-c or --help-complement\n";
+    msg += "          --region <start>-<end>\n";
+    msg += "                               With --chrom, process only elements that overlap the\n";
+    msg += "                                 0-based, half-open region [start, end).  With the -e/-n\n";
+    msg += "                                 operations, only the first (reference) file is restricted.\n";
+    msg += "                                 Starch archives skip straight to the region.\n";
     msg += "          --range L:R          Add 'L' bp to all start coordinates and 'R' bp to end\n";
     msg += "                                 coordinates. Either value may be + or - to grow or\n";
     msg += "                                 shrink regions.  With the -e/-n operations, the first\n";
     msg += "                                 (reference) file is not padded, unlike all other files.\n";
     msg += "          --range S            Pad or shrink input file(s) coordinates symmetrically by S.\n";
     msg += "                                 This is shorthand for: --range -S:S.\n";
+    msg += "          --starch-output [--bzip2|--gzip]\n";
+    msg += "                               Write output as a Starch archive rather than BED\n";
+    msg += "                                 (bzip2 compression by default).\n";
     msg += "          --version            Print program information.\n\n";
 
     msg += "      Operations: (choose one of)\n";
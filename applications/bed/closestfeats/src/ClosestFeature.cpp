@@ -38,6 +38,8 @@
 #include "data/bed/AllocateIterator_BED_starch.hpp"
 #include "data/bed/BedCheckIterator.hpp"
 #include "data/bed/BedTypes.hpp"
+#include "data/bed/BinaryBed.hpp"
+#include "data/starch/starchStdoutArchive.hpp"
 #include "suite/BEDOPS.Constants.hpp"
 #include "suite/BEDOPS.Version.hpp"
 #include "utility/Exception.hpp"
@@ -69,7 +71,17 @@ int main(int argc, char** argv) {
   try {
     // Check inputs; initialize variables
     FeatDist::Input input(argc, argv);
-    FeatDist::doWork(input);
+    if ( input.StarchOutput() ) {
+      starch::StdoutArchive archive(input.StarchGzip() ? starch::kGzip : starch::kBzip2);
+      FeatDist::doWork(input);
+      archive.Finish();
+    } else if ( input.BinaryOutput() ) {
+      Bed::BinaryStdout binary;
+      FeatDist::doWork(input);
+      binary.Finish();
+    }
+    else
+      FeatDist::doWork(input);
     return(EXIT_SUCCESS);
 
   } catch(FeatDist::HelpException& h) {
@@ -215,7 +227,10 @@ struct createWork {
       BedReaderType2* nonRefFile = static_cast<BedReaderType2*>(0);
 
       refFilePtr = new FPType(input.GetReferenceFileName());
-      refFile = new BedReaderType1(IterType1(*refFilePtr, mem1, input.Chrome()));
+      if ( input.RegionSpecific() ) // <query-file> is read in full, as nearest elements may lie outside
+        refFile = new BedReaderType1(IterType1(*refFilePtr, mem1, input.Chrome(), input.RegionStart(), input.RegionEnd()));
+      else
+        refFile = new BedReaderType1(IterType1(*refFilePtr, mem1, input.Chrome()));
 
       nonRefFilePtr = new FPType(input.GetNonReferenceFileName());
       nonRefFile = new BedReaderType2(IterType2(*nonRefFilePtr, mem2, input.Chrome()));
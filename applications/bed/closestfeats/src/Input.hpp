@@ -24,10 +24,12 @@
 #ifndef _FEATDIST_INPUT_HPP
 #define _FEATDIST_INPUT_HPP
 
+#include "suite/BEDOPS.Constants.hpp"
 #include "utility/Assertion.hpp"
 #include "utility/Exception.hpp"
 
 #include <set>
+#include <sstream>
 #include <string>
 
 namespace FeatDist {
@@ -45,7 +47,8 @@ namespace FeatDist {
     // Constructor
     Input(int argc, char **argv)
       : ec_(false), shortestOnly_(false), distances_(false), suppressRef_(false),
-        overlaps_(true), delim_("|"), refFile_(""), nonRefFile_(""), chr_("all") {
+        overlaps_(true), starchOutput_(false), starchGzip_(false), binaryOutput_(false), delim_("|"), refFile_(""),
+        nonRefFile_(""), chr_("all"), region_(false), regionStart_(0), regionEnd_(0) {
 
       typedef Ext::UserError UE;
       if ( 1 == argc )
@@ -73,6 +76,22 @@ namespace FeatDist {
           Ext::Assert<UE>(++argcntr < argc, "No value given for --chrome.");
           chr_ = argv[argcntr];
         }
+        else if ( next == "--region" ) {
+          Ext::Assert<UE>(!region_, "--region specified multiple times.");
+          Ext::Assert<UE>(++argcntr < argc, "No value given for --region.");
+          const std::string ints = "0123456789";
+          next = argv[argcntr];
+          std::string::size_type pos = next.find("-");
+          Ext::Assert<UE>(pos != std::string::npos && pos > 0 && pos + 1 < next.size() &&
+                          next.find_first_not_of(ints) == pos &&
+                          next.find_first_not_of(ints, pos + 1) == std::string::npos,
+                          "Expect --region <start>-<end> with non-negative integers.");
+          std::stringstream convs(next.substr(0, pos)), conve(next.substr(pos + 1));
+          convs >> regionStart_;
+          conve >> regionEnd_;
+          Ext::Assert<UE>(regionStart_ < regionEnd_, "--region <start> must be less than <end>.");
+          region_ = true;
+        }
         else if ( next == "--closest" ) {
           Ext::Assert<UE>(!outoption, "Multiple output options not allowed.");
           shortestOnly_ = true;
@@ -82,6 +101,18 @@ namespace FeatDist {
           distances_ = true;
         else if ( next == "--no-ref" )
           suppressRef_ = true;
+        else if ( next == "--starch-output" ) {
+          Ext::Assert<UE>(!starchOutput_, "--starch-output specified multiple times.");
+          starchOutput_ = true;
+          if ( argcntr + 1 < argc && (std::string(argv[argcntr+1]) == "--bzip2" || std::string(argv[argcntr+1]) == "--gzip") )
+            starchGzip_ = (std::string(argv[++argcntr]) == "--gzip");
+        }
+        else if ( next == "--bzip2" || next == "--gzip" )
+          throw(UE(next + " must directly follow --starch-output."));
+        else if ( next == "--binary-out" ) {
+          Ext::Assert<UE>(!binaryOutput_, "--binary-out specified multiple times.");
+          binaryOutput_ = true;
+        }
         else if ( next == "--help" )
           throw(HelpException());
         else if ( next == "--shortest" ) { // silently supported for bckwd compatibility
@@ -100,11 +131,19 @@ namespace FeatDist {
       nonRefFile_ = argv[argcntr];
       Ext::Assert<UE>(refFile_.find("--") != 0, "Option given where file expected: " + refFile_ + ".");
       Ext::Assert<UE>(nonRefFile_.find("--") != 0, "Option given where file expected: " + nonRefFile_ + ".");
+      Ext::Assert<UE>(!starchOutput_ || !suppressRef_, "--starch-output needs the <input-file> element first on each row: remove --no-ref.");
+      Ext::Assert<UE>(!binaryOutput_ || !suppressRef_, "--binary-out needs the <input-file> element first on each row: remove --no-ref.");
+      Ext::Assert<UE>(!starchOutput_ || !binaryOutput_, "--starch-output and --binary-out detected.  Choose one.");
+      Ext::Assert<UE>(!region_ || chr_ != "all", "--region requires --chrom.");
+      Ext::Assert<UE>(!region_ || !ec_, "--region may not be used with --ec or --header.");
     }
 
     bool AllowOverlaps() const
       { return(overlaps_); }
 
+    bool BinaryOutput() const
+      { return(binaryOutput_); }
+
     std::string Chrome() const
       { return(chr_); }
 
@@ -123,9 +162,24 @@ namespace FeatDist {
     bool PrintDistances() const
       { return(distances_); }
 
+    bool RegionSpecific() const
+      { return(region_); }
+
+    Bed::CoordType RegionStart() const
+      { return(regionStart_); }
+
+    Bed::CoordType RegionEnd() const
+      { return(regionEnd_); }
+
     bool ShortestOnly() const
       { return(shortestOnly_); }
 
+    bool StarchGzip() const
+      { return(starchGzip_); }
+
+    bool StarchOutput() const
+      { return(starchOutput_); }
+
     bool SuppressReference() const
       { return(suppressRef_); }
 
@@ -133,9 +187,12 @@ namespace FeatDist {
     bool ec_;
     bool shortestOnly_;
     bool distances_, suppressRef_, overlaps_;
+    bool starchOutput_, starchGzip_, binaryOutput_;
     std::string delim_;
     std::string refFile_, nonRefFile_;
     std::string chr_;
+    bool region_;
+    Bed::CoordType regionStart_, regionEnd_;
   };
 
 
@@ -146,12 +203,15 @@ namespace FeatDist {
     msg += "   All input files must be sorted per sort-bed.\n";
     msg += "   The program accepts BED and Starch file formats\n";
     msg += "   May use '-' for a file to indicate reading from standard input (BED format only).\n";
+    msg += "   Binary streams written with --binary-out are recognized on any input.\n";
     msg += "\n";
     msg += "   For every element in <input-file>, determine the two elements from <query-file> falling\n";
     msg += "     nearest to its left and right edges (See NOTES below).  By default, echo the <input-file>\n";
     msg += "     element, followed by those left and right elements found in <query-file>.\n";
     msg += "\n";
     msg += "  Process Flags:\n";
+    msg += "    --binary-out           Write a binary stream for another BEDOPS program to read, rather than\n";
+    msg += "                             text.  Same requirements as --starch-output.  Faster through pipes.\n";
     msg += "    --chrom <chromosome>   Jump to and process data for given <chromosome> only.\n";
     msg += "    --closest              Choose the closest element for output only.  Ties go the left element.\n";
     msg += "    --delim <delim>        Change output delimiter from '|' to <delim> between columns (e.g. \'\\t\')\n";
@@ -162,6 +222,12 @@ namespace FeatDist {
     msg += "    --help                 Print this message and exit successfully.\n";
     msg += "    --no-overlaps          Overlapping elements from <query-file> will not be reported.\n";
     msg += "    --no-ref               Do not echo elements from <input-file>.\n";
+    msg += "    --region <start>-<end> With --chrom, process only <input-file> elements that overlap the\n";
+    msg += "                             0-based, half-open region [start, end).  Nearest <query-file>\n";
+    msg += "                             elements may lie outside of it.  Starch archives skip straight to it.\n";
+    msg += "    --starch-output [--bzip2|--gzip]\n";
+    msg += "                           Write output as a Starch archive rather than text (bzip2 by default).\n";
+    msg += "                             Rows must be valid BED: use --delim '\\t' with 3-column <input-file>s.\n";
     msg += "    --version              Print program information.\n";
     msg += "\n";
     msg += "  NOTES:\n";
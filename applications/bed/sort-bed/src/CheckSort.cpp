@@ -21,20 +21,357 @@
 //    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 //
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
 #include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "data/bed/BedCheckIterator.hpp"
 #include "data/bed/BedTypes.hpp"
+#include "data/starch/starchApi.hpp"
 #include "suite/BEDOPS.Constants.hpp"
 #include "utility/Exception.hpp"
 #include "utility/PooledMemory.hpp"
 
 #include "Structures.hpp"
 
+namespace {
+
+  /*
+    The quick check below only ever passes rows that bed_check_iterator would pass too.  Anything
+      it is unsure of -- headers, odd whitespace, a bad or unsorted row -- sends the whole input
+      back through bed_check_iterator on one thread, so messages and row numbers stay exactly as
+      they have always been.  Only inputs that are fine are checked in parallel from start to end.
+  */
+
+  // a BED row as check() compares it; rest is everything after the end coordinate
+  struct RowView {
+    char const* chrom;
+    std::size_t chromLen;
+    Bed::CoordType start, end;
+    char const* rest;
+    std::size_t restLen;
+  };
+
+  struct SavedRow {
+    SavedRow() : start(0), end(0) { }
+
+    void save(const RowView& r) {
+      chrom.assign(r.chrom, r.chromLen);
+      rest.assign(r.rest, r.restLen);
+      start = r.start;
+      end = r.end;
+    }
+
+    RowView view() const {
+      RowView r = { chrom.data(), chrom.size(), start, end, rest.data(), rest.size() };
+      return r;
+    }
+
+    std::string chrom;
+    Bed::CoordType start, end;
+    std::string rest;
+  };
+
+  // compares bytes as strcmp() does, given neither side holds a '\0'
+  inline int
+  compareBytes(char const* a, std::size_t aLen, char const* b, std::size_t bLen) {
+    const int cmp = std::memcmp(a, b, std::min(aLen, bLen));
+    if ( cmp != 0 || aLen == bLen )
+      return cmp;
+    return (aLen < bLen) ? -1 : 1;
+  }
+
+  // false when cur must not follow prev, or when check() compares the two differently than bytes
+  inline bool
+  inOrder(const RowView& prev, const RowView& cur) {
+    const int cmp = compareBytes(prev.chrom, prev.chromLen, cur.chrom, cur.chromLen);
+    if ( cmp != 0 )
+      return cmp < 0;
+    else if ( prev.start != cur.start )
+      return prev.start < cur.start;
+    else if ( prev.end != cur.end )
+      return prev.end < cur.end;
+    else if ( std::memchr(prev.rest, '\0', prev.restLen) || std::memchr(cur.rest, '\0', cur.restLen) )
+      return false; // check() compares these as C strings
+    return compareBytes(prev.rest, prev.restLen, cur.rest, cur.restLen) <= 0;
+  }
+
+  inline bool
+  namedLike(char const* p, std::size_t len, char const* name) {
+    const std::size_t nameLen = std::strlen(name);
+    if ( len != nameLen )
+      return false;
+    for ( std::size_t i = 0; i < len; ++i ) {
+      if ( std::tolower(static_cast<unsigned char>(p[i])) != name[i] )
+        return false;
+    } // for
+    return true;
+  }
+
+  // a first column check() accepts as is, and that sscanf() reads back the same
+  inline bool
+  plainChrom(char const* p, std::size_t len) {
+    if ( 0 == len || len > Bed::MAXCHROMSIZE || *p == '#' || *p == '@' )
+      return false;
+    for ( std::size_t i = 0; i < len; ++i ) {
+      if ( p[i] == '\0' || std::isspace(static_cast<unsigned char>(p[i])) )
+        return false;
+    } // for
+    return !namedLike(p, len, "browser") && !namedLike(p, len, "track");
+  }
+
+  // a line that check() skips as a header when it leads the input
+  inline bool
+  headerLine(char const* p, char const* eol) {
+    if ( p == eol )
+      return false;
+    else if ( *p == '#' || *p == '@' )
+      return true;
+    char const* q = p;
+    while ( q != eol && *q != ' ' && *q != '\t' )
+      ++q;
+    return namedLike(p, static_cast<std::size_t>(q - p), "browser") ||
+           namedLike(p, static_cast<std::size_t>(q - p), "track");
+  }
+
+  // reads a coordinate at p, as check() would allow it; NULL if it would not
+  inline char const*
+  plainCoord(char const* p, char const* eol, Bed::CoordType* value) {
+    char const* q = p;
+    *value = 0;
+    while ( q != eol && *q >= '0' && *q <= '9' ) {
+      if ( static_cast<unsigned long>(q - p) == Bed::MAX_DEC_INTEGERS )
+        return NULL;
+      *value = *value * 10 + static_cast<Bed::CoordType>(*q - '0');
+      ++q;
+    } // while
+    return (q == p) ? NULL : q;
+  }
+
+  // fills row from the line [p, eol), or returns false if check() might not accept it as is
+  inline bool
+  plainRow(char const* p, char const* eol, RowView* row) {
+    char const* q = static_cast<char const*>(std::memchr(p, '\t', static_cast<std::size_t>(eol - p)));
+    if ( q == NULL || !plainChrom(p, static_cast<std::size_t>(q - p)) )
+      return false;
+    row->chrom = p;
+    row->chromLen = static_cast<std::size_t>(q - p);
+    if ( (q = plainCoord(q + 1, eol, &row->start)) == NULL || q == eol || *q != '\t' )
+      return false;
+    if ( (q = plainCoord(q + 1, eol, &row->end)) == NULL || (q != eol && *q != '\t') )
+      return false;
+    row->rest = q;
+    row->restLen = static_cast<std::size_t>(eol - q);
+    if ( row->restLen > 0 && row->restLen - 1 > Bed::MAXRESTSIZE )
+      return false;
+    return row->end > row->start;
+  }
+
+  // line-aligned piece of a mapped file, or one chromosome of a Starch archive
+  struct CheckChunk {
+    CheckChunk() : begin(0), end(0), hasRows(false) { }
+
+    char const* begin;
+    char const* end;
+    std::string chrom;
+    bool hasRows;
+    SavedRow first, last;
+  };
+
+  /*
+    checkChunks() runs check on every chunk, with up to numThreads threads, and then compares the
+      rows on either side of each boundary between chunks.  Once some chunk is found wanting, the
+      chunks after it are dropped, as the input is going to be checked once more anyway.
+  */
+  template <typename CheckFunction>
+  bool
+  checkChunks(std::vector<CheckChunk>& chunks, unsigned int numThreads, CheckFunction check) {
+    std::atomic<std::size_t> next(0), firstBad(chunks.size());
+    auto work = [&]() {
+      std::size_t i = 0;
+      while ( (i = next++) < chunks.size() && i < firstBad ) {
+        if ( !check(chunks[i], i, firstBad) ) {
+          std::size_t bad = firstBad;
+          while ( i < bad && !firstBad.compare_exchange_weak(bad, i) )
+            ;
+        }
+      } // while
+    };
+
+    std::vector<std::thread> workers;
+    const std::size_t numWorkers = std::min<std::size_t>(numThreads, chunks.size());
+    for ( std::size_t t = 1; t < numWorkers; ++t )
+      workers.push_back(std::thread(work));
+    work();
+    for ( std::size_t t = 0; t < workers.size(); ++t )
+      workers[t].join();
+    if ( firstBad < chunks.size() )
+      return false;
+
+    SavedRow const* last = NULL;
+    for ( std::size_t i = 0; i < chunks.size(); ++i ) {
+      if ( !chunks[i].hasRows )
+        continue;
+      else if ( last && !inOrder(last->view(), chunks[i].first.view()) )
+        return false;
+      last = &chunks[i].last;
+    } // for
+    return true;
+  }
+
+  // every line of one chunk of a mapped BED file; only the first chunk may open with headers
+  bool
+  checkLines(CheckChunk& chunk, std::size_t index, const std::atomic<std::size_t>& firstBad) {
+    RowView prev = RowView(), row = RowView();
+    char const* p = chunk.begin;
+    char const* eol = NULL;
+    while ( p < chunk.end ) {
+      if ( index > firstBad ) // an earlier chunk failed: this one no longer matters
+        return true;
+      eol = static_cast<char const*>(std::memchr(p, '\n', static_cast<std::size_t>(chunk.end - p)));
+      if ( eol == NULL )
+        eol = chunk.end; // last line, without a newline
+      if ( 0 == index && !chunk.hasRows && headerLine(p, eol) ) {
+        p = eol + 1;
+        continue;
+      }
+      if ( !plainRow(p, eol, &row) || (chunk.hasRows && !inOrder(prev, row)) )
+        return false;
+      if ( !chunk.hasRows )
+        chunk.first.save(row);
+      chunk.hasRows = true;
+      prev = row;
+      p = eol + 1;
+    } // while
+    if ( chunk.hasRows )
+      chunk.last.save(prev);
+    return true;
+  }
+
+  /*
+    checkMappedFile() maps a regular file and cuts it into line-aligned chunks, so that each can be
+      checked by its own thread.  false when the file is not plainly sorted BED, or is not a kind
+      of input that can be mapped here.
+  */
+  bool
+  checkMappedFile(char const* fileName, const struct stat& st, unsigned int numThreads) {
+    const std::size_t minChunk = 1 << 24;
+    const std::size_t size = static_cast<std::size_t>(st.st_size);
+    if ( 0 == size )
+      return false;
+
+    const int fd = open(fileName, O_RDONLY);
+    if ( fd < 0 )
+      return false;
+    void* map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if ( map == MAP_FAILED )
+      return false;
+    madvise(map, size, MADV_SEQUENTIAL);
+
+    char const* data = static_cast<char const*>(map);
+    char const* fileEnd = data + size;
+    bool rtn = false;
+    if ( *data != '\0' ) { // a leading '\0' marks binary BED
+      // a few chunks per thread, so that one slow chunk does not hold up the rest
+      const std::size_t numChunks = (numThreads > 1) ? std::min<std::size_t>(4 * numThreads, size / minChunk + 1) : 1;
+      std::vector<CheckChunk> chunks;
+      char const* p = data;
+      for ( std::size_t i = 0; i < numChunks && p < fileEnd; ++i ) {
+        char const* q = (i + 1 == numChunks) ? fileEnd : std::max(p, data + size / numChunks * (i + 1));
+        if ( q != fileEnd ) {
+          q = static_cast<char const*>(std::memchr(q, '\n', static_cast<std::size_t>(fileEnd - q)));
+          q = (q == NULL) ? fileEnd : q + 1;
+        }
+        chunks.push_back(CheckChunk());
+        chunks.back().begin = p;
+        chunks.back().end = q;
+        p = q;
+      } // for
+      rtn = checkChunks(chunks, numThreads, checkLines);
+    }
+    munmap(map, size);
+    return rtn;
+  }
+
+  /*
+    checkArchive() checks each chromosome of a Starch archive on its own thread, through a reader
+      of its own that shares the metadata read here, and then the order of the chromosomes.  false when any row is not plainly
+      sorted BED.  An archive that cannot be opened at all throws here, just as it would from
+      bed_check_iterator.
+  */
+  bool
+  checkArchive(char const* fileName, unsigned int numThreads) {
+    starch::Starch archive(fileName, false, true, "all");
+    std::vector<CheckChunk> chunks;
+    for ( starch::Metadata* md = archive.getArchiveRecordIter(); md != NULL; md = md->next ) {
+      chunks.push_back(CheckChunk());
+      chunks.back().chrom = md->chromosome;
+    } // for
+
+    auto checkRecords = [&archive](CheckChunk& chunk, std::size_t index, const std::atomic<std::size_t>& firstBad) {
+      try {
+        starch::Starch reader(archive, chunk.chrom);
+        SavedRow prev;
+        RowView row = RowView();
+        char const* chrom = NULL;
+        char const* rest = NULL;
+        while ( reader.extractBEDRecord(chrom, row.start, row.end, rest) ) {
+          if ( index > firstBad )
+            return true;
+          row.chrom = chrom;
+          row.chromLen = std::strlen(chrom);
+          row.rest = rest; // without the tab that leads it in text, which compares the same
+          row.restLen = std::strlen(rest);
+          if ( chunk.chrom != chrom || !plainChrom(row.chrom, row.chromLen) ||
+               row.start > static_cast<Bed::CoordType>(Bed::MAX_COORD_VALUE) ||
+               row.end > static_cast<Bed::CoordType>(Bed::MAX_COORD_VALUE) ||
+               row.end <= row.start || row.restLen > Bed::MAXRESTSIZE ||
+               (chunk.hasRows && !inOrder(prev.view(), row)) )
+            return false;
+          if ( !chunk.hasRows )
+            chunk.first.save(row);
+          chunk.hasRows = true;
+          prev.save(row);
+        } // while
+        if ( chunk.hasRows )
+          chunk.last = prev;
+        return true;
+      } catch(...) { // reported when checked once more
+        return false;
+      }
+    };
+    return checkChunks(chunks, numThreads, checkRecords);
+  }
+
+  // true when fileName is a regular file or Starch archive that is plainly sorted BED
+  bool
+  quickCheck(char const* fileName, unsigned int numThreads) {
+    struct stat st;
+    if ( 0 == std::strcmp(fileName, "-") || stat(fileName, &st) != 0 || !S_ISREG(st.st_mode) )
+      return false;
+
+    std::string fn(fileName);
+    if ( starch::Starch::isStarch(fn) )
+      return checkArchive(fileName, numThreads);
+    return checkMappedFile(fileName, st, numThreads);
+  }
+
+} // unnamed namespace
+
 int
-checkSort(char const **bedFileNames, unsigned int numFiles)
+checkSort(char const **bedFileNames, unsigned int numFiles, unsigned int numThreads)
 {
   constexpr std::size_t PoolSz = 8*2;
   typedef Bed::bed_check_iterator<Bed::B3Rest*, PoolSz> IterType;
@@ -42,6 +379,8 @@ checkSort(char const **bedFileNames, unsigned int numFiles)
   try {
     Ext::PooledMemory<Bed::B3Rest, PoolSz> pool;
     for ( unsigned int i = 0; i < numFiles; ++i ) {
+      if ( quickCheck(bedFileNames[i], numThreads) )
+        continue;
       std::ifstream infile(bedFileNames[i]);
       if ( 0 != std::strcmp(bedFileNames[i], "-") && !infile )
         throw(Ext::UserError("Unable to find: " + std::string(bedFileNames[i])));
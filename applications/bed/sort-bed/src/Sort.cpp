@@ -35,15 +35,16 @@
 using namespace std;
 
 #define MAX_INFILES 10000
+#define MAX_THREADS 1024
 
 static const char *name = "sort-bed";
 static const char *authors = "Scott Kuehn";
-static const char *usage = "\nUSAGE: sort-bed [--help] [--version] [--check-sort] [--max-mem <val>] [--tmpdir <path>] [--unique] [--duplicates] <file1.bed> <file2.bed> <...>\n        Sort BED file(s).\n        May use '-' to indicate stdin.\n        Results are sent to stdout.\n\n        <val> for --max-mem may be 8G, 8000M, or 8000000000 to specify 8 GB of memory.\n        --tmpdir is useful only with --max-mem.\n        --unique can be used to print only unique BED elements (similar to 'sort -u'). Cannot be used with --duplicates.\n        --duplicates can be used to print only duplicated or repeated elements (similar to 'uniq -d'). Cannot be used with --unique.\n";
+static const char *usage = "\nUSAGE: sort-bed [--help] [--version] [--check-sort] [--merge-sorted] [--max-mem <val>] [--tmpdir <path>] [--compress-tmp] [--threads <n>] [--diagnostics] [--unique] [--duplicates] [--starch [--bzip2|--gzip] [--note <text>]] <file1.bed> <file2.bed> <...>\n        Sort BED file(s).\n        May use '-' to indicate stdin.\n        Results are sent to stdout.\n\n        --merge-sorted merges inputs that are each sorted already, like 'sort -m', checking their order as it goes.  Inputs may be Starch archives.\n        <val> for --max-mem may be 8G, 8000M, or 8000000000 to specify 8 GB of memory.\n        --tmpdir is useful only with --max-mem.\n        --compress-tmp compresses temporary files written with --max-mem, to save disk space and I/O.\n        --threads <n> uses up to <n> threads to read and sort input held in memory.  Output is the same.  With --check-sort, up to <n> threads check pieces of each file, or the chromosomes of each Starch archive.\n        --diagnostics reports to stderr how many already-sorted runs each chromosome held.  Nearly-sorted input is merged rather than fully sorted.\n        --unique can be used to print only unique BED elements (similar to 'sort -u'). Cannot be used with --duplicates.\n        --duplicates can be used to print only duplicated or repeated elements (similar to 'uniq -d'). Cannot be used with --unique.\n        --starch writes a Starch archive to stdout rather than BED, like piping the output through 'starch -'.  --bzip2 (default) or --gzip picks the compression, and --note adds a note to the archive metadata.  With --threads, chromosomes are compressed concurrently.\n";
 
 static void
-getArgs(int argc, char **argv, const char **inFiles, unsigned int *numInFiles, int *justCheck, double* maxMem, char **tmpPath, bool *printUniques, bool *printDuplicates)
+getArgs(int argc, char **argv, const char **inFiles, unsigned int *numInFiles, int *justCheck, bool *mergeSorted, double* maxMem, char **tmpPath, bool *compressTmp, bool *printUniques, bool *printDuplicates, unsigned int *numThreads, bool *diagnostics, bool *starchOutput, starch::CompressionType *starchType, char const **note)
 {
-    int numFiles, i, j, stdincnt = 0, changeMem = 0, units = 0, changeTDir = 0;
+    int numFiles, i, j, stdincnt = 0, changeMem = 0, units = 0, changeTDir = 0, changeThreads = 0, changeType = 0;
     size_t k;
     size_t lng = 0U;
     double factor = 1;
@@ -160,6 +161,49 @@ getArgs(int argc, char **argv, const char **inFiles, unsigned int *numInFiles, i
                             numFiles -= 2;
                             continue;
                         }
+                    else if(strcmp(argv[i], "--compress-tmp") == 0)
+                        {
+                            *compressTmp = true;
+                            --j;
+                            numFiles -= 1;
+                            continue;
+                        }
+                    else if(strcmp(argv[i], "--threads") == 0)
+                        {
+                            if(changeThreads != 0)
+                                {
+                                    fprintf(stderr, "Specify --threads at most one time!\n");
+                                    exit(EXIT_FAILURE);
+                                }
+                            changeThreads = 1;
+                            if(++i == argc)
+                                {
+                                    fprintf(stderr, "No value given for --threads.\n");
+                                    exit(EXIT_FAILURE);
+                                }
+                            lng = strlen(argv[i]);
+                            for(k=0; k < lng; ++k)
+                                {
+                                    if(!isdigit(argv[i][k]))
+                                        break;
+                                } /* for */
+                            *numThreads = static_cast<unsigned int>( strtoul(argv[i], NULL, 10) );
+                            if(0 == lng || k != lng || *numThreads < 1 || *numThreads > MAX_THREADS)
+                                {
+                                    fprintf(stderr, "Bad number for --threads.  Expect a whole number from 1 to %d.\n", MAX_THREADS);
+                                    exit(EXIT_FAILURE);
+                                }
+                            --j;
+                            numFiles -= 2;
+                            continue;
+                        }
+                    else if(strcmp(argv[i], "--diagnostics") == 0)
+                        {
+                            *diagnostics = true;
+                            --j;
+                            numFiles -= 1;
+                            continue;
+                        }
                     else if(strcmp(argv[i], "--check-sort") == 0)
                         {
                             *justCheck = 1;
@@ -167,6 +211,50 @@ getArgs(int argc, char **argv, const char **inFiles, unsigned int *numInFiles, i
                             numFiles -= 1;
                             continue;
                         }
+                    else if(strcmp(argv[i], "--merge-sorted") == 0)
+                        {
+                            *mergeSorted = true;
+                            --j;
+                            numFiles -= 1;
+                            continue;
+                        }
+                    else if(strcmp(argv[i], "--starch") == 0)
+                        {
+                            *starchOutput = true;
+                            --j;
+                            numFiles -= 1;
+                            continue;
+                        }
+                    else if((strcmp(argv[i], "--bzip2") == 0) || (strcmp(argv[i], "--gzip") == 0))
+                        {
+                            if(changeType != 0)
+                                {
+                                    fprintf(stderr, "Specify --bzip2 or --gzip at most one time!\n");
+                                    exit(EXIT_FAILURE);
+                                }
+                            changeType = 1;
+                            *starchType = (strcmp(argv[i], "--gzip") == 0) ? starch::kGzip : starch::kBzip2;
+                            --j;
+                            numFiles -= 1;
+                            continue;
+                        }
+                    else if(strcmp(argv[i], "--note") == 0)
+                        {
+                            if(*note != NULL)
+                                {
+                                    fprintf(stderr, "Specify --note at most one time!\n");
+                                    exit(EXIT_FAILURE);
+                                }
+                            if(++i == argc)
+                                {
+                                    fprintf(stderr, "No value given for --note.\n");
+                                    exit(EXIT_FAILURE);
+                                }
+                            *note = argv[i];
+                            --j;
+                            numFiles -= 2;
+                            continue;
+                        }
                     else if((strcmp(argv[i], "--unique") == 0) || (strcmp(argv[i], "-u") == 0))
                         {
                             *printUniques = true;
@@ -195,6 +283,16 @@ getArgs(int argc, char **argv, const char **inFiles, unsigned int *numInFiles, i
             fprintf(stderr, "Cannot specify '-' more than once\n");
             exit(EXIT_FAILURE);
         }
+    else if(!*starchOutput && (changeType || *note != NULL))
+        {
+            fprintf(stderr, "--bzip2, --gzip and --note go with --starch.\n");
+            exit(EXIT_FAILURE);
+        }
+    else if(*starchOutput && *justCheck)
+        {
+            fprintf(stderr, "--starch cannot be used with --check-sort.\n");
+            exit(EXIT_FAILURE);
+        }
     else if((numFiles < 1) || (*printUniques && *printDuplicates)) /* can be different from before if --max-mem was used, for example*/
         {
             fprintf(stderr, "%s\n  citation: %s\n  version:  %s\n  authors:  %s\n%s\n%s\n",
@@ -211,15 +309,37 @@ main(int argc, char **argv)
     double maxMemory = -1;
     const char *inFiles[MAX_INFILES];
     char* tmpPath = NULL;
+    bool compressTmp = false;
     bool clean = false;
     int justCheck = 0;
+    bool mergeSorted = false;
     int rval = EXIT_FAILURE;
     bool printUniques = false;
     bool printDuplicates = false;
+    unsigned int numThreads = 1U;
+    bool diagnostics = false;
+    bool starchOutput = false;
+    starch::CompressionType starchType = starch::kBzip2;
+    char const *note = NULL;
+    char *tag = NULL;
+    starch::Starch2Writer *archive = NULL;
+
+    getArgs(argc, argv, inFiles, &numInFiles, &justCheck, &mergeSorted, &maxMemory, &tmpPath, &compressTmp, &printUniques, &printDuplicates, &numThreads, &diagnostics, &starchOutput, &starchType, &note);
+    if(starchOutput) /* rows go to a Starch archive on stdout, as 'starch -' would make it */
+        {
+            starch::STARCH_buildProcessIDTag(&tag);
+            if(starch::STARCH2_openWriter(&archive, stdout, starchType, tag, note, starch::kStarchTrue) != STARCH_EXIT_SUCCESS)
+                {
+                    fprintf(stderr, "Unable to start a Starch archive on stdout\n");
+                    exit(EXIT_FAILURE);
+                }
+            free(tag);
+        }
 
-    getArgs(argc, argv, inFiles, &numInFiles, &justCheck, &maxMemory, &tmpPath, &printUniques, &printDuplicates);
     if(justCheck) /* just checking inputs */
-        rval = checkSort(inFiles, numInFiles);
+        rval = checkSort(inFiles, numInFiles, numThreads);
+    else if(mergeSorted) /* inputs are sorted already */
+        rval = mergeSortedFiles(inFiles, numInFiles, printUniques, printDuplicates, archive);
     else /* sorting */
         {
             if(tmpPath != NULL)
@@ -240,11 +360,14 @@ main(int argc, char **argv)
                 }
 
             // sort
-            rval = processData(inFiles, numInFiles, maxMemory, tmpPath, printUniques, printDuplicates);
+            rval = processData(inFiles, numInFiles, maxMemory, tmpPath, compressTmp, printUniques, printDuplicates, numThreads, diagnostics, archive);
 
             if(clean)
                 free(tmpPath);
         }
 
+    /* metadata and footer go out only when every row made it into the archive */
+    if(archive && starch::STARCH2_closeWriter(&archive, (rval == EXIT_SUCCESS) ? starch::kStarchTrue : starch::kStarchFalse) != STARCH_EXIT_SUCCESS)
+        rval = EXIT_FAILURE;
     return rval;
 }
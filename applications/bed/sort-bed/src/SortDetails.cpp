@@ -23,20 +23,29 @@
 //
 
 #include <algorithm>
+#include <atomic>
 #include <cinttypes>
 #include <cerrno>
+#include <cstdarg>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <cctype>
+#include <condition_variable>
 #include <fstream>
 #include <map>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/unistd.h>
 
+#include "zlib.h"
+
+#include "data/starch/starchApi.hpp"
 #include "suite/BEDOPS.Constants.hpp"
 
 #include "Structures.hpp"
@@ -44,10 +53,15 @@
 using namespace std;
 
 int
-mergeSort(FILE* output, FILE **tmpFiles, unsigned int numFiles);
+mergeSort(FILE* output, starch::Starch2Writer *archive, FILE **tmpFiles, unsigned int numFiles, const bool spillOutput,
+          const bool printUniques, const bool printDuplicates);
+
+int
+writeBed(FILE *out, starch::Starch2Writer *archive, BedData *beds, const bool printUniques, const bool printDuplicates,
+         const bool spill);
 
 FILE *
-createTmpFile(char const* path, char** fileName);
+createTmpFile(char const* path, char** fileName, const bool compress);
 
 void
 freeTmpFiles(unsigned int fcount, FILE **tmpFiles, char **tmpFileNames);
@@ -113,8 +127,212 @@ namespace dbug_help
 } // end namespace dbug_help
 
 
+/*
+  Compressed runs (--compress-tmp) sit behind an ordinary FILE*, so spilling and merging code does
+    not change.  Each buffer stdio hands over becomes one block in the temp file: a uint32 raw length,
+    a uint32 compressed length, then the zlib-compressed bytes.  A block is compressed on a
+    background thread while the caller fills the next buffer.  Rewinding to the start, as
+    mergeSort() does, switches the run to reading, and from then on the next block is read and
+    inflated on a background thread while the current one is consumed.
+*/
+namespace
+{
+    struct CompressedRun
+    {
+        FILE *fp;
+        bool reading;
+        bool failed;
+        std::vector<unsigned char> block;  /* being handed to stdio (reading) */
+        size_t blockPos;
+        std::vector<unsigned char> next;   /* being compressed (writing) or inflated (reading) */
+        std::vector<unsigned char> packed;
+        std::thread worker;
+    };
+
+    void
+    compressBlock(CompressedRun *run)
+    {
+        uLongf packedLen = compressBound(static_cast<uLong>(run->next.size()));
+        uint32_t lens[2];
+        run->packed.resize(packedLen);
+        if(compress2(&run->packed[0], &packedLen, &run->next[0], static_cast<uLong>(run->next.size()), Z_BEST_SPEED) != Z_OK)
+            {
+                run->failed = true;
+                return;
+            }
+        lens[0] = static_cast<uint32_t>(run->next.size());
+        lens[1] = static_cast<uint32_t>(packedLen);
+        if(fwrite(lens, sizeof(lens[0]), 2, run->fp) != 2 || fwrite(&run->packed[0], 1, packedLen, run->fp) != packedLen)
+            run->failed = true;
+    }
+
+    /* run->next is left empty at the end of the run */
+    void
+    inflateBlock(CompressedRun *run)
+    {
+        uint32_t lens[2];
+        uLongf rawLen = 0;
+        const size_t got = fread(lens, sizeof(lens[0]), 2, run->fp);
+        run->next.clear();
+        if(got == 0)
+            return;
+        run->packed.resize(lens[1]);
+        run->next.resize(lens[0]);
+        rawLen = lens[0];
+        if(got != 2 || lens[0] == 0
+               || fread(&run->packed[0], 1, lens[1], run->fp) != lens[1]
+               || uncompress(&run->next[0], &rawLen, &run->packed[0], lens[1]) != Z_OK
+               || rawLen != lens[0])
+            {
+                run->next.clear();
+                run->failed = true;
+            }
+    }
+
+    inline void
+    waitOn(CompressedRun *run)
+    {
+        if(run->worker.joinable())
+            run->worker.join();
+    }
+
+    long
+    compressedRunWrite(void *cookie, const char *buf, size_t size)
+    {
+        CompressedRun *run = static_cast<CompressedRun*>(cookie);
+        waitOn(run);
+        if(run->reading || run->failed)
+            return -1;
+        if(size == 0)
+            return 0;
+        run->next.assign(buf, buf + size);
+        run->worker = std::thread(compressBlock, run);
+        return static_cast<long>(size);
+    }
+
+    long
+    compressedRunRead(void *cookie, char *buf, size_t size)
+    {
+        CompressedRun *run = static_cast<CompressedRun*>(cookie);
+        size_t n = 0;
+        if(!run->reading)
+            return -1;
+        if(run->blockPos == run->block.size())
+            {
+                waitOn(run);
+                if(run->failed)
+                    return -1;
+                run->block.swap(run->next);
+                run->blockPos = 0;
+                if(run->block.empty())
+                    return 0;
+                run->worker = std::thread(inflateBlock, run);
+            }
+        n = std::min(size, run->block.size() - run->blockPos);
+        memcpy(buf, &run->block[run->blockPos], n);
+        run->blockPos += n;
+        return static_cast<long>(n);
+    }
+
+    /* only a rewind to the start is supported: it ends writing and starts reading */
+    int
+    compressedRunRewind(void *cookie, long offset, int whence)
+    {
+        CompressedRun *run = static_cast<CompressedRun*>(cookie);
+        waitOn(run);
+        if(offset != 0 || whence != SEEK_SET || run->failed || fflush(run->fp) != 0 || fseek(run->fp, 0, SEEK_SET) != 0)
+            return -1;
+        run->reading = true;
+        run->block.clear();
+        run->blockPos = 0;
+        run->worker = std::thread(inflateBlock, run);
+        return 0;
+    }
+
+    int
+    compressedRunClose(void *cookie)
+    {
+        CompressedRun *run = static_cast<CompressedRun*>(cookie);
+        waitOn(run);
+        const int rtn = fclose(run->fp);
+        delete run;
+        return rtn;
+    }
+
+#if defined(__APPLE__) || defined(__FreeBSD__)
+    int
+    compressedRunWriteFn(void *cookie, const char *buf, int size)
+    { return static_cast<int>(compressedRunWrite(cookie, buf, static_cast<size_t>(size))); }
+
+    int
+    compressedRunReadFn(void *cookie, char *buf, int size)
+    { return static_cast<int>(compressedRunRead(cookie, buf, static_cast<size_t>(size))); }
+
+    fpos_t
+    compressedRunSeekFn(void *cookie, fpos_t offset, int whence)
+    { return (compressedRunRewind(cookie, static_cast<long>(offset), whence) == 0) ? 0 : -1; }
+#else
+    ssize_t
+    compressedRunWriteFn(void *cookie, const char *buf, size_t size)
+    { return static_cast<ssize_t>(compressedRunWrite(cookie, buf, size)); }
+
+    ssize_t
+    compressedRunReadFn(void *cookie, char *buf, size_t size)
+    { return static_cast<ssize_t>(compressedRunRead(cookie, buf, size)); }
+
+    int
+    compressedRunSeekFn(void *cookie, off64_t *offset, int whence)
+    {
+        if(compressedRunRewind(cookie, static_cast<long>(*offset), whence) != 0)
+            return -1;
+        *offset = 0;
+        return 0;
+    }
+#endif
+
+    /* wraps fp, which is closed along with the returned stream; NULL on failure */
+    FILE *
+    openCompressedRun(FILE *fp)
+    {
+        FILE *stream = NULL;
+        CompressedRun *run = new CompressedRun;
+        run->fp = fp;
+        run->reading = false;
+        run->failed = false;
+        run->blockPos = 0;
+#if defined(__APPLE__) || defined(__FreeBSD__)
+        stream = funopen(run, compressedRunReadFn, compressedRunWriteFn, compressedRunSeekFn, compressedRunClose);
+#else
+        cookie_io_functions_t io = { compressedRunReadFn, compressedRunWriteFn, compressedRunSeekFn, compressedRunClose };
+        stream = fopencookie(run, "w+", io);
+#endif
+        if(stream == NULL)
+            {
+                delete run;
+                return NULL;
+            }
+        setvbuf(stream, NULL, _IOFBF, SPILL_BUFFER_SIZE);
+        return stream;
+    }
+
+    /* the stream a run is written through: fp itself, with a larger buffer, or a compressed run over fp */
+    FILE *
+    tmpStream(FILE *fp, const bool compress)
+    {
+        FILE *stream = fp;
+        if(fp == NULL)
+            return NULL;
+        else if(!compress)
+            setvbuf(fp, NULL, _IOFBF, SPILL_BUFFER_SIZE);
+        else if((stream = openCompressedRun(fp)) == NULL)
+            fclose(fp);
+        return stream;
+    }
+} // unnamed namespace
+
+
 FILE *
-createTmpFile(char const* path, char** fileName)
+createTmpFile(char const* path, char** fileName, const bool compress)
 {
     FILE* fp;
     int fd;
@@ -123,7 +341,8 @@ createTmpFile(char const* path, char** fileName)
     if (path == NULL)
         {
             fileName = NULL;
-            return tmpfile();
+            fp = tmpfile();
+            return tmpStream(fp, compress);
         }
 
     tmpl = static_cast<char*>( malloc(1 + strlen(path) + L_tmpnam) );
@@ -139,7 +358,7 @@ createTmpFile(char const* path, char** fileName)
     *fileName = static_cast<char*>( malloc(strlen(tmpl) + 1) );
     strcpy(*fileName, tmpl);
     free(tmpl);
-    return fp;
+    return tmpStream(fp, compress);
 }
 
 int
@@ -163,7 +382,7 @@ createDir(char* dir)
                         {
                             makeit = false;
                             /* make sure it's writable */
-                            fptr = createTmpFile(dir, &fname);
+                            fptr = createTmpFile(dir, &fname, false);
                             if (fptr == NULL)
                                 {
                                     fprintf(stderr, "Unable to create a file in existing directory: %s\n.Check permissions.\n", dir);
@@ -214,6 +433,7 @@ initializeBedData(double *bytes)
             return NULL;
         }
     beds->numChroms = 0;
+    beds->text = NULL;
     beds->chroms = static_cast<ChromBedData**>( malloc(sizeof(ChromBedData *) * (NUM_CHROM_EST)) );
     *bytes += (sizeof(ChromBedData*) * NUM_CHROM_EST);
     if (beds->chroms == NULL) 
@@ -244,93 +464,68 @@ initializeChromBedData(char *chromBuf, double *bytes) {
 
     /* Coords */
     chrom->coords = NULL;
+    chrom->firstSegment = NULL;
+    chrom->lastSegment = NULL;
   
     /* Chrom name*/
     chromBufLen = strlen(chromBuf); // we know >= 1
     strncpy(chrom->chromName, chromBuf, chromBufLen);
     chrom->chromName[chromBufLen] = '\0';
     chrom->numCoords = 0;
+    chrom->numRuns = 0;
     return chrom;
 }
 
 
 
 Bed::SignedCoordType
-appendChromBedEntry(ChromBedData *chrom, Bed::SignedCoordType startPos, Bed::SignedCoordType endPos,
-                    char *data, double *bytes, double maxMem)
+appendChromBedEntry(BedData *beds, ChromBedData *chrom, Bed::SignedCoordType startPos, Bed::SignedCoordType endPos,
+                    char *data, double *bytes)
 {
 
-    /* can realloc a lot of data in this function
-         need to be mindful of whether we could dynamically get to maxMem.
-       in particular, might get to maxMem upon reallocation and then drop back below it.
-         in such a case, set *bytes to maxMem (when applicable).
+    /* *bytes grows by exactly what is allocated here: a new coordinate segment when the last one
+         is full, and a new text block when the last one cannot take data.  Nothing is reallocated.
     */
-    Bed::LineCountType index;
-    size_t dataBufLen, newSize;
-    char *dataPtr;
+    CoordSegment *segment;
+    TextBlock *block;
+    BedCoordData *row;
+    size_t dataBufLen, size;
 
-    if(chrom == NULL)
+    if(chrom == NULL || beds == NULL)
         {
             fprintf(stderr, "Error: %s, %d: Bad 'chrom' variable.\n", __FILE__, __LINE__);
             return static_cast<Bed::SignedCoordType>(-1);
         }
-  
-    index = chrom->numCoords;
 
-    // requires INIT_NUM_BED_ITEMS_EST < NUM_BED_ITEMS_EST
-    if (index == 0)
-        { // first initialization
-            chrom->coords = static_cast<BedCoordData*>( malloc(sizeof(BedCoordData) * INIT_NUM_BED_ITEMS_EST) );
-            if(chrom->coords == NULL)
+    segment = chrom->lastSegment;
+    if(segment == NULL || segment->numRows == segment->maxRows)
+        { // few rows to start with, as many chromosomes hold few rows; each segment doubles the last, up to NUM_BED_ITEMS_EST
+            const Bed::LineCountType maxRows = (segment == NULL) ? INIT_NUM_BED_ITEMS_EST
+                                                                 : std::min<Bed::LineCountType>(2 * segment->maxRows, NUM_BED_ITEMS_EST);
+            size = sizeof(CoordSegment) + sizeof(BedCoordData) * static_cast<size_t>(maxRows);
+            segment = static_cast<CoordSegment*>( malloc(size) );
+            if(segment == NULL)
                 {
                     fprintf(stderr, "Error: %s, %d: Unable to create BedCoordData structure. Out of memory.\n", __FILE__, __LINE__);
                     return static_cast<Bed::SignedCoordType>(-1);
                 }
-            *bytes += (sizeof(BedCoordData) * INIT_NUM_BED_ITEMS_EST);
-        }
-    else if (index == (INIT_NUM_BED_ITEMS_EST-1))
-        {
-            newSize = sizeof(BedCoordData) * static_cast<size_t>(NUM_BED_ITEMS_EST);
-            chrom->coords = static_cast<BedCoordData*>( realloc(chrom->coords, newSize) );
-            if(chrom->coords == NULL)
-                {
-                    fprintf(stderr, "Error: %s, %d: Unable to create BED structure. Out of memory.\n", __FILE__, __LINE__);
-                    return static_cast<Bed::SignedCoordType>(-1);
-                }
-            if ((maxMem > 0) && (*bytes + newSize >= maxMem))
-                { // may have temporarily reach maxMem or more
-                    *bytes = maxMem;
-                }
+            *bytes += size;
+            segment->next = NULL;
+            segment->numRows = 0;
+            segment->maxRows = maxRows;
+            if(chrom->lastSegment == NULL)
+                chrom->firstSegment = segment;
             else
-                {
-                    *bytes += (sizeof(BedCoordData) * NUM_BED_ITEMS_EST);
-                    *bytes -= (sizeof(BedCoordData) * INIT_NUM_BED_ITEMS_EST);
-                }
-        }
-    else if((index % (NUM_BED_ITEMS_EST-1)) == 0)
-        {
-            //fprintf(stderr, "Reallocating...\n");
-            newSize = sizeof(BedCoordData) * static_cast<size_t>(index + NUM_BED_ITEMS_EST);
-            chrom->coords = static_cast<BedCoordData*>( realloc(chrom->coords, newSize) );
-            if(chrom->coords == NULL)
-                {
-                    fprintf(stderr, "Error: %s, %d: Unable to create BED structure. Out of memory.\n", __FILE__, __LINE__);
-                    return static_cast<Bed::SignedCoordType>(-1);
-                }
-            if ((maxMem > 0) && (*bytes + newSize >= maxMem))
-                { // may have temporarily reach maxMem or more
-                    *bytes = maxMem;
-                }
-            else
-                { // only increasing by NUM_BED_ITEMS_EST since last time around
-                    *bytes += (sizeof(BedCoordData) * NUM_BED_ITEMS_EST);
-                }
+                chrom->lastSegment->next = segment;
+            chrom->lastSegment = segment;
         }
 
     /* Coords */
-    chrom->coords[index].startCoord = startPos;
-    chrom->coords[index].endCoord = endPos;
-  
+    row = reinterpret_cast<BedCoordData*>(segment + 1) + segment->numRows;
+    row->startCoord = startPos;
+    row->endCoord = endPos;
+    row->data = NULL;
+
     /* Copy in data */
     if(data)
         {
@@ -340,22 +535,66 @@ appendChromBedEntry(ChromBedData *chrom, Bed::SignedCoordType startPos, Bed::Sig
                     fprintf(stderr, "Error: %s, %d: Bad 'data' variable.\n", __FILE__, __LINE__);
                     return static_cast<Bed::SignedCoordType>(-1);
                 }
-            dataPtr = static_cast<char*>( calloc(dataBufLen + 1, sizeof(char)) );
-            *bytes += dataBufLen + 1;
-            if(dataPtr == NULL) 
+            block = beds->text;
+            if(block == NULL || block->size - block->used < dataBufLen + 1)
                 {
-                    fprintf(stderr, "Error: %s, %d: Unable to create BED structure. Out of memory.\n", __FILE__, __LINE__);
-                    return static_cast<Bed::SignedCoordType>(-1);
+                    size = std::max(static_cast<size_t>(TEXT_BLOCK_SIZE), dataBufLen + 1);
+                    block = static_cast<TextBlock*>( malloc(sizeof(TextBlock) + size) );
+                    if(block == NULL)
+                        {
+                            fprintf(stderr, "Error: %s, %d: Unable to create BED structure. Out of memory.\n", __FILE__, __LINE__);
+                            return static_cast<Bed::SignedCoordType>(-1);
+                        }
+                    *bytes += sizeof(TextBlock) + size;
+                    block->next = beds->text;
+                    block->used = 0;
+                    block->size = size;
+                    beds->text = block;
                 }
-            chrom->coords[index].data = strncpy(dataPtr, data, dataBufLen + 1);
-            chrom->coords[index].data[dataBufLen] = '\0';
+            row->data = reinterpret_cast<char*>(block + 1) + block->used;
+            memcpy(row->data, data, dataBufLen + 1);
+            block->used += dataBufLen + 1;
         }
-    else
-        chrom->coords[index].data = NULL;
 
+    segment->numRows++;
     return static_cast<Bed::SignedCoordType>(++chrom->numCoords);
 }
 
+int
+gatherCoords(ChromBedData *chrom)
+{
+    /* puts the rows of every segment into chrom->coords, in the order read; -1 when out of memory.
+         A lone segment is used where it is, and is freed with the chromosome. */
+    CoordSegment *segment, *next;
+    BedCoordData *coords;
+    Bed::LineCountType index = 0;
+
+    if(chrom->coords != NULL || chrom->firstSegment == NULL)
+        return 0;
+    else if(chrom->firstSegment == chrom->lastSegment)
+        {
+            chrom->coords = reinterpret_cast<BedCoordData*>(chrom->firstSegment + 1);
+            return 0;
+        }
+
+    coords = static_cast<BedCoordData*>( malloc(sizeof(BedCoordData) * static_cast<size_t>(chrom->numCoords)) );
+    if(coords == NULL)
+        {
+            fprintf(stderr, "Error: %s, %d: Unable to create BedCoordData structure. Out of memory.\n", __FILE__, __LINE__);
+            return -1;
+        }
+    for(segment = chrom->firstSegment; segment != NULL; segment = next)
+        {
+            memcpy(coords + index, segment + 1, sizeof(BedCoordData) * static_cast<size_t>(segment->numRows));
+            index += segment->numRows;
+            next = segment->next;
+            free(segment);
+        }
+    chrom->firstSegment = chrom->lastSegment = NULL;
+    chrom->coords = coords;
+    return 0;
+}
+
 int
 checkFiles(const char **bedFileNames, unsigned int numFiles)
 {
@@ -385,151 +624,1132 @@ checkFiles(const char **bedFileNames, unsigned int numFiles)
     return 0;
 }
 
+namespace
+{
+    /*
+      Runs spilled under --max-mem are binary, in native byte order, so nothing is re-parsed at merge
+        time.  A run opens with its chromosome table in sort order: a uint32 count, then each name as
+        a uint32 length and its chars.  Each row follows as a uint32 index into that table, int64
+        start and end, and a uint32 length with the text after the end coordinate (leading tab included).
+        Under --unique and --duplicates, rows are distinct within a run, and each is followed by the
+        number of input rows it stands for, so that runs are merged on counts alone.
+    */
+    inline void
+    writeSpillTable(FILE *out, std::vector<char const*> const &names)
+    {
+        uint32_t len = static_cast<uint32_t>(names.size());
+        fwrite(&len, sizeof(len), 1, out);
+        for(size_t i = 0; i < names.size(); ++i)
+            {
+                len = static_cast<uint32_t>(strlen(names[i]));
+                fwrite(&len, sizeof(len), 1, out);
+                fwrite(names[i], 1, len, out);
+            }
+    }
+
+    /* a row's text after its end coordinate is tab + rest when tab is set, or just rest */
+    inline void
+    writeSpillRow(FILE *out, uint32_t chromIdx, Bed::SignedCoordType startPos, Bed::SignedCoordType endPos,
+                  bool tab, char const *rest, size_t restLen)
+    {
+        char head[sizeof(uint32_t) + 2 * sizeof(Bed::SignedCoordType) + sizeof(uint32_t)];
+        const uint32_t len = static_cast<uint32_t>(restLen + (tab ? 1 : 0));
+        memcpy(head, &chromIdx, sizeof(chromIdx));
+        memcpy(head + sizeof(chromIdx), &startPos, sizeof(startPos));
+        memcpy(head + sizeof(chromIdx) + sizeof(startPos), &endPos, sizeof(endPos));
+        memcpy(head + sizeof(chromIdx) + sizeof(startPos) + sizeof(endPos), &len, sizeof(len));
+        fwrite(head, 1, sizeof(head), out);
+        if(tab)
+            fputc('\t', out);
+        if(restLen)
+            fwrite(rest, 1, restLen, out);
+    }
+
+    inline void
+    writeSpillCount(FILE *out, Bed::LineCountType count)
+    {
+        fwrite(&count, sizeof(count), 1, out);
+    }
+
+    inline bool
+    sameRow(BedCoordData const &a, BedCoordData const &b)
+    {
+        if(a.startCoord != b.startCoord || a.endCoord != b.endCoord)
+            return false;
+        else if(a.data == NULL || b.data == NULL)
+            return a.data == b.data;
+        return strcmp(a.data, b.data) == 0;
+    }
+
+    /*
+      putRow() sends a sorted row to out, or to archive under --starch, where it is added as a record
+        with no text formatted or parsed.  rest is the text after the end coordinate, leading tab
+        included.  false when the archive refuses the row, which is described on stderr.
+    */
+    inline bool
+    putRow(FILE *out, starch::Starch2Writer *archive, char const *chrom, Bed::SignedCoordType startPos,
+           Bed::SignedCoordType endPos, char const *rest)
+    {
+        if(archive)
+            return starch::STARCH2_addRecordToWriter(archive, chrom, startPos, endPos, (*rest != '\0') ? rest + 1 : NULL) == STARCH_EXIT_SUCCESS;
+        fprintf(out, "%s\t%" PRId64 "\t%" PRId64 "%s\n", chrom, startPos, endPos, rest);
+        return true;
+    }
+
+    /* elem is a whole row with its newline, as composed for --unique and --duplicates */
+    inline bool
+    writeElem(FILE *out, starch::Starch2Writer *archive, char const *chrom, char const *elem)
+    {
+        if(!archive)
+            {
+                fprintf(out, "%s", elem);
+                return true;
+            }
+        char *rest = NULL;
+        const Bed::SignedCoordType startPos = strtoll(elem + strlen(chrom) + 1, &rest, 10);
+        const Bed::SignedCoordType endPos = strtoll(rest + 1, &rest, 10);
+        const std::string remainder(rest, strlen(rest) - 1); /* less the newline */
+        return putRow(out, archive, chrom, startPos, endPos, remainder.c_str());
+    }
+
+    struct SpillRun
+    {
+        FILE *fp;
+        std::vector<std::string> names;
+        std::vector<uint32_t> ranks; /* index into names -> position in merged chromosome order */
+        uint32_t rank;
+        Bed::SignedCoordType startPos, endPos;
+        std::vector<char> rest;
+        bool done;
+        bool counted; /* rows are followed by their counts */
+        Bed::LineCountType count;
+    };
+
+    /* under --unique and --duplicates, mergeSort() holds back each distinct row while runs add to its count */
+    struct HeldRow
+    {
+        HeldRow() : rank(0), startPos(0), endPos(0), count(0) {}
+
+        uint32_t rank;
+        Bed::SignedCoordType startPos, endPos;
+        std::string rest;
+        Bed::LineCountType count;
+    };
+
+    bool
+    readSpillTable(SpillRun &run)
+    {
+        uint32_t count = 0, len = 0;
+        if(fread(&count, sizeof(count), 1, run.fp) != 1)
+            return false;
+        run.names.resize(count);
+        for(uint32_t i = 0; i < count; ++i)
+            {
+                if(fread(&len, sizeof(len), 1, run.fp) != 1 || len > CHROM_NAME_LEN)
+                    return false;
+                run.names[i].resize(len);
+                if(len && fread(&run.names[i][0], 1, len, run.fp) != len)
+                    return false;
+            }
+        return true;
+    }
+
+    /* false on a damaged run; run.done is set at its end */
+    bool
+    readSpillRow(SpillRun &run)
+    {
+        char head[sizeof(uint32_t) + 2 * sizeof(Bed::SignedCoordType) + sizeof(uint32_t)];
+        uint32_t chromIdx = 0, len = 0;
+        const size_t got = fread(head, 1, sizeof(head), run.fp);
+        if(got == 0)
+            {
+                run.done = true;
+                return true;
+            }
+        else if(got != sizeof(head))
+            return false;
+        memcpy(&chromIdx, head, sizeof(chromIdx));
+        memcpy(&run.startPos, head + sizeof(chromIdx), sizeof(run.startPos));
+        memcpy(&run.endPos, head + sizeof(chromIdx) + sizeof(run.startPos), sizeof(run.endPos));
+        memcpy(&len, head + sizeof(chromIdx) + sizeof(run.startPos) + sizeof(run.endPos), sizeof(len));
+        if(chromIdx >= run.ranks.size() || len > BED_LINE_LEN)
+            return false;
+        run.rank = run.ranks[chromIdx];
+        if(len && fread(&run.rest[0], 1, len, run.fp) != len)
+            return false;
+        run.rest[len] = '\0';
+        run.count = 1;
+        if(run.counted && (fread(&run.count, sizeof(run.count), 1, run.fp) != 1 || run.count == 0))
+            return false;
+        return true;
+    }
+
+    /*
+      Sort order of the current rows of two runs, for SpillRuns here and for the inputs of
+        mergeSortedFiles().  Finished runs sort last, and ties go to the earlier run.
+    */
+    template <typename Run>
+    inline bool
+    runLess(std::vector<Run> const &runs, unsigned int a, unsigned int b)
+    {
+        Run const &ra = runs[a];
+        Run const &rb = runs[b];
+        int val = 0;
+        if(ra.done || rb.done)
+            return (ra.done == rb.done) ? (a < b) : rb.done;
+        if(ra.rank != rb.rank)
+            return rb.rank > ra.rank; /* not ra.rank < ..., which would name std::rank<> */
+        if(ra.startPos != rb.startPos)
+            return ra.startPos < rb.startPos;
+        if(ra.endPos != rb.endPos)
+            return ra.endPos < rb.endPos;
+        if((val = strcmp(&ra.rest[0], &rb.rest[0])) != 0)
+            return val < 0;
+        return a < b;
+    }
+
+    /*
+      LoserTree merges runs: winner() is the run with the least row, and each internal node n holds
+        the run that lost the match played at n.  Once the winner has moved on to its next row,
+        replay() restores the tree with one match per level.
+    */
+    template <typename Run>
+    class LoserTree
+    {
+      public:
+        explicit LoserTree(std::vector<Run> const &runs)
+            : runs_(runs), tree_(std::max<size_t>(runs.size(), 1), 0) { build(); }
+
+        /* plays every match again, for when more than the winner has changed */
+        void
+        build()
+        {
+            const unsigned int k = static_cast<unsigned int>(runs_.size());
+            std::vector<unsigned int> winners(2 * static_cast<size_t>(k));
+            unsigned int i = 0U, n = 0U;
+            for(i = 0; i < k; ++i)
+                winners[k + i] = i;
+            for(n = (k > 0) ? k - 1 : 0; n > 0; --n)
+                {
+                    const unsigned int l = winners[2 * n], r = winners[2 * n + 1];
+                    const bool leftWins = runLess(runs_, l, r);
+                    winners[n] = leftWins ? l : r;
+                    tree_[n] = leftWins ? r : l;
+                }
+            tree_[0] = (k > 1) ? winners[1] : 0;
+        }
+
+        unsigned int
+        winner() const { return tree_[0]; }
+
+        /* replays the matches on the path from the winner's leaf to the root */
+        void
+        replay()
+        {
+            const unsigned int k = static_cast<unsigned int>(runs_.size());
+            unsigned int w = tree_[0], n = 0U;
+            for(n = (w + k) / 2; n > 0; n /= 2)
+                if(runLess(runs_, tree_[n], w))
+                    std::swap(tree_[n], w);
+            tree_[0] = w;
+        }
+
+      private:
+        std::vector<Run> const &runs_;
+        std::vector<unsigned int> tree_;
+    };
+
+    /* a held row goes on, with its count, to another run; or out, when its count suits --unique or --duplicates */
+    inline bool
+    flushHeldRow(FILE *output, starch::Starch2Writer *archive, std::vector<char const*> const &names, HeldRow const &row,
+                 const bool spillOutput, const bool printUniques, const bool printDuplicates)
+    {
+        if(spillOutput)
+            {
+                writeSpillRow(output, row.rank, row.startPos, row.endPos, false, row.rest.c_str(), row.rest.size());
+                writeSpillCount(output, row.count);
+            }
+        else if((printUniques && row.count == 1) || (printDuplicates && row.count > 1))
+            return putRow(output, archive, names[row.rank], row.startPos, row.endPos, row.rest.c_str());
+        return true;
+    }
+} // unnamed namespace
+
 int
-mergeSort(FILE* output, FILE **tmpFiles, unsigned int numFiles)
+mergeSort(FILE* output, starch::Starch2Writer *archive, FILE **tmpFiles, unsigned int numFiles, const bool spillOutput,
+          const bool printUniques, const bool printDuplicates)
 {
     /* error checking in processData() has already been performed, headers and empty rows removed, etc. */
+    /* runs are merged through a LoserTree; spillOutput writes another run, and archive takes the rows under --starch */
+    /* under --unique and --duplicates, equal rows of all runs are counted together before any is kept or dropped */
+    /* -1 for a damaged run, 1 when archive refuses a row (reported on stderr already) */
+    const bool counted = printUniques || printDuplicates;
+    std::vector<SpillRun> runs(numFiles);
+    std::vector<char const*> names;
+    HeldRow held;
     unsigned int i = 0U;
-    int done = 0, currMin = 0, val = 0;
-    char* currRest = NULL;
-    char **chroms = static_cast<char**>( malloc(sizeof(char*) * static_cast<size_t>(numFiles)) );
- 
-   if(chroms == NULL)
-        return -1;
-
-    Bed::SignedCoordType *starts = static_cast<Bed::SignedCoordType*>( malloc(sizeof(Bed::SignedCoordType) * static_cast<size_t>(numFiles)) );
-    if(starts == NULL)
-        return -1;
-
-    Bed::SignedCoordType *ends = static_cast<Bed::SignedCoordType*>( malloc(sizeof(Bed::SignedCoordType) * static_cast<size_t>(numFiles)) );
-    if(ends == NULL)
-        return -1;
-
-    int *fields = static_cast<int*>( malloc(sizeof(int) * static_cast<size_t>(numFiles)) );
-    if(fields == NULL)
-        return -1;
-
-    char **rests = static_cast<char**>( malloc(sizeof(char*) * static_cast<size_t>(numFiles)) );
-    if(rests == NULL)
-        return -1;
-
-    for(i=0; i < numFiles; ++i) {
-        fseek(tmpFiles[i], 0, SEEK_SET);
-        chroms[i] = static_cast<char*>( malloc(sizeof(char) * (CHROM_NAME_LEN+1)) );
-        if(chroms[i] == NULL)
+    size_t j = 0;
+
+    if(numFiles == 0)
+        return 0;
+
+    for(i = 0; i < numFiles; ++i)
+        {
+            runs[i].fp = tmpFiles[i];
+            runs[i].rest.resize(BED_LINE_LEN + 1);
+            runs[i].done = false;
+            runs[i].counted = counted;
+            fseek(tmpFiles[i], 0, SEEK_SET);
+            if(!readSpillTable(runs[i]))
+                return -1;
+            for(j = 0; j < runs[i].names.size(); ++j)
+                names.push_back(runs[i].names[j].c_str());
+        } /* for */
+
+    /* every run's chromosomes, in sort order */
+    std::sort(names.begin(), names.end(), [](char const *a, char const *b) { return strcmp(a, b) < 0; });
+    names.erase(std::unique(names.begin(), names.end(), [](char const *a, char const *b) { return strcmp(a, b) == 0; }), names.end());
+    for(i = 0; i < numFiles; ++i)
+        {
+            runs[i].ranks.resize(runs[i].names.size());
+            for(j = 0; j < runs[i].names.size(); ++j)
+                runs[i].ranks[j] = static_cast<uint32_t>(std::lower_bound(names.begin(), names.end(), runs[i].names[j].c_str(),
+                                                                          [](char const *a, char const *b) { return strcmp(a, b) < 0; }) - names.begin());
+            if(!readSpillRow(runs[i]))
+                return -1;
+        } /* for */
+    if(spillOutput)
+        writeSpillTable(output, names);
+
+    LoserTree<SpillRun> tree(runs);
+    while(!runs[tree.winner()].done)
+        {
+            SpillRun &run = runs[tree.winner()];
+            if(counted)
+                {
+                    if(held.count > 0 && held.rank == run.rank && held.startPos == run.startPos &&
+                       held.endPos == run.endPos && held.rest == &run.rest[0])
+                        held.count += run.count;
+                    else
+                        {
+                            if(held.count > 0 && !flushHeldRow(output, archive, names, held, spillOutput, printUniques, printDuplicates))
+                                return 1;
+                            held.rank = run.rank;
+                            held.startPos = run.startPos;
+                            held.endPos = run.endPos;
+                            held.rest = &run.rest[0];
+                            held.count = run.count;
+                        }
+                }
+            else if(spillOutput)
+                writeSpillRow(output, run.rank, run.startPos, run.endPos, false, &run.rest[0], strlen(&run.rest[0]));
+            else if(!putRow(output, archive, names[run.rank], run.startPos, run.endPos, &run.rest[0]))
+                return 1;
+
+            if(!readSpillRow(run))
+                return -1;
+
+            tree.replay();
+        } /* while */
+
+    if(held.count > 0 && !flushHeldRow(output, archive, names, held, spillOutput, printUniques, printDuplicates))
+        return 1;
+    return 0;
+}
+
+void
+freeTmpFiles(unsigned int fcount, FILE **tmpFiles, char **tmpFileNames) {
+    if (fcount)
+        {
+            unsigned int i = 0;
+            while (i < fcount)
+                {
+                    /* tmpFileNames[i] will be NULL if temp file was created through C's tmpfile() */
+                    fclose(tmpFiles[i]);
+                    if ( tmpFileNames[i] != NULL )
+                        {
+                            remove(tmpFileNames[i]);
+                            free(tmpFileNames[i]);
+                        }
+                    ++i;
+                } /* while */
+            free(tmpFileNames);
+            free(tmpFiles);
+        }
+}
+
+static void
+report(FILE *errs, char const *format, ...)
+{
+    if(errs == NULL)
+        return;
+    va_list args;
+    va_start(args, format);
+    vfprintf(errs, format, args);
+    va_end(args);
+}
+
+/*
+  parseBedLine() checks one input row, as read by fgets() into bedLine after bedLine[BED_LINE_LEN]
+    was set to anything but '\0'.  It returns 1 for a BED row, 0 for a blank or header row, and -1
+    for a bad row, which is described on errs unless errs is NULL.  For a BED row, chromBuf gets the
+    chromosome name reversed (see processData()), and bedLine gets everything after the 3rd column.
+*/
+static int
+parseBedLine(char *bedLine, char *chromBuf, char *tmpArr, Bed::SignedCoordType *startPos,
+             Bed::SignedCoordType *endPos, int *fields, int *headCheck, Bed::LineCountType lines,
+             char const *fileName, FILE *errs)
+{
+    char *cptr = NULL;
+    char *dptr = NULL;
+    unsigned int jidx, kidx;
+    int val = 0;
+
+    if('\n' == bedLine[0])
+        { /* only a new line was found */
+            return 0;
+        }
+    else if('\0' == bedLine[BED_LINE_LEN])
+        {
+            report(errs, "BED row length exceeds capacity at line %" PRIu64 " in %s.\n",
+                   lines, fileName);
+            report(errs, "Check that you have unix newlines (cat -A) or increase TOKENS_MAX_LENGTH in BEDOPS.Constants.hpp and recompile BEDOPS.\n");
+            return -1;
+        }
+    else if(' ' == bedLine[0] || '\t' == bedLine[0])
+        {
+            report(errs, "Row begins with a tab or space at line %" PRIu64 " in %s.\n",
+                   lines, fileName);
+            return -1;
+        }
+
+    if(*headCheck &&
+       (strstr(bedLine, "browser") == bedLine ||
+        strstr(bedLine, "track") == bedLine ||
+        strstr(bedLine, "#") == bedLine ||
+        strstr(bedLine, "@") == bedLine))
+        { /* allow silly headers on input; delete them on output */
+            return 0;
+        }
+
+    /* chromosome check */
+    cptr = strpbrk(bedLine, "\t "); /* we'll convert spaces to tabs in the first 3 fields */
+    if(cptr == NULL)
+        {
+            report(errs, "No tabs/spaces found at line %" PRIu64 " in %s.\n",
+                   lines, fileName);
             return -1;
-        rests[i] = static_cast<char*>( malloc(sizeof(char) * (BED_LINE_LEN+1)) );
-        if(rests[i] == NULL)
+        }
+    if(static_cast<size_t>(cptr - bedLine) > CHROM_NAME_LEN)
+        {
+            report(errs, "Chromosome name too long at line %" PRIu64 " in %s.\n",
+                   lines, fileName);
+            report(errs, "Check that you have unix newlines (cat -A) or increase TOKEN_CHR_MAX_LENGTH in BEDOPS.Constants.hpp and recompile BEDOPS.\n");
             return -1;
-        rests[i][0] = '\0';
-    } /* for */
+        }
 
-    for(i=0; i < numFiles; ++i)
+    // reverse chrom name for faster lookup in common case that everything looks like chrBLAH
+    jidx = 0;
+    for ( kidx = static_cast<unsigned int>(cptr-bedLine); kidx > 0; )
+      chromBuf[jidx++] = bedLine[--kidx];
+    chromBuf[static_cast<size_t>(cptr-bedLine)-1] = bedLine[0];
+    //  memcpy(chromBuf, bedLine, static_cast<size_t>(cptr-bedLine));
+    chromBuf[cptr-bedLine] = '\0';
+
+    /* start coord check */
+    dptr = strpbrk(++cptr, "\t "); /* we'll convert spaces to tabs in the first 3 fields */
+    if(dptr == NULL)
         {
-            fields[i] = fscanf(tmpFiles[i], "%s\t%" SCNd64 "\t%" SCNd64 "%[^\n]s\n",
-                               chroms[i], &starts[i], &ends[i], rests[i]);
-            if(fields[i] == EOF)
+            report(errs, "No tabs/spaces found after the start coordinate (or no start coordinate at all) at line %" PRIu64 " in %s.\n",
+                   lines, fileName);
+            return -1;
+        }
+    if(dptr - cptr > static_cast<double>( Bed::MAX_DEC_INTEGERS ))
+        {
+            report(errs, "Start coordinate is too large.  Max decimal digits allowed is %ld in BEDOPS.Constants.hpp.  See line %" PRIu64 " in %s.\n",
+                   Bed::MAX_DEC_INTEGERS, lines, fileName);
+            return -1;
+        }
+    else if(0 == dptr - cptr)
+        {
+            report(errs, "Consecutive tabs and/or spaces between chromosome and start coordinate.  See line %" PRIu64 " in %s.\n",
+                   lines, fileName);
+            return -1;
+        }
+    memcpy(tmpArr, cptr, static_cast<size_t>(dptr-cptr));
+    tmpArr[dptr-cptr] = '\0';
+    for(kidx=0; kidx < static_cast<unsigned int>(dptr-cptr); ++kidx)
+        {
+            if(!isdigit(tmpArr[kidx]))
                 {
-                    starts[i] = -1;
-                    ends[i] = -1;
-                    fields[i] = 0;
+                    report(errs, "Non-numeric start coordinate.  See line %" PRIu64 " in %s.\n(remember that chromosome names should not contain spaces.)\n",
+                           lines, fileName);
+                    return -1;
                 }
         } /* for */
+    if(atof(tmpArr) > double(Bed::MAX_COORD_VALUE))
+        {
+            report(errs, "Start coordinate is too large.  Max allowed value is %" PRIu64 " in BEDOPS.Constants.hpp.  See line %" PRIu64 " in %s.\n",
+                   Bed::MAX_COORD_VALUE, lines, fileName);
+            return -1;
+        }
+    sscanf(tmpArr, "%" SCNd64, startPos);
+
+    /* end coord check */
+    cptr = strpbrk(++dptr, "\t ");
+    if(cptr == NULL)
+        { /* eol */
+            cptr = strchr(dptr, '\n');
+            if(cptr == NULL)
+                {
+                    report(errs, "No end of line found at %" PRIu64 " in %s.\nMay need to increase BED_LINE_LEN and recompile.\nFirst check that you have unix newlines (cat -A).",
+                           lines, fileName);
+                    return -1;
+                }
+        }
+    if(cptr - dptr > static_cast<double>( Bed::MAX_DEC_INTEGERS ))
+        {
+            report(errs, "End coordinate is too large.  Max decimal digits allowed is %ld in BEDOPS.Constants.hpp.  See line %" PRIu64 " in %s.\n",
+                   Bed::MAX_DEC_INTEGERS, lines, fileName);
+            return -1;
+        }
+    else if(cptr == dptr)
+        {
+            report(errs, "Extra tab and/or space found in between start and end coordinates.  See line %" PRIu64 " in %s.\n",
+                   lines, fileName);
+            return -1;
+        }
+    memcpy(tmpArr, dptr, static_cast<size_t>(cptr-dptr));
+    tmpArr[cptr-dptr] = '\0';
+    for(kidx=0; kidx < static_cast<unsigned int>(cptr-dptr); ++kidx)
+        {
+            if(!isdigit(tmpArr[kidx]))
+                {
+                    report(errs, "Non-numeric end coordinate.  See line %" PRIu64 " in %s.\n",
+                           lines, fileName);
+                    return -1;
+                }
+        } /* for */
+    if(atof(tmpArr) > double(Bed::MAX_COORD_VALUE))
+        {
+            report(errs, "End coordinate is too large.  Max allowed value is %" PRIu64 " in BEDOPS.Constants.hpp.  See line %" PRIu64 " in %s.\n",
+                   Bed::MAX_COORD_VALUE, lines, fileName);
+            return -1;
+        }
+    sscanf(tmpArr, "%" SCNd64, endPos);
+
+    /* rest of the line goes into bedLine */
+    *fields = 3;
+    if ( (val = sscanf(cptr, "\t%[^\n]s\n", bedLine)) != EOF )
+      *fields += val;
+    *headCheck = 0;
 
-    /* find minimum, over and over again */
-    while(!done)
+    /* Validate Coords */
+    if ((*startPos < 0) || (*endPos < 0)) 
         {
-            currMin = -1;
-            currRest = NULL;
-            for(i=0; i < numFiles; ++i)
+            report(errs, "Error on line %" PRIu64 " in %s. Genomic position must be greater than 0.\n", 
+                   lines, fileName);
+            return -1;
+        }
+    if (*endPos <= *startPos)
+        {
+            report(errs, "Error on line %" PRIu64 " in %s. Genomic end coordinate is less than (or equal to) start coordinate.\n", 
+                   lines, fileName);
+            return -1;
+        }
+
+    if(*fields > 3)
+        { /* check ID column is <= ID_NAME_LEN for the benefit of downstream programs */
+            cptr = strpbrk(bedLine, "\t "); /* bedops/bedmap do not differentiate these whitespace characters */
+            if(cptr == NULL)
                 {
-                    if(starts[i]>=0)
+                    if(strlen(bedLine) > ID_NAME_LEN)
                         {
-                            if(currMin<0 || (val = strcmp(chroms[i], chroms[currMin]))<0)
-                                currMin = static_cast<int>(i), currRest = rests[i];
-                            else if(0 == val)
-                                {
-                                    if(starts[i] < starts[currMin])
-                                        currMin = static_cast<int>(i), currRest = rests[i];
-                                    else if(starts[i] == starts[currMin] && ends[i] < ends[currMin])
-                                        currMin = static_cast<int>(i), currRest = rests[i];
-                                    else if(starts[i] == starts[currMin] && ends[i] == ends[currMin])
-                                        {
-                                            if (currRest == NULL)
-                                                {
-                                                    currMin = static_cast<int>(i);
-                                                    currRest = rests[i];
-                                                }
-                                            else if (strcmp(rests[i], currRest) < 0)
-                                                {
-                                                    currMin = static_cast<int>(i);
-                                                    currRest = rests[i];
-                                                }
-                                        }
-                                }
+                            report(errs, "ID field too long at line %" PRIu64 " in %s.\n",
+                                   lines, fileName);
+                            report(errs, "Check that you have unix newlines (cat -A) or increase TOKEN_ID_MAX_LENGTH in BEDOPS.Constants.hpp and recompile BEDOPS.\n");
+                            report(errs, "You may instead choose to put a dummy id column (like 'id') in as the 4th field to fix this.\n");
+                            return -1;
                         }
-                } /* for */
-            if(currMin < 0)
-                break;
+                }
+            else if(cptr - bedLine > static_cast<double>( ID_NAME_LEN ))
+                {
+                    report(errs, "ID field too long at line %" PRIu64 " in %s.\n",
+                           lines, fileName);
+                    report(errs, "Check that you have unix newlines (cat -A) or increase TOKEN_ID_MAX_LENGTH in BEDOPS.Constants.hpp and recompile BEDOPS.\n");
+                    report(errs, "You may instead choose to put a dummy id column (like 'id') in as the 4th field to fix this.\n");
+                    return -1;
+                }
+        }
+    return 1;
+}
+
+namespace
+{
+    /*
+      One input of mergeSortedFiles(), read a row at a time.  The fields up to done are those
+        runLess() reads.  rank is 0 while the input's row is on the chromosome being merged, and 1
+        once the input has moved past it, so rows are compared by chromosome name only when an
+        input moves on to its next chromosome.
+    */
+    struct SortedInput
+    {
+        uint32_t rank;
+        Bed::SignedCoordType startPos, endPos;
+        std::string rest; /* text after the end coordinate, leading tab included */
+        bool done;
+        std::string chrom;
+        std::string nextRest;
+        char const *fileName;
+        FILE *fp;
+        starch::Starch *archive;
+        Bed::LineCountType lines;
+        int headCheck;
+        bool started;
+    };
+
+    /*
+      nextSortedRow() moves in to its next row, and checks that this row does not sort before the
+        last one.  It returns -1 for a bad row or unsorted input, which is described on stderr;
+        in.done is set at the end of the input.  bedLine, chromBuf and tmpArr are scratch space
+        shared by all inputs.
+    */
+    int
+    nextSortedRow(SortedInput &in, char *bedLine, char *chromBuf, char *tmpArr)
+    {
+        Bed::SignedCoordType startPos = 0, endPos = 0;
+        Bed::CoordType s = 0, e = 0;
+        Bed::LineCountType line = 0;
+        char const *chrom = NULL, *rest = NULL;
+        char const *msg = NULL;
+        int fields = 0, val = 0;
+
+        if(in.archive)
+            {
+                if(!in.archive->extractBEDRecord(chrom, s, e, rest))
+                    {
+                        in.done = true;
+                        return 0;
+                    }
+                line = in.lines++;
+                startPos = static_cast<Bed::SignedCoordType>(s);
+                endPos = static_cast<Bed::SignedCoordType>(e);
+                in.nextRest.clear();
+                if(*rest)
+                    in.nextRest.append(1, '\t').append(rest);
+            }
+        else
+            {
+                do
+                    {
+                        bedLine[BED_LINE_LEN] = '1';
+                        if(!fgets(bedLine, BED_LINE_LEN+1, in.fp))
+                            {
+                                in.done = true;
+                                return 0;
+                            }
+                        line = in.lines++;
+                        if((val = parseBedLine(bedLine, chromBuf, tmpArr, &startPos, &endPos, &fields, &in.headCheck,
+                                               line, in.fileName, stderr)) < 0)
+                            return -1;
+                    } while(0 == val); /* blank line or header */
+
+                /* parseBedLine() gives the chromosome name reversed */
+                std::reverse(chromBuf, chromBuf + strlen(chromBuf));
+                chrom = chromBuf;
+                in.nextRest.clear();
+                if(fields > 3)
+                    in.nextRest.append(1, '\t').append(bedLine);
+            }
+
+        if(!in.started || (val = strcmp(chrom, in.chrom.c_str())) > 0)
+            { /* first row on a new chromosome */
+                in.chrom = chrom;
+                in.rank = 1;
+                in.started = true;
+            }
+        else if(val < 0)
+            msg = "first column";
+        else if(startPos < in.startPos)
+            msg = "start coordinates";
+        else if(startPos == in.startPos && endPos < in.endPos)
+            msg = "end coordinates when start coordinates are identical";
+        else if(startPos == in.startPos && endPos == in.endPos && in.nextRest < in.rest)
+            msg = "information following the 3rd column (columns 1-3 equal to previous row)";
+
+        if(msg)
+            {
+                fprintf(stderr, "Bed file not properly sorted by %s.  See %s %" PRIu64 " in %s.\n",
+                        msg, in.archive ? "row" : "line", line, in.fileName);
+                fprintf(stderr, "Every input to --merge-sorted must already be sorted by sort-bed.\n");
+                return -1;
+            }
+
+        in.startPos = startPos;
+        in.endPos = endPos;
+        in.rest.swap(in.nextRest);
+        return 0;
+    }
+
+    /* --unique and --duplicates hold back each distinct row until the next one shows up */
+    struct PendingRow
+    {
+        PendingRow() : startPos(0), endPos(0), count(0) {}
+
+        std::string chrom;
+        Bed::SignedCoordType startPos, endPos;
+        std::string rest;
+        Bed::LineCountType count;
+    };
+
+    inline bool
+    flushPendingRow(FILE *out, starch::Starch2Writer *archive, PendingRow const &row, const bool printUniques,
+                    const bool printDuplicates)
+    {
+        if((printUniques && row.count == 1) || (printDuplicates && row.count > 1))
+            return putRow(out, archive, row.chrom.c_str(), row.startPos, row.endPos, row.rest.c_str());
+        return true;
+    }
+
+    /* opens each input, and reads its first row; -1 if any cannot be */
+    int
+    openSortedInputs(char const **bedFileNames, std::vector<SortedInput> &inputs,
+                     char *bedLine, char *chromBuf, char *tmpArr)
+    {
+        struct stat st;
+        for(size_t i = 0; i < inputs.size(); ++i)
+            {
+                SortedInput &in = inputs[i];
+                in.rank = 1;
+                in.startPos = in.endPos = 0;
+                in.done = in.started = false;
+                in.fileName = bedFileNames[i];
+                in.fp = NULL;
+                in.archive = NULL;
+                in.lines = 1;
+                in.headCheck = 1;
+                if(strcmp(bedFileNames[i], "-") == 0)
+                    in.fp = stdin;
+                else if((in.fp = fopen(bedFileNames[i], "r")) == NULL)
+                    {
+                        fprintf(stderr, "Unable to access %s\n", bedFileNames[i]);
+                        return -1;
+                    }
+                else if(stat(bedFileNames[i], &st) == 0 && !S_ISFIFO(st.st_mode) && starch::Starch::isStarch(in.fp))
+                    { /* named pipes cannot be positioned to look for a Starch archive */
+                        in.archive = new starch::Starch(in.fp, "all", true); /* owns fp */
+                        in.fp = NULL;
+                    }
+            } /* for */
+
+        for(size_t i = 0; i < inputs.size(); ++i)
+            if(nextSortedRow(inputs[i], bedLine, chromBuf, tmpArr) < 0)
+                return -1;
+        return 0;
+    }
+
+    int
+    mergeSortedInputs(FILE *out, starch::Starch2Writer *archive, std::vector<SortedInput> &inputs,
+                      const bool printUniques, const bool printDuplicates, char *bedLine, char *chromBuf, char *tmpArr)
+    {
+        LoserTree<SortedInput> tree(inputs);
+        PendingRow pending;
+        char const *chrom = NULL;
+        size_t i = 0;
+
+        while(!inputs.empty() && !inputs[tree.winner()].done)
+            {
+                SortedInput &in = inputs[tree.winner()];
+                if(in.rank != 0)
+                    { /* every input is past the last chromosome merged: merge the least one next */
+                        chrom = NULL;
+                        for(i = 0; i < inputs.size(); ++i)
+                            if(!inputs[i].done && (chrom == NULL || strcmp(inputs[i].chrom.c_str(), chrom) < 0))
+                                chrom = inputs[i].chrom.c_str();
+                        for(i = 0; i < inputs.size(); ++i)
+                            inputs[i].rank = (!inputs[i].done && strcmp(inputs[i].chrom.c_str(), chrom) == 0) ? 0 : 1;
+                        tree.build();
+                        continue;
+                    }
+
+                if(!printUniques && !printDuplicates)
+                    {
+                        if(!putRow(out, archive, in.chrom.c_str(), in.startPos, in.endPos, in.rest.c_str()))
+                            return -1;
+                    }
+                else if(pending.count > 0 && pending.startPos == in.startPos && pending.endPos == in.endPos &&
+                        pending.rest == in.rest && pending.chrom == in.chrom)
+                    ++pending.count;
+                else
+                    {
+                        if(pending.count > 0 && !flushPendingRow(out, archive, pending, printUniques, printDuplicates))
+                            return -1;
+                        pending.chrom = in.chrom;
+                        pending.startPos = in.startPos;
+                        pending.endPos = in.endPos;
+                        pending.rest = in.rest;
+                        pending.count = 1;
+                    }
+
+                if(nextSortedRow(in, bedLine, chromBuf, tmpArr) < 0)
+                    return -1;
+                tree.replay();
+            } /* while */
+
+        if(pending.count > 0 && !flushPendingRow(out, archive, pending, printUniques, printDuplicates))
+            return -1;
+        return 0;
+    }
+} // unnamed namespace
+
+/*
+  mergeSortedFiles() merges inputs that are each sorted already, like 'sort -m', holding a single
+    row per input.  Each input is checked as it is read, and the merge stops at the first row out
+    of order.  Starch archives given by file name are read without first extracting them.
+*/
+int
+mergeSortedFiles(char const **bedFileNames, unsigned int numFiles, const bool printUniques, const bool printDuplicates,
+                 starch::Starch2Writer *archive)
+{
+    std::vector<SortedInput> inputs(numFiles);
+    std::vector<char> bedLine(BED_LINE_LEN + 1), chromBuf(CHROM_NAME_LEN + 1), tmpArr(BED_LINE_LEN + 1);
+    int rval = EXIT_FAILURE;
+
+    if(checkFiles(bedFileNames, numFiles) < 0)
+        return EXIT_FAILURE;
+
+    try
+        {
+            if(openSortedInputs(bedFileNames, inputs, &bedLine[0], &chromBuf[0], &tmpArr[0]) == 0 &&
+               mergeSortedInputs(stdout, archive, inputs, printUniques, printDuplicates, &bedLine[0], &chromBuf[0], &tmpArr[0]) == 0)
+                rval = EXIT_SUCCESS;
+        }
+    catch(std::string &s)
+        { /* from the Starch API */
+            fprintf(stderr, "%s\n", s.c_str());
+        }
+    catch(std::exception &e)
+        {
+            fprintf(stderr, "%s\n", e.what());
+        }
+
+    for(size_t i = 0; i < inputs.size(); ++i)
+        {
+            delete inputs[i].archive;
+            if(inputs[i].fp != NULL && inputs[i].fp != stdin)
+                fclose(inputs[i].fp);
+        } /* for */
+    return rval;
+}
+
+namespace
+{
+    /* chromosome lookup by (reversed) name for the multithreaded paths, using the same strategy as processData() */
+    struct ChromIndex
+    {
+        ChromIndex() : last(-1), allocs(1) {}
+
+        /* position of chromBuf in beds->chroms, or -1 */
+        Bed::SignedCoordType
+        find(BedData const *beds, char const *chromBuf)
+        {
+            if(last >= 0 && strcmp(beds->chroms[last]->chromName, chromBuf) == 0)
+                return last;
+            if(names.empty())
+                {
+                    for(Bed::SignedCoordType i = 0; i < beds->numChroms; ++i)
+                        if(strcmp(beds->chroms[i]->chromName, chromBuf) == 0)
+                            return (last = i);
+                    return -1;
+                }
+            std::map<std::string, Bed::SignedCoordType>::const_iterator siter = names.find(chromBuf);
+            return (siter == names.end()) ? -1 : (last = siter->second);
+        }
+
+        /* false when out of memory */
+        bool
+        add(BedData *beds, ChromBedData *chrom)
+        {
+            if(beds->numChroms >= static_cast<Bed::SignedCoordType>(NUM_CHROM_EST * allocs))
+                {
+                    allocs++;
+                    beds->chroms = static_cast<ChromBedData**>( realloc(beds->chroms, sizeof(ChromBedData*) * NUM_CHROM_EST * allocs) );
+                    if(beds->chroms == NULL)
+                        return false;
+                }
+            beds->chroms[beds->numChroms] = chrom;
+            last = beds->numChroms++;
+            if(!names.empty())
+                names.insert(std::make_pair(std::string(chrom->chromName), last));
+            else if(beds->numChroms == ChromCrossover)
+                for(Bed::SignedCoordType i = 0; i < beds->numChroms; ++i)
+                    names.insert(std::make_pair(std::string(beds->chroms[i]->chromName), i));
+            return true;
+        }
+
+        static const Bed::SignedCoordType ChromCrossover = 1000;
+        std::map<std::string, Bed::SignedCoordType> names;
+        Bed::SignedCoordType last;
+        size_t allocs;
+    };
+
+    /* copy the row at pos into bedLine, as fgets() would; returns the number of bytes consumed */
+    size_t
+    nextRow(char const *pos, char const *end, char *bedLine)
+    {
+        char const *eol = static_cast<char const*>( memchr(pos, '\n', static_cast<size_t>(end - pos)) );
+        size_t len = (eol == NULL) ? static_cast<size_t>(end - pos) : static_cast<size_t>(eol - pos + 1);
+        if(len > BED_LINE_LEN)
+            len = BED_LINE_LEN;
+        bedLine[BED_LINE_LEN] = '1';
+        memcpy(bedLine, pos, len);
+        bedLine[len] = '\0';
+        return len;
+    }
+
+    /* whole rows of one file, parsed by one thread */
+    struct ParseChunk
+    {
+        char const *begin;
+        char const *end;
+        Bed::LineCountType numLines;
+        BedData *beds;
+        bool ok;
+    };
+
+    /*
+      parseChunk() reads the rows of chunk into chunk->beds, checking them exactly as processData()
+        does, and stops at the first bad row.  Bad rows are described on errs unless errs is NULL,
+        with line numbers counted from firstLine.  Leading headers must already be skipped.
+    */
+    void
+    parseChunk(ParseChunk *chunk, Bed::LineCountType firstLine, char const *fileName, FILE *errs)
+    {
+        char *bedLine = static_cast<char*>( malloc(BED_LINE_LEN + 1) );
+        char *chromBuf = static_cast<char*>( malloc(CHROM_NAME_LEN + 1) );
+        char *tmpArr = static_cast<char*>( malloc(BED_LINE_LEN + 1) );
+        Bed::SignedCoordType startPos = 0, endPos = 0, idx = 0;
+        int fields = 0, headCheck = 0, val = 0;
+        double bytes = 0;
+        ChromIndex index;
+        ChromBedData *chrom = NULL;
+        char const *pos = chunk->begin;
+
+        chunk->numLines = 0;
+        chunk->beds = (bedLine && chromBuf && tmpArr) ? initializeBedData(&bytes) : NULL;
+        chunk->ok = (chunk->beds != NULL);
+        if(!chunk->ok)
+            fprintf(stderr, "Error: %s, %d: Unable to create BED structure. Out of memory.\n", __FILE__, __LINE__);
+
+        while(chunk->ok && pos < chunk->end)
+            {
+                pos += nextRow(pos, chunk->end, bedLine);
+                val = parseBedLine(bedLine, chromBuf, tmpArr, &startPos, &endPos, &fields, &headCheck,
+                                   firstLine + chunk->numLines, fileName, errs);
+                chunk->numLines++;
+                if(val < 0)
+                    {
+                        chunk->ok = false;
+                        break;
+                    }
+                else if(0 == val)
+                    continue;
+
+                if((idx = index.find(chunk->beds, chromBuf)) < 0)
+                    {
+                        if((chrom = initializeChromBedData(chromBuf, &bytes)) == NULL || !index.add(chunk->beds, chrom))
+                            {
+                                fprintf(stderr, "Error: %s, %d: Unable to create Chrom structure. Out of memory.\n", __FILE__, __LINE__);
+                                chunk->ok = false;
+                                break;
+                            }
+                        idx = index.last;
+                    }
+                if(appendChromBedEntry(chunk->beds, chunk->beds->chroms[idx], startPos, endPos, (fields > 3) ? bedLine : NULL, &bytes) < 0)
+                    chunk->ok = false;
+            } /* while */
+
+        free(bedLine);
+        free(chromBuf);
+        free(tmpArr);
+    }
+
+    /* step over the blank and header rows that may lead a file, as processData() does */
+    char const *
+    skipHeaders(char const *pos, char const *end, Bed::LineCountType *lines, int *headCheck, char const *fileName)
+    {
+        char bedLine[BED_LINE_LEN + 1], chromBuf[CHROM_NAME_LEN + 1], tmpArr[BED_LINE_LEN + 1];
+        Bed::SignedCoordType startPos = 0, endPos = 0;
+        int fields = 0, check = 1;
+        size_t len = 0;
+        while(pos < end)
+            {
+                len = nextRow(pos, end, bedLine);
+                if(0 != parseBedLine(bedLine, chromBuf, tmpArr, &startPos, &endPos, &fields, &check, *lines, fileName, NULL))
+                    { /* the first BED row, or a bad one: leave it for parseChunk() */
+                        *headCheck = 0;
+                        break;
+                    }
+                pos += len;
+                (*lines)++;
+            } /* while */
+        return pos;
+    }
+
+    /*
+      mergeBedData() moves the rows of part onto the ends of their chromosomes in beds, along with
+        the text they point into, and frees part.  Segments are linked, not copied.  Returns false
+        when out of memory.
+    */
+    bool
+    mergeBedData(BedData *beds, ChromIndex &index, BedData *part)
+    {
+        Bed::SignedCoordType i = 0, idx = 0;
+        TextBlock *block = NULL;
+        for(i = 0; i < part->numChroms; ++i)
+            {
+                ChromBedData *from = part->chroms[i];
+                if((idx = index.find(beds, from->chromName)) < 0)
+                    { /* new chromosome: take it over whole */
+                        if(!index.add(beds, from))
+                            return false;
+                        continue;
+                    }
+
+                ChromBedData *to = beds->chroms[idx];
+                to->lastSegment->next = from->firstSegment;
+                to->lastSegment = from->lastSegment;
+                to->numCoords += from->numCoords;
+                free(from);
+            } /* for */
+        if(part->text != NULL)
+            {
+                for(block = part->text; block->next != NULL; block = block->next)
+                    ;
+                block->next = beds->text;
+                beds->text = part->text;
+            }
+        free(part->chroms);
+        free(part);
+        return true;
+    }
+
+    /*
+      processDataThreaded() is processData() for the in-memory case with more than one thread.  Input
+        is read in large blocks of whole rows; each block is cut into one chunk per thread at row
+        boundaries, and the chunks are parsed concurrently.  The results are gathered in input order.
+        When a chunk holds a bad row, that chunk is parsed once more on this thread to report it with
+        the right line number, so messages match those of a single thread.
+    */
+    int
+    processDataThreaded(char const **bedFileNames, unsigned int numFiles, unsigned int numThreads,
+                        const bool printUniques, const bool printDuplicates, const bool diagnostics,
+                        starch::Starch2Writer *archive)
+    {
+        const size_t chunkBytes = 1 << 23;
+        std::vector<char> block(chunkBytes * numThreads);
+        std::vector<ParseChunk> chunks(numThreads);
+        std::vector<std::thread> workers;
+        ChromIndex index;
+        double bytes = 0;
+        FILE *bedFile = NULL;
+        unsigned int iidx = 0U, tidx = 0U, numChunks = 0U;
+
+        BedData *beds = initializeBedData(&bytes);
+        if(beds == NULL)
+            {
+                fprintf(stderr, "Error: %s, %d: Unable to create BED structure. Out of memory.\n", __FILE__, __LINE__);
+                return EXIT_FAILURE;
+            }
+
+        for(iidx = 0; iidx < numFiles; iidx++)
+            {
+                const bool notStdin = (strcmp(bedFileNames[iidx], "-") != 0);
+                bedFile = notStdin ? fopen(bedFileNames[iidx], "r") : stdin;
+                Bed::LineCountType lines = 1;
+                int headCheck = 1;
+                size_t carry = 0, got = 0;
+                bool eof = false;
+                while(!eof)
+                    {
+                        got = fread(&block[carry], 1, block.size() - carry, bedFile);
+                        eof = (got < block.size() - carry);
+                        char const *pos = &block[0];
+                        char const *end = pos + carry + got;
+                        char const *stop = end; /* end of the whole rows in block */
+                        if(!eof)
+                            {
+                                while(stop != pos && *(stop-1) != '\n')
+                                    --stop;
+                                if(stop == pos) /* a row longer than block, which parseBedLine() rejects */
+                                    stop = end;
+                            }
+
+                        if(headCheck)
+                            pos = skipHeaders(pos, stop, &lines, &headCheck, bedFileNames[iidx]);
+
+                        /* one chunk per thread, cut at row boundaries */
+                        for(numChunks = 0; numChunks < numThreads && pos < stop; ++numChunks)
+                            {
+                                char const *cut = pos + std::max(static_cast<size_t>(1), static_cast<size_t>(stop - pos) / (numThreads - numChunks));
+                                while(cut < stop && *(cut-1) != '\n')
+                                    ++cut;
+                                chunks[numChunks].begin = pos;
+                                chunks[numChunks].end = cut;
+                                pos = cut;
+                            } /* for */
+
+                        workers.clear();
+                        for(tidx = 1; tidx < numChunks; ++tidx)
+                            workers.push_back(std::thread(parseChunk, &chunks[tidx], 0, bedFileNames[iidx], static_cast<FILE*>(NULL)));
+                        if(numChunks > 0)
+                            parseChunk(&chunks[0], 0, bedFileNames[iidx], NULL);
+                        for(tidx = 0; tidx < workers.size(); ++tidx)
+                            workers[tidx].join();
+
+                        for(tidx = 0; tidx < numChunks; ++tidx)
+                            {
+                                if(!chunks[tidx].ok)
+                                    {
+                                        parseChunk(&chunks[tidx], lines, bedFileNames[iidx], stderr);
+                                        return EXIT_FAILURE;
+                                    }
+                                lines += chunks[tidx].numLines;
+                                if(!mergeBedData(beds, index, chunks[tidx].beds))
+                                    {
+                                        fprintf(stderr, "Error: %s, %d: Unable to create BED structure. Out of memory.\n", __FILE__, __LINE__);
+                                        return EXIT_FAILURE;
+                                    }
+                            } /* for */
 
-            if(3 == fields[currMin])
-                fprintf(output, "%s\t%" PRId64 "\t%" PRId64 "\n", chroms[currMin],
-                        starts[currMin], ends[currMin]);
-            else
-                fprintf(output, "%s\t%" PRId64 "\t%" PRId64 "%s\n", chroms[currMin],
-                        starts[currMin], ends[currMin], rests[currMin]);
-
-            rests[currMin][0] = '\0';
-            fields[currMin] = fscanf(tmpFiles[currMin], "%s\t%" SCNd64 "\t%" SCNd64 "%[^\n]s\n",
-                                     chroms[currMin], &starts[currMin],
-                                     &ends[currMin], rests[currMin]);
-            if(fields[currMin] == EOF)
-                {
-                    starts[currMin] = -1;
-                    ends[currMin] = -1;
-                    fields[currMin] = 0;
-                }
-        } /* while */
+                        /* a partial last row moves to the front for the next block */
+                        carry = static_cast<size_t>(end - stop);
+                        memmove(&block[0], stop, carry);
+                    } /* while */
 
-    for(i=0; i < numFiles; ++i)
-        {
-            free(chroms[i]);
-            free(rests[i]);
-        }
-    free(chroms);
-    free(starts);
-    free(ends);
-    free(rests);
-    free(fields);
+                if(notStdin)
+                    fclose(bedFile);
+            } /* for */
 
-    return 0;
-}
+        if(lexSortBedData(beds, numThreads) != 0)
+            return EXIT_FAILURE;
+        if(diagnostics)
+            reportRuns(stderr, beds);
+        if(printBed(stdout, archive, beds, printUniques, printDuplicates, numThreads) != 0)
+            return EXIT_FAILURE;
+        /* freeBedData(beds); let the OS clean up - takes significant time to do this step manually */
+        return EXIT_SUCCESS;
+    }
 
-void
-freeTmpFiles(unsigned int fcount, FILE **tmpFiles, char **tmpFileNames) {
-    if (fcount)
-        {
-            unsigned int i = 0;
-            while (i < fcount)
-                {
-                    /* tmpFileNames[i] will be NULL if temp file was created through C's tmpfile() */
-                    fclose(tmpFiles[i]);
-                    if ( tmpFileNames[i] != NULL )
-                        {
-                            remove(tmpFileNames[i]);
-                            free(tmpFileNames[i]);
-                        }
-                    ++i;
-                } /* while */
-            free(tmpFileNames);
-            free(tmpFiles);
-        }
-}
+} // unnamed namespace
 
 int
-processData(char const **bedFileNames, unsigned int numFiles, const double maxMem, char *tmpPath, const bool printUniques, const bool printDuplicates)
+processData(char const **bedFileNames, unsigned int numFiles, const double maxMem, char *tmpPath,
+            const bool compressTmp, const bool printUniques, const bool printDuplicates, unsigned int numThreads,
+            const bool diagnostics, starch::Starch2Writer *archive)
 {
     /* maxMem will be ignored if <= 0 */
+    /* numThreads > 1 parses input concurrently when sorting in memory, and sorts concurrently in any case */
     /* function does not do a great job of cleaning up memory on failure (including user input problems).
          But, failure leads to quick program termination and cleanup by the OS. */
 
@@ -538,8 +1758,9 @@ processData(char const **bedFileNames, unsigned int numFiles, const double maxMe
     int notStdin = 0,
         fields = 0,
         headCheck = 1,
-        val = 0;
-    unsigned int iidx, jidx, kidx, tidx, newChrom;
+        val = 0,
+        rval = 0;
+    unsigned int iidx, jidx, tidx, newChrom;
     unsigned int tmpFileCount = 0U;
     size_t chromAllocs = 1;
     Bed::SignedCoordType lastidx = 0;
@@ -555,11 +1776,10 @@ processData(char const **bedFileNames, unsigned int numFiles, const double maxMe
     FILE **tmpFiles = NULL;
     char *tfile = NULL;
 
-    double **chromBytes = NULL;
     const int chromCrossover = 1000;
     const unsigned int maxTmpFiles = 120; // can hit max open file descriptors in extreme cases.  use hierarchial merge-sort
-    double diffBytes = 0;
-    double maxChromBytes = 0;
+    const double runBytes = static_cast<double>(SPILL_BUFFER_SIZE) * (compressTmp ? 4 : 1); // buffers held by each open run
+    double maxChromBytes = 0; /* coords of the largest chromosome: sorting needs as much again */
     bool firstCross = true;
     std::map<std::string, unsigned int> chrNames;
     std::map<std::string, unsigned int>::iterator siter;
@@ -592,25 +1812,23 @@ processData(char const **bedFileNames, unsigned int numFiles, const double maxMe
     chromBuf[0] = '\0';
     tmpArr[0] = '\0';
 
-    char *cptr = NULL;
-    char *dptr = NULL;
-
     /* check input files */
     if(0 != checkFiles(bedFileNames, numFiles))
         {
             return EXIT_FAILURE;
         }
 
-    /* if we'll perform file system merge sort, create or check tmp dir */
-    if ((tmpPath != NULL) && (createDir(tmpPath) == EXIT_FAILURE))
+    if((numThreads > 1) && (maxMem <= 0))
         {
-            return EXIT_FAILURE;
+            free(bedLine);
+            free(chromBuf);
+            free(tmpArr);
+            return processDataThreaded(bedFileNames, numFiles, numThreads, printUniques, printDuplicates, diagnostics, archive);
         }
 
-    chromBytes = static_cast<double**>( malloc(sizeof(double *)) );
-    if(chromBytes == NULL)
+    /* if we'll perform file system merge sort, create or check tmp dir */
+    if ((tmpPath != NULL) && (createDir(tmpPath) == EXIT_FAILURE))
         {
-            fprintf(stderr, "Error: %s, %d: Unable to create double* array. Out of memory.\n", __FILE__, __LINE__);
             return EXIT_FAILURE;
         }
 
@@ -646,162 +1864,17 @@ processData(char const **bedFileNames, unsigned int numFiles, const double maxMe
             bedLine[0] = '\n';
             while(fgets(bedLine, BED_LINE_LEN+1, bedFile))
                 {
-                    if('\n' == bedLine[0])
-                        { /* only a new line was found */
-                            lines++;
-                            continue;
-                        }
-                    else if('\0' == bedLine[BED_LINE_LEN])
-                        {
-                            fprintf(stderr, "BED row length exceeds capacity at line %" PRIu64 " in %s.\n",
-                                    lines, bedFileNames[iidx]);
-                            fprintf(stderr, "Check that you have unix newlines (cat -A) or increase TOKENS_MAX_LENGTH in BEDOPS.Constants.hpp and recompile BEDOPS.\n");
-                            return EXIT_FAILURE;
-                        }
-                    else if(' ' == bedLine[0] || '\t' == bedLine[0])
+                    if((val = parseBedLine(bedLine, chromBuf, tmpArr, &startPos, &endPos, &fields, &headCheck,
+                                           lines, bedFileNames[iidx], stderr)) < 0)
                         {
-                            fprintf(stderr, "Row begins with a tab or space at line %" PRIu64 " in %s.\n",
-                                    lines, bedFileNames[iidx]);
                             return EXIT_FAILURE;
                         }
-
-                    if(headCheck &&
-                       (strstr(bedLine, "browser") == bedLine ||
-                        strstr(bedLine, "track") == bedLine ||
-                        strstr(bedLine, "#") == bedLine ||
-                        strstr(bedLine, "@") == bedLine))
-                        { /* allow silly headers on input; delete them on output */
+                    else if(0 == val)
+                        { /* blank line or header */
                             lines++;
                             continue;
                         }
 
-                    /* chromosome check */
-                    cptr = strpbrk(bedLine, "\t "); /* we'll convert spaces to tabs in the first 3 fields */
-                    if(cptr == NULL)
-                        {
-                            fprintf(stderr, "No tabs/spaces found at line %" PRIu64 " in %s.\n",
-                                    lines, bedFileNames[iidx]);
-                            return EXIT_FAILURE;
-                        }
-                    if(static_cast<size_t>(cptr - bedLine) > CHROM_NAME_LEN)
-                        {
-                            fprintf(stderr, "Chromosome name too long at line %" PRIu64 " in %s.\n",
-                                    lines, bedFileNames[iidx]);
-                            fprintf(stderr, "Check that you have unix newlines (cat -A) or increase TOKEN_CHR_MAX_LENGTH in BEDOPS.Constants.hpp and recompile BEDOPS.\n");
-                            return EXIT_FAILURE;
-                        }
-
-                    // reverse chrom name for faster lookup in common case that everything looks like chrBLAH
-                    jidx = 0;
-                    for ( kidx = static_cast<unsigned int>(cptr-bedLine); kidx > 0; )
-                      chromBuf[jidx++] = bedLine[--kidx];
-                    chromBuf[static_cast<size_t>(cptr-bedLine)-1] = bedLine[0];
-                    //  memcpy(chromBuf, bedLine, static_cast<size_t>(cptr-bedLine));
-                    chromBuf[cptr-bedLine] = '\0';
-
-                    /* start coord check */
-                    dptr = strpbrk(++cptr, "\t "); /* we'll convert spaces to tabs in the first 3 fields */
-                    if(dptr == NULL)
-                        {
-                            fprintf(stderr, "No tabs/spaces found after the start coordinate (or no start coordinate at all) at line %" PRIu64 " in %s.\n",
-                                    lines, bedFileNames[iidx]);
-                            return EXIT_FAILURE;
-                        }
-                    if(dptr - cptr > static_cast<double>( Bed::MAX_DEC_INTEGERS ))
-                        {
-                            fprintf(stderr, "Start coordinate is too large.  Max decimal digits allowed is %ld in BEDOPS.Constants.hpp.  See line %" PRIu64 " in %s.\n",
-                                    Bed::MAX_DEC_INTEGERS, lines, bedFileNames[iidx]);
-                            return EXIT_FAILURE;
-                        }
-                    else if(0 == dptr - cptr)
-                        {
-                            fprintf(stderr, "Consecutive tabs and/or spaces between chromosome and start coordinate.  See line %" PRIu64 " in %s.\n",
-                                    lines, bedFileNames[iidx]);
-                            return EXIT_FAILURE;
-                        }
-                    memcpy(tmpArr, cptr, static_cast<size_t>(dptr-cptr));
-                    tmpArr[dptr-cptr] = '\0';
-                    for(kidx=0; kidx < static_cast<unsigned int>(dptr-cptr); ++kidx)
-                        {
-                            if(!isdigit(tmpArr[kidx]))
-                                {
-                                    fprintf(stderr, "Non-numeric start coordinate.  See line %" PRIu64 " in %s.\n(remember that chromosome names should not contain spaces.)\n",
-                                            lines, bedFileNames[iidx]);
-                                    return EXIT_FAILURE;
-                                }
-                        } /* for */
-                    if(atof(tmpArr) > double(Bed::MAX_COORD_VALUE))
-                        {
-                            fprintf(stderr, "Start coordinate is too large.  Max allowed value is %" PRIu64 " in BEDOPS.Constants.hpp.  See line %" PRIu64 " in %s.\n",
-                                    Bed::MAX_COORD_VALUE, lines, bedFileNames[iidx]);
-                            return EXIT_FAILURE;
-                        }
-                    sscanf(tmpArr, "%" SCNd64, &startPos);
-
-                    /* end coord check */
-                    cptr = strpbrk(++dptr, "\t ");
-                    if(cptr == NULL)
-                        { /* eol */
-                            cptr = strchr(dptr, '\n');
-                            if(cptr == NULL)
-                                {
-                                    fprintf(stderr, "No end of line found at %" PRIu64 " in %s.\nMay need to increase BED_LINE_LEN and recompile.\nFirst check that you have unix newlines (cat -A).",
-                                            lines, bedFileNames[iidx]);
-                                    return EXIT_FAILURE;
-                                }
-                        }
-                    if(cptr - dptr > static_cast<double>( Bed::MAX_DEC_INTEGERS ))
-                        {
-                            fprintf(stderr, "End coordinate is too large.  Max decimal digits allowed is %ld in BEDOPS.Constants.hpp.  See line %" PRIu64 " in %s.\n",
-                                    Bed::MAX_DEC_INTEGERS, lines, bedFileNames[iidx]);
-                            return EXIT_FAILURE;
-                        }
-                    else if(cptr == dptr)
-                        {
-                            fprintf(stderr, "Extra tab and/or space found in between start and end coordinates.  See line %" PRIu64 " in %s.\n",
-                                    lines, bedFileNames[iidx]);
-                            return EXIT_FAILURE;
-                        }
-                    memcpy(tmpArr, dptr, static_cast<size_t>(cptr-dptr));
-                    tmpArr[cptr-dptr] = '\0';
-                    for(kidx=0; kidx < static_cast<unsigned int>(cptr-dptr); ++kidx)
-                        {
-                            if(!isdigit(tmpArr[kidx]))
-                                {
-                                    fprintf(stderr, "Non-numeric end coordinate.  See line %" PRIu64 " in %s.\n",
-                                            lines, bedFileNames[iidx]);
-                                    return EXIT_FAILURE;
-                                }
-                        } /* for */
-                    if(atof(tmpArr) > double(Bed::MAX_COORD_VALUE))
-                        {
-                            fprintf(stderr, "End coordinate is too large.  Max allowed value is %" PRIu64 " in BEDOPS.Constants.hpp.  See line %" PRIu64 " in %s.\n",
-                                    Bed::MAX_COORD_VALUE, lines, bedFileNames[iidx]);
-                            return EXIT_FAILURE;
-                        }
-                    sscanf(tmpArr, "%" SCNd64, &endPos);
-
-                    /* rest of the line goes into bedLine */
-                    fields = 3;
-                    if ( (val = sscanf(cptr, "\t%[^\n]s\n", bedLine)) != EOF )
-                      fields += val;
-                    headCheck = 0;
-
-                    /* Validate Coords */
-                    if ((startPos < 0) || (endPos < 0)) 
-                        {
-                            fprintf(stderr, "Error on line %" PRIu64 " in %s. Genomic position must be greater than 0.\n", 
-                                    lines, bedFileNames[iidx]);
-                            return EXIT_FAILURE;
-                        }
-                    if (endPos <= startPos)
-                        {
-                            fprintf(stderr, "Error on line %" PRIu64 " in %s. Genomic end coordinate is less than (or equal to) start coordinate.\n", 
-                                    lines, bedFileNames[iidx]);
-                            return EXIT_FAILURE;
-                        }
-
-
                     /*Find the chrom*/
                     newChrom = 1;
                     if (beds->numChroms < chromCrossover)
@@ -850,44 +1923,13 @@ processData(char const **bedFileNames, unsigned int numFiles, const double maxMe
                     if (!newChrom)
                         {
                             /* Append data to current chrom */
-                            diffBytes = totalBytes;
-                            if(fields > 3)
-                                { /* check ID column is <= ID_NAME_LEN for the benefit of downstream programs */
-                                    cptr = strpbrk(bedLine, "\t "); /* bedops/bedmap do not differentiate these whitespace characters */
-                                    if(cptr == NULL)
-                                        {
-                                            if(strlen(bedLine) > ID_NAME_LEN)
-                                                {
-                                                    fprintf(stderr, "ID field too long at line %" PRIu64 " in %s.\n",
-                                                            lines, bedFileNames[iidx]);
-                                                    fprintf(stderr, "Check that you have unix newlines (cat -A) or increase TOKEN_ID_MAX_LENGTH in BEDOPS.Constants.hpp and recompile BEDOPS.\n");
-                                                    fprintf(stderr, "You may instead choose to put a dummy id column (like 'id') in as the 4th field to fix this.\n");
-                                                    return EXIT_FAILURE;
-                                                }
-                                        }
-                                    else if(cptr - bedLine > static_cast<double>( ID_NAME_LEN ))
-                                        {
-                                            fprintf(stderr, "ID field too long at line %" PRIu64 " in %s.\n",
-                                                    lines, bedFileNames[iidx]);
-                                            fprintf(stderr, "Check that you have unix newlines (cat -A) or increase TOKEN_ID_MAX_LENGTH in BEDOPS.Constants.hpp and recompile BEDOPS.\n");
-                                            fprintf(stderr, "You may instead choose to put a dummy id column (like 'id') in as the 4th field to fix this.\n");
-                                            return EXIT_FAILURE;
-                                        }
-                                    chromEntryCount = appendChromBedEntry(beds->chroms[jidx], startPos, endPos, bedLine, &totalBytes, maxMem);
-                                }
-                            else
-                                {
-                                    chromEntryCount = appendChromBedEntry(beds->chroms[jidx], startPos, endPos, NULL, &totalBytes, maxMem);
-                                }
+                            chromEntryCount = appendChromBedEntry(beds, beds->chroms[jidx], startPos, endPos, (fields > 3) ? bedLine : NULL, &totalBytes);
 
                             if (static_cast<int>(chromEntryCount) < 0)
                                 {
                                     fprintf(stderr, "Error: %s, %d: Unable to create BED structure.\n", __FILE__, __LINE__);
                                     return EXIT_FAILURE;
                                 }
-                            diffBytes = totalBytes - diffBytes;
-                            *chromBytes[jidx] += diffBytes;
-                            maxChromBytes = (*chromBytes[jidx] < maxChromBytes) ? maxChromBytes : *chromBytes[jidx]; 
                         }
                     else /* new chrom */
                         {
@@ -905,7 +1947,6 @@ processData(char const **bedFileNames, unsigned int numFiles, const double maxMe
                                         }
                                 }
 
-                            diffBytes = totalBytes;
                             chrom = initializeChromBedData(chromBuf, &totalBytes);
                             if(chrom == NULL)
                                 {
@@ -913,71 +1954,25 @@ processData(char const **bedFileNames, unsigned int numFiles, const double maxMe
                                             __LINE__, strerror(errno));
                                     return EXIT_FAILURE;
                                 }
-                            diffBytes = totalBytes - diffBytes;
-                            chromBytes = static_cast<double**>( realloc(chromBytes, sizeof(double*) * (static_cast<size_t>(beds->numChroms) + 1)) );
-                            if(chromBytes == NULL)
-                                {
-                                    fprintf(stderr, "Error: %s, %d: Unable to create double* array. Out of memory.\n", __FILE__, __LINE__);
-                                    return EXIT_FAILURE;
-                                }
-                            chromBytes[beds->numChroms] = static_cast<double*>( malloc(sizeof(double)) );
-                            if(chromBytes[beds->numChroms] == NULL)
-                                {
-                                    fprintf(stderr, "Error: %s, %d: Unable to create double. Out of memory.\n", __FILE__, __LINE__);
-                                    return EXIT_FAILURE;
-                                }
-                            *chromBytes[beds->numChroms] = diffBytes;
-                            totalBytes += sizeof(double*) + sizeof(double); // sizeof(double*) increments in realloc of chromBytes + sizeof(double) for malloc
-                            diffBytes = totalBytes;
-                            if(fields > 3)
-                                { /* check ID column is <= ID_NAME_LEN for the benefit of downstream programs */
-                                    cptr = strpbrk(bedLine, "\t "); /* bedops/bedmap do not differentiate these whitespace characters */
-                                    if(cptr == NULL)
-                                        {
-                                            if(strlen(bedLine) > ID_NAME_LEN)
-                                                {
-                                                    fprintf(stderr, "ID field too long at line %" PRIu64 " in %s.\n",
-                                                            lines, bedFileNames[iidx]);
-                                                    fprintf(stderr, "Check that you have unix newlines (cat -A) or increase TOKEN_ID_MAX_LENGTH in BEDOPS.Constants.hpp and recompile BEDOPS.\n");
-                                                    fprintf(stderr, "You may instead choose to put a dummy id column (like 'id') in as the 4th field to fix this.\n");
-                                                    return EXIT_FAILURE;
-                                                }
-                                        }
-                                    else if(cptr - bedLine > static_cast<double>( ID_NAME_LEN ))
-                                        {
-                                            fprintf(stderr, "ID field too long at line %" PRIu64 " in %s.\n",
-                                                    lines, bedFileNames[iidx]);
-                                            fprintf(stderr, "Check that you have unix newlines (cat -A) or increase TOKEN_ID_MAX_LENGTH in BEDOPS.Constants.hpp and recompile BEDOPS.\n");
-                                            fprintf(stderr, "You may instead choose to put a dummy id column (like 'id') in as the 4th field to fix this.\n");
-                                            return EXIT_FAILURE;
-                                        }
-                                    chromEntryCount = appendChromBedEntry(chrom, startPos, endPos, bedLine, &totalBytes, maxMem);
-                                }
-                            else
-                                {
-                                    chromEntryCount = appendChromBedEntry(chrom, startPos, endPos, NULL, &totalBytes, maxMem);
-                                }
+                            chromEntryCount = appendChromBedEntry(beds, chrom, startPos, endPos, (fields > 3) ? bedLine : NULL, &totalBytes);
 
                             if(static_cast<int>(chromEntryCount) < 0) 
                                 {
                                     fprintf(stderr, "Error: %s, %d: Unable to create BED structure.\n", __FILE__, __LINE__);
                                     return EXIT_FAILURE;
                                 }        
-                            diffBytes = totalBytes - diffBytes;
-                            *chromBytes[beds->numChroms] += diffBytes;
-                            maxChromBytes = (*chromBytes[beds->numChroms] < maxChromBytes) ? maxChromBytes : *chromBytes[beds->numChroms];
         
                             beds->chroms[beds->numChroms] = chrom;
                             lastidx = beds->numChroms++;
                         }
+                    maxChromBytes = std::max(maxChromBytes, static_cast<double>(chromEntryCount) * sizeof(BedCoordData));
 
                      /* check memory */
                      if(maxMem > 0 && (totalBytes + maxChromBytes >= maxMem))
                          {
-                             /* worst case quicksort memory is O(2*n),
-                                yet we sort by a single chrom at a time and totalBytes already
-                                accounts for 1*n maxChromBytes.  totalBytes is a conservative
-                                measure of memory used.
+                             /* totalBytes counts every segment and text block allocated, and
+                                gathering then sorting the coords of a chromosome takes as much
+                                again as its coords, one chrom at a time: maxChromBytes.
                              */
 
                              errno = 0;
@@ -999,7 +1994,7 @@ processData(char const **bedFileNames, unsigned int numFiles, const double maxMe
                              totalBytes += sizeof(FILE*) * (tmpFileCount+1);
                              totalBytes += sizeof(char*) * (tmpFileCount+1);
                              tfile = NULL;
-                             tmpFiles[tmpFileCount] = createTmpFile(tmpPath, &tfile);
+                             tmpFiles[tmpFileCount] = createTmpFile(tmpPath, &tfile, compressTmp);
                              if(tmpFiles[tmpFileCount] == NULL)
                                  {
                                      fprintf(stderr, "Error: %s, %d: Unable to create FILE* for temp file: %s. Out of memory.\n", __FILE__, 
@@ -1008,28 +2003,24 @@ processData(char const **bedFileNames, unsigned int numFiles, const double maxMe
                                  }
                              totalBytes += (tfile == NULL) ? 0 : (strlen(tfile)+1);
                              tmpFileNames[tmpFileCount] = tfile;
-                             lexSortBedData(beds);
-                             printBed(tmpFiles[tmpFileCount], beds, printUniques, printDuplicates);
-                             for(tidx = 0; tidx < beds->numChroms; ++tidx)
-                                 free(chromBytes[tidx]);
-                             free(chromBytes);
+                             if(lexSortBedData(beds, numThreads) != 0)
+                                 return EXIT_FAILURE;
+                             if(diagnostics)
+                                 reportRuns(stderr, beds);
+                             writeBed(tmpFiles[tmpFileCount], NULL, beds, printUniques, printDuplicates, true);
+                             fflush(tmpFiles[tmpFileCount]); /* a compressed run finishes in the background */
 
                              freeBedData(beds);
                              chromAllocs = 1;
                              chrNames.clear();
                              firstCross = true;
-                             chromBytes = static_cast<double**>( malloc(sizeof(double *)) );
-                             if(chromBytes == NULL)
-                                 {
-                                     fprintf(stderr, "Error: %s, %d: Unable to create double* array. Out of memory.\n", __FILE__, __LINE__);
-                                     return EXIT_FAILURE;
-                                 }
                              maxChromBytes = 0;
-                             totalBytes = overhead; /* already includes chromBytes array */
+                             totalBytes = overhead;
+                             totalBytes += static_cast<double>(tmpFileCount + 1) * runBytes;
                              if ( ++tmpFileCount == maxTmpFiles )
                                  { /* hierarchial merge sort to keep # open file descriptors low */
                                      tfile = NULL;
-                                     tmpX = createTmpFile(tmpPath, &tfile);
+                                     tmpX = createTmpFile(tmpPath, &tfile, compressTmp);
                                      if(tmpX == NULL)
                                          {
                                              fprintf(stderr, "Error: %s, %d: Unable to create FILE* for temp file: %s. Out of memory.\n", __FILE__, 
@@ -1037,7 +2028,7 @@ processData(char const **bedFileNames, unsigned int numFiles, const double maxMe
                                              return EXIT_FAILURE;
                                          }
 
-                                     if(0 != mergeSort(tmpX, tmpFiles, tmpFileCount))
+                                     if(0 != mergeSort(tmpX, NULL, tmpFiles, tmpFileCount, true, printUniques, printDuplicates))
                                          {
                                              fprintf(stderr, "Error: %s, %d.  Out of memory.\n", __FILE__, __LINE__);
                                              return EXIT_FAILURE;
@@ -1104,7 +2095,7 @@ processData(char const **bedFileNames, unsigned int numFiles, const double maxMe
                             return EXIT_FAILURE;
                         }
                     tfile = NULL;
-                    tmpFiles[tmpFileCount] = createTmpFile(tmpPath, &tfile);
+                    tmpFiles[tmpFileCount] = createTmpFile(tmpPath, &tfile, compressTmp);
                     if(tmpFiles[tmpFileCount] == NULL)
                         {
                             fprintf(stderr, "Error: %s, %d: Unable to create FILE* for temp file: %s. Out of memory.\n", __FILE__, 
@@ -1112,28 +2103,30 @@ processData(char const **bedFileNames, unsigned int numFiles, const double maxMe
                             return EXIT_FAILURE;
                         }
                     tmpFileNames[tmpFileCount] = tfile;
-                    lexSortBedData(beds);
-                    printBed(tmpFiles[tmpFileCount], beds, printUniques, printDuplicates);
+                    if(lexSortBedData(beds, numThreads) != 0)
+                        return EXIT_FAILURE;
+                    if(diagnostics)
+                        reportRuns(stderr, beds);
+                    writeBed(tmpFiles[tmpFileCount], NULL, beds, printUniques, printDuplicates, true);
                     ++tmpFileCount;
-                    for(tidx = 0; tidx < beds->numChroms; ++tidx)
-                        free(chromBytes[tidx]);
-                    free(chromBytes);
                     freeBedData(beds);
                 }
-            if(0 != mergeSort(stdout, tmpFiles, tmpFileCount))
+            if(0 != (rval = mergeSort(stdout, archive, tmpFiles, tmpFileCount, false, printUniques, printDuplicates)))
                 {
-                    fprintf(stderr, "Error: %s, %d.  Out of memory.\n", __FILE__, __LINE__);
+                    if(rval < 0)
+                        fprintf(stderr, "Error: %s, %d.  Out of memory.\n", __FILE__, __LINE__);
                     return EXIT_FAILURE;
                 }
             freeTmpFiles(tmpFileCount, tmpFiles, tmpFileNames);
         }
     else
         {
-            lexSortBedData(beds);
-            printBed(stdout, beds, printUniques, printDuplicates);
-            for(tidx = 0; tidx < beds->numChroms; ++tidx)
-                free(chromBytes[tidx]);
-            free(chromBytes);
+            if(lexSortBedData(beds, numThreads) != 0)
+                return EXIT_FAILURE;
+            if(diagnostics)
+                reportRuns(stderr, beds);
+            if(printBed(stdout, archive, beds, printUniques, printDuplicates, numThreads) != 0)
+                return EXIT_FAILURE;
             /* freeBedData(beds); let the OS clean up - takes significant time to do this step manually */
         }
 
@@ -1147,19 +2140,51 @@ processData(char const **bedFileNames, unsigned int numFiles, const double maxMe
     return EXIT_SUCCESS;
 }
 
-void 
-printBed(FILE *out, BedData *beds, const bool printUniques, const bool printDuplicates)
+/* rows go out as text, as records of archive under --starch, or as a binary run to merge later when spill is set */
+int
+writeBed(FILE *out, starch::Starch2Writer *archive, BedData *beds, const bool printUniques, const bool printDuplicates,
+         const bool spill)
 {
     unsigned int i = 0U;
     Bed::LineCountType j = 0;
+    int rval = 0;
 
     if(beds == NULL) 
-        return;
+        return 0;
+
+    if(spill)
+        {
+            std::vector<char const*> names;
+            for(i = 0; i < beds->numChroms; i++)
+                names.push_back(beds->chroms[i]->chromName);
+            writeSpillTable(out, names);
+        }
 
-    if (!printUniques && !printDuplicates)
+    if (spill || (!printUniques && !printDuplicates))
         for(i = 0; i < beds->numChroms; i++)
             for(j = 0; j < beds->chroms[i]->numCoords; j++) 
                 {
+                    if(spill)
+                        {
+                            BedCoordData const *coords = beds->chroms[i]->coords;
+                            char const *data = coords[j].data;
+                            Bed::LineCountType count = 1;
+                            if(printUniques || printDuplicates) /* sorted, equal rows are neighbors: one stands for all */
+                                for(; j + 1 < beds->chroms[i]->numCoords && sameRow(coords[j], coords[j + 1]); ++j)
+                                    ++count;
+                            writeSpillRow(out, i, coords[j].startCoord, coords[j].endCoord,
+                                          data != NULL, data, (data != NULL) ? strlen(data) : 0);
+                            if(printUniques || printDuplicates)
+                                writeSpillCount(out, count);
+                            continue;
+                        }
+                    else if(archive)
+                        {
+                            if(starch::STARCH2_addRecordToWriter(archive, beds->chroms[i]->chromName, beds->chroms[i]->coords[j].startCoord,
+                                                                 beds->chroms[i]->coords[j].endCoord, beds->chroms[i]->coords[j].data) != STARCH_EXIT_SUCCESS)
+                                return -1;
+                            continue;
+                        }
                     fprintf(out, 
                             "%s\t%" PRId64 "\t%" PRId64, 
                             beds->chroms[i]->chromName, 
@@ -1197,8 +2222,8 @@ printBed(FILE *out, BedData *beds, const bool printUniques, const bool printDupl
                     exit(EXIT_FAILURE);
                 }
 
-            for(i = 0; i < beds->numChroms; i++)
-                for(j = 0; j < beds->chroms[i]->numCoords; j++) 
+            for(i = 0; rval == 0 && i < beds->numChroms; i++)
+                for(j = 0; rval == 0 && j < beds->chroms[i]->numCoords; j++) 
                     {
                         if (j == 0) {
                             sprintf(currElem,
@@ -1216,7 +2241,7 @@ printBed(FILE *out, BedData *beds, const bool printUniques, const bool printDupl
                                         beds->chroms[i]->chromName, 
                                         beds->chroms[i]->coords[j+1].startCoord, 
                                         beds->chroms[i]->coords[j+1].endCoord);
-                                if(beds->chroms[i]->coords[j].data)
+                                if(beds->chroms[i]->coords[j+1].data)
                                     sprintf(nextElem + strlen(nextElem), "\t%s\n", beds->chroms[i]->coords[j+1].data);
                                 else
                                     sprintf(nextElem + strlen(nextElem), "\n");
@@ -1232,7 +2257,7 @@ printBed(FILE *out, BedData *beds, const bool printUniques, const bool printDupl
                                     beds->chroms[i]->chromName, 
                                     beds->chroms[i]->coords[j+1].startCoord, 
                                     beds->chroms[i]->coords[j+1].endCoord);
-                            if(beds->chroms[i]->coords[j].data)
+                            if(beds->chroms[i]->coords[j+1].data)
                                 sprintf(nextElem + strlen(nextElem), "\t%s\n", beds->chroms[i]->coords[j+1].data);
                             else
                                 sprintf(nextElem + strlen(nextElem), "\n");
@@ -1246,11 +2271,11 @@ printBed(FILE *out, BedData *beds, const bool printUniques, const bool printDupl
                             {
                                 if((prevElem[0] == '\0') && (strcmp(currElem, nextElem) != 0))
                                     {
-                                        fprintf(out, "%s", currElem);
+                                        rval = writeElem(out, archive, beds->chroms[i]->chromName, currElem) ? 0 : -1;
                                     }
                                 else if ((strcmp(prevElem, currElem) != 0) && (strcmp(currElem, nextElem) != 0))
                                     {
-                                        fprintf(out, "%s", currElem);
+                                        rval = writeElem(out, archive, beds->chroms[i]->chromName, currElem) ? 0 : -1;
                                     }
                             }
                         else if (printDuplicates)
@@ -1261,7 +2286,7 @@ printBed(FILE *out, BedData *beds, const bool printUniques, const bool printDupl
                                     }
                                 else if(strcmp(currElem, prevElem) == 0)
                                     {
-                                        fprintf(out, "%s", currElem);
+                                        rval = writeElem(out, archive, beds->chroms[i]->chromName, currElem) ? 0 : -1;
                                     }
                             }
 
@@ -1278,14 +2303,115 @@ printBed(FILE *out, BedData *beds, const bool printUniques, const bool printDupl
             nextElem = NULL;
         }
 
-    return;
+    return rval;
+}
+
+namespace
+{
+    /*
+      writeArchiveThreaded() is writeBed() for --starch with more than one thread.  Each chromosome
+        is compressed into a chromosome writer of its own on a worker thread, and each is added to
+        the archive, in order, as soon as it is done.  Workers stay at most a few chromosomes ahead
+        of the next one to add, which bounds the temporary files held open.
+    */
+    int
+    writeArchiveThreaded(starch::Starch2Writer *archive, BedData *beds, unsigned int numThreads)
+    {
+        const unsigned int numChroms = static_cast<unsigned int>(beds->numChroms);
+        const unsigned int ahead = 2 * numThreads;
+        std::vector<starch::Starch2Writer*> parts(numChroms, static_cast<starch::Starch2Writer*>(NULL));
+        std::vector<int> status(numChroms, 0); /* 1 when compressed, -1 on failure */
+        std::vector<std::thread> workers;
+        std::mutex lock;
+        std::condition_variable ready;
+        unsigned int next = 0U, added = 0U, i = 0U;
+        bool failed = false;
+        int rval = 0;
+
+        auto compress = [&]()
+            {
+                for(;;)
+                    {
+                        unsigned int idx = 0U;
+                        {
+                            std::unique_lock<std::mutex> guard(lock);
+                            ready.wait(guard, [&]() { return failed || next >= numChroms || next < added + ahead; });
+                            if(failed || next >= numChroms)
+                                return;
+                            idx = next++;
+                        }
+
+                        ChromBedData *chrom = beds->chroms[idx];
+                        starch::Starch2Writer *part = NULL;
+                        bool ok = (starch::STARCH2_openChromosomeWriter(&part, archive) == STARCH_EXIT_SUCCESS);
+                        for(Bed::LineCountType j = 0; ok && j < chrom->numCoords; ++j)
+                            ok = (starch::STARCH2_addRecordToWriter(part, chrom->chromName, chrom->coords[j].startCoord,
+                                                                    chrom->coords[j].endCoord, chrom->coords[j].data) == STARCH_EXIT_SUCCESS);
+
+                        {
+                            std::lock_guard<std::mutex> guard(lock);
+                            parts[idx] = part;
+                            status[idx] = ok ? 1 : -1;
+                        }
+                        ready.notify_all();
+                    } /* for */
+            };
+
+        for(i = 0; i < numThreads; ++i)
+            workers.push_back(std::thread(compress));
+
+        for(i = 0; i < numChroms; ++i)
+            {
+                starch::Starch2Writer *part = NULL;
+                int done = 0;
+                {
+                    std::unique_lock<std::mutex> guard(lock);
+                    ready.wait(guard, [&]() { return status[i] != 0; });
+                    part = parts[i];
+                    parts[i] = NULL;
+                    done = status[i];
+                }
+
+                if(done < 0 || starch::STARCH2_appendChromosomeWriter(archive, &part) != STARCH_EXIT_SUCCESS)
+                    {
+                        starch::STARCH2_closeWriter(&part, starch::kStarchFalse);
+                        rval = -1;
+                    }
+
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    ++added;
+                    failed = (rval != 0);
+                }
+                ready.notify_all();
+                if(rval != 0)
+                    break;
+            } /* for */
+
+        for(i = 0; i < workers.size(); ++i)
+            workers[i].join();
+        for(i = 0; i < numChroms; ++i)
+            starch::STARCH2_closeWriter(&parts[i], starch::kStarchFalse);
+        return rval;
+    }
+} // unnamed namespace
+
+/* 0 when every row went out, -1 when archive refused one, which is described on stderr */
+int
+printBed(FILE *out, starch::Starch2Writer *archive, BedData *beds, const bool printUniques, const bool printDuplicates,
+         unsigned int numThreads)
+{
+    if(archive && numThreads > 1 && !printUniques && !printDuplicates)
+        return writeArchiveThreaded(archive, beds, numThreads);
+    return writeBed(out, archive, beds, printUniques, printDuplicates, false);
 }
 
 void 
 freeBedData(BedData *beds) 
 {
     unsigned int i = 0;
-    Bed::LineCountType j = 0;
+    CoordSegment *segment = NULL, *nextSegment = NULL;
+    TextBlock *block = NULL, *nextBlock = NULL;
 
     if(beds == NULL) 
         {
@@ -1294,20 +2420,256 @@ freeBedData(BedData *beds)
   
     for(i = 0; i < beds->numChroms; i++) 
         {
-
-            for(j = 0; j < beds->chroms[i]->numCoords; j++) 
+            if(beds->chroms[i]->firstSegment == NULL)
+                {
+                    free(beds->chroms[i]->coords);
+                }
+            for(segment = beds->chroms[i]->firstSegment; segment != NULL; segment = nextSegment)
                 {
-                    free(beds->chroms[i]->coords[j].data);
+                    nextSegment = segment->next;
+                    free(segment);
                 }
-            free(beds->chroms[i]->coords);
             free(beds->chroms[i]);
         }
+    for(block = beds->text; block != NULL; block = nextBlock)
+        {
+            nextBlock = block->next;
+            free(block);
+        }
     free(beds->chroms);
     free(beds);
 }
 
-void
-lexSortBedData(BedData *beds)
+namespace
+{
+    /*
+      sortBuckets() sorts coords[0, n) into bcd_cmp() order.  Rows are first distributed into
+        buckets by the high bits of startCoord (an MSD radix pass over the range of starts, sized
+        for a few rows per bucket), and each bucket is then sorted in place with std::sort().
+        Buckets are small and hold nearby coordinates, so the row text is only compared among
+        rows with equal coordinates, which are rare for most data.  Small inputs, or a failed
+        scratch allocation, go straight to std::sort().
+    */
+    const size_t RADIX_MIN_ROWS = 512;
+    const unsigned int RADIX_MAX_BITS = 20;
+    const size_t RADIX_ROWS_PER_BUCKET = 4;
+
+    void
+    sortBuckets(BedCoordData *coords, size_t n)
+    {
+        BedCoordData *scratch = NULL;
+        std::vector<size_t> offsets;
+        Bed::SignedCoordType minStart = 0, maxStart = 0;
+        unsigned int bits = 0, rangeBits = 0, shift = 0;
+        size_t i = 0, b = 0, sum = 0, tmp = 0, numBuckets = 0;
+
+        if(n < RADIX_MIN_ROWS || (scratch = static_cast<BedCoordData*>(malloc(n * sizeof(BedCoordData)))) == NULL)
+            {
+                std::sort(coords, coords + n);
+                return;
+            }
+
+        minStart = maxStart = coords[0].startCoord;
+        for(i = 1; i < n; ++i)
+            {
+                minStart = std::min(minStart, coords[i].startCoord);
+                maxStart = std::max(maxStart, coords[i].startCoord);
+            }
+        for(tmp = static_cast<size_t>(maxStart - minStart); tmp; tmp >>= 1)
+            ++rangeBits;
+        while(bits < RADIX_MAX_BITS && (static_cast<size_t>(1) << (bits + 1)) * RADIX_ROWS_PER_BUCKET <= n)
+            ++bits;
+        shift = (rangeBits > bits) ? rangeBits - bits : 0;
+        numBuckets = (static_cast<size_t>(maxStart - minStart) >> shift) + 1;
+
+        offsets.assign(numBuckets + 1, 0);
+        for(i = 0; i < n; ++i)
+            ++offsets[static_cast<size_t>(coords[i].startCoord - minStart) >> shift];
+        for(b = 0; b <= numBuckets; ++b)
+            {
+                tmp = offsets[b];
+                offsets[b] = sum;
+                sum += tmp;
+            }
+        for(i = 0; i < n; ++i)
+            scratch[offsets[static_cast<size_t>(coords[i].startCoord - minStart) >> shift]++] = coords[i];
+        /* offsets[b] is now where bucket b+1 begins */
+        for(b = 0, sum = 0; b < numBuckets; sum = offsets[b++])
+            if(offsets[b] - sum > 1)
+                std::sort(scratch + sum, scratch + offsets[b]);
+        memcpy(coords, scratch, n * sizeof(BedCoordData));
+        free(scratch);
+    }
+
+    /*
+      Input is often nearly sorted already: concatenated sorted files, or a few rows out of place.
+        findRuns() finds the already-sorted runs in coords[0, n), in one pass; as in timsort, a
+        strictly descending run is reversed in place to make it ascending.  When there are no more
+        than NATURAL_MAX_RUNS runs, mergeRuns() merges neighboring runs pairwise, which takes
+        linear time per round.  Otherwise, a full sort is cheaper.
+    */
+    const Bed::LineCountType NATURAL_MAX_RUNS = 64;
+
+    /* runStarts gets where each run begins, up to NATURAL_MAX_RUNS of them */
+    Bed::LineCountType
+    findRuns(BedCoordData *coords, size_t n, std::vector<size_t> &runStarts)
+    {
+        Bed::LineCountType numRuns = 0;
+        size_t start = 0, i = 0;
+        runStarts.clear();
+        while(start < n)
+            {
+                i = start + 1;
+                if(i < n && coords[i] < coords[i-1])
+                    {
+                        while(i < n && coords[i] < coords[i-1])
+                            ++i;
+                        std::reverse(coords + start, coords + i);
+                    }
+                else
+                    {
+                        while(i < n && !(coords[i] < coords[i-1]))
+                            ++i;
+                    }
+                if(++numRuns <= NATURAL_MAX_RUNS)
+                    runStarts.push_back(start);
+                start = i;
+            } /* while */
+        return numRuns;
+    }
+
+    void
+    mergeRuns(BedCoordData *coords, size_t n, std::vector<size_t> runStarts)
+    {
+        BedCoordData *scratch = static_cast<BedCoordData*>(malloc(n * sizeof(BedCoordData)));
+        BedCoordData *src = coords, *dst = (scratch != NULL) ? scratch : coords;
+        std::vector<size_t> merged;
+        size_t r = 0;
+
+        runStarts.push_back(n);
+        while(runStarts.size() > 2)
+            {
+                merged.clear();
+                for(r = 0; r + 2 < runStarts.size(); r += 2)
+                    {
+                        if(scratch != NULL)
+                            std::merge(src + runStarts[r], src + runStarts[r+1], src + runStarts[r+1], src + runStarts[r+2], dst + runStarts[r]);
+                        else
+                            std::inplace_merge(coords + runStarts[r], coords + runStarts[r+1], coords + runStarts[r+2]);
+                        merged.push_back(runStarts[r]);
+                    } /* for */
+                if(r + 2 == runStarts.size())
+                    { /* odd run out */
+                        if(scratch != NULL)
+                            std::copy(src + runStarts[r], src + runStarts[r+1], dst + runStarts[r]);
+                        merged.push_back(runStarts[r]);
+                    }
+                merged.push_back(n);
+                runStarts.swap(merged);
+                std::swap(src, dst);
+            } /* while */
+
+        if(src != coords)
+            memcpy(coords, src, n * sizeof(BedCoordData));
+        free(scratch);
+    }
+
+    /* sorts coords[0, n) and returns how many already-sorted runs it held */
+    Bed::LineCountType
+    sortCoords(BedCoordData *coords, size_t n)
+    {
+        std::vector<size_t> runStarts;
+        const Bed::LineCountType numRuns = findRuns(coords, n, runStarts);
+        if(numRuns > NATURAL_MAX_RUNS)
+            sortBuckets(coords, n);
+        else if(numRuns > 1)
+            mergeRuns(coords, n, runStarts);
+        return numRuns;
+    }
+
+    /* sortCoords() on numThreads threads: equal partitions are sorted concurrently, then merged pairwise */
+    Bed::LineCountType
+    sortPartitioned(BedCoordData *coords, size_t n, unsigned int numThreads)
+    {
+        std::vector<size_t> bounds;
+        std::vector<std::thread> workers;
+        size_t p = 0, width = 0;
+        const Bed::LineCountType numRuns = findRuns(coords, n, bounds);
+
+        if(numRuns <= NATURAL_MAX_RUNS)
+            {
+                if(numRuns > 1)
+                    mergeRuns(coords, n, bounds);
+                return numRuns;
+            }
+        bounds.clear();
+        for(p = 0; p <= numThreads; ++p)
+            bounds.push_back(n / numThreads * p + std::min(static_cast<size_t>(p), n % numThreads));
+
+        for(p = 0; p < numThreads; ++p)
+            {
+                BedCoordData *first = coords + bounds[p];
+                BedCoordData *last = coords + bounds[p+1];
+                workers.push_back(std::thread([=]() { sortBuckets(first, static_cast<size_t>(last - first)); }));
+            }
+        for(p = 0; p < workers.size(); ++p)
+            workers[p].join();
+
+        for(width = 1; width < numThreads; width *= 2)
+            {
+                workers.clear();
+                for(p = 0; p + width < numThreads; p += 2 * width)
+                    {
+                        BedCoordData *first = coords + bounds[p];
+                        BedCoordData *middle = coords + bounds[p + width];
+                        BedCoordData *last = coords + bounds[std::min(p + 2 * width, static_cast<size_t>(numThreads))];
+                        workers.push_back(std::thread([=]() { std::inplace_merge(first, middle, last); }));
+                    }
+                for(p = 0; p < workers.size(); ++p)
+                    workers[p].join();
+            } /* for */
+        return numRuns;
+    }
+
+    /*
+      sortChromsThreaded() sorts the coords of every chromosome with numThreads threads.  Any
+        chromosome holding more than an even share of all rows is split across all threads, one at a
+        time.  The rest are handed out to threads from a shared list, largest first.  Equal elements
+        are identical rows, so output does not depend on which thread sorts what.
+    */
+    void
+    sortChromsThreaded(BedData *beds, unsigned int numThreads)
+    {
+        const Bed::LineCountType minSplit = 1 << 20;
+        std::vector<ChromBedData*> order(beds->chroms, beds->chroms + beds->numChroms);
+        std::vector<std::thread> workers;
+        std::atomic<size_t> next(0);
+        Bed::LineCountType total = 0;
+        size_t i = 0;
+
+        std::sort(order.begin(), order.end(),
+                  [](ChromBedData const *a, ChromBedData const *b) { return a->numCoords > b->numCoords; });
+        for(i = 0; i < order.size(); ++i)
+            total += order[i]->numCoords;
+
+        const Bed::LineCountType share = std::max(total / numThreads, minSplit);
+        for(i = 0; i < order.size() && order[i]->numCoords > share; ++i)
+            order[i]->numRuns = sortPartitioned(order[i]->coords, static_cast<size_t>(order[i]->numCoords), numThreads);
+
+        next = i;
+        for(unsigned int t = 0; t < numThreads; ++t)
+            workers.push_back(std::thread([&order, &next]() {
+                                              size_t c = 0;
+                                              while((c = next++) < order.size())
+                                                  order[c]->numRuns = sortCoords(order[c]->coords, static_cast<size_t>(order[c]->numCoords));
+                                          }));
+        for(i = 0; i < workers.size(); ++i)
+            workers[i].join();
+    }
+} // unnamed namespace
+
+int
+lexSortBedData(BedData *beds, unsigned int numThreads)
 {
     unsigned int i, j, k;
     char chromBuf[CHROM_NAME_LEN + 1];
@@ -1316,7 +2678,7 @@ lexSortBedData(BedData *beds)
 
     if(beds == NULL) 
         {
-            return;
+            return 0;
         }
 
     /* reverse chromosome names (back to correct names) before comparisons */
@@ -1328,17 +2690,48 @@ lexSortBedData(BedData *beds)
             for ( j = static_cast<unsigned int>(chromBufLen); j > 0; )
                 beds->chroms[i]->chromName[k++] = chromBuf[--j];
             /* terminating null is already in correct spot */
+            if(gatherCoords(beds->chroms[i]) != 0)
+                return -1;
         }
 
     /* sort coords */
-    for(i = 0; i < beds->numChroms; ++i)
+    if(numThreads < 2)
+        {
+            for(i = 0; i < beds->numChroms; ++i)
+                {
+                    beds->chroms[i]->numRuns = sortCoords(beds->chroms[i]->coords, static_cast<size_t>(beds->chroms[i]->numCoords));
+                }
+        }
+    else
         {
-            std::sort(beds->chroms[i]->coords, (beds->chroms[i]->coords+static_cast<size_t>(beds->chroms[i]->numCoords)));
+            sortChromsThreaded(beds, numThreads);
         }
 
     /* sort chroms */
     qsort(beds->chroms, static_cast<size_t>(beds->numChroms), sizeof(ChromBedData *), lexCompareBedData);
-    return;
+    return 0;
+}
+
+void
+reportRuns(FILE *out, BedData *beds)
+{
+    unsigned int i = 0U;
+    Bed::LineCountType rows = 0, runs = 0;
+
+    if(beds == NULL)
+        return;
+
+    for(i = 0; i < beds->numChroms; ++i)
+        {
+            ChromBedData const *chrom = beds->chroms[i];
+            fprintf(out, "%s: %" PRIu64 " rows in %" PRIu64 " sorted run(s), %s\n", chrom->chromName,
+                    static_cast<uint64_t>(chrom->numCoords), static_cast<uint64_t>(chrom->numRuns),
+                    (chrom->numRuns <= 1) ? "already sorted" : (chrom->numRuns <= NATURAL_MAX_RUNS) ? "merged" : "fully sorted");
+            rows += chrom->numCoords;
+            runs += chrom->numRuns;
+        }
+    fprintf(out, "total: %" PRIu64 " rows in %" PRIu64 " sorted run(s) over %" PRId64 " chromosome(s)\n",
+            static_cast<uint64_t>(rows), static_cast<uint64_t>(runs), static_cast<int64_t>(beds->numChroms));
 }
 
 int 
@@ -27,6 +27,7 @@
 
 #include <cstdio>
 
+#include "data/starch/starchHelpers.h"
 #include "suite/BEDOPS.Constants.hpp"
 
 static const unsigned long CHROM_NAME_LEN         = Bed::TOKEN_CHR_MAX_LENGTH;
@@ -35,6 +36,8 @@ static const unsigned long BED_LINE_LEN           = Bed::TOKENS_MAX_LENGTH;
 static const unsigned long NUM_BED_ITEMS_EST      = 100000;
 static const unsigned long INIT_NUM_BED_ITEMS_EST = 10;
 static const unsigned long NUM_CHROM_EST          = 32;
+static const unsigned long SPILL_BUFFER_SIZE      = 1 << 18;
+static const unsigned long TEXT_BLOCK_SIZE        = 1 << 20;
 
 #define GT(A,B) ((A) > (B) ? 1 : 0)
 
@@ -85,30 +88,58 @@ struct BedCoordData {
     inline friend bool operator==(BedCoordData const& b1, BedCoordData const& b2) { return bcd_cmp(b1,b2) == 0; }
 };
 
+/*
+  Rows are appended to fixed-size segments as they are read, so nothing is ever reallocated or
+    copied while reading, and memory use grows a segment at a time.  gatherCoords() puts them into
+    one coords array just before sorting.  The rows of a segment follow its header.
+*/
+typedef struct CoordSegment {
+    struct CoordSegment *next;
+    Bed::LineCountType numRows;
+    Bed::LineCountType maxRows;
+} CoordSegment;
+
+/* The text of every row after its 3rd column is packed into large blocks, and follows the header */
+typedef struct TextBlock {
+    struct TextBlock *next;
+    size_t used;
+    size_t size;
+} TextBlock;
+
 typedef struct {
     char chromName[CHROM_NAME_LEN + 1];
     Bed::LineCountType numCoords;
-    BedCoordData *coords;
+    Bed::LineCountType numRuns; /* already-sorted runs found when last sorted */
+    BedCoordData *coords; /* NULL until gathered; may point into the only segment */
+    CoordSegment *firstSegment;
+    CoordSegment *lastSegment;
 } ChromBedData;
 
 typedef struct {
     Bed::SignedCoordType numChroms;
     ChromBedData **chroms; // struct is padded on 64-bit OS X system - cf. http://stackoverflow.com/questions/15031061/alignas-for-struct-members-using-clang-c11 for possible portable solution for warning
+    TextBlock *text; /* newest first */
 } BedData;
 
 /* Function Prototypes */
 int
-checkSort(char const **bedFileNames, unsigned int numFiles);
+checkSort(char const **bedFileNames, unsigned int numFiles, unsigned int numThreads);
 
 int
 mergeSort(FILE **tmpFiles, unsigned int numFiles);
 
+int
+mergeSortedFiles(char const **bedFileNames, unsigned int numFiles, const bool printUniques, const bool printDuplicates,
+                 starch::Starch2Writer *archive);
+
 int
 processData(char const **bedFileNames, unsigned int numFiles, double maxMem, char *tmpPath, 
-            const bool printUniques, const bool printDuplicates);
+            const bool compressTmp, const bool printUniques, const bool printDuplicates, unsigned int numThreads,
+            const bool diagnostics, starch::Starch2Writer *archive);
 
-void
-printBed(FILE *out, BedData *beds, const bool printUniques, const bool printDuplicates);
+int
+printBed(FILE *out, starch::Starch2Writer *archive, BedData *beds, const bool printUniques, const bool printDuplicates,
+         unsigned int numThreads);
 
 void
 freeBedData(BedData *beds);
@@ -119,12 +150,18 @@ sortBedData(BedData *beds);
 void
 numSortBedData(BedData *beds);
 
+int
+lexSortBedData(BedData *beds, unsigned int numThreads);
+
 void
-lexSortBedData(BedData *beds);
+reportRuns(FILE *out, BedData *beds);
 
 Bed::SignedCoordType
-appendChromBedEntry(ChromBedData *chrom, Bed::SignedCoordType startPos, Bed::SignedCoordType endPos,
-                    char *data, double* bytes, double maxMem);
+appendChromBedEntry(BedData *beds, ChromBedData *chrom, Bed::SignedCoordType startPos, Bed::SignedCoordType endPos,
+                    char *data, double* bytes);
+
+int
+gatherCoords(ChromBedData *chrom);
 
 ChromBedData*
 initializeChromBedData(char * chromName, double* bytes);
@@ -57,6 +57,9 @@ main(int argc, char **argv)
     Boolean bedReportProgressFlag = kStarchFalse;
     LineCountType bedReportProgressN = 0;
     Boolean bedHeaderFlag = kStarchFalse;
+    unsigned int numThreads = 1U;
+    LineCountType blockLineCount = STARCH2_DEFAULT_INDEX_LINE_COUNT;
+    Boolean columnarFlag = kStarchFalse;
     unsigned char *starchHeader = NULL;
 
     setlocale (LC_ALL, "POSIX");
@@ -84,6 +87,9 @@ main(int argc, char **argv)
     bedReportProgressFlag = starch_client_global_args.reportProgressFlag;
     bedReportProgressN = starch_client_global_args.reportProgressN;
     bedHeaderFlag = starch_client_global_args.headerFlag;
+    numThreads = starch_client_global_args.numThreads;
+    blockLineCount = starch_client_global_args.blockLineCount;
+    columnarFlag = starch_client_global_args.columnarFlag;
 
     if (STARCH_MAJOR_VERSION == 1)
     {
@@ -175,8 +181,23 @@ main(int argc, char **argv)
             }
         }
 
+        if (bedHeaderFlag == kStarchFalse) {
+            if (STARCH_transformInputWithWriter(bedFnPtr, 
+                                                type, 
+                                                tag, 
+                                                note, 
+                                                bedGeneratePerChrSignatureFlag, 
+                                                bedReportProgressFlag, 
+                                                bedReportProgressN, 
+                                                numThreads,
+                                                blockLineCount,
+                                                columnarFlag) != STARCH_EXIT_SUCCESS)
+            {
+                exit (EXIT_FAILURE);
+            }
+        }
 #ifdef __cplusplus
-        if (STARCH2_transformInput(&starchHeader, 
+        else if (STARCH2_transformInput(&starchHeader, 
                                    &metadata, 
                                    reinterpret_cast<const FILE *>( bedFnPtr ), 
                                    static_cast<const CompressionType>( type ), 
@@ -190,7 +211,7 @@ main(int argc, char **argv)
             exit (EXIT_FAILURE);
         }
 #else
-        if (STARCH2_transformInput(&starchHeader, 
+        else if (STARCH2_transformInput(&starchHeader, 
                                    &metadata, 
                                    (const FILE *) bedFnPtr, 
                                    (const CompressionType) type, 
@@ -250,6 +271,9 @@ STARCH_initializeGlobals()
     starch_client_global_args.reportProgressFlag = kStarchFalse;
     starch_client_global_args.reportProgressN = 0;
     starch_client_global_args.headerFlag = kStarchFalse;
+    starch_client_global_args.numThreads = 1U;
+    starch_client_global_args.blockLineCount = STARCH2_DEFAULT_INDEX_LINE_COUNT;
+    starch_client_global_args.columnarFlag = kStarchFalse;
     starch_client_global_args.inputFile = NULL;
     starch_client_global_args.uniqueTag = NULL;
     starch_client_global_args.numberInputFiles = 0;
@@ -264,9 +288,11 @@ STARCH_parseCommandLineOptions(int argc, char **argv)
 #endif
 
     int starch_client_long_index;
+    char *threadsEnd = NULL;
+    char *blockLineCountEnd = NULL;
     int starch_client_opt = getopt_long (argc, argv, starch_client_opt_string, starch_client_long_options, &starch_client_long_index);
 
-    if (argc > 6) {
+    if (argc > 10) {
         fprintf (stderr, "ERROR: Wrong number of arguments.\n");
         return STARCH_FATAL_ERROR;
     }
@@ -300,6 +326,29 @@ STARCH_parseCommandLineOptions(int argc, char **argv)
                 return STARCH_FATAL_ERROR;
             }
             break;
+        case 't':
+            errno = 0;
+#ifdef __cplusplus
+            starch_client_global_args.numThreads = static_cast<unsigned int>( strtoul(optarg, &threadsEnd, 10) );
+#else
+            starch_client_global_args.numThreads = (unsigned int) strtoul(optarg, &threadsEnd, 10);
+#endif
+            if ((errno == ERANGE) || (threadsEnd == optarg) || (*threadsEnd != '\0') || (starch_client_global_args.numThreads < 1) || (starch_client_global_args.numThreads > STARCH_MAX_THREADS)) {
+                fprintf (stderr, "ERROR: Number of threads must be a whole number from 1 to %d.\n", STARCH_MAX_THREADS);
+                return STARCH_FATAL_ERROR;
+            }
+            break;
+        case 'k':
+            errno = 0;
+            starch_client_global_args.blockLineCount = strtoumax(optarg, &blockLineCountEnd, 10);
+            if ((errno == ERANGE) || (blockLineCountEnd == optarg) || (*blockLineCountEnd != '\0') || (*optarg == '-')) {
+                fprintf (stderr, "ERROR: Number of elements per block must be a whole number.\n");
+                return STARCH_FATAL_ERROR;
+            }
+            break;
+        case 'c':
+            starch_client_global_args.columnarFlag = kStarchTrue;
+            break;
         case 'e':
             starch_client_global_args.headerFlag = kStarchTrue;
             break;
@@ -313,6 +362,12 @@ STARCH_parseCommandLineOptions(int argc, char **argv)
         starch_client_opt = getopt_long (argc, argv, starch_client_opt_string, starch_client_long_options, &starch_client_long_index);
     }
 
+    /* columns are kept for each block, through the archive writer */
+    if ((starch_client_global_args.columnarFlag) && ((starch_client_global_args.headerFlag) || (starch_client_global_args.blockLineCount == 0))) {
+        fprintf (stderr, "ERROR: The --columnar option cannot be used with --header or --block-records=0.\n");
+        return STARCH_FATAL_ERROR;
+    }
+
     STARCH_buildProcessIDTag (&(starch_client_global_args.uniqueTag));
 
     starch_client_global_args.inputFiles = argv + optind;
@@ -395,6 +450,218 @@ STARCH_printRevision()
     }
 }
 
+/*
+    STARCH_transformInputWithWriter() writes headerless BED input through an archive 
+    writer, with the records, signatures and line statistics STARCH2_transformInput() 
+    would give, and starts a block of each chromosome's index every blockLineCount 
+    records. With more than one thread, this thread reads and transforms the input, and 
+    the archive writer cuts the transformed stream into blocks, which up to numThreads 
+    worker threads compress, so that a single large chromosome is compressed on every 
+    thread, as are the blocks of neighbouring chromosomes. Streams are cut differently 
+    than in one piece, so stream sizes in the metadata differ a little from those of a 
+    single thread. Two blocks per thread are held at once. With columnarFlag set, the 
+    compression blocks are the index blocks, which are written in columns.
+*/
+
+int
+STARCH_transformInputWithWriter(FILE *inFp, const CompressionType type, const char *tag, const char *note, const Boolean generatePerChrSignatureFlag, const Boolean reportProgressFlag, const LineCountType reportProgressN, const unsigned int numThreads, const LineCountType blockLineCount, const Boolean columnarFlag)
+{
+#ifdef DEBUG
+    fprintf (stderr, "\n--- STARCH_transformInputWithWriter() ---\n");
+#endif
+    StarchBlockPool pool;
+    Starch2Writer *archive = NULL;
+    pthread_t *workers = NULL;
+    unsigned int numWorkers = 0U;
+    unsigned int threadIdx = 0U;
+    char chromosome[TOKEN_CHR_MAX_LENGTH + 1] = {0};
+    size_t chrLength = 0U;
+    char *line = NULL;
+    size_t lineCapacity = 0U;
+    ssize_t lineLength = 0;
+    LineCountType lineIdx = 0;
+    int result = STARCH_EXIT_SUCCESS;
+
+    memset(&pool, 0, sizeof(pool));
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.changed, NULL);
+    pool.capacity = 2 * numThreads;
+#ifdef __cplusplus
+    pool.blocks = static_cast<Starch2Block **>( calloc(pool.capacity, sizeof(Starch2Block *)) );
+    pool.statuses = static_cast<int *>( calloc(pool.capacity, sizeof(int)) );
+    workers = static_cast<pthread_t *>( malloc(sizeof(pthread_t) * numThreads) );
+#else
+    pool.blocks = calloc(pool.capacity, sizeof(Starch2Block *));
+    pool.statuses = calloc(pool.capacity, sizeof(int));
+    workers = malloc(sizeof(pthread_t) * numThreads);
+#endif
+    if ((!pool.blocks) || (!pool.statuses) || (!workers)) {
+        fprintf(stderr, "ERROR: Not enough memory is available\n");
+        result = STARCH_EXIT_FAILURE;
+    }
+
+    if ((result == STARCH_EXIT_SUCCESS) && ((STARCH2_openWriter(&archive, stdout, type, tag, note, generatePerChrSignatureFlag) != STARCH_EXIT_SUCCESS) || 
+                                            (STARCH2_setWriterIndexLineCount(archive, blockLineCount) != STARCH_EXIT_SUCCESS)))
+        result = STARCH_EXIT_FAILURE;
+    for (threadIdx = 0U; (result == STARCH_EXIT_SUCCESS) && (numThreads > 1) && (threadIdx < numThreads); threadIdx++)
+        if (pthread_create(&workers[numWorkers], NULL, STARCH_compressBlocks, &pool) == 0)
+            numWorkers++;
+    if ((result == STARCH_EXIT_SUCCESS) && (numThreads > 1) && (numWorkers == 0U)) {
+        fprintf(stderr, "ERROR: Could not start compression threads\n");
+        result = STARCH_EXIT_FAILURE;
+    }
+    if ((result == STARCH_EXIT_SUCCESS) && (numThreads > 1) && (STARCH2_setWriterBlockPool(archive, pool.capacity, STARCH_submitBlock, STARCH_waitForBlock, &pool) != STARCH_EXIT_SUCCESS))
+        result = STARCH_EXIT_FAILURE;
+    if ((result == STARCH_EXIT_SUCCESS) && (columnarFlag) && (STARCH2_setWriterColumnar(archive) != STARCH_EXIT_SUCCESS))
+        result = STARCH_EXIT_FAILURE;
+
+    while ((result == STARCH_EXIT_SUCCESS) && ((lineLength = getline(&line, &lineCapacity, inFp)) > 0)) {
+        if (line[lineLength - 1] == '\n')
+            line[--lineLength] = '\0';
+
+        chrLength = strcspn(line, "\t");
+        if ((chrLength == 0) || (line[chrLength] != '\t')) {
+            fprintf(stderr, "ERROR: BED data is missing chromosome and/or coordinate data\n");
+            result = STARCH_FATAL_ERROR;
+            break;
+        }
+        if (chrLength > TOKEN_CHR_MAX_LENGTH) {
+            fprintf(stderr, "ERROR: Chromosome field length is too long (must be no longer than %lu characters)\n", TOKEN_CHR_MAX_LENGTH);
+            result = STARCH_FATAL_ERROR;
+            break;
+        }
+
+        if (reportProgressFlag == kStarchTrue) {
+            if ((strncmp(line, chromosome, chrLength) != 0) || (chromosome[chrLength] != '\0')) {
+                memcpy(chromosome, line, chrLength);
+                chromosome[chrLength] = '\0';
+                lineIdx = 0;
+            }
+            if (++lineIdx % reportProgressN == 0)
+                fprintf(stderr, "PROGRESS: Transforming element [%lu] of chromosome [%s] -> [%s]\n", (unsigned long) lineIdx, chromosome, line);
+        }
+
+        if (STARCH2_addBEDLineToWriter(archive, line) != STARCH_EXIT_SUCCESS)
+            result = STARCH_EXIT_FAILURE;
+    }
+    if ((result == STARCH_EXIT_SUCCESS) && (ferror(inFp))) {
+        fprintf(stderr, "ERROR: Could not read BED input\n");
+        result = STARCH_EXIT_FAILURE;
+    }
+
+    /* the writer waits for the blocks it holds before it closes */
+    if ((archive) && (STARCH2_closeWriter(&archive, (result == STARCH_EXIT_SUCCESS) ? kStarchTrue : kStarchFalse) != STARCH_EXIT_SUCCESS))
+        result = STARCH_EXIT_FAILURE;
+    if (result != STARCH_EXIT_SUCCESS)
+        fprintf(stderr, "ERROR: Could not write transformed/compressed data to output file pointer.\n");
+
+    pthread_mutex_lock(&pool.lock);
+    pool.inputDoneFlag = kStarchTrue;
+    pthread_cond_broadcast(&pool.changed);
+    pthread_mutex_unlock(&pool.lock);
+    for (threadIdx = 0U; threadIdx < numWorkers; threadIdx++)
+        pthread_join(workers[threadIdx], NULL);
+
+    free(pool.blocks);
+    free(pool.statuses);
+    free(workers);
+    free(line);
+    pthread_cond_destroy(&pool.changed);
+    pthread_mutex_destroy(&pool.lock);
+
+    return result;
+}
+
+/* a worker thread: compresses blocks as they are handed over, until the input is done */
+void *
+STARCH_compressBlocks(void *arg)
+{
+#ifdef DEBUG
+    fprintf (stderr, "\n--- STARCH_compressBlocks() ---\n");
+#endif
+#ifdef __cplusplus
+    StarchBlockPool *pool = static_cast<StarchBlockPool *>( arg );
+#else
+    StarchBlockPool *pool = arg;
+#endif
+    unsigned int slot = 0U;
+    int status = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        while ((pool->numTaken == pool->numSubmitted) && (!pool->inputDoneFlag))
+            pthread_cond_wait(&pool->changed, &pool->lock);
+        if (pool->numTaken == pool->numSubmitted) {
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }
+        slot = pool->numTaken++ % pool->capacity;
+        pthread_mutex_unlock(&pool->lock);
+
+        status = (STARCH2_compressBlock(pool->blocks[slot]) == STARCH_EXIT_SUCCESS) ? 1 : -1;
+
+        pthread_mutex_lock(&pool->lock);
+        pool->statuses[slot] = status;
+        pthread_cond_broadcast(&pool->changed);
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    return NULL;
+}
+
+/* the writer hands over a block to compress; it holds no more blocks than the ring takes */
+int
+STARCH_submitBlock(void *arg, Starch2Block *block)
+{
+#ifdef __cplusplus
+    StarchBlockPool *pool = static_cast<StarchBlockPool *>( arg );
+#else
+    StarchBlockPool *pool = arg;
+#endif
+    unsigned int slot = 0U;
+    int result = STARCH_EXIT_SUCCESS;
+
+    pthread_mutex_lock(&pool->lock);
+    if (pool->numSubmitted - pool->numRetired == pool->capacity)
+        result = STARCH_EXIT_FAILURE;
+    else {
+        slot = pool->numSubmitted++ % pool->capacity;
+        pool->blocks[slot] = block;
+        pool->statuses[slot] = 0;
+        pthread_cond_broadcast(&pool->changed);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return result;
+}
+
+/* the writer waits for the oldest block it handed over */
+int
+STARCH_waitForBlock(void *arg, Starch2Block *block)
+{
+#ifdef __cplusplus
+    StarchBlockPool *pool = static_cast<StarchBlockPool *>( arg );
+#else
+    StarchBlockPool *pool = arg;
+#endif
+    unsigned int slot = 0U;
+    int status = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    slot = pool->numRetired % pool->capacity;
+    if ((pool->numRetired == pool->numSubmitted) || (pool->blocks[slot] != block))
+        status = -1;
+    else {
+        while (pool->statuses[slot] == 0)
+            pthread_cond_wait(&pool->changed, &pool->lock);
+        status = pool->statuses[slot];
+        pool->numRetired++;
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return (status > 0) ? STARCH_EXIT_SUCCESS : STARCH_EXIT_FAILURE;
+}
+
 #ifdef __cplusplus
 } // unnamed namespace
 #endif
@@ -29,8 +29,10 @@
 #include <getopt.h>
 #include <inttypes.h>
 #include <errno.h>
+#include <pthread.h>
 
 #include "data/starch/starchMetadataHelpers.h"
+#include "data/starch/starchHelpers.h"
 
 #ifdef __cplusplus
 namespace {
@@ -38,6 +40,8 @@ namespace {
 } // unnamed namespace
 #endif
 
+#define STARCH_MAX_THREADS 1024
+
 static const char *name = "starch";
 static const char *authors = "Alex Reynolds and Shane Neph";
 static const char *usage = "\n" \
@@ -45,6 +49,9 @@ static const char *usage = "\n" \
     "              [ --bzip2 | --gzip ]\n" \
     "              [ --omit-signature ]\n" \
     "              [ --report-progress=N ]\n" \
+    "              [ --threads=N ]\n" \
+    "              [ --block-records=N ]\n" \
+    "              [ --columnar ]\n" \
     "              [ --header ] [ <unique-tag> ] <bed-file>\n" \
     "    \n" \
     "    * BED input must be sorted lexicographically (e.g., using BEDOPS sort-bed).\n" \
@@ -62,6 +69,17 @@ static const char *usage = "\n" \
     "                          (optional, default is to generate signature).\n\n" \
     "    --report-progress=N   Report compression progress every N elements per\n" \
     "                          chromosome to standard error stream (optional)\n\n" \
+    "    --threads=N           Compress on N threads at once (optional,\n" \
+    "                          default is 1). Not used with --header.\n\n" \
+    "    --block-records=N     Start a block every N elements of a chromosome, which\n" \
+    "                          can be extracted without the elements before it\n" \
+    "                          (optional, default is 25000; 0 for no blocks). Not\n" \
+    "                          used with --header.\n\n" \
+    "    --columnar            Compress the start coordinates, lengths and rest of\n" \
+    "                          the elements of each block apart, so that readers\n" \
+    "                          which need only coordinates pass over the rest\n" \
+    "                          (optional). Not used with --header or\n" \
+    "                          --block-records=0.\n\n" \
     "    --header              Support BED input with custom UCSC track, SAM or VCF\n" \
     "                          headers, or generic comments (optional).\n\n" \
     "    <unique-tag>          Optional. Specify unique identifier for transformed\n" \
@@ -76,6 +94,9 @@ static struct starch_client_global_args_t {
     Boolean reportProgressFlag;
     LineCountType reportProgressN;
     Boolean headerFlag;
+    unsigned int numThreads;
+    LineCountType blockLineCount;
+    Boolean columnarFlag;
     char *inputFile;
     char *uniqueTag;
     char *tag;
@@ -89,18 +110,39 @@ static struct option starch_client_long_options[] = {
     {"gzip",            no_argument,       NULL, 'g'},
     {"omit-signature",  no_argument,       NULL, 'o'},
     {"report-progress", required_argument, NULL, 'r'},
+    {"threads",         required_argument, NULL, 't'},
+    {"block-records",   required_argument, NULL, 'k'},
+    {"columnar",        no_argument,       NULL, 'c'},
     {"header",          no_argument,       NULL, 'e'},
     {"version",         no_argument,       NULL, 'v'},
     {"help",            no_argument,       NULL, 'h'},
     {NULL,              no_argument,       NULL,  0 }
 };
 
-static const char *starch_client_opt_string = "n:bgorevh?";
+static const char *starch_client_opt_string = "n:bgort:k:cevh?";
 
 #ifdef __cplusplus
 namespace starch {
 #endif
 
+/*
+    With --threads, the archive writer cuts each chromosome's transformed stream into 
+    blocks, and worker threads compress them. Blocks handed over by the writer wait in 
+    a ring of capacity entries, which the writer empties in the order it fills it.
+*/
+
+typedef struct starch_block_pool_t {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    Starch2Block **blocks;
+    int *statuses; /* 0 until compressed, then 1, or -1 on failure */
+    unsigned int capacity;
+    uint64_t numSubmitted;
+    uint64_t numTaken; /* blocks taken by a worker */
+    uint64_t numRetired; /* blocks given back to the writer */
+    Boolean inputDoneFlag;
+} StarchBlockPool;
+
 void          STARCH_initializeGlobals();
 
 int           STARCH_parseCommandLineOptions(int argc, 
@@ -110,6 +152,25 @@ void          STARCH_printUsage(int t);
 
 void          STARCH_printRevision();
 
+int           STARCH_transformInputWithWriter(FILE *inFp,
+                                 const CompressionType type,
+                                            const char *tag,
+                                            const char *note,
+                                         const Boolean generatePerChrSignatureFlag,
+                                         const Boolean reportProgressFlag,
+                                   const LineCountType reportProgressN,
+                                    const unsigned int numThreads,
+                                   const LineCountType blockLineCount,
+                                         const Boolean columnarFlag);
+
+void *        STARCH_compressBlocks(void *arg);
+
+int           STARCH_submitBlock(void *pool,
+                         Starch2Block *block);
+
+int           STARCH_waitForBlock(void *pool,
+                          Starch2Block *block);
+
 #ifdef __cplusplus
 } // namespace starch
 #endif
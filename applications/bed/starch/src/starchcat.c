@@ -333,6 +333,7 @@ STARCHCAT2_copyInputRecordToOutput(Metadata **outMd, const char *outTag, const C
     Boolean outDuplicateElementExists = STARCH_DEFAULT_DUPLICATE_ELEMENT_FLAG_VALUE;
     Boolean outNestedElementExists = STARCH_DEFAULT_NESTED_ELEMENT_FLAG_VALUE;
     Metadata *iter, *inMd = inRec->metadata;
+    Metadata *inChrMd = NULL;
     const ArchiveVersion *av = inRec->av;
     char buffer[STARCHCAT_COPY_BUFFER_MAXSIZE];
     size_t nBytesRead = 0;
@@ -416,6 +417,7 @@ STARCHCAT2_copyInputRecordToOutput(Metadata **outMd, const char *outTag, const C
                 return STARCHCAT_EXIT_FAILURE;
             }
             endOffset = startOffset + iter->size;
+            inChrMd = iter;
             break;
         }
         else {
@@ -533,6 +535,12 @@ STARCHCAT2_copyInputRecordToOutput(Metadata **outMd, const char *outTag, const C
                                      outFileLineMaxStringLength );
     }
 
+    /* the stream is copied as-is, so offsets of its blocks stay as they were */
+    if ((*outMd) && (inChrMd) && (STARCH_setMetadataBlocks(*outMd, inChrMd->blocks, inChrMd->numBlocks) != STARCH_EXIT_SUCCESS)) {
+        fprintf(stderr, "ERROR: Could not copy block index of chromosome [%s] to output metadata.\n", inChr);
+        return STARCHCAT_EXIT_FAILURE;
+    }
+
     return STARCHCAT_EXIT_SUCCESS;
 }
 
@@ -808,6 +816,7 @@ STARCHCAT2_rewriteInputRecordToOutput(Metadata **outMd, const char *outTag, cons
     size_t nBzRemainderBuf = 0;
     size_t nBzRead = 0;
     size_t bzBufIndex = 0;
+    uint64_t bzBlockIdx = 0;
     unsigned char *bzLineBuf = NULL;
     unsigned int bzOutBytesConsumedLo32 = 0U;
     unsigned int bzOutBytesConsumedHi32 = 0U;
@@ -1459,6 +1468,13 @@ STARCHCAT2_rewriteInputRecordToOutput(Metadata **outMd, const char *outTag, cons
                         bzBufIndex++;
                     }
                 }
+                /* a block-indexed stream goes on with the bzip2 stream of its next block */
+#ifdef __cplusplus
+                if ((bzInError == BZ_STREAM_END) && (UNSTARCH_bzOpenNextBlock(&bzInFp, inFp, iter, static_cast<uint64_t>( startOffset ), &bzBlockIdx) == 0))
+#else
+                if ((bzInError == BZ_STREAM_END) && (UNSTARCH_bzOpenNextBlock(&bzInFp, inFp, iter, (uint64_t) startOffset, &bzBlockIdx) == 0))
+#endif
+                    bzInError = BZ_OK;
             }
 
             if (generatePerChrSignatureFlag) {
@@ -2851,11 +2867,6 @@ STARCHCAT2_mergeInputRecordsToOutput(const char *inChr, Metadata **outMd, const
             continue;
         }
 
-        if (STARCHCAT2_setupInitialFileOffsets(inChr, summary, inRecIdx) != STARCHCAT_EXIT_SUCCESS) {
-            fprintf(stderr, "ERROR: Could not set up file offsets at chromosome [%s]!\n", inChr);
-            return STARCHCAT_EXIT_FAILURE;
-        }
-
         inRecord                                                = *(summary->records) + inRecIdx;
         inType                                                  = inRecord->type; /* get record type */
         inFp                                                    = inRecord->fp;
@@ -2903,6 +2914,12 @@ STARCHCAT2_mergeInputRecordsToOutput(const char *inChr, Metadata **outMd, const
         transformStates[inRecIdx]->t_currentRemainderLength     = UNSTARCH_SECOND_TOKEN_MAX_LENGTH + 1; 
         transformStates[inRecIdx]->t_nExtractionBuffer          = 0;
         transformStates[inRecIdx]->t_nExtractionBufferPos       = 0;
+
+        if (STARCHCAT2_setupInitialFileOffsets(inChr, summary, inRecIdx, transformStates[inRecIdx]) != STARCHCAT_EXIT_SUCCESS) {
+            fprintf(stderr, "ERROR: Could not set up file offsets at chromosome [%s]!\n", inChr);
+            return STARCHCAT_EXIT_FAILURE;
+        }
+
 #ifdef __cplusplus
         extractionRemainderBufs[inRecIdx]                       = static_cast<char *>( malloc(TOKENS_MAX_LENGTH + 1) );
 #else
@@ -2914,67 +2931,81 @@ STARCHCAT2_mergeInputRecordsToOutput(const char *inChr, Metadata **outMd, const
         }
         nExtractionRemainderBufs[inRecIdx]                      = 0;
 
-        switch (inType) {
-            case kBzip2: {
-                nBzReads[inRecIdx] = 0;
+        /* a columnar stream is read a block at a time, without an input stream */
+        if (STARCH_isColumnarStream(transformStates[inRecIdx]->t_inMd)) {
+            memset(&transformStates[inRecIdx]->t_columnarBlock, 0, sizeof(StarchColumnarBlock));
+            if (STARCHCAT2_fillExtractionBufferFromColumnarStream(&eofFlags[inRecIdx], 
+                                                                  extractionBuffers[inRecIdx], 
+                                                                  &nExtractionBuffers[inRecIdx], 
+                                                                  inType, 
+                                                                  transformStates[inRecIdx]) != STARCHCAT_EXIT_SUCCESS) {
+                fprintf(stderr, "ERROR: Could not extract data from columnar input stream at index [%zu]!\n", inRecIdx);
+                return STARCHCAT_EXIT_FAILURE;
+            }
+        }
+        else {
+            switch (inType) {
+                case kBzip2: {
+                    nBzReads[inRecIdx] = 0;
 #ifdef __cplusplus
-                if (STARCHCAT2_setupBzip2InputStream(static_cast<const size_t>( inRecIdx ), 
-                             summary, 
-                             &bzInFps[inRecIdx]) != STARCHCAT_EXIT_SUCCESS) {
+                    if (STARCHCAT2_setupBzip2InputStream(static_cast<const size_t>( inRecIdx ), 
+                                 summary, 
+                                 &bzInFps[inRecIdx]) != STARCHCAT_EXIT_SUCCESS) {
 #else
-                if (STARCHCAT2_setupBzip2InputStream((const size_t) inRecIdx, 
-                             summary, 
-                             &bzInFps[inRecIdx]) != STARCHCAT_EXIT_SUCCESS) {
+                    if (STARCHCAT2_setupBzip2InputStream((const size_t) inRecIdx, 
+                                 summary, 
+                                 &bzInFps[inRecIdx]) != STARCHCAT_EXIT_SUCCESS) {
 #endif
-                    fprintf(stderr, "ERROR: Could not set up bzip2 input stream at index [%zu]!\n", inRecIdx);
-                    return STARCHCAT_EXIT_FAILURE;
-                }
-                if (STARCHCAT2_fillExtractionBufferFromBzip2Stream(&eofFlags[inRecIdx], 
+                        fprintf(stderr, "ERROR: Could not set up bzip2 input stream at index [%zu]!\n", inRecIdx);
+                        return STARCHCAT_EXIT_FAILURE;
+                    }
+                    if (STARCHCAT2_fillExtractionBufferFromBzip2Stream(&eofFlags[inRecIdx], 
 #ifdef __cplusplus
-                                                                   const_cast<char *>( inChr ), 
+                                                                       const_cast<char *>( inChr ), 
 #else
-                                                                   (char *) inChr, 
+                                                                       (char *) inChr, 
 #endif
-                                                                   extractionBuffers[inRecIdx], 
-                                                                   &nExtractionBuffers[inRecIdx], 
-                                                                   &bzInFps[inRecIdx], 
-                                                                   &nBzReads[inRecIdx], 
-                                                                   extractionRemainderBufs[inRecIdx], 
-                                                                   &nExtractionRemainderBufs[inRecIdx], 
-                                                                   transformStates[inRecIdx]) != STARCHCAT_EXIT_SUCCESS) {
-                    fprintf(stderr, "ERROR: Could not extract data from bzip2 input stream at index [%zu]!\n", inRecIdx);
-                    return STARCHCAT_EXIT_FAILURE;
-                }
-                break;
-            }
-            case kGzip: {
-                nZReads[inRecIdx] = 0;
-                if (STARCHCAT2_setupGzipInputStream(&zInStreams[inRecIdx]) != STARCHCAT_EXIT_SUCCESS) {
-                    fprintf(stderr, "ERROR: Could not set up gzip input stream at index [%zu]!\n", inRecIdx);
-                    return STARCHCAT_EXIT_FAILURE;
+                                                                       extractionBuffers[inRecIdx], 
+                                                                       &nExtractionBuffers[inRecIdx], 
+                                                                       &bzInFps[inRecIdx], 
+                                                                       &nBzReads[inRecIdx], 
+                                                                       extractionRemainderBufs[inRecIdx], 
+                                                                       &nExtractionRemainderBufs[inRecIdx], 
+                                                                       transformStates[inRecIdx]) != STARCHCAT_EXIT_SUCCESS) {
+                        fprintf(stderr, "ERROR: Could not extract data from bzip2 input stream at index [%zu]!\n", inRecIdx);
+                        return STARCHCAT_EXIT_FAILURE;
+                    }
+                    break;
                 }
-                if (STARCHCAT2_fillExtractionBufferFromGzipStream(&eofFlags[inRecIdx], 
-                                                                  &zInFps[inRecIdx], 
+                case kGzip: {
+                    nZReads[inRecIdx] = 0;
+                    if (STARCHCAT2_setupGzipInputStream(&zInStreams[inRecIdx]) != STARCHCAT_EXIT_SUCCESS) {
+                        fprintf(stderr, "ERROR: Could not set up gzip input stream at index [%zu]!\n", inRecIdx);
+                        return STARCHCAT_EXIT_FAILURE;
+                    }
+                    if (STARCHCAT2_fillExtractionBufferFromGzipStream(&eofFlags[inRecIdx], 
+                                                                      &zInFps[inRecIdx], 
 #ifdef __cplusplus
-                                                                  const_cast<char *>( inChr ), 
+                                                                      const_cast<char *>( inChr ), 
 #else
-                                                                  (char *) inChr, 
+                                                                      (char *) inChr, 
 #endif
-                                                                  extractionBuffers[inRecIdx], 
-                                                                  &nExtractionBuffers[inRecIdx], 
-                                                                  &zInStreams[inRecIdx], 
-                                                                  &nZReads[inRecIdx], 
-                                                                  &extractionRemainderBufs[inRecIdx], 
-                                                                  &nExtractionRemainderBufs[inRecIdx], 
-                                                                  transformStates[inRecIdx]) != STARCHCAT_EXIT_SUCCESS) {
-                    fprintf(stderr, "ERROR: Could not extract data from gzip input stream at index [%zu]!\n", inRecIdx);
+                                                                      extractionBuffers[inRecIdx], 
+                                                                      &nExtractionBuffers[inRecIdx], 
+                                                                      &zInStreams[inRecIdx], 
+                                                                      &nZReads[inRecIdx], 
+                                                                      &extractionRemainderBufs[inRecIdx], 
+                                                                      &nExtractionRemainderBufs[inRecIdx], 
+                                                                      transformStates[inRecIdx]) != STARCHCAT_EXIT_SUCCESS) {
+                        fprintf(stderr, "ERROR: Could not extract data from gzip input stream at index [%zu]!\n", inRecIdx);
+                        return STARCHCAT_EXIT_FAILURE;
+                    }
+                    break;
+                }
+                case kUndefined: {
+                    fprintf(stderr, "ERROR: Unknown compression type specified in input stream at index [%zu]!\n", inRecIdx);
                     return STARCHCAT_EXIT_FAILURE;
                 }
-                break;
-            }
-            case kUndefined: {
-                fprintf(stderr, "ERROR: Unknown compression type specified in input stream at index [%zu]!\n", inRecIdx);
-                return STARCHCAT_EXIT_FAILURE;
             }
         }
         extractionBufferOffsets[inRecIdx] = 0; /* point these guys to the first element */
@@ -3128,49 +3159,61 @@ STARCHCAT2_mergeInputRecordsToOutput(const char *inChr, Metadata **outMd, const
                 memset(transformStates[lowestStartElementIdx]->t_secondInputToken, 0, UNSTARCH_SECOND_TOKEN_MAX_LENGTH);
                 memset(transformStates[lowestStartElementIdx]->t_currentRemainder, 0, UNSTARCH_SECOND_TOKEN_MAX_LENGTH);
 
-                switch (inType) {
-                    case kBzip2: {
-                        if (STARCHCAT2_fillExtractionBufferFromBzip2Stream(&eofFlags[lowestStartElementIdx], 
-#ifdef __cplusplus
-                                                                           const_cast<char *>( inChr ), 
-#else
-                                                                           (char *) inChr, 
-#endif
-                                                                           extractionBuffers[lowestStartElementIdx], 
-                                                                           &nExtractionBuffers[lowestStartElementIdx], 
-                                                                           &bzInFps[lowestStartElementIdx], 
-                                                                           &nBzReads[lowestStartElementIdx], 
-                                                                           extractionRemainderBufs[lowestStartElementIdx], 
-                                                                           &nExtractionRemainderBufs[lowestStartElementIdx], 
-                                                                           transformStates[lowestStartElementIdx]) != STARCHCAT_EXIT_SUCCESS) {
-                            fprintf(stderr, "ERROR: Could not extract data from bzip2 input stream at index [%zu]!\n", lowestStartElementIdx);
-                            return STARCHCAT_EXIT_FAILURE;
-                        }
-                        break;
-                    }
-                    case kGzip: {
-                        if (STARCHCAT2_fillExtractionBufferFromGzipStream(&eofFlags[lowestStartElementIdx], 
-                                                                          &zInFps[lowestStartElementIdx], 
-#ifdef __cplusplus
-                                                                          const_cast<char *>( inChr ), 
-#else
-                                                                          (char *) inChr, 
-#endif
+                if (STARCH_isColumnarStream(transformStates[lowestStartElementIdx]->t_inMd)) {
+                    if (STARCHCAT2_fillExtractionBufferFromColumnarStream(&eofFlags[lowestStartElementIdx], 
                                                                           extractionBuffers[lowestStartElementIdx], 
                                                                           &nExtractionBuffers[lowestStartElementIdx], 
-                                                                          &zInStreams[lowestStartElementIdx], 
-                                                                          &nZReads[lowestStartElementIdx], 
-                                                                          &extractionRemainderBufs[lowestStartElementIdx], 
-                                                                          &nExtractionRemainderBufs[lowestStartElementIdx], 
+                                                                          inType, 
                                                                           transformStates[lowestStartElementIdx]) != STARCHCAT_EXIT_SUCCESS) {
-                            fprintf(stderr, "ERROR: Could not extract data from gzip input stream at index [%zu]!\n", lowestStartElementIdx);
+                        fprintf(stderr, "ERROR: Could not extract data from columnar input stream at index [%zu]!\n", lowestStartElementIdx);
+                        return STARCHCAT_EXIT_FAILURE;
+                    }
+                }
+                else {
+                    switch (inType) {
+                        case kBzip2: {
+                            if (STARCHCAT2_fillExtractionBufferFromBzip2Stream(&eofFlags[lowestStartElementIdx], 
+#ifdef __cplusplus
+                                                                               const_cast<char *>( inChr ), 
+#else
+                                                                               (char *) inChr, 
+#endif
+                                                                               extractionBuffers[lowestStartElementIdx], 
+                                                                               &nExtractionBuffers[lowestStartElementIdx], 
+                                                                               &bzInFps[lowestStartElementIdx], 
+                                                                               &nBzReads[lowestStartElementIdx], 
+                                                                               extractionRemainderBufs[lowestStartElementIdx], 
+                                                                               &nExtractionRemainderBufs[lowestStartElementIdx], 
+                                                                               transformStates[lowestStartElementIdx]) != STARCHCAT_EXIT_SUCCESS) {
+                                fprintf(stderr, "ERROR: Could not extract data from bzip2 input stream at index [%zu]!\n", lowestStartElementIdx);
+                                return STARCHCAT_EXIT_FAILURE;
+                            }
+                            break;
+                        }
+                        case kGzip: {
+                            if (STARCHCAT2_fillExtractionBufferFromGzipStream(&eofFlags[lowestStartElementIdx], 
+                                                                              &zInFps[lowestStartElementIdx], 
+#ifdef __cplusplus
+                                                                              const_cast<char *>( inChr ), 
+#else
+                                                                              (char *) inChr, 
+#endif
+                                                                              extractionBuffers[lowestStartElementIdx], 
+                                                                              &nExtractionBuffers[lowestStartElementIdx], 
+                                                                              &zInStreams[lowestStartElementIdx], 
+                                                                              &nZReads[lowestStartElementIdx], 
+                                                                              &extractionRemainderBufs[lowestStartElementIdx], 
+                                                                              &nExtractionRemainderBufs[lowestStartElementIdx], 
+                                                                              transformStates[lowestStartElementIdx]) != STARCHCAT_EXIT_SUCCESS) {
+                                fprintf(stderr, "ERROR: Could not extract data from gzip input stream at index [%zu]!\n", lowestStartElementIdx);
+                                return STARCHCAT_EXIT_FAILURE;
+                            }
+                            break;
+                        }
+                        case kUndefined: {
+                            fprintf(stderr, "ERROR: Unknown compression type specified in input stream at index [%zu]!\n", lowestStartElementIdx);
                             return STARCHCAT_EXIT_FAILURE;
                         }
-                        break;
-                    }
-                    case kUndefined: {
-                        fprintf(stderr, "ERROR: Unknown compression type specified in input stream at index [%zu]!\n", lowestStartElementIdx);
-                        return STARCHCAT_EXIT_FAILURE;
                     }
                 }
 
@@ -3340,24 +3383,29 @@ STARCHCAT2_mergeInputRecordsToOutput(const char *inChr, Metadata **outMd, const
             }
             inRecord = *(summary->records) + inRecIdx;
             inType = inRecord->type; /* get record type of input stream */
-            switch (inType) {
-                case kBzip2: {
-                    if (STARCHCAT2_breakdownBzip2InputStream(&bzInFps[inRecIdx]) != STARCHCAT_EXIT_SUCCESS) {
-                        fprintf(stderr, "ERROR: Could not break down bzip2 input stream at index [%zu]!\n", inRecIdx);
-                        return STARCHCAT_EXIT_FAILURE;
+            if (STARCH_isColumnarStream(transformStates[inRecIdx]->t_inMd)) {
+                UNSTARCH_freeColumnarBlock(&transformStates[inRecIdx]->t_columnarBlock);
+            }
+            else {
+                switch (inType) {
+                    case kBzip2: {
+                        if (STARCHCAT2_breakdownBzip2InputStream(&bzInFps[inRecIdx]) != STARCHCAT_EXIT_SUCCESS) {
+                            fprintf(stderr, "ERROR: Could not break down bzip2 input stream at index [%zu]!\n", inRecIdx);
+                            return STARCHCAT_EXIT_FAILURE;
+                        }
+                        break;
                     }
-                    break;
-                }
-                case kGzip: {
-                    if (STARCHCAT2_breakdownGzipInputStream(&zInStreams[inRecIdx]) != STARCHCAT_EXIT_SUCCESS) {
-                        fprintf(stderr, "ERROR: Could not break down gzip input stream at index [%zu]!\n", inRecIdx);
+                    case kGzip: {
+                        if (STARCHCAT2_breakdownGzipInputStream(&zInStreams[inRecIdx]) != STARCHCAT_EXIT_SUCCESS) {
+                            fprintf(stderr, "ERROR: Could not break down gzip input stream at index [%zu]!\n", inRecIdx);
+                            return STARCHCAT_EXIT_FAILURE;
+                        }
+                        break;
+                    }
+                    case kUndefined: {
+                        fprintf(stderr, "ERROR: Unknown compression type specified in input stream at index [%zu]!\n", inRecIdx);
                         return STARCHCAT_EXIT_FAILURE;
                     }
-                    break;
-                }
-                case kUndefined: {
-                    fprintf(stderr, "ERROR: Unknown compression type specified in input stream at index [%zu]!\n", inRecIdx);
-                    return STARCHCAT_EXIT_FAILURE;
                 }
             }
         } 
@@ -4996,6 +5044,41 @@ STARCHCAT_isArchiveConcurrentOrOlder(const ArchiveVersion *av)
     return kStarchFalse;
 }
 
+Boolean
+STARCHCAT_isArchiveStreamCompatible(const ArchiveVersion *av)
+{
+#ifdef DEBUG
+    fprintf (stderr, "\n--- STARCHCAT_isArchiveStreamCompatible() ---\n");
+#endif
+
+    /* 
+        v2.2 streams differ from current streams only in lacking a block 
+        index, so their bytes and metadata can be copied without a rewrite 
+    */
+    if ((av->major == STARCH_MAJOR_VERSION) && 
+        (av->minor >= 2) && 
+        (STARCHCAT_isArchiveNewer(av) == kStarchFalse))
+        return kStarchTrue;
+
+    return kStarchFalse;
+}
+
+Boolean
+STARCHCAT_isColumnarRecordStream(const MetadataRecord *rec, const char *chr)
+{
+#ifdef DEBUG
+    fprintf (stderr, "\n--- STARCHCAT_isColumnarRecordStream() ---\n");
+#endif
+    const Metadata *iter = NULL;
+
+    for (iter = rec->metadata; iter != NULL; iter = iter->next) {
+        if (strcmp(iter->chromosome, chr) == 0)
+            return STARCH_isColumnarStream(iter);
+    }
+
+    return kStarchFalse;
+}
+
 Boolean
 STARCHCAT_isArchiveOlder(const ArchiveVersion *av)
 {
@@ -5272,10 +5355,10 @@ STARCHCAT2_mergeChromosomeStreams(const ChromosomeSummaries *chrSums, const Comp
 
 #ifdef __cplusplus
             if ( (inputType == outputType) && 
-                 (STARCHCAT_isArchiveConcurrent(reinterpret_cast<const ArchiveVersion *>( inputRecord->av )) == kStarchTrue) ) {
+                 (STARCHCAT_isArchiveStreamCompatible(reinterpret_cast<const ArchiveVersion *>( inputRecord->av )) == kStarchTrue) ) {
 #else
             if ( (inputType == outputType) && 
-                 (STARCHCAT_isArchiveConcurrent((const ArchiveVersion *) inputRecord->av) == kStarchTrue) ) {
+                 (STARCHCAT_isArchiveStreamCompatible((const ArchiveVersion *) inputRecord->av) == kStarchTrue) ) {
 #endif
 
 #ifdef __cplusplus
@@ -5294,6 +5377,24 @@ STARCHCAT2_mergeChromosomeStreams(const ChromosomeSummaries *chrSums, const Comp
                                                             (const MetadataRecord *) inputRecord, 
                                                             cumulativeOutputSize,
                                                             reportProgressFlag) );
+#endif
+            }
+            else if (STARCHCAT_isColumnarRecordStream(inputRecord, inputChr) == kStarchTrue) {
+                /* a columnar stream is not rewritten in place, but read as a merge of one record */
+#ifdef __cplusplus
+                assert( STARCHCAT2_mergeInputRecordsToOutput( reinterpret_cast<const char *>( inputChr ), 
+                                                              &outputMd, 
+                                                              reinterpret_cast<const char *>( outputTag ), 
+                                                              static_cast<const CompressionType>( outputType ), 
+                                                              reinterpret_cast<const ChromosomeSummary *>( summary ),
+                                                              cumulativeOutputSize) );
+#else
+                assert( STARCHCAT2_mergeInputRecordsToOutput( (const char *) inputChr, 
+                                                              &outputMd, 
+                                                              (const char *) outputTag, 
+                                                              (const CompressionType) outputType, 
+                                                              (const ChromosomeSummary *) summary,
+                                                              cumulativeOutputSize) );
 #endif
             }
 #ifdef __cplusplus
@@ -5598,7 +5699,7 @@ STARCHCAT2_testSummaryForChromosomeExistence(const char *chrName, const Chromoso
 }
 
 int
-STARCHCAT2_setupInitialFileOffsets(const char *chrName, const ChromosomeSummary *chrSummary, const size_t recIndex)
+STARCHCAT2_setupInitialFileOffsets(const char *chrName, const ChromosomeSummary *chrSummary, const size_t recIndex, TransformState *t_state)
 {
 #ifdef DEBUG
     fprintf(stderr, "\n--- STARCHCAT2_setupInitialFileOffsets() ---\n");
@@ -5631,6 +5732,12 @@ STARCHCAT2_setupInitialFileOffsets(const char *chrName, const ChromosomeSummary
     fseeko(rec->fp, (off_t) offset, SEEK_SET);
 #endif
 
+    /* the bzip2 streams of later blocks of the chromosome are found from here */
+    t_state->t_inFp = rec->fp;
+    t_state->t_inMd = iter;
+    t_state->t_inStreamOffset = offset;
+    t_state->t_inBlockIdx = 0;
+
     return STARCHCAT_EXIT_SUCCESS;
 }
 
@@ -5925,8 +6032,11 @@ STARCHCAT2_fillExtractionBufferFromBzip2Stream(Boolean *eofFlag, char *recordChr
     *nBzRead = (size_t) BZ2_bzRead(&bzError, *bzStream, bzReadBuf, (int) nBzReadBuf);
 #endif
 
-    if (bzError == BZ_STREAM_END)
-        *eofFlag = kStarchTrue;
+    if (bzError == BZ_STREAM_END) {
+        /* a block-indexed stream goes on with the bzip2 stream of its next block */
+        if (UNSTARCH_bzOpenNextBlock(bzStream, t_state->t_inFp, t_state->t_inMd, t_state->t_inStreamOffset, &t_state->t_inBlockIdx) != 0)
+            *eofFlag = kStarchTrue;
+    }
 
     else if (bzError != BZ_OK) {
         switch (bzError) {
@@ -6428,6 +6538,62 @@ STARCHCAT2_fillExtractionBufferFromGzipStream(Boolean *eofFlag, FILE **inputFp,
     return STARCHCAT_EXIT_SUCCESS;
 }
 
+int
+STARCHCAT2_fillExtractionBufferFromColumnarStream(Boolean *eofFlag, char *extractionBuffer, size_t *nExtractionBuffer, const CompressionType inType, TransformState *t_state)
+{
+#ifdef DEBUG
+    fprintf(stderr, "\n--- STARCHCAT2_fillExtractionBufferFromColumnarStream() ---\n");
+#endif
+
+    /*
+        Fills the extraction buffer with BED lines from the records of a columnar 
+        stream, reading its blocks in turn; t_inBlockIdx is the next block to read. 
+        The buffer is filled only as far as it surely holds another line.
+    */
+
+    SignedCoordType start = 0;
+    SignedCoordType stop = 0;
+    char *rest = NULL;
+    size_t restLength = 0;
+    int res = 0;
+
+    if (*eofFlag == kStarchTrue)
+        return STARCHCAT_EXIT_SUCCESS;
+
+    t_state->t_nExtractionBuffer = 0;
+    t_state->t_nExtractionBufferPos = 0;
+    extractionBuffer[0] = '\0';
+
+    while (*nExtractionBuffer - t_state->t_nExtractionBufferPos > TOKENS_MAX_LENGTH) {
+        res = UNSTARCH_nextColumnarRecord(&t_state->t_columnarBlock, &start, &stop, &rest, &restLength);
+        if (res == 1) {
+            if (t_state->t_inBlockIdx >= t_state->t_inMd->numBlocks) {
+                *eofFlag = kStarchTrue;
+                break;
+            }
+            if (UNSTARCH_readColumnarBlock(t_state->t_inFp, t_state->t_inMd, t_state->t_inStreamOffset, t_state->t_inBlockIdx++, inType, kStarchTrue, &t_state->t_columnarBlock) != 0)
+                return STARCHCAT_EXIT_FAILURE;
+            continue;
+        }
+        else if (res != 0)
+            return STARCHCAT_EXIT_FAILURE;
+
+#ifdef __cplusplus
+        t_state->t_nExtractionBuffer = (restLength > 0) ? 
+            static_cast<size_t>( sprintf(extractionBuffer + t_state->t_nExtractionBufferPos, "%s\t%" PRId64 "\t%" PRId64 "\t%s\n", t_state->t_inMd->chromosome, start, stop, rest) ) :
+            static_cast<size_t>( sprintf(extractionBuffer + t_state->t_nExtractionBufferPos, "%s\t%" PRId64 "\t%" PRId64 "\n", t_state->t_inMd->chromosome, start, stop) );
+#else
+        t_state->t_nExtractionBuffer = (restLength > 0) ? 
+            (size_t) sprintf(extractionBuffer + t_state->t_nExtractionBufferPos, "%s\t%" PRId64 "\t%" PRId64 "\t%s\n", t_state->t_inMd->chromosome, start, stop, rest) :
+            (size_t) sprintf(extractionBuffer + t_state->t_nExtractionBufferPos, "%s\t%" PRId64 "\t%" PRId64 "\n", t_state->t_inMd->chromosome, start, stop);
+#endif
+        t_state->t_nExtractionBufferPos += t_state->t_nExtractionBuffer;
+        t_state->t_lineIdx++;
+    }
+
+    return STARCHCAT_EXIT_SUCCESS;
+}
+
 int
 STARCHCAT2_extractBedLine(Boolean *eobFlag, char *extractionBuffer, int *extractionBufferOffset, char **extractedElement) 
 {
@@ -6575,6 +6741,9 @@ STARCHCAT2_parseCoordinatesFromBedLineV2p2(Boolean *eobFlag, const char *extract
     char stopStr[MAX_DEC_INTEGERS + 1] = {0};
     SignedCoordType result = 0;
 
+    /* a BED3 element has no remainder; do not keep that of the element before it */
+    (*remainder)[0] = '\0';
+
     while (extractedElement[charIdx] != '\0') {
         if (extractedElement[charIdx] == tab) {
             if (fieldIdx < 3) {
@@ -6819,6 +6988,12 @@ STARCHCAT2_transformCompressionBuffer (const char *compBuf, char *retransBuf, Tr
 #ifdef DEBUG
                 fprintf(stderr, "\tretransLineBuf - [%s]\n", retransLineBuf);
 #endif
+
+                /* tokens leave the remainder alone for BED3 lines, so drop it, as starch does */
+                if (retransRemainder) {
+                    free(retransRemainder);
+                    retransRemainder = NULL;
+                }
             }
         }
     }
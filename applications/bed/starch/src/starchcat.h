@@ -99,6 +99,11 @@ typedef struct transformState {
     size_t                   t_currentRemainderLength;
     SignedCoordType          t_lastPosition;
     SignedCoordType          t_lcDiff;    
+    FILE                    *t_inFp;
+    const Metadata          *t_inMd;
+    uint64_t                 t_inStreamOffset;
+    uint64_t                 t_inBlockIdx;
+    StarchColumnarBlock      t_columnarBlock;
     size_t                   t_nExtractionBuffer;
     size_t                   t_nExtractionBufferPos;
     char                     r_chromosome[TOKEN_CHR_MAX_LENGTH];
@@ -325,8 +330,13 @@ Boolean  STARCHCAT_isArchiveConcurrent (const ArchiveVersion *av);
 
 Boolean  STARCHCAT_isArchiveConcurrentOrOlder (const ArchiveVersion *av);
 
+Boolean  STARCHCAT_isArchiveStreamCompatible (const ArchiveVersion *av);
+
 Boolean  STARCHCAT_isArchiveOlder (const ArchiveVersion *av);
 
+Boolean  STARCHCAT_isColumnarRecordStream (const MetadataRecord *rec, 
+                                                const char *chr);
+
 Boolean  STARCHCAT_isArchiveNewer (const ArchiveVersion *av);
 
 Boolean  STARCHCAT_isArchiveNewerThan (const ArchiveVersion *av,
@@ -351,7 +361,7 @@ int      STARCHCAT2_mergeInputRecordsToOutput (const char *inChr,
 int      STARCHCAT2_setupBzip2OutputStream (BZFILE **bzStream, FILE *outStream);
 int      STARCHCAT2_setupGzipOutputStream (z_stream *zStream);
 int      STARCHCAT2_testSummaryForChromosomeExistence (const char *chrName, const ChromosomeSummary *chrSummary, const size_t recIndex);
-int      STARCHCAT2_setupInitialFileOffsets (const char *chrName, const ChromosomeSummary *chrSummary, const size_t recIndex);
+int      STARCHCAT2_setupInitialFileOffsets (const char *chrName, const ChromosomeSummary *chrSummary, const size_t recIndex, TransformState *t_state);
 int      STARCHCAT2_setupBzip2InputStream (const size_t recIdx, const ChromosomeSummary *chrSummary, BZFILE **bzStream);
 int      STARCHCAT2_setupGzipInputStream (z_stream *zStream);
 int      STARCHCAT2_breakdownBzip2InputStream (BZFILE **bzStream);
@@ -360,6 +370,7 @@ int      STARCHCAT2_breakdownBzip2OutputStream (BZFILE **bzStream, uint64_t *bzO
 int      STARCHCAT2_breakdownGzipOutputStream (z_stream *zStream);
 int      STARCHCAT2_fillExtractionBufferFromBzip2Stream (Boolean *eofFlag, char *recordChromosome, char *extractionBuffer, size_t *nExtractionBuffer, BZFILE **bzStream, size_t *nBzRead, char *bzRemainderBuf, size_t *nBzRemainderBuf, TransformState *t_state);
 int      STARCHCAT2_fillExtractionBufferFromGzipStream (Boolean *eofFlag, FILE **inputFp, char *recordChromosome, char *extractionBuffer, size_t *nExtractionBuffer, z_stream *zStream, size_t *nZRead, char **zRemainderBuf, size_t *nZRemainderBuf, TransformState *t_state);
+int      STARCHCAT2_fillExtractionBufferFromColumnarStream (Boolean *eofFlag, char *extractionBuffer, size_t *nExtractionBuffer, const CompressionType inType, TransformState *t_state);
 int      STARCHCAT2_extractBedLine (Boolean *eobFlag, char *extractionBuffer, int *extractionBufferOffset, char **extractedElement);
 int      STARCHCAT2_parseCoordinatesFromBedLineV2 (Boolean *eobFlag, const char *extractedElement, SignedCoordType *start, SignedCoordType *stop);
 int      STARCHCAT2_parseCoordinatesFromBedLineV2p2 (Boolean *eobFlag, const char *extractedElement, SignedCoordType *start, SignedCoordType *stop, char **remainder);
@@ -268,6 +268,11 @@ STARCHSTRIP_write_chromosome_streams(FILE* os)
                                                              iter->lineMaxStringLength );
                 }
 #endif
+                // the stream is copied as-is, along with its block index
+                if (STARCH_setMetadataBlocks(output_records_tail, iter->blocks, iter->numBlocks) != STARCH_EXIT_SUCCESS) {
+                    fprintf(stderr, "Error: Could not copy block index of chromosome [%s]\n", iter->chromosome);
+                    exit(ENOMEM); /* Not enough space (POSIX.1) */
+                }
                 // increment records
                 records_added++;
 
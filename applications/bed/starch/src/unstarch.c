@@ -80,6 +80,8 @@ main(int argc, char **argv)
     char *jsonString = NULL;
     unsigned char mdHashBuffer[STARCH2_MD_FOOTER_SHA1_LENGTH + 1] = {0};
     Boolean signatureVerificationFlag = kStarchFalse;
+    SignedCoordType regionStart = 0;
+    SignedCoordType regionEnd = 0;
 
     /*
         unstarch overview
@@ -361,7 +363,35 @@ main(int argc, char **argv)
             resultValue = UNSTARCH_VERSION_ERROR;
         else if (option && ((strcmp(option, "archiveVersion") == 0) || (strcmp(option, "archive-version") == 0)))
             resultValue = UNSTARCH_ARCHIVE_VERSION_ERROR;
-        else {
+        else if (UNSTARCH_parseRegion(records, whichChromosome, &regionStart, &regionEnd) == kStarchTrue) {
+            if (regionStart >= regionEnd) {
+                fprintf(stderr, "ERROR: Region start must be less than region end\n");
+                resultValue = EXIT_FAILURE;
+            }
+#ifdef __cplusplus
+            else if (UNSTARCH_extractRegion(&inFilePtr,
+                                            NULL,
+                                            whichChromosome,
+                                            regionStart,
+                                            regionEnd,
+                                            reinterpret_cast<const Metadata *>( records ),
+                                            (archiveVersion->major == 1) ? static_cast<uint64_t>( metadataOffset ) : static_cast<uint64_t>( sizeof(starchRevision2HeaderBytes) ),
+                                            type) != 0) {
+#else
+            else if (UNSTARCH_extractRegion(&inFilePtr,
+                                            NULL,
+                                            whichChromosome,
+                                            regionStart,
+                                            regionEnd,
+                                            (const Metadata *) records,
+                                            (archiveVersion->major == 1) ? (uint64_t) metadataOffset : (uint64_t) sizeof(starchRevision2HeaderBytes),
+                                            type) != 0) {
+#endif
+                fprintf(stderr, "ERROR: Backend extraction of region failed\n");
+                resultValue = EXIT_FAILURE;
+            }
+        }
+else {
             if ((STARCH_MAJOR_VERSION == 1) || (archiveVersion->major == 1)) {
                 switch (type) {
                     case kBzip2: {
@@ -1303,6 +1333,50 @@ UNSTARCH_printMetadataSha1Signature(unsigned char *sha1Buffer)
     jsonBase64String = NULL;
 }
 
+Boolean
+UNSTARCH_parseRegion(const Metadata *md, char *chr, SignedCoordType *start, SignedCoordType *end)
+{
+#ifdef DEBUG
+    fprintf(stderr, "\n--- UNSTARCH_parseRegion() ---\n");
+#endif
+    const Metadata *iter = NULL;
+    char *colon = NULL;
+    char *dash = NULL;
+    char *p = NULL;
+
+    /*
+        A <chromosome> of the form chr:start-end (BED coordinates: 0-based, 
+        half-open) selects a region. The name of a chromosome in the archive 
+        is always taken as it is, even if it looks like a region. On success, 
+        chr is cut back to the chromosome name.
+    */
+
+    for (iter = md; iter != NULL; iter = iter->next)
+        if (strcmp(chr, iter->chromosome) == 0)
+            return kStarchFalse;
+
+    colon = strrchr(chr, ':');
+    if ((!colon) || (colon == chr))
+        return kStarchFalse;
+    dash = strchr(colon + 1, '-');
+    if ((!dash) || (dash == colon + 1) || (*(dash + 1) == '\0'))
+        return kStarchFalse;
+    for (p = colon + 1; *p != '\0'; p++)
+        if ((p != dash) && ((*p < '0') || (*p > '9')))
+            return kStarchFalse;
+
+#ifdef __cplusplus
+    *start = static_cast<SignedCoordType>( strtoll(colon + 1, NULL, UNSTARCH_RADIX) );
+    *end = static_cast<SignedCoordType>( strtoll(dash + 1, NULL, UNSTARCH_RADIX) );
+#else
+    *start = (SignedCoordType) strtoll(colon + 1, NULL, UNSTARCH_RADIX);
+    *end = (SignedCoordType) strtoll(dash + 1, NULL, UNSTARCH_RADIX);
+#endif
+    *colon = '\0';
+
+    return kStarchTrue;
+}
+
 #ifdef __cplusplus
 } // namespace starch
 #endif
@@ -32,7 +32,9 @@
 static const char *name = "unstarch";
 static const char *authors = "Alex Reynolds and Shane Neph";
 static const char *usage = "\n" \
-    "USAGE: unstarch [ <chromosome> ]  [ --elements | \n" \
+    "USAGE: unstarch [ <chromosome> |\n" \
+    "                  <chromosome>:<start>-<end> ]\n" \
+    "                                  [ --elements | \n" \
     "                                    --elements-max-string-length |\n" \
     "                                    --bases | --bases-uniq |\n" \
     "                                    --has-duplicates | --has-nested | --list |\n" \
@@ -48,6 +50,12 @@ static const char *usage = "\n" \
     "                                     specific records from the starch archive\n" \
     "                                     file or restricts action of operator to\n" \
     "                                     chromosome (e.g., chr1, chrY, etc.).\n\n" \
+    "    <chromosome>:<start>-<end>       Optional. Unarchives the records that\n" \
+    "                                     overlap the region (e.g., chr7:55000000-\n" \
+    "                                     56000000, in 0-based, half-open BED\n" \
+    "                                     coordinates). Only the blocks of a block-\n" \
+    "                                     indexed (v2.3) archive that can hold\n" \
+    "                                     such records are decompressed.\n\n" \
     "    Process Flags\n" \
     "    --------------------------------------------------------------------------\n" \
     "    --elements                       Show total element count for archive. If\n" \
@@ -140,6 +148,11 @@ void                 UNSTARCH_printCompressionType(const CompressionType t);
 
 void                 UNSTARCH_printMetadataSha1Signature(unsigned char *sha1Buffer);
 
+Boolean              UNSTARCH_parseRegion(const Metadata *md,
+                                                  char *chr,
+                                       SignedCoordType *start,
+                                       SignedCoordType *end);
+
 #ifdef __cplusplus
 } // namespace starch
 #endif
@@ -24,6 +24,8 @@
 #ifndef WINDOWED_SWEEP_ALGORITHM_H
 #define WINDOWED_SWEEP_ALGORITHM_H
 
+#include <vector>
+
 #include "data/bed/BedDistances.hpp"
 
 namespace WindowSweep {
@@ -67,6 +69,25 @@ namespace WindowSweep {
              RangeComp inRange, EventVisitor& visitor, bool sweepMapAll = false);
 
 
+  //=================================================================
+  // sweep() Overload3 : Many reference iterator pairs, one map pair
+  //  Each reference iterator pair has its own visitor, and sees the
+  //   same events it would see from Overload2.  The map iterator
+  //   pair is read only once, through a window shared by every
+  //   reference cursor.  Reference cursors are advanced together
+  //   in genomic order to keep the shared window small.
+  //=================================================================
+  template <
+            class InputIterator1,
+            class InputIterator2,
+            class RangeComp,
+            class EventVisitor
+           >
+  void sweep(std::vector<InputIterator1>& refStarts, std::vector<InputIterator1>& refEnds,
+             InputIterator2 mapFromStart, InputIterator2 mapFromEnd,
+             RangeComp inRange, std::vector<EventVisitor*>& visitors, bool sweepMapAll = false);
+
+
   /*
     sweep() Assumptions:
     1) in terms of RangeComp(a, b):
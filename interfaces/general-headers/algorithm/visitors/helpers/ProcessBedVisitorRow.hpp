@@ -24,6 +24,7 @@
 #ifndef _VISITOR_BED_POST_PROCESSING_
 #define _VISITOR_BED_POST_PROCESSING_
 
+#include <memory>
 #include <set>
 #include <string>
 #include <type_traits>
@@ -349,26 +350,33 @@ namespace Visitors {
     // PrintRowID()
     //==============
     struct PrintRowID {
+      PrintRowID() : rowID_(0), subRowID_(0) { /* */ }
+
       template <typename T>
       void operator()(T* t) const {
         static char const* id = "id-";
-        static unsigned long rowID = 0;
-        static unsigned long subRowID = 0;
-        static T last;
         static Bed::GenomicRestCompare<T> grc;
+        if ( !last_ ) // row numbers belong to each instance, so each <ref-file> counts its own rows
+          last_ = std::shared_ptr<void>(new T);
+        T& last = *static_cast<T*>(last_.get());
         if ( !grc(&last, t) && !grc(t, &last) ) { // equal
           static constexpr unsigned long sz = 1000;
           static char formatted[sz+1];
           formatted[0] = '\0';
-          std::snprintf(formatted, sz, "%s%lu.%06lu", id, rowID, ++subRowID);
+          std::snprintf(formatted, sz, "%s%lu.%06lu", id, rowID_, ++subRowID_);
           PrintTypes::Print(formatted);
           return;
         }
         last = *t;
         PrintTypes::Print(id);
-        PrintTypes::Print(++rowID);
-        subRowID = 0;
+        PrintTypes::Print(++rowID_);
+        subRowID_ = 0;
       }
+
+    private:
+      mutable unsigned long rowID_;
+      mutable unsigned long subRowID_;
+      mutable std::shared_ptr<void> last_;
     };
 
     //=======================
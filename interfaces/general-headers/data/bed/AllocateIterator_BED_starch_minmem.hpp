@@ -30,12 +30,15 @@
 #include <cstdlib>
 #include <cstring>
 #include <iterator>
+#include <memory>
 
 #include <sys/stat.h>
 
 #include "algorithm/bed/FindBedRange.hpp"
 #include "algorithm/visitors/helpers/ProcessVisitorRow.hpp"
 #include "data/bed/Bed_minmem.hpp"
+#include "data/bed/BinaryBed.hpp"
+#include "data/bed/StarchBed.hpp"
 #include "data/starch/starchApi.hpp"
 #include "utility/FPWrap.hpp"
 
@@ -54,13 +57,15 @@ namespace Bed {
     typedef BedType**                 pointer;
     typedef BedType*&                 reference;
   
-    allocate_iterator_starch_bed_mm() : fp_(NULL), _M_ok(false), _M_value(0), is_starch_(false), all_(false), archive_(NULL) { chr_[0] = '\0'; }
+    allocate_iterator_starch_bed_mm() : fp_(NULL), _M_ok(false), _M_value(0), is_starch_(false), all_(false), archive_(NULL),
+                                        region_(false), rstart_(0), rend_(0) { chr_[0] = '\0'; }
 
     template <typename ErrorType>
     allocate_iterator_starch_bed_mm(Ext::FPWrap<ErrorType>& fp, const std::string& chr = "all") /* this ASSUMES fp is open and meaningful */
       : fp_(fp), _M_ok(fp_ && !std::feof(fp_)), _M_value(0),
-        is_starch_(_M_ok && (fp_ != stdin) && starch::Starch::isStarch(fp_)),
-        all_(0 == std::strcmp(chr.c_str(), "all")), archive_(NULL) {
+        is_starch_(false),
+        all_(0 == std::strcmp(chr.c_str(), "all")), archive_(NULL),
+        region_(false), rstart_(0), rend_(0) {
 
       chr_[0] = '\0';
       std::size_t sz = std::min(chr.size(), static_cast<std::size_t>(Bed::MAXCHROMSIZE));
@@ -80,7 +85,21 @@ namespace Bed {
           throw(ErrorType("Error: stat() failed on: " + fp.Name()));
         is_namedpipe = (S_ISFIFO(st.st_mode) != 0);
       }
-      is_starch_ = (is_starch_ && !is_namedpipe);
+
+      if ( BinaryBedReader<FILE*>::isBinary(fp_, fp.Name()) ) { // binary stream, any source
+        binary_ = std::make_shared< BinaryBedReader<FILE*> >(fp_, fp.Name());
+        while ( (_M_ok = binary_->next()) ) { // stream through to chr_ if need be
+          if ( all_ || 0 == std::strcmp(binary_->chrom(), chr_) ) {
+            _M_value = get_binary();
+            break;
+          }
+        } // while
+        if ( !_M_ok )
+          fp_ = NULL;
+        return;
+      }
+
+      is_starch_ = ((fp_ != stdin) && starch::Starch::isStarch(fp_) && !is_namedpipe);
 
       if ( (fp_ == stdin || is_namedpipe) && !all_ ) { // BED, chrom-specific, using stdin
         // stream through until we find what we want
@@ -100,6 +119,8 @@ namespace Bed {
       if ( is_starch_ ) { // starch archive can deal with all or specific chromosomes
         const bool perLineUsage = true;
         archive_ = new starch::Starch(fp_, chr_, perLineUsage);
+        // three-column types without rest pass over the rest column of a columnar archive
+        archive_->setRestFlag(BedType::NumFields != 3 || BedType::UseRest);
         _M_ok = archive_->getArchiveRecordIter();
         if ( !_M_ok ) {
           fp_ = NULL;
@@ -166,41 +187,39 @@ namespace Bed {
       }
     }
   
+    template <typename ErrorType>
+    allocate_iterator_starch_bed_mm(Ext::FPWrap<ErrorType>& fp, const std::string& chr,
+                                    Bed::CoordType start, Bed::CoordType end)
+      : allocate_iterator_starch_bed_mm(fp, chr) {
+      // only rows of chr that overlap [start, end): a Starch archive skips to the
+      //   first block that can hold one, while BED is read through
+      region_ = true;
+      rstart_ = start;
+      rend_ = end;
+      if ( _M_ok && is_starch_ ) {
+        delete _M_value;
+        archive_->seekRegion(chr_, start, end);
+        _M_value = get_starch();
+        _M_ok = (static_cast<bool>(_M_value) && 
+                 (archive_->getArchiveRecordIter() != NULL) &&
+                 !archive_->isEOF());
+      }
+      to_region();
+    }
+
     reference operator*() { return _M_value; }
     pointer operator->() { return &(operator*()); }
   
     allocate_iterator_starch_bed_mm& operator++() { 
-      if ( _M_ok ) {
-        if ( !is_starch_ ) {
-          _M_value = new BedType(fp_);
-          _M_ok = !std::feof(fp_) && (all_ || 0 == std::strcmp(_M_value->chrom(), chr_));
-          // very small leak in event that !all_ and _M_value->chrom() is not chr_
-          //   too expensive to check
-        } else {
-          _M_value = get_starch();
-          _M_ok = (static_cast<bool>(_M_value) && 
-                   (archive_->getArchiveRecordIter() != NULL) &&
-                   !archive_->isEOF());
-        }
-      }
+      next();
+      to_region();
       return *this;
     }
   
     allocate_iterator_starch_bed_mm operator++(int)  {
       allocate_iterator_starch_bed_mm __tmp = *this;
-      if ( _M_ok ) {
-        if ( !is_starch_ ) {
-          _M_value = new BedType(fp_);
-          _M_ok = !std::feof(fp_) && (all_ || 0 == std::strcmp(_M_value->chrom(), chr_));
-          // very small leak in event that !all_ and _M_value->chrom() is not chr_
-          //   too expensive to check
-        } else {
-          _M_value = get_starch();
-          _M_ok = (static_cast<bool>(_M_value) && 
-                   (archive_->getArchiveRecordIter() != NULL) &&
-                   !archive_->isEOF());
-        }
-      }
+      next();
+      to_region();
       return __tmp;
     }
   
@@ -218,11 +237,52 @@ namespace Bed {
     }
   
   private:
+    inline void next() {
+      if ( _M_ok ) {
+        if ( binary_ ) {
+          _M_ok = binary_->next() && (all_ || 0 == std::strcmp(binary_->chrom(), chr_));
+          if ( _M_ok )
+            _M_value = get_binary();
+        } else if ( !is_starch_ ) {
+          _M_value = new BedType(fp_);
+          _M_ok = !std::feof(fp_) && (all_ || 0 == std::strcmp(_M_value->chrom(), chr_));
+          // very small leak in event that !all_ and _M_value->chrom() is not chr_
+          //   too expensive to check
+        } else {
+          _M_value = get_starch();
+          _M_ok = (static_cast<bool>(_M_value) && 
+                   (archive_->getArchiveRecordIter() != NULL) &&
+                   !archive_->isEOF());
+        }
+      }
+    }
+
+    inline void to_region() {
+      if ( !region_ )
+        return;
+      // rows are sorted by start but not by end: skip every row that ends before the region
+      while ( _M_ok && _M_value->end() <= rstart_ ) {
+        delete _M_value;
+        next();
+      }
+      if ( _M_ok && _M_value->start() >= rend_ ) {
+        delete _M_value;
+        _M_ok = false;
+      }
+    }
+
+    inline BedType* get_binary() {
+      static std::string line;
+      return(make_binary<BedType>(*binary_, line));
+    }
+
     inline BedType* get_starch() {
+      // decoded fields go straight into the new object; no BED text in between
+      static StarchRecordReader record;
       static std::string line;
-      if ( archive_ == NULL || !archive_->extractBEDLine(line) )
+      if ( archive_ == NULL || !record.next(*archive_) )
         return(0);
-      return(new BedType(line.c_str()));
+      return(make_binary<BedType>(record, line));
     }
   
   private:
@@ -233,6 +293,9 @@ namespace Bed {
     bool is_starch_;
     const bool all_;
     starch::Starch* archive_;
+    std::shared_ptr< BinaryBedReader<FILE*> > binary_;
+    bool region_;
+    Bed::CoordType rstart_, rend_;
   };
   
   template <class BedType>
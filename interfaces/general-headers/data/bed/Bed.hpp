@@ -254,6 +254,9 @@ namespace Bed {
     : public BasicCoords<IsNonStaticChrom, false> {
 
     BasicCoords() : BaseClass() { fullrest_[0] = '\0'; }
+    BasicCoords(char const* chrom, CoordType start, CoordType end, char const* fullrest)
+      : BaseClass(chrom, start, end)
+      { *fullrest_ = '\0'; if ( fullrest != nullptr ) std::strcpy(fullrest_, fullrest); }
     BasicCoords(const BasicCoords& c)
       : BaseClass(c)
       { std::strcpy(fullrest_, c.fullrest_); }
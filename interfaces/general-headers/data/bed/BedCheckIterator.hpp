@@ -31,6 +31,7 @@
 #include <istream>
 #include <iterator>
 #include <limits>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <type_traits>
@@ -41,6 +42,7 @@
 #include "algorithm/bed/FindBedRange.hpp"
 #include "algorithm/visitors/helpers/ProcessVisitorRow.hpp"
 #include "data/bed/Bed.hpp"
+#include "data/bed/BinaryBed.hpp"
 #include "data/starch/starchApi.hpp"
 #include "suite/BEDOPS.Constants.hpp"
 #include "utility/ByLine.hpp"
@@ -89,18 +91,21 @@ namespace Bed {
         is_namedpipe = (S_ISFIFO(st.st_mode) != 0);
       }
 
-      isStarch_ = (fp_ && !is_namedpipe && (&is != &std::cin) && starch::Starch::isStarch(fn_));
+      if ( fp_ && BinaryBedReader<std::istream*>::isBinary(&fp_, fn_) ) // binary stream, any source
+        binary_ = std::make_shared< BinaryBedReader<std::istream*> >(&fp_, fn_);
+
+      isStarch_ = (fp_ && !binary_ && !is_namedpipe && (&is != &std::cin) && starch::Starch::isStarch(fn_));
       if ( isStarch_ ) // Starch constructor opens a stream for us
         dynamic_cast<std::ifstream&>(fp_).close(); // isStarch_ ensures fp_ is open and it's not std::cin/named pipe
 
       // compare pointers directly, to allow compilation with Clang/LLVM against C++11 standard
-      if ( (&fp_ == &std::cin || is_namedpipe) && !all_ ) { // only BED through stdin; chromosome-specific
+      if ( (&fp_ == &std::cin || is_namedpipe || binary_) && !all_ ) { // only BED through stdin; chromosome-specific
         // cannot 'jump' to chr_ -> stream through, line by line until we find it or eof
         Ext::ByLine bl;
-        while ( (_M_ok = (fp_ && fp_ >> bl)) ) {
+        while ( (_M_ok = get_line(bl)) ) {
           ++cnt_;
           while ( !check(bl) ) {
-            if ( fp_ >> bl )
+            if ( get_line(bl) )
               ++cnt_;
             else { /* only headers found */
               _M_ok = false;
@@ -215,12 +220,12 @@ namespace Bed {
         std::fclose(tmpf);
       } else { // BED, process everything
         Ext::ByLine bl;
-        if ( !(_M_ok && fp_ >> bl) )
+        if ( !(_M_ok && get_line(bl)) )
           _M_ok = false;
         else {
           ++cnt_;
           while ( !check(bl) ) {
-            if ( fp_ >> bl )
+            if ( get_line(bl) )
               ++cnt_;
             else { /* only headers found */
               _M_ok = false;
@@ -238,7 +243,7 @@ namespace Bed {
       static Ext::ByLine bl;
       if ( _M_ok ) {
         if ( !isStarch_ ) { // bed
-          if ( (_M_ok = (fp_ && fp_ >> bl)) ) {
+          if ( (_M_ok = get_line(bl)) ) {
             ++cnt_;
             if ( !check(bl) ) {
               std::stringstream s;
@@ -269,7 +274,7 @@ namespace Bed {
       static Ext::ByLine bl;
       if ( _M_ok ) {
         if ( !isStarch_ ) { // bed
-          if ( (_M_ok = (fp_ && fp_ >> bl)) ) {
+          if ( (_M_ok = get_line(bl)) ) {
             ++cnt_;
             if ( !check(bl) ) {
               std::stringstream s;
@@ -326,6 +331,15 @@ namespace Bed {
       return (tmp == "browser" || tmp == "track");
     }
 
+    bool get_line(Ext::ByLine& bl) {
+      if ( !binary_ )
+        return static_cast<bool>(fp_ && fp_ >> bl);
+      if ( !binary_->next() )
+        return false;
+      binary_->line(bl);
+      return true;
+    }
+
     bool get_starch(std::string& line) {
       if ( archive_ == NULL || !archive_->extractBEDLine(line) )
         return false;
@@ -659,6 +673,7 @@ namespace Bed {
     bool isStarch_;
     const bool all_;
     starch::Starch* archive_;
+    std::shared_ptr< BinaryBedReader<std::istream*> > binary_;
     Ext::PooledMemory<BedType, SZ>* pool_;
   };
 
@@ -0,0 +1,311 @@
+/*
+  Author: Shane Neph & Alex Reynolds
+  Date:   Sun Oct 18 09:12:40 PDT 2026
+*/
+//
+//    BEDOPS
+//    Copyright (C) 2011-2018 Shane Neph, Scott Kuehn and Alex Reynolds
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License along
+//    with this program; if not, write to the Free Software Foundation, Inc.,
+//    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+#ifndef BED_BIN_GENERATING_ITERATOR_HPP
+#define BED_BIN_GENERATING_ITERATOR_HPP
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "data/bed/Bed.hpp"
+#include "suite/BEDOPS.Constants.hpp"
+#include "utility/Exception.hpp"
+#include "utility/FPWrap.hpp"
+
+namespace Bed {
+
+  /*
+    bin_iterator<> generates fixed-size, coordinate-only BedType elements over a set
+      of regions, without reading them from disk.  Regions come from either:
+        - a chromosome sizes file (<chrom> <tab> <size>), which need not be sorted, or
+        - a BED file sorted per sort-bed.  Overlapping and adjacent regions are merged
+          first, so bins match those of 'bedops --chop <size> [--stagger <stagger>]'.
+    Only two BedType objects ever exist per iterator.  operator*() hands out one while
+      the next bin is written into the other, which is all that sweep() requires since
+      it is finished with a reference element before fetching the one after next.  No
+      text formatting and no pooled allocation is performed for the generated elements.
+  */
+  template <class BedType>
+  class bin_iterator;
+
+  template <class BedType>
+  class bin_iterator<BedType*> {
+
+    struct Region {
+      Region() : start_(0), end_(0) { /* */ }
+      std::string chrom_;
+      CoordType start_;
+      CoordType end_;
+    };
+
+    struct State {
+      State(FILE* fp, const std::string& name, CoordType binSize, CoordType stagger, const std::string& chr)
+        : fp_(fp), name_(name), binSize_(binSize), step_((0 == stagger) ? binSize : stagger),
+          all_(chr == "all"), chr_(chr), sizesFile_(false), sizesIdx_(0),
+          hasRegion_(false), hasPending_(false), pos_(0), lastStart_(0), which_(0) { /* */ }
+
+      FILE* fp_;
+      const std::string name_;
+      const CoordType binSize_;
+      const CoordType step_;
+      const bool all_;
+      const std::string chr_;
+      bool sizesFile_;
+      std::vector<Region> sizes_;
+      std::size_t sizesIdx_;
+      Region region_;
+      bool hasRegion_;
+      Region pending_;
+      bool hasPending_;
+      CoordType pos_;
+      std::string lastChrom_;
+      CoordType lastStart_;
+      std::string line_;
+      BedType bins_[2];
+      int which_;
+    };
+
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef BedType*                  value_type;
+    typedef std::ptrdiff_t            difference_type;
+    typedef BedType**                 pointer;
+    typedef BedType*&                 reference;
+
+    bin_iterator() : _M_ok(false), _M_value(0) { /* */ }
+
+    template <typename ErrorType>
+    bin_iterator(Ext::FPWrap<ErrorType>& fp, CoordType binSize, CoordType stagger,
+                 const std::string& chr = "all") /* this ASSUMES fp is open and meaningful */
+      : state_(std::make_shared<State>(fp, fp.Name(), binSize, stagger, chr)), _M_ok(true), _M_value(0) {
+
+      if ( 0 == binSize )
+        throw(Ext::ProgramError("bin_iterator<> requires a bin size > 0"));
+
+      // chromosome sizes or BED?  The first data line decides
+      Region r;
+      const int numFields = readRegion(r);
+      if ( 2 == numFields ) {
+        state_->sizesFile_ = true;
+        do {
+          if ( state_->all_ || r.chrom_ == state_->chr_ )
+            state_->sizes_.push_back(r);
+        } while ( 2 == readRegion(r) );
+        if ( !std::feof(state_->fp_) )
+          throw(Ext::InvalidFile("Mixed chromosome sizes and BED content in: " + fp.Name()));
+        std::sort(state_->sizes_.begin(), state_->sizes_.end(), lexCompare);
+        for ( std::size_t i = 1; i < state_->sizes_.size(); ++i ) {
+          if ( state_->sizes_[i-1].chrom_ == state_->sizes_[i].chrom_ )
+            throw(Ext::InvalidFile("Duplicate chromosome " + state_->sizes_[i].chrom_ + " in: " + fp.Name()));
+        } // for
+      } else if ( 0 != numFields ) {
+        checkOrder(r);
+        if ( state_->all_ || r.chrom_ == state_->chr_ ) {
+          state_->pending_ = r;
+          state_->hasPending_ = true;
+        }
+      }
+      _M_value = nextBin();
+      _M_ok = (_M_value != 0);
+    }
+
+    reference operator*() { return _M_value; }
+    pointer operator->() { return &(operator*()); }
+
+    bin_iterator& operator++() {
+      if ( _M_ok ) {
+        _M_value = nextBin();
+        _M_ok = (_M_value != 0);
+      }
+      return *this;
+    }
+
+    bin_iterator operator++(int) {
+      auto __tmp = *this;
+      ++*this;
+      return __tmp;
+    }
+
+    bool _M_equal(const bin_iterator& __x) const {
+      return (
+               (_M_ok == __x._M_ok) &&
+               (!_M_ok || state_ == __x.state_)
+             );
+    }
+
+  private:
+    static bool lexCompare(const Region& a, const Region& b)
+      { return std::strcmp(a.chrom_.c_str(), b.chrom_.c_str()) < 0; }
+
+    // returns the number of coordinate fields found on the next data line (2 or 3), or
+    //  0 at end of input.  Headers and comment lines are skipped.
+    int readRegion(Region& r) {
+      static char buf[4096];
+      std::string& line = state_->line_;
+      while ( true ) {
+        line.clear();
+        while ( std::fgets(buf, sizeof(buf), state_->fp_) ) {
+          line += buf;
+          if ( !line.empty() && line[line.size()-1] == '\n' )
+            break;
+        } // while
+        if ( line.empty() )
+          return 0;
+        if ( line[line.size()-1] == '\n' )
+          line.resize(line.size()-1);
+        if ( line.empty() || line[0] == '#' || 0 == line.compare(0, 5, "track") || 0 == line.compare(0, 7, "browser") )
+          continue;
+        break;
+      } // while
+
+      const std::size_t tab = line.find('\t');
+      if ( tab == std::string::npos || tab == 0 || tab > MAXCHROMSIZE )
+        throw(Ext::InvalidFile("Bad region line in " + state_->name_ + ": " + line));
+      r.chrom_.assign(line, 0, tab);
+
+      char const* p = line.c_str() + tab + 1;
+      char* q = NULL;
+      if ( !std::isdigit(*p) )
+        throw(Ext::InvalidFile("Bad region line in " + state_->name_ + ": " + line));
+      r.start_ = std::strtoull(p, &q, 10);
+      if ( *q == '\0' || (*q == '\t' && !std::isdigit(q[1])) ) { // chromosome sizes
+        r.end_ = r.start_;
+        r.start_ = 0;
+        return 2;
+      }
+      if ( *q != '\t' )
+        throw(Ext::InvalidFile("Bad region line in " + state_->name_ + ": " + line));
+      p = q + 1;
+      r.end_ = std::strtoull(p, &q, 10);
+      if ( (*q != '\0' && *q != '\t') || r.end_ < r.start_ )
+        throw(Ext::InvalidFile("Bad region line in " + state_->name_ + ": " + line));
+      return 3;
+    }
+
+    void checkOrder(const Region& r) {
+      const int cmp = std::strcmp(r.chrom_.c_str(), state_->lastChrom_.c_str());
+      if ( cmp < 0 || (0 == cmp && r.start_ < state_->lastStart_) )
+        throw(Ext::InvalidFile("Regions are not sorted per sort-bed in: " + state_->name_));
+      if ( 0 != cmp )
+        state_->lastChrom_ = r.chrom_;
+      state_->lastStart_ = r.start_;
+    }
+
+    // next region, after merging any overlapping or adjacent BED regions
+    bool nextRegion(Region& r) {
+      if ( state_->sizesFile_ ) {
+        if ( state_->sizesIdx_ == state_->sizes_.size() )
+          return false;
+        r = state_->sizes_[state_->sizesIdx_++];
+        return true;
+      }
+
+      Region n;
+      while ( !state_->hasPending_ ) {
+        const int numFields = readRegion(n);
+        if ( 0 == numFields )
+          return false;
+        if ( 3 != numFields )
+          throw(Ext::InvalidFile("Mixed chromosome sizes and BED content in: " + state_->name_));
+        checkOrder(n);
+        if ( state_->all_ || n.chrom_ == state_->chr_ ) {
+          state_->pending_ = n;
+          state_->hasPending_ = true;
+        }
+      } // while
+
+      r = state_->pending_;
+      state_->hasPending_ = false;
+      int numFields = 0;
+      while ( 0 != (numFields = readRegion(n)) ) {
+        if ( 3 != numFields )
+          throw(Ext::InvalidFile("Mixed chromosome sizes and BED content in: " + state_->name_));
+        checkOrder(n);
+        if ( !state_->all_ && n.chrom_ != state_->chr_ )
+          continue;
+        if ( n.chrom_ == r.chrom_ && n.start_ <= r.end_ ) {
+          r.end_ = std::max(r.end_, n.end_);
+          continue;
+        }
+        state_->pending_ = n;
+        state_->hasPending_ = true;
+        break;
+      } // while
+      return true;
+    }
+
+    BedType* nextBin() {
+      State& s = *state_;
+      while ( !s.hasRegion_ || s.pos_ >= s.region_.end_ ) {
+        if ( !nextRegion(s.region_) ) {
+          s.hasRegion_ = false;
+          return(0);
+        }
+        s.hasRegion_ = true;
+        s.pos_ = s.region_.start_;
+      } // while
+
+      s.which_ = 1 - s.which_;
+      BedType* b = &s.bins_[s.which_];
+      if ( 0 != std::strcmp(b->chrom(), s.region_.chrom_.c_str()) )
+        b->chrom(s.region_.chrom_.c_str());
+      b->start(s.pos_);
+      if ( s.region_.end_ - s.pos_ > s.binSize_ )
+        b->end(s.pos_ + s.binSize_);
+      else
+        b->end(s.region_.end_);
+      s.pos_ += s.step_;
+      return(b);
+    }
+
+  private:
+    std::shared_ptr<State> state_;
+    bool _M_ok;
+    BedType* _M_value;
+  };
+
+  template <class BedType>
+  inline bool
+  operator==(const bin_iterator<BedType>& __x,
+             const bin_iterator<BedType>& __y) {
+    return __x._M_equal(__y);
+  }
+
+  template <class BedType>
+  inline bool
+  operator!=(const bin_iterator<BedType>& __x,
+             const bin_iterator<BedType>& __y) {
+    return !__x._M_equal(__y);
+  }
+
+} // namespace Bed
+
+#endif // BED_BIN_GENERATING_ITERATOR_HPP
@@ -0,0 +1,327 @@
+/*
+  Author: Shane Neph & Alex Reynolds
+  Date:   Sun Oct 18 15:48:02 PDT 2026
+*/
+//
+//    BEDOPS
+//    Copyright (C) 2011-2018 Shane Neph, Scott Kuehn and Alex Reynolds
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License along
+//    with this program; if not, write to the Free Software Foundation, Inc.,
+//    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+#ifndef BED_BINARY_STREAM_HPP
+#define BED_BINARY_STREAM_HPP
+
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <istream>
+#include <string>
+#include <type_traits>
+
+#include "data/bed/Bed.hpp"
+#include "utility/Exception.hpp"
+#include "utility/StdoutRows.hpp"
+
+namespace Bed {
+
+  /*
+    Binary BED stream, for piping one BEDOPS program into another without printing
+      and re-scanning every row as text.  Layout, in native byte order (these
+      streams are meant for pipes and scratch files on one host):
+        header:  8 bytes  "\0BEDOPS1"
+                 4 bytes  uint32 0x01020304, to catch a byte order mismatch
+        records: 4 bytes  uint32 tag
+                 8 bytes  uint64 start
+                 8 bytes  uint64 end
+                 tag bytes of everything after the 3rd column, without its leading tab
+    A record tagged ChromTag names the chromosome of the records that follow it: its
+      start holds the length of the name, which comes next.  Producers emit one each
+      time the chromosome changes, so the chromosome table is built as the stream
+      goes rather than up front.
+    Text BED never starts with '\0', which is how readers tell the two apart with a
+      single byte of lookahead, on pipes as well as on files.
+  */
+  namespace binary_details {
+    constexpr char Magic[] = { '\0', 'B', 'E', 'D', 'O', 'P', 'S', '1' };
+    constexpr std::size_t MagicSize = sizeof(Magic);
+    constexpr std::uint32_t ByteOrder = 0x01020304;
+    constexpr std::uint32_t ChromTag = 0xffffffff;
+    constexpr std::size_t HeadSize = sizeof(std::uint32_t) + 2 * sizeof(std::uint64_t);
+
+    inline std::size_t get(FILE* fp, void* p, std::size_t n)
+      { return std::fread(p, 1, n, fp); }
+
+    inline std::size_t get(std::istream* is, void* p, std::size_t n) {
+      is->read(static_cast<char*>(p), n);
+      return static_cast<std::size_t>(is->gcount());
+    }
+
+    inline bool leadsWithNull(FILE* fp) {
+      const int c = std::fgetc(fp);
+      if ( c == EOF )
+        return false;
+      std::ungetc(c, fp);
+      return (c == '\0');
+    }
+
+    inline bool leadsWithNull(std::istream* is) {
+      return (is->peek() == '\0');
+    }
+  } // namespace binary_details
+
+
+  //=================
+  // BinaryBedReader : Source is FILE* or std::istream*
+  //=================
+  template <typename Source>
+  class BinaryBedReader {
+  public:
+    BinaryBedReader(Source src, const std::string& name)
+      : src_(src), name_(name), start_(0), end_(0) { /* */ }
+
+    // true, and the header consumed, if src holds a binary stream.  Otherwise src is
+    //  left as it was found.
+    static bool isBinary(Source src, const std::string& name) {
+      using namespace binary_details;
+      if ( !leadsWithNull(src) )
+        return false;
+      char m[MagicSize];
+      std::uint32_t order = 0;
+      if ( get(src, m, MagicSize) != MagicSize || 0 != std::memcmp(m, Magic, MagicSize) )
+        throw(Ext::InvalidFile("Unrecognized binary input in: " + name));
+      if ( get(src, &order, sizeof(order)) != sizeof(order) || order != ByteOrder )
+        throw(Ext::InvalidFile("Binary input was written with a different byte order: " + name));
+      return true;
+    }
+
+    // false at the end of the stream
+    bool next() {
+      using namespace binary_details;
+      char head[HeadSize];
+      std::uint32_t tag = 0;
+      while ( true ) {
+        const std::size_t got = get(src_, head, HeadSize);
+        if ( 0 == got )
+          return false;
+        else if ( got != HeadSize )
+          throw(Ext::InvalidFile("Truncated binary input in: " + name_));
+        std::memcpy(&tag, head, sizeof(tag));
+        std::memcpy(&start_, head + sizeof(tag), sizeof(start_));
+        std::memcpy(&end_, head + sizeof(tag) + sizeof(start_), sizeof(end_));
+        if ( tag != ChromTag )
+          break;
+        if ( 0 == start_ || start_ > MAXCHROMSIZE )
+          throw(Ext::InvalidFile("Bad chromosome name length in binary input: " + name_));
+        chrom_.resize(start_);
+        if ( get(src_, &chrom_[0], chrom_.size()) != chrom_.size() )
+          throw(Ext::InvalidFile("Truncated binary input in: " + name_));
+      } // while
+
+      if ( chrom_.empty() )
+        throw(Ext::InvalidFile("Binary input has a record before any chromosome: " + name_));
+      if ( tag >= MAXRESTSIZE )
+        throw(Ext::InvalidFile("Binary input has a row that cannot fit into MAXRESTSIZE chars: " + name_));
+      fullrest_.resize(tag ? tag + 1 : 0);
+      if ( tag ) {
+        fullrest_[0] = '\t';
+        if ( get(src_, &fullrest_[1], tag) != tag )
+          throw(Ext::InvalidFile("Truncated binary input in: " + name_));
+      }
+      return true;
+    }
+
+    char const* chrom() const { return chrom_.c_str(); }
+    CoordType start() const { return start_; }
+    CoordType end() const { return end_; }
+    char const* full_rest() const { return fullrest_.c_str(); } /* leading tab, if non-empty */
+
+    // the current record as a BED row
+    void line(std::string& s) const {
+      s = chrom_;
+      s += '\t';
+      s += std::to_string(start_);
+      s += '\t';
+      s += std::to_string(end_);
+      s += fullrest_;
+    }
+
+  private:
+    Source src_;
+    const std::string name_;
+    std::string chrom_;
+    std::uint64_t start_, end_;
+    std::string fullrest_;
+  };
+
+  // Construct a BedType from the current record of a BinaryBedReader or a
+  //  StarchRecordReader.  Three-column types are built straight from the fields;
+  //  the others parse the row as text.
+  template <typename BedType, typename Reader>
+  inline typename std::enable_if<BedType::NumFields == 3 && !BedType::UseRest, BedType*>::type
+  make_binary(const Reader& r, std::string&) {
+    return new BedType(r.chrom(), r.start(), r.end());
+  }
+
+  template <typename BedType, typename Reader>
+  inline typename std::enable_if<BedType::NumFields == 3 && BedType::UseRest, BedType*>::type
+  make_binary(const Reader& r, std::string&) {
+    return new BedType(r.chrom(), r.start(), r.end(), r.full_rest());
+  }
+
+  template <typename BedType, typename Reader>
+  inline typename std::enable_if<(BedType::NumFields > 3), BedType*>::type
+  make_binary(const Reader& r, std::string& buf) {
+    r.line(buf);
+    return new BedType(buf);
+  }
+
+  template <typename BedType, typename Pool, typename Reader>
+  inline typename std::enable_if<BedType::NumFields == 3 && !BedType::UseRest, BedType*>::type
+  make_binary(Pool& p, const Reader& r, std::string&) {
+    return p.construct(r.chrom(), r.start(), r.end());
+  }
+
+  template <typename BedType, typename Pool, typename Reader>
+  inline typename std::enable_if<BedType::NumFields == 3 && BedType::UseRest, BedType*>::type
+  make_binary(Pool& p, const Reader& r, std::string&) {
+    return p.construct(r.chrom(), r.start(), r.end(), r.full_rest());
+  }
+
+  template <typename BedType, typename Pool, typename Reader>
+  inline typename std::enable_if<(BedType::NumFields > 3), BedType*>::type
+  make_binary(Pool& p, const Reader& r, std::string& buf) {
+    r.line(buf);
+    return p.construct(buf);
+  }
+
+
+  //=================
+  // BinaryBedWriter
+  //=================
+  class BinaryBedWriter {
+  public:
+    explicit BinaryBedWriter(FILE* out) : out_(out) {
+      using namespace binary_details;
+      const std::uint32_t order = ByteOrder;
+      std::fwrite(Magic, 1, MagicSize, out_);
+      std::fwrite(&order, sizeof(order), 1, out_);
+    }
+
+    // rest is everything after the 3rd column, without its leading tab
+    void write(char const* chrom, CoordType start, CoordType end, char const* rest, std::size_t restLength) {
+      using namespace binary_details;
+      if ( 0 != std::strcmp(chrom, chrom_.c_str()) ) {
+        chrom_ = chrom;
+        put(ChromTag, chrom_.size(), 0);
+        std::fwrite(chrom_.c_str(), 1, chrom_.size(), out_);
+      }
+      put(static_cast<std::uint32_t>(restLength), start, end);
+      if ( restLength )
+        std::fwrite(rest, 1, restLength, out_);
+    }
+
+    template <typename BedType>
+    typename std::enable_if<BedType::UseRest, void>::type
+    write(const BedType* b) {
+      char const* r = b->full_rest(); // leading tab, if non-empty
+      if ( *r == '\t' )
+        ++r;
+      write(b->chrom(), b->start(), b->end(), r, std::strlen(r));
+    }
+
+    template <typename BedType>
+    typename std::enable_if<!BedType::UseRest && BedType::NumFields == 3, void>::type
+    write(const BedType* b) {
+      write(b->chrom(), b->start(), b->end(), "", 0);
+    }
+
+    void flush() { std::fflush(out_); }
+
+  private:
+    BinaryBedWriter(const BinaryBedWriter&); // not safe to copy
+    BinaryBedWriter& operator=(const BinaryBedWriter&);
+
+    void put(std::uint32_t tag, std::uint64_t a, std::uint64_t b) {
+      char head[binary_details::HeadSize];
+      std::memcpy(head, &tag, sizeof(tag));
+      std::memcpy(head + sizeof(tag), &a, sizeof(a));
+      std::memcpy(head + sizeof(tag) + sizeof(a), &b, sizeof(b));
+      std::fwrite(head, 1, sizeof(head), out_);
+    }
+
+  private:
+    FILE* out_;
+    std::string chrom_;
+  };
+
+
+  /*
+    BinaryStdout sends the rows a program prints to stdout out as a binary stream.
+      It is for programs whose rows are composed in many places (bedmap and
+      closest-features), where each row must still be BED: the leading chromosome,
+      start and end are pulled off and the rest passes through as is.  Programs that
+      print whole Bed objects should hand them to a BinaryBedWriter instead.
+  */
+  class BinaryStdout {
+  public:
+    BinaryStdout() : writer_(stdout), rows_(*this) { /* writer_ takes stdout before rows_ replaces it */ }
+
+    void Finish() {
+      const bool ok = rows_.Finish();
+      writer_.flush();
+      if ( !ok )
+        throw(Ext::DataError("Binary output requires BED rows: <chrom><tab><start><tab><end>[<tab>...].\nSee row: " + bad_));
+    }
+
+  private:
+    friend class Ext::StdoutRows<BinaryStdout>;
+
+    bool row(char const* line) {
+      char const* p = std::strchr(line, '\t');
+      char* q = NULL;
+      CoordType start = 0, end = 0;
+      bool ok = (p != NULL && p != line && static_cast<CoordType>(p - line) <= MAXCHROMSIZE);
+      if ( ok && (ok = (std::isdigit(p[1]) != 0)) ) {
+        start = std::strtoull(p + 1, &q, 10);
+        ok = (*q == '\t' && std::isdigit(q[1]));
+      }
+      if ( ok ) {
+        end = std::strtoull(q + 1, &q, 10);
+        ok = (*q == '\0' || *q == '\t');
+      }
+      if ( !ok ) {
+        bad_ = line;
+        return false;
+      }
+      chrom_.assign(line, p - line);
+      if ( *q == '\t' )
+        ++q;
+      writer_.write(chrom_.c_str(), start, end, q, std::strlen(q));
+      return true;
+    }
+
+  private:
+    BinaryBedWriter writer_;
+    Ext::StdoutRows<BinaryStdout> rows_;
+    std::string chrom_;
+    std::string bad_;
+  };
+
+} // namespace Bed
+
+#endif // BED_BINARY_STREAM_HPP
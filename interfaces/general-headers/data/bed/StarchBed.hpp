@@ -0,0 +1,101 @@
+/*
+  Author: Shane Neph & Alex Reynolds
+  Date:   Sun Oct 18 21:12:40 PDT 2026
+*/
+//
+//    BEDOPS
+//    Copyright (C) 2011-2018 Shane Neph, Scott Kuehn and Alex Reynolds
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License along
+//    with this program; if not, write to the Free Software Foundation, Inc.,
+//    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+#ifndef BED_STARCH_RECORD_HPP
+#define BED_STARCH_RECORD_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+#include "data/bed/Bed.hpp"
+#include "data/starch/starchApi.hpp"
+#include "utility/Exception.hpp"
+
+namespace Bed {
+
+  //===================
+  // StarchRecordReader
+  //===================
+  /*
+    The record last decoded from a Starch archive, through the same interface as
+      BinaryBedReader, so that make_binary() builds Bed objects from the decoded
+      fields.  Three-column types then skip formatting each row to text and
+      scanning it back.  The fields are good until the archive's next extraction.
+  */
+  class StarchRecordReader {
+  public:
+    StarchRecordReader()
+      : chrom_(""), start_(0), end_(0), rest_(""), restLength_(0), hasFullRest_(false) { /* */ }
+
+    // false at the end of the archive, or of its selected chromosome or region
+    bool next(starch::Starch& archive) {
+      if ( !archive.extractBEDRecord(chrom_, start_, end_, rest_, restLength_) )
+        return false;
+      if ( restLength_ >= MAXRESTSIZE )
+        throw(Ext::InvalidFile("Starch archive has a row that cannot fit into MAXRESTSIZE chars"));
+      hasFullRest_ = false;
+      return true;
+    }
+
+    char const* chrom() const { return chrom_; }
+    CoordType start() const { return start_; }
+    CoordType end() const { return end_; }
+
+    char const* full_rest() const { /* leading tab, if non-empty */
+      if ( !hasFullRest_ ) {
+        fullrest_.resize(restLength_ ? restLength_ + 1 : 0);
+        if ( restLength_ ) {
+          fullrest_[0] = '\t';
+          std::memcpy(&fullrest_[1], rest_, restLength_);
+        }
+        hasFullRest_ = true;
+      }
+      return fullrest_.c_str();
+    }
+
+    // the current record as a BED row
+    void line(std::string& s) const {
+      s = chrom_;
+      s += '\t';
+      s += std::to_string(start_);
+      s += '\t';
+      s += std::to_string(end_);
+      if ( restLength_ ) {
+        s += '\t';
+        s.append(rest_, restLength_);
+      }
+    }
+
+  private:
+    char const* chrom_;
+    CoordType start_, end_;
+    char const* rest_; /* no leading tab */
+    std::size_t restLength_;
+    mutable std::string fullrest_;
+    mutable bool hasFullRest_;
+  };
+
+} // namespace Bed
+
+#endif // BED_STARCH_RECORD_HPP
@@ -62,12 +62,18 @@ namespace starch
             Starch(const std::string&, const bool);
             Starch(const std::string&, const bool, const bool, const std::string&);
             Starch(const std::string&, const bool, const bool, Metadata *, CompressionType, ArchiveVersion *, uint64_t, unsigned int);
+            Starch(const Starch&, const std::string&);
+            Starch(FILE *, const std::string&, Bed::CoordType, Bed::CoordType);
             virtual ~Starch();
             Starch(const Starch& cpArchive);            
             Starch& operator=(const Starch& cpArchive);
 
             int listJSONMetadata(FILE *out, FILE *err);
             bool extractBEDLine(std::string& line);
+            bool extractBEDRecord(const char*& chr, Bed::CoordType& start, Bed::CoordType& stop, const char*& rest);
+            bool extractBEDRecord(const char*& chr, Bed::CoordType& start, Bed::CoordType& stop, const char*& rest, std::size_t& restLen);
+            bool seekRegion(const std::string& chr, Bed::CoordType start, Bed::CoordType end);
+            void setRestFlag(bool _restFlag) { restFlag = _restFlag; }
             int extractAllData(const std::string& chr, FILE *out);
 
             static bool fnExists(const std::string& _inFn) 
@@ -727,6 +733,9 @@ namespace starch
         bool                            getAllChromosomesHaveDuplicateElement() { Metadata *_archMdIter; for (_archMdIter = archMd; _archMdIter != NULL; _archMdIter = _archMdIter->next) { if (UNSTARCH_duplicateElementExistsForChromosome(archMd, _archMdIter->chromosome) == kStarchTrue) return true; } return false; }
         bool                            getAllChromosomesHaveNestedElement() { Metadata *_archMdIter; for (_archMdIter = archMd; _archMdIter != NULL; _archMdIter = _archMdIter->next) { if (UNSTARCH_nestedElementExistsForChromosome(archMd, _archMdIter->chromosome) == kStarchTrue) return true; } return false; }
         inline bool                     isEOF() { return (!getCurrentChromosome()); }
+        // when false, the rest of each record of a columnar stream is passed over, 
+        // and its records are extracted without it
+        inline bool                     getRestFlag() { return restFlag; }
 
         // ------------        
 
@@ -748,6 +757,7 @@ namespace starch
         std::string selectedChromosome;
         uint64_t cumulativeSize;
         BZFILE *bzFp;
+        uint64_t bzBlockIdx;
         unsigned char *bzOutput;
         z_stream zStream;
         char *zOutput;
@@ -765,6 +775,8 @@ namespace starch
         bool postBreakdownZValuesIdentical;
         bool allowHeadersFlag;
         bool perLineUsageFlag;            
+        bool recordOnlyFlag;
+        std::string recordLine;
         char *currentChromosome;
         Bed::SignedCoordType currentStart;
         Bed::SignedCoordType currentStop;
@@ -780,6 +792,12 @@ namespace starch
         Bed::SignedCoordType _currStop;
         char *_currRemainder;
         size_t _currRemainderLen;
+        bool regionFlag;
+        Bed::SignedCoordType regionStart;
+        Bed::SignedCoordType regionEnd;
+        bool restFlag;
+        StarchColumnarBlock columnarBlock;
+        uint64_t columnarBlockIdx;
         
         int initializeMembers();
         int setupBzip2Works();
@@ -791,6 +809,9 @@ namespace starch
         int zReadChunk();
         int zReadLine();
         int extractLine(std::string& line);
+        int extractColumnarLine(std::string& line);
+        bool extractNextBEDLine(std::string& line);
+        int endRegion();
         int setupPerLineAccess();
         int readJSONMetadata(bool suppressErrorMsgs, bool preserveJSONRef);
         
@@ -895,7 +916,7 @@ namespace starch
         void setSelectedChromosome(const std::string& _selChr) { selectedChromosome = _selChr; }
     };
     
-    Starch::Starch() 
+    inline Starch::Starch() 
     {
 #ifdef DEBUG
         std::fprintf(stderr, "\n--- Starch::Starch() ---\n");
@@ -906,7 +927,7 @@ namespace starch
             setupPerLineAccess();
     }
 
-    Starch::Starch(FILE *_inFP, 
+    inline Starch::Starch(FILE *_inFP, 
       const std::string& _chr, 
                     bool _perLineUsage)
     {
@@ -923,7 +944,7 @@ namespace starch
             setupPerLineAccess();
     }
 
-    Starch::Starch(FILE *_inFp, 
+    inline Starch::Starch(FILE *_inFp, 
       const std::string& _inFn, 
       const std::string& _chr, 
                     bool _perLineUsage)
@@ -942,7 +963,7 @@ namespace starch
             setupPerLineAccess();
     }
 
-    Starch::Starch(const std::string& _inFn)
+    inline Starch::Starch(const std::string& _inFn)
     {
 #ifdef DEBUG
         std::fprintf(stderr, "\n--- Starch::Starch(std::string) ---\n");
@@ -955,7 +976,7 @@ namespace starch
             setupPerLineAccess();
     }
 
-    Starch::Starch(const std::string &_inFn, 
+    inline Starch::Starch(const std::string &_inFn, 
                           const bool _allowHeadersFlag) 
     {
 #ifdef DEBUG
@@ -970,7 +991,7 @@ namespace starch
             setupPerLineAccess();
     }
 
-    Starch::Starch(const std::string &_inFn, 
+    inline Starch::Starch(const std::string &_inFn, 
                           const bool _allowHeadersFlag, 
                           const bool _perLineUsageFlag, 
                    const std::string &_selectedChromosome) 
@@ -989,7 +1010,7 @@ namespace starch
             setupPerLineAccess();
     }
 
-    Starch::Starch(const std::string& _inFn, 
+    inline Starch::Starch(const std::string& _inFn, 
                            const bool _allowHeadersFlag,
                            const bool _perLineUsageFlag,
                            Metadata * _md, 
@@ -1024,7 +1045,92 @@ namespace starch
             setupPerLineAccess();
     }    
 
-    Starch::~Starch() 
+    inline Starch::Starch(const Starch& _archive, 
+                          const std::string& _selectedChromosome) 
+    {
+#ifdef DEBUG
+        std::fprintf(stderr, "\n--- Starch::Starch(Starch &, std::string) ---\n");
+#endif
+        /*
+            Reads one chromosome of an archive that is open already, through 
+            a handle of its own, without reading the metadata of the archive 
+            again.  Only the record of the selected chromosome is kept, and 
+            extraction starts at its stream.  Any number of these may read 
+            different chromosomes of _archive at the same time, on different 
+            threads.  Nothing is extracted if there is no such chromosome.
+        */
+
+        const Metadata *_md = NULL;
+
+        initializeMembers();
+
+        inFn = _archive.inFn;
+        allowHeadersFlag = _archive.allowHeadersFlag;
+        perLineUsageFlag = true;
+        restFlag = _archive.restFlag;
+        selectedChromosome = _selectedChromosome;
+        archType = _archive.archType;
+        archMdOffset = _archive.archMdOffset;
+        archStreamOffset = _archive.archStreamOffset;
+        archHeaderFlag = _archive.archHeaderFlag;
+        archShowNewlineFlag = _archive.archShowNewlineFlag;
+        if (_archive.archVersion != NULL) {
+            archVersion = new ArchiveVersion;
+            *archVersion = *_archive.archVersion;
+        }
+
+        for (_md = _archive.archMd; _md != NULL; _md = _md->next) {
+            if (selectedChromosome == _md->chromosome)
+                break;
+            cumulativeSize += _md->size;
+        }
+        if (_md == NULL)
+            return;
+
+        archMd = STARCH_createMetadata(_md->chromosome, 
+                                       _md->filename, 
+                                       _md->size, 
+                                       _md->lineCount, 
+                                       _md->totalNonUniqueBases, 
+                                       _md->totalUniqueBases, 
+                                       _md->duplicateElementExists, 
+                                       _md->nestedElementExists, 
+                                       _md->signature, 
+                                       _md->lineMaxStringLength);
+        if ((!archMd) || (STARCH_setMetadataBlocks(archMd, _md->blocks, _md->numBlocks) != STARCH_EXIT_SUCCESS))
+            throw(std::string("ERROR: could not allocate space for metadata record"));
+
+        inFp = std::fopen(inFn.c_str(), "rbR");
+        if (!inFp)
+            throw("ERROR: could not open handle to " + inFn);
+
+        setupPerLineAccess();
+    }
+
+    inline Starch::Starch(FILE *_inFp, 
+      const std::string& _chr, 
+           Bed::CoordType _start, 
+           Bed::CoordType _end)
+    {
+#ifdef DEBUG
+        std::fprintf(stderr, "\n--- Starch::Starch(FILE *, std::string, Bed::CoordType, Bed::CoordType) ---\n");
+#endif
+        /*
+            Extracts only the records of _chr that overlap [_start, _end); 
+            see seekRegion()
+        */
+
+        initializeMembers();
+
+        inFn = "unknown";
+        inFp = _inFp;
+        selectedChromosome = _chr;
+        perLineUsageFlag = true;
+        setupPerLineAccess();
+        seekRegion(_chr, _start, _end);
+    }
+
+    inline Starch::~Starch() 
     {
 #ifdef DEBUG
         std::fprintf(stderr, "\n--- Starch::~Starch() ---\n");
@@ -1037,9 +1143,10 @@ namespace starch
             std::fclose(inFp), inFp = NULL;
         if (bzOutput != NULL)
             free(bzOutput), bzOutput = NULL;
+        UNSTARCH_freeColumnarBlock(&columnarBlock);
     }
 
-    Starch::Starch(const Starch& cpArchive) 
+    inline Starch::Starch(const Starch& cpArchive) 
     {
 #ifdef DEBUG
         std::fprintf(stderr, "\n--- Starch::Starch(Starch &) ---\n");
@@ -1059,6 +1166,9 @@ namespace starch
         archMdOffset = cpArchive.archMdOffset;
         archHeaderFlag = cpArchive.archHeaderFlag;
         archShowNewlineFlag = cpArchive.archShowNewlineFlag;
+        restFlag = cpArchive.restFlag;
+        std::memset(&columnarBlock, 0, sizeof(columnarBlock));
+        columnarBlockIdx = 0;
 
         if (!inFn.empty()) { 
             inFp = std::fopen(inFn.c_str(), "rbR");
@@ -1067,7 +1177,7 @@ namespace starch
         }
     }
 
-    Starch& 
+    inline Starch& 
     Starch::operator=(const Starch& cpArchive) 
     {
 #ifdef DEBUG
@@ -1103,7 +1213,7 @@ namespace starch
         return *this;
     }
 
-    int 
+    inline int 
     Starch::initializeMembers()
     {
 #ifdef DEBUG
@@ -1125,6 +1235,7 @@ namespace starch
         inFn = "";
         cumulativeSize = 0;
         bzFp = NULL;
+        bzBlockIdx = 0;
         bzOutput = NULL;
         zOutput = NULL;
         zRemainderBuf = NULL;
@@ -1138,6 +1249,7 @@ namespace starch
         zBufOffset = 0;
         allowHeadersFlag = false;
         perLineUsageFlag = false;
+        recordOnlyFlag = false;
         currentChromosome = NULL;
         currentStart = -2LL;
         currentStop = 0;
@@ -1154,6 +1266,12 @@ namespace starch
         _currStop = 0;
         _currRemainder = NULL;
         _currRemainderLen = 0;
+        regionFlag = false;
+        regionStart = 0;
+        regionEnd = 0;
+        restFlag = true;
+        std::memset(&columnarBlock, 0, sizeof(columnarBlock));
+        columnarBlockIdx = 0;
 
         archVersion = new ArchiveVersion;
         if (!archVersion)
@@ -1165,7 +1283,7 @@ namespace starch
         return EXIT_SUCCESS;
     }
 
-    int 
+    inline int 
     Starch::readJSONMetadata(bool _suppressErrorMsgs, bool _preserveJSONRef) 
     {   
 #ifdef DEBUG
@@ -1203,7 +1321,7 @@ namespace starch
         return result;
     }
 
-    int
+    inline int
     Starch::listJSONMetadata(FILE *out, 
                              FILE *err) 
     {
@@ -1224,7 +1342,7 @@ namespace starch
                                        static_cast<const Boolean>( getArchiveShowNewlineFlag() ));
     }
 
-    int
+    inline int
     Starch::setupBzip2Works()
     {
 #ifdef DEBUG
@@ -1238,6 +1356,7 @@ namespace starch
             // opening bzip2 handle...
             // http://www.bzip.org/1.0.5/bzip2-manual-1.0.5.html#bzcompress-init
             bzFp = BZ2_bzReadOpen( &bzError, getInFp(), 0, 0, NULL, 0 ); 
+            bzBlockIdx = 0;
             if (bzError != BZ_OK) {
                 BZ2_bzReadClose( &bzError, bzFp );
                 throw(std::string("ERROR: bzip2 data stream could not be opened"));
@@ -1263,7 +1382,7 @@ namespace starch
         return EXIT_SUCCESS;
     }
 
-    int
+    inline int
     Starch::breakdownBzip2Works()
     {
 #ifdef DEBUG
@@ -1288,7 +1407,7 @@ namespace starch
         return EXIT_SUCCESS;
     }
 
-    int
+    inline int
     Starch::setupGzipWorks()
     {
 #ifdef DEBUG
@@ -1348,7 +1467,7 @@ namespace starch
         return EXIT_SUCCESS;
     }
 
-    int
+    inline int
     Starch::breakdownGzipWorks()
     {
 #ifdef DEBUG
@@ -1378,7 +1497,7 @@ namespace starch
         return EXIT_SUCCESS;
     }
 
-    int
+    inline int
     Starch::setupTransformationParameters()
     {
 #ifdef DEBUG
@@ -1391,6 +1510,11 @@ namespace starch
         t_firstInputToken[0] = '\0';
         t_secondInputToken[0] = '\0';
 
+        // a columnar stream is read again from its first block
+        columnarBlockIdx = 0;
+        columnarBlock.positions[STARCH2_START_COLUMN] = 0;
+        columnarBlock.columnLengths[STARCH2_START_COLUMN] = 0;
+
         /*
             We check the archive version and set the stream offset parameters
             to initialize transformation
@@ -1416,7 +1540,7 @@ namespace starch
         return EXIT_SUCCESS;
     }
 
-    int
+    inline int
     Starch::seekCurrentInFpPosition()
     {
 #ifdef DEBUG
@@ -1434,12 +1558,35 @@ namespace starch
         return EXIT_SUCCESS;
     }
 
-    bool
+    inline bool
     Starch::extractBEDLine(std::string& line)
     {
 #ifdef DEBUG
         std::fprintf(stderr, "\n--- Starch::extractBEDLine(std::string &) ---\n");
 #endif
+        if (!regionFlag)
+            return extractNextBEDLine(line);
+
+        // records are sorted by start, but not by stop: any record before the
+        // end of the region may overlap it, however far back it starts
+        while (extractNextBEDLine(line) && !line.empty()) {
+            if (_currStart >= regionEnd) {
+                endRegion();
+                line.clear();
+                return false;
+            }
+            if (_currStop > regionStart)
+                return true;
+        }
+        return false;
+    }
+
+    inline bool
+    Starch::extractNextBEDLine(std::string& line)
+    {
+#ifdef DEBUG
+        std::fprintf(stderr, "\n--- Starch::extractNextBEDLine(std::string &) ---\n");
+#endif
 
         line.clear();
         while (!isEOF()) {
@@ -1500,7 +1647,152 @@ namespace starch
         return !isEOF();
     }
 
-    int
+    inline bool
+    Starch::extractBEDRecord(const char*& chr, Bed::CoordType& start, Bed::CoordType& stop, const char*& rest)
+    {
+#ifdef DEBUG
+        std::fprintf(stderr, "\n--- Starch::extractBEDRecord(const char*&, Bed::CoordType&, Bed::CoordType&, const char*&) ---\n");
+#endif
+
+        /*
+            Same walk through the archive as extractBEDLine(), but the decoded
+            fields are handed back as-is, with no formatting to (or re-parsing 
+            from) text.  The pointers remain valid until the next extraction 
+            call on this archive.  rest does not include the leading tab and 
+            is empty for BED3 records.
+        */
+
+        recordOnlyFlag = true;
+        const bool hasRecord = extractBEDLine(recordLine) && !recordLine.empty();
+        recordOnlyFlag = false;
+        if (!hasRecord || !_currChr)
+            return false;
+
+        chr = _currChr;
+        start = static_cast<Bed::CoordType>( _currStart );
+        stop = static_cast<Bed::CoordType>( _currStop );
+        rest = (_currRemainder) ? _currRemainder : "";
+        return true;
+    }
+
+    inline bool
+    Starch::extractBEDRecord(const char*& chr, Bed::CoordType& start, Bed::CoordType& stop, const char*& rest, std::size_t& restLen)
+    {
+#ifdef DEBUG
+        std::fprintf(stderr, "\n--- Starch::extractBEDRecord(const char*&, Bed::CoordType&, Bed::CoordType&, const char*&, std::size_t&) ---\n");
+#endif
+
+        /*
+            As above, also giving the length of rest, for callers that copy it
+        */
+
+        if (!extractBEDRecord(chr, start, stop, rest))
+            return false;
+        restLen = std::strlen(rest);
+        return true;
+    }
+
+    inline bool
+    Starch::seekRegion(const std::string& _chr, Bed::CoordType _start, Bed::CoordType _end)
+    {
+#ifdef DEBUG
+        std::fprintf(stderr, "\n--- Starch::seekRegion(std::string, Bed::CoordType, Bed::CoordType) ---\n");
+#endif
+
+        /*
+            Limits extraction to the records of _chr that overlap [_start, _end).
+            In a block-indexed stream, decompression starts at the first block
+            whose maxEnd (the greatest stop coordinate so far) lies past _start,
+            so that long elements from earlier blocks are not missed, and ends
+            at the first record that starts at or past _end.  Other streams are
+            read from their start.  Returns false if there is no such
+            chromosome, in which case nothing is extracted.
+        */
+
+        Metadata *_md = NULL;
+        uint64_t _offset = 0;
+        uint64_t _blockIdx = 0;
+
+        if (!archMd)
+            readJSONMetadata(false, false);
+        endRegion();
+
+        for (_md = archMd; _md != NULL; _md = _md->next) {
+            if (_chr == _md->chromosome)
+                break;
+            _offset += _md->size;
+        }
+        selectedChromosome = _chr;
+        firstPass = true;
+        regionFlag = true;
+        regionStart = static_cast<Bed::SignedCoordType>( _start );
+        regionEnd = static_cast<Bed::SignedCoordType>( _end );
+        if ((!_md) || (regionStart >= regionEnd))
+            return (_md != NULL);
+
+        if (_md->numBlocks > 0) {
+            _blockIdx = UNSTARCH_firstBlockOfRegion(_md, regionStart);
+            if (_blockIdx == _md->numBlocks)
+                return true;
+        }
+
+        setArchiveMdIter(_md);
+        setCurrentChromosome(_md->chromosome);
+        cumulativeSize = _offset + _md->size; // as seekCurrentInFpPosition() leaves it
+        setupTransformationParameters();
+        if (STARCH_fseeko( getInFp(), static_cast<off_t>( archStreamOffset + _offset + ((_md->numBlocks > 0) ? _md->blocks[_blockIdx].offset : 0) ), SEEK_SET ) != 0)
+            throw(std::string("ERROR: could not seek data in archive"));
+
+        switch (archType) {
+            case kBzip2: {
+                setupBzip2Works();
+                bzBlockIdx = _blockIdx;
+                break;
+            }
+            case kGzip: {
+                zBufIdx = 0;
+                zOutBufIdx = 0;
+                zHave = 0;
+                setupGzipWorks();
+                // past the first block, the flushed z-stream goes on with raw
+                // deflate data, without a zlib header
+                if ((_blockIdx > 0) && (!STARCH_isColumnarStream(_md)) && (inflateReset2(&zStream, -MAX_WBITS) != Z_OK))
+                    throw(std::string("ERROR: could not reset z-stream for block"));
+                break;
+            }
+            case kUndefined: {
+                throw(std::string("ERROR: backend compression type is undefined"));
+            }
+        }
+
+        // blocks go on from where the stop coordinate of the previous block left off
+        t_lastEnd = (_blockIdx > 0) ? _md->blocks[_blockIdx - 1].lastEnd : 0;
+        columnarBlockIdx = _blockIdx;
+
+        return true;
+    }
+
+    inline int
+    Starch::endRegion()
+    {
+#ifdef DEBUG
+        std::fprintf(stderr, "\n--- Starch::endRegion() ---\n");
+#endif
+        // closes any open stream and leaves the archive at its end
+        if (bzFp)
+            breakdownBzip2Works();
+        if (zInBuf)
+            breakdownGzipWorks();
+        postBreakdownZValuesIdentical = false;
+        archMdIter = NULL;
+        if (currentChromosome) free(currentChromosome), currentChromosome = NULL;
+        if (_currChr) free(_currChr), _currChr = NULL;
+        if (_currRemainder) free(_currRemainder), _currRemainder = NULL;
+
+        return EXIT_SUCCESS;
+    }
+
+    inline int
     Starch::extractLine(std::string& line)
     { 
 #ifdef DEBUG
@@ -1515,10 +1807,14 @@ namespace starch
 #ifdef DEBUG
             std::fprintf(stderr, "getCurrentChromosome [ %s ]\n", getCurrentChromosome());
 #endif
+            // a columnar stream is read a block at a time, without reverse transformation
+            if (STARCH_isColumnarStream(archMdIter))
+                return extractColumnarLine(line);
+
             switch (archType) {
                 case kBzip2: {
                     // extract untransformed line from archive
-                    UNSTARCH_bzReadLine(bzFp, &bzOutput);
+                    UNSTARCH_bzReadBlockLine(&bzFp, getInFp(), archMdIter, cumulativeSize - archMdIter->size + archStreamOffset, &bzBlockIdx, &bzOutput);
                     if (bzOutput) {
 #ifdef DEBUG
                         std::fprintf(stderr, "--> bzOutput [ %s ]\n", bzOutput);
@@ -1792,17 +2088,25 @@ namespace starch
 #endif
             setCurrentStart(_currStart);
             setCurrentStop(_currStop);
-            if (_currRemainder) {
-                setCurrentRemainder(_currRemainder);
-            }
 
-            if (_currRemainder && (_currRemainderLen > 0)) {
-                std::sprintf(out, "%s\t%" PRId64 "\t%" PRId64 "\t%s", _currChr, _currStart, _currStop, _currRemainder);
+            if (recordOnlyFlag) {
+                // extractBEDRecord() reads the _curr* fields directly; a non-empty
+                // placeholder is all extractBEDLine() needs to see a record is ready
+                line.assign(1, tab);
             }
             else {
-                std::sprintf(out, "%s\t%" PRId64 "\t%" PRId64, _currChr, _currStart, _currStop);
+                if (_currRemainder) {
+                    setCurrentRemainder(_currRemainder);
+                }
+
+                if (_currRemainder && (_currRemainderLen > 0)) {
+                    std::sprintf(out, "%s\t%" PRId64 "\t%" PRId64 "\t%s", _currChr, _currStart, _currStop, _currRemainder);
+                }
+                else {
+                    std::sprintf(out, "%s\t%" PRId64 "\t%" PRId64, _currChr, _currStart, _currStop);
+                }
+                line = out;
             }
-            line = out;
 
             if (archType == kGzip)
                 postBreakdownZValuesIdentical = (zOutBufIdx == zHave);
@@ -1811,7 +2115,87 @@ namespace starch
         return EXIT_SUCCESS;
     }
 
-    int 
+    inline int
+    Starch::extractColumnarLine(std::string& line)
+    {
+#ifdef DEBUG
+        std::fprintf(stderr, "\n--- Starch::extractColumnarLine(std::string &) ---\n");
+#endif
+
+        static char out[STARCH_BUFFER_MAX_LENGTH];
+        char *rest = NULL;
+        size_t restLen = 0;
+        size_t chrLen = 0;
+        int res = 0;
+
+        while ((res = UNSTARCH_nextColumnarRecord(&columnarBlock, &_currStart, &_currStop, &rest, &restLen)) != 0) {
+            if (res != 1)
+                throw(std::string("ERROR: could not read record of columnar stream"));
+            if (columnarBlockIdx < archMdIter->numBlocks) {
+                if (UNSTARCH_readColumnarBlock(getInFp(), archMdIter, cumulativeSize - archMdIter->size + archStreamOffset, columnarBlockIdx++, archType, (restFlag) ? kStarchTrue : kStarchFalse, &columnarBlock) != 0)
+                    throw(std::string("ERROR: could not read block of columnar stream"));
+                continue;
+            }
+
+            // at the end of the stream, go on to the next chromosome, as extractLine() does
+            if (archType == kBzip2)
+                breakdownBzip2Works();
+            else {
+                postBreakdownZValuesIdentical = false;
+                zOutBufIdx = 0;
+                breakdownGzipWorks();
+            }
+            if ((std::strcmp(selectedChromosome.c_str(), getCurrentChromosome()) == 0) || (!archMdIter->next)) {
+                archMdIter = NULL;
+                if (currentChromosome) free(currentChromosome), currentChromosome = NULL;
+                if (currentRemainder) free(currentRemainder), currentRemainder = NULL;
+                if (_currChr) free(_currChr), _currChr = NULL;
+                if (_currRemainder) free(_currRemainder), _currRemainder = NULL;
+                line.clear();
+                return EXIT_SUCCESS;
+            }
+            iterateArchiveMdIter();
+            seekCurrentInFpPosition();
+            (archType == kBzip2) ? setupBzip2Works() : setupGzipWorks();
+            return extractLine(line);
+        }
+
+        chrLen = std::strlen(archMdIter->chromosome);
+        if ((!_currChr) || (chrLen + 1 > _currChrLen)) {
+            _currChrLen = (chrLen + 1 > TOKEN_CHR_MAX_LENGTH) ? chrLen + 1 : TOKEN_CHR_MAX_LENGTH;
+            _currChr = static_cast<char *>( std::realloc(_currChr, _currChrLen) );
+            if (!_currChr)
+                throw(std::string("ERROR: ran out of memory while extending chromosome token"));
+        }
+        std::memcpy(_currChr, archMdIter->chromosome, chrLen + 1);
+        if ((!_currRemainder) || (restLen + 1 > _currRemainderLen)) {
+            _currRemainderLen = 2 * (restLen + 1);
+            _currRemainder = static_cast<char *>( std::realloc(_currRemainder, _currRemainderLen) );
+            if (!_currRemainder)
+                throw(std::string("ERROR: ran out of memory while extending remainder token"));
+        }
+        if (restLen > 0)
+            std::memcpy(_currRemainder, rest, restLen);
+        _currRemainder[restLen] = '\0';
+
+        setCurrentStart(_currStart);
+        setCurrentStop(_currStop);
+        if (recordOnlyFlag) {
+            line.assign(1, '\t');
+        }
+        else {
+            setCurrentRemainder(_currRemainder);
+            if (restLen > 0)
+                std::sprintf(out, "%s\t%" PRId64 "\t%" PRId64 "\t%s", _currChr, _currStart, _currStop, _currRemainder);
+            else
+                std::sprintf(out, "%s\t%" PRId64 "\t%" PRId64, _currChr, _currStart, _currStop);
+            line = out;
+        }
+
+        return EXIT_SUCCESS;
+    }
+
+    inline int 
     Starch::zReadChunk()
     {
 #ifdef DEBUG
@@ -1836,7 +2220,7 @@ namespace starch
         return EXIT_SUCCESS;
     }
 
-    int
+    inline int
     Starch::zReadLine()
     {       
         // goal: read through zOutBuf until we hit a newline, then return with
@@ -1970,7 +2354,7 @@ namespace starch
         return EXIT_SUCCESS;
     }
 
-    int 
+    inline int 
     Starch::extractAllData(const std::string& chr, FILE *out)
     {
 #ifdef DEBUG
@@ -2009,7 +2393,7 @@ namespace starch
         return EXIT_SUCCESS;
     }
 
-    int
+    inline int
     Starch::setupPerLineAccess()
     { 
 #ifdef DEBUG
@@ -56,7 +56,29 @@ namespace starch {
 #define STARCH_BZ_SMALL 0
 #define STARCH_BZ_WORKFACTOR 0
 #define STARCH_BZ_ABANDON 0
+#define STARCH_BZ_BLOCK_CAPACITY (100000 * STARCH_BZ_COMPRESSION_LEVEL - 19)
 #define STARCH_RADIX 10
+#define STARCH2_Z_BLOCK_LENGTH STARCH_BUFFER_MAX_LENGTH
+#define STARCH2_BZ_BLOCK_LENGTH (4 * STARCH_BZ_BLOCK_CAPACITY)
+#define STARCH2_Z_DICTIONARY_LENGTH 32768
+#define STARCH2_DEFAULT_INDEX_LINE_COUNT 25000
+#define STARCH2_START_COLUMN 0
+#define STARCH2_LENGTH_COLUMN 1
+#define STARCH2_REST_COLUMN 2
+#define STARCH2_NUM_COLUMNS 3
+#define STARCH_INPUT_BUFFER_MAX_LENGTH 64*1024
+
+typedef struct starch2Writer Starch2Writer;
+typedef struct starch2Block Starch2Block;
+typedef int (*Starch2BlockFunction)(void *pool, Starch2Block *block);
+
+/* BED input read in blocks, handed over a line at a time */
+typedef struct starchInputBuffer {
+    FILE *fp;
+    size_t length;
+    size_t position;
+    char data[STARCH_INPUT_BUFFER_MAX_LENGTH];
+} StarchInputBuffer;
 
 #define STARCH_NONFATAL_ERROR -2
 #define STARCH_FATAL_ERROR -1
@@ -65,6 +87,14 @@ namespace starch {
 
 char *  STARCH_strdup(const char *str);
 
+void    STARCH_initializeInputBuffer(StarchInputBuffer *in,
+                                                FILE *fp);
+
+int     STARCH_readInputLine(StarchInputBuffer *in, 
+                                          char *line, 
+                                  const size_t lineCapacity, 
+                                        size_t *lineLength);
+
 int     STARCH_compressFileWithGzip(const char *inFn, 
                                           char **outFn, 
                                          off_t *outFnSize);
@@ -139,6 +169,44 @@ int     STARCH2_transformHeaderlessBEDInput(const FILE *inFp,
                                          const Boolean reportProgressFlag,
                                    const LineCountType reportProgressN);
 
+int     STARCH2_openWriter(Starch2Writer **w,
+                                    FILE *outFp,
+                   const CompressionType type,
+                              const char *tag,
+                              const char *note,
+                           const Boolean generatePerChrSignatureFlag);
+
+int     STARCH2_addRecordToWriter(Starch2Writer *w,
+                                     const char *chr,
+                                  const int64_t start,
+                                  const int64_t stop,
+                                     const char *remainder);
+
+int     STARCH2_addBEDLineToWriter(Starch2Writer *w,
+                                      const char *line);
+
+int     STARCH2_openChromosomeWriter(Starch2Writer **w,
+                                  const Starch2Writer *archive);
+
+int     STARCH2_appendChromosomeWriter(Starch2Writer *w,
+                                       Starch2Writer **chromosomeWriter);
+
+int     STARCH2_closeWriter(Starch2Writer **w,
+                         const Boolean finalizeFlag);
+
+int     STARCH2_setWriterBlockPool(Starch2Writer *w,
+                            const unsigned int maxBlocks,
+                          Starch2BlockFunction submitBlock,
+                          Starch2BlockFunction waitBlock,
+                                          void *pool);
+
+int     STARCH2_setWriterIndexLineCount(Starch2Writer *w,
+                          const LineCountType indexLineCount);
+
+int     STARCH2_setWriterColumnar(Starch2Writer *w);
+
+int     STARCH2_compressBlock(Starch2Block *block);
+
 int     STARCH2_writeStarchHeaderToOutputFp(const unsigned char *header, 
                                                      const FILE *fp);
 
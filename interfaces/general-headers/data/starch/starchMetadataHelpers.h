@@ -43,7 +43,7 @@
 #endif
 
 #define STARCH_MAJOR_VERSION 2
-#define STARCH_MINOR_VERSION 2
+#define STARCH_MINOR_VERSION 4
 #define STARCH_REVISION_VERSION 0
 
 #define STARCH_DEFAULT_COMPRESSION_TYPE kBzip2
@@ -88,6 +88,14 @@
 #define STARCH_METADATA_STREAM_TOTALUNIQUEBASES_KEY "uniqueBaseCount"
 #define STARCH_METADATA_STREAM_DUPLICATEELEMENTEXISTS_KEY "duplicateElementExists"
 #define STARCH_METADATA_STREAM_NESTEDELEMENTEXISTS_KEY "nestedElementExists"
+#define STARCH_METADATA_STREAM_BLOCKS_KEY "blocks"
+#define STARCH_METADATA_STREAM_BLOCK_OFFSET_KEY "offset"
+#define STARCH_METADATA_STREAM_BLOCK_FIRSTSTART_KEY "firstStart"
+#define STARCH_METADATA_STREAM_BLOCK_LASTEND_KEY "lastEnd"
+#define STARCH_METADATA_STREAM_BLOCK_MAXEND_KEY "maxEnd"
+#define STARCH_METADATA_STREAM_BLOCK_LINECOUNT_KEY "lineCount"
+#define STARCH_METADATA_STREAM_BLOCK_LENGTHOFFSET_KEY "lengthOffset"
+#define STARCH_METADATA_STREAM_BLOCK_RESTOFFSET_KEY "restOffset"
 #define STARCH_METADATA_STREAM_ARCHIVE_KEY "archive"
 #define STARCH_METADATA_STREAM_ARCHIVE_TYPE_KEY "type"
 #define STARCH_METADATA_STREAM_ARCHIVE_NOTE_KEY "note"
@@ -148,6 +156,30 @@ static const unsigned char starchRevision2HeaderBytes[] = { 0xca, 0x5c, 0xad, 0x
     -------------------------------------------------
 */
 
+/*
+    Starch rev. 2.3 chromosome streams may be cut into blocks, each of which can 
+    be decompressed without those before it. The offset of a block is counted in 
+    bytes from the start of its chromosome stream; firstStart and lastEnd are the 
+    coordinates of its first and last records, and maxEnd the greatest stop 
+    coordinate of the chromosome up to and including the block. A stream with no 
+    blocks is read as one block.
+
+    In a rev. 2.4 columnar stream, each block is instead three compressed streams 
+    of its own, one after the other: start coordinates from offset, element 
+    lengths from lengthOffset, and the rest of each line from restOffset (see 
+    STARCH2_setWriterColumnar()). Both are zero in a stream of transformed lines.
+*/
+
+typedef struct metadataBlock {
+    uint64_t offset;
+    SignedCoordType firstStart;
+    SignedCoordType lastEnd;
+    SignedCoordType maxEnd;
+    LineCountType lineCount;
+    uint64_t lengthOffset;
+    uint64_t restOffset;
+} MetadataBlock;
+
 typedef struct metadata {
     char *chromosome;
     char *filename;
@@ -159,6 +191,8 @@ typedef struct metadata {
     Boolean duplicateElementExists;
     Boolean nestedElementExists;
     char *signature;
+    MetadataBlock *blocks;
+    uint64_t numBlocks;
     struct metadata *next;
 } Metadata;
 
@@ -212,6 +246,16 @@ Metadata *       STARCH_addMetadata(Metadata *md,
 
 Metadata *       STARCH_copyMetadata(const Metadata *md);
 
+MetadataBlock *  STARCH_addMetadataBlock(Metadata *md,
+                                         uint64_t offset,
+                                  SignedCoordType firstStart);
+
+int              STARCH_setMetadataBlocks(Metadata *md,
+                                const MetadataBlock *blocks,
+                                         uint64_t numBlocks);
+
+Boolean          STARCH_isColumnarStream(const Metadata *md);
+
 int              STARCH_updateMetadataForChromosome(Metadata **md, 
                                                         char *chr, 
                                                         char *fn, 
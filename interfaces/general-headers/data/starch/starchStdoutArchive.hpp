@@ -0,0 +1,98 @@
+/*
+  Author: Shane Neph & Alex Reynolds
+  Date:   Sun Oct 18 14:02:11 PDT 2026
+*/
+//
+//    BEDOPS
+//    Copyright (C) 2011-2018 Shane Neph, Scott Kuehn and Alex Reynolds
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License along
+//    with this program; if not, write to the Free Software Foundation, Inc.,
+//    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+#ifndef STARCH_STDOUT_ARCHIVE_HPP
+#define STARCH_STDOUT_ARCHIVE_HPP
+
+#include <cstdlib>
+#include <memory>
+
+#include "data/starch/starchHelpers.h"
+#include "data/starch/starchMetadataHelpers.h"
+#include "utility/Exception.hpp"
+#include "utility/StdoutRows.hpp"
+
+namespace starch {
+
+  /*
+    StdoutArchive turns everything a tool prints to stdout into a Starch archive,
+      which is written to the original stdout.  The tools keep printing BED rows
+      with std::printf(); each complete row goes straight to a Starch2Writer, which
+      compresses a chromosome's stream and completes its metadata record as soon as
+      the next chromosome shows up.  This replaces '| starch -' without a pipe and
+      without re-scanning every row char by char.
+    Finish() writes the metadata and footer and restores stdout.  If Finish() is
+      never reached (an exception was thrown), the destructor restores stdout and
+      abandons the archive.
+  */
+  class StdoutArchive {
+  public:
+    explicit StdoutArchive(CompressionType type) : writer_(NULL) {
+      char* tag = NULL;
+      STARCH_buildProcessIDTag(&tag);
+      const int rtn = STARCH2_openWriter(&writer_, stdout, type, tag, NULL, kStarchTrue);
+      std::free(tag);
+      if ( rtn != STARCH_EXIT_SUCCESS )
+        throw(Ext::ProgramError("Unable to start a Starch archive on stdout"));
+      try {
+        rows_.reset(new Ext::StdoutRows<StdoutArchive>(*this));
+      } catch(...) {
+        STARCH2_closeWriter(&writer_, kStarchFalse);
+        throw;
+      }
+    }
+
+    void Finish() {
+      if ( !rows_ )
+        return;
+      const bool ok = rows_->Finish() && (STARCH2_closeWriter(&writer_, kStarchTrue) == STARCH_EXIT_SUCCESS);
+      rows_.reset();
+      if ( writer_ )
+        STARCH2_closeWriter(&writer_, kStarchFalse);
+      if ( !ok )
+        throw(Ext::DataError("Unable to create a Starch archive from this output.  It must be sorted BED (see message above)."));
+    }
+
+    ~StdoutArchive() {
+      rows_.reset();
+      if ( writer_ )
+        STARCH2_closeWriter(&writer_, kStarchFalse);
+    }
+
+  private:
+    friend class Ext::StdoutRows<StdoutArchive>;
+
+    StdoutArchive(const StdoutArchive&); // not safe to copy
+    StdoutArchive& operator=(const StdoutArchive&);
+
+    bool row(const char* line)
+      { return STARCH2_addBEDLineToWriter(writer_, line) == STARCH_EXIT_SUCCESS; }
+
+  private:
+    Starch2Writer* writer_;
+    std::unique_ptr< Ext::StdoutRows<StdoutArchive> > rows_;
+  };
+
+} // namespace starch
+
+#endif // STARCH_STDOUT_ARCHIVE_HPP
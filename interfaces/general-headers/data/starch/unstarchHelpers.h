@@ -29,6 +29,7 @@
 #include <bzlib.h>
 
 #include "data/starch/starchMetadataHelpers.h"
+#include "data/starch/starchHelpers.h"
 #include "suite/BEDOPS.Constants.hpp"
 
 #ifdef __cplusplus
@@ -74,6 +75,23 @@
 #define UNSTARCH_ELEMENT_MAX_STRING_LENGTH_CHR_ERROR 35
 #define UNSTARCH_ELEMENT_MAX_STRING_LENGTH_ALL_ERROR 36
 
+/*
+    An index block of a columnar stream (see STARCH2_setWriterColumnar()), read and
+    decompressed by UNSTARCH_readColumnarBlock(); the rest column is decompressed only
+    when restFlag is set. Zero it before its first use, and reuse it from block to
+    block, so that its buffers are kept.
+*/
+typedef struct starchColumnarBlock {
+    unsigned char *compressed;
+    size_t compressedCapacity;
+    unsigned char *columns[STARCH2_NUM_COLUMNS];
+    size_t columnLengths[STARCH2_NUM_COLUMNS];
+    size_t columnCapacities[STARCH2_NUM_COLUMNS];
+    size_t positions[STARCH2_NUM_COLUMNS];
+    SignedCoordType start;
+    Boolean restFlag;
+} StarchColumnarBlock;
+
 int                UNSTARCH_reverseTransformInput(const char *chr,
                                          const unsigned char *str,
                                                         char delim,
@@ -193,6 +211,47 @@ char *             UNSTARCH_strndup(const char *s,
 void               UNSTARCH_bzReadLine(BZFILE *input, 
                                 unsigned char **output);
 
+int                UNSTARCH_bzOpenNextBlock(BZFILE **input, 
+                                              FILE *inFp, 
+                                    const Metadata *md, 
+                                    const uint64_t streamOffset, 
+                                          uint64_t *blockIdx);
+
+void               UNSTARCH_bzReadBlockLine(BZFILE **input, 
+                                              FILE *inFp, 
+                                    const Metadata *md, 
+                                    const uint64_t streamOffset, 
+                                          uint64_t *blockIdx, 
+                                     unsigned char **output);
+
+uint64_t           UNSTARCH_firstBlockOfRegion(const Metadata *md, 
+                                        const SignedCoordType regionStart);
+
+int                UNSTARCH_extractRegion(FILE **inFp, 
+                                          FILE *outFp, 
+                                    const char *whichChr, 
+                         const SignedCoordType regionStart, 
+                         const SignedCoordType regionEnd, 
+                                const Metadata *md, 
+                                const uint64_t mdOffset, 
+                         const CompressionType type);
+
+int                UNSTARCH_readColumnarBlock(FILE *inFp, 
+                                    const Metadata *md, 
+                                    const uint64_t streamOffset, 
+                                    const uint64_t blockIdx, 
+                             const CompressionType type, 
+                                     const Boolean restFlag, 
+                               StarchColumnarBlock *block);
+
+int                UNSTARCH_nextColumnarRecord(StarchColumnarBlock *block, 
+                                                SignedCoordType *start, 
+                                                SignedCoordType *stop, 
+                                                           char **rest, 
+                                                         size_t *restLength);
+
+void               UNSTARCH_freeColumnarBlock(StarchColumnarBlock *block);
+
 LineCountType      UNSTARCH_lineCountForChromosome(const Metadata *md, 
                                                        const char *chr);
 
@@ -0,0 +1,128 @@
+/*
+  Author: Shane Neph & Alex Reynolds
+  Date:   Sun Oct 18 15:20:37 PDT 2026
+*/
+//
+//    BEDOPS
+//    Copyright (C) 2011-2018 Shane Neph, Scott Kuehn and Alex Reynolds
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License along
+//    with this program; if not, write to the Free Software Foundation, Inc.,
+//    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+#ifndef STDOUT_ROWS_HPP
+#define STDOUT_ROWS_HPP
+
+#include <cstdio>
+#include <string>
+#include <sys/types.h>
+
+#include "utility/Exception.hpp"
+
+namespace Ext {
+
+  /*
+    StdoutRows<Handler> points stdout at a stream that hands every complete row a
+      program prints, without its newline, to Handler::row(char const*).  Programs
+      keep printing with std::printf() and friends and never know the difference.
+    Handler::row() returns false to reject a row; nothing more is passed along after
+      that, and Finish() reports the failure.  Finish() also passes along a last row
+      that has no newline, and restores stdout.  If Finish() is never reached, the
+      destructor restores stdout and drops anything still buffered.
+  */
+  template <typename Handler>
+  class StdoutRows {
+  public:
+    explicit StdoutRows(Handler& h)
+      : h_(h), real_(stdout), rows_(NULL), failed_(false) {
+#if defined(__APPLE__) || defined(__FreeBSD__)
+      rows_ = funopen(this, NULL, &StdoutRows::write, NULL, NULL);
+#else
+      cookie_io_functions_t io = { NULL, &StdoutRows::write, NULL, NULL };
+      rows_ = fopencookie(this, "w", io);
+#endif
+      if ( !rows_ )
+        throw(Ext::ProgramError("Unable to redirect stdout"));
+      std::setvbuf(rows_, NULL, _IOFBF, BufSize);
+      stdout = rows_;
+    }
+
+    FILE* Real() const { return real_; }
+
+    bool Finish() {
+      if ( !rows_ )
+        return !failed_;
+      std::fclose(rows_); // flushes the last rows through write()
+      rows_ = NULL;
+      stdout = real_;
+      if ( !failed_ && !line_.empty() ) // last row had no newline
+        failed_ = !h_.row(line_.c_str());
+      line_.clear();
+      return !failed_;
+    }
+
+    ~StdoutRows() {
+      if ( rows_ ) {
+        failed_ = true; // drop whatever is still buffered
+        std::fclose(rows_);
+        stdout = real_;
+      }
+    }
+
+  private:
+    StdoutRows(const StdoutRows&); // not safe to copy
+    StdoutRows& operator=(const StdoutRows&);
+
+    // hand complete rows to h_; a partial row waits in line_ for the rest
+    std::size_t consume(const char* buf, std::size_t size) {
+      if ( failed_ )
+        return 0;
+      line_.append(buf, size);
+      std::size_t from = 0, nl = 0;
+      while ( (nl = line_.find('\n', from)) != std::string::npos ) {
+        line_[nl] = '\0';
+        if ( !h_.row(line_.c_str() + from) ) {
+          failed_ = true;
+          return 0;
+        }
+        from = nl + 1;
+      } // while
+      line_.erase(0, from);
+      return size;
+    }
+
+#if defined(__APPLE__) || defined(__FreeBSD__)
+    static int write(void* cookie, const char* buf, int size) {
+      std::size_t done = static_cast<StdoutRows*>(cookie)->consume(buf, static_cast<std::size_t>(size));
+      return (done == static_cast<std::size_t>(size)) ? size : -1;
+    }
+#else
+    static ssize_t write(void* cookie, const char* buf, std::size_t size) {
+      std::size_t done = static_cast<StdoutRows*>(cookie)->consume(buf, size);
+      return (done == size) ? static_cast<ssize_t>(size) : -1;
+    }
+#endif
+
+  private:
+    static constexpr std::size_t BufSize = 1024*1024;
+    Handler& h_;
+    FILE* real_;
+    FILE* rows_;
+    bool failed_;
+    std::string line_;
+  };
+
+} // namespace Ext
+
+#endif // STDOUT_ROWS_HPP
@@ -21,13 +21,18 @@
 //    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 //
 
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <deque>
+#include <limits>
+#include <vector>
 
 #include "data/bed/AllocateIterator_BED_starch_minmem.hpp"
 #include "data/bed/AllocateIterator_BED_starch.hpp"
 #include "data/bed/BedCheckIterator.hpp"
 #include "data/bed/BedCheckIterator_minmem.hpp"
+#include "data/bed/BinIterator_BED.hpp"
 #include "utility/AllocateIterator.hpp"
 
 namespace WindowSweep {
@@ -102,6 +107,17 @@ namespace WindowSweep {
     inline void clean(Bed::bed_check_iterator<T*, PoolSz>& i, T* p)
       { static auto& pool = i.get_pool(); pool.release(p); }
 
+
+    // generated bins (v2p4p27 and newer); the iterator owns its elements
+    template <typename T>
+    inline typename Bed::bin_iterator<T*>::value_type
+                                     get(Bed::bin_iterator<T*>& i)
+      { return(*i); } /* no copy via operator new here */
+
+    template <typename T>
+    inline void clean(Bed::bin_iterator<T*>&, T*)
+      { /* nothing to release */ }
+
   } // namespace Details
 
   //===================
@@ -302,4 +318,160 @@ namespace WindowSweep {
 
   } // sweep() overload2
 
+
+  //===================
+  // sweep Overload3 :
+  //===================
+  template <
+            class InputIterator1,
+            class InputIterator2,
+            class RangeComp,
+            class EventVisitor
+           >
+  void sweep(std::vector<InputIterator1>& refStarts, std::vector<InputIterator1>& refEnds,
+             InputIterator2 mapFromStart, InputIterator2 mapFromEnd,
+             RangeComp inRange, std::vector<EventVisitor*>& visitors, bool sweepMapAll) {
+
+    // Local typedefs
+    typedef typename EventVisitor::RefType RefType;
+    typedef typename EventVisitor::MapType MapType;
+    typedef MapType* MapTypePtr;
+    typedef RefType* RefTypePtr;
+    typedef std::deque<std::size_t> WindowType; // map element numbers
+
+    // Each cursor's window holds the numbers of map elements added for its
+    //  current reference.  'shared' holds every map element, in order, from
+    //  the first one still needed by some cursor through the last one read.
+    //  An element is needed while a window holds it or while some cursor
+    //  has yet to compare it to a reference element.
+    struct Cursor {
+      Cursor() : ref_(0), next_(0), done_(false) { /* */ }
+      RefTypePtr ref_;
+      std::size_t next_; // number of the next map element to compare to ref_
+      WindowType win_;
+      bool done_;
+    };
+
+    // Local variables
+    const std::size_t numRefs = refStarts.size();
+    const std::size_t allSeen = std::numeric_limits<std::size_t>::max();
+    std::vector<Cursor> cursors(numRefs);
+    std::vector<InputIterator1> rorigs(refStarts);
+    InputIterator2 morig = mapFromStart;
+    std::deque<MapTypePtr> shared;
+    std::deque<std::size_t> holds; // number of windows holding each element of 'shared'
+    std::size_t base = 0; // number of the map element at shared[0]
+    MapTypePtr mPtr = static_cast<MapTypePtr>(0);
+    RefTypePtr rPtr = static_cast<RefTypePtr>(0);
+    double value = 0;
+
+    for ( std::size_t k = 0; k < numRefs; ++k ) {
+      if ( refStarts[k] != refEnds[k] ) {
+        cursors[k].ref_ = Details::get(refStarts[k]); // don't do get(refStarts[k]++); in case allocate_iterator
+        ++refStarts[k];
+      } else {
+        cursors[k].done_ = true;
+        cursors[k].next_ = allSeen;
+        visitors[k]->OnEnd();
+      }
+    } // for
+
+    // Loop through inputs
+    while ( true ) {
+      // Work on the cursor with the left-most reference element
+      std::size_t k = numRefs;
+      for ( std::size_t i = 0; i < numRefs; ++i ) {
+        if ( cursors[i].done_ )
+          continue;
+        if ( k == numRefs )
+          k = i;
+        else {
+          const int c = std::strcmp(cursors[i].ref_->chrom(), cursors[k].ref_->chrom());
+          if ( c < 0 || (c == 0 && cursors[i].ref_->start() < cursors[k].ref_->start()) )
+            k = i;
+        }
+      } // for
+      if ( k == numRefs )
+        break;
+
+      Cursor& cursor = cursors[k];
+      EventVisitor& visitor = *visitors[k];
+      WindowType& win = cursor.win_;
+      rPtr = cursor.ref_;
+      visitor.OnStart(rPtr);
+
+      // See if we will be starting a new window
+      if ( !win.empty() && (inRange.Map2Ref(shared[win.back()-base], rPtr) < 0) )
+        visitor.OnPurge(); // notify visitor before deleting elements
+
+      // Pop off items falling out of range 'to the left'
+      while ( !win.empty() && inRange.Map2Ref(shared[win.front()-base], rPtr) < 0 ) {
+        visitor.OnDelete(shared[win.front()-base]);
+        --holds[win.front()-base];
+        win.pop_front();
+      } // while
+
+      // Check for items to be included in current windowed range
+      while ( true ) {
+        if ( cursor.next_ == base + shared.size() ) { // this cursor is the furthest along
+          if ( mapFromStart == mapFromEnd )
+            break;
+          shared.push_back(Details::get(mapFromStart)); // don't do get(mapFromStart++); in case allocate_iterator
+          holds.push_back(0);
+          ++mapFromStart;
+        }
+
+        mPtr = shared[cursor.next_-base];
+        if ( (value = inRange.Ref2Map(rPtr, mPtr)) == 0 ) { // within range
+          win.push_back(cursor.next_);
+          ++holds[cursor.next_-base];
+          visitor.OnAdd(mPtr);
+        }
+        else if ( value < 0 ) // read one passed current windowed range
+          break;
+        ++cursor.next_;
+      } // while
+      visitor.OnDone(); // done processing current ref item
+      Details::clean(rorigs[k], rPtr);
+
+      if ( refStarts[k] != refEnds[k] ) {
+        cursor.ref_ = Details::get(refStarts[k]);
+        ++refStarts[k];
+      } else { // deletions belonging to NO ref
+        visitor.OnEnd();
+        while ( !win.empty() ) {
+          --holds[win.front()-base];
+          win.pop_front();
+        } // while
+        cursor.done_ = true;
+        cursor.next_ = allSeen;
+      }
+
+      // Release map elements no cursor needs anymore
+      std::size_t minNext = allSeen;
+      for ( std::size_t i = 0; i < numRefs; ++i )
+        minNext = std::min(minNext, cursors[i].next_);
+      while ( !shared.empty() && base < minNext && 0 == holds.front() ) {
+        Details::clean(morig, shared.front());
+        shared.pop_front();
+        holds.pop_front();
+        ++base;
+      } // while
+    } // while more ref data
+
+    while ( !shared.empty() ) { // never given to a visitor, or all done with
+      Details::clean(morig, shared.front());
+      shared.pop_front();
+    } // while
+
+    if ( sweepMapAll ) { // read and clean remainder of map file
+      while ( mapFromStart != mapFromEnd ) {
+        mPtr = Details::get(mapFromStart); // don't do get(mapFromStart); in case allocate_iterator
+        ++mapFromStart;
+        Details::clean(morig, mPtr); // never given to visitor
+      } // while
+    }
+
+  } // sweep() overload3
+
 } // namespace WindowSweep
@@ -73,6 +73,57 @@ STARCH_strdup(const char *str)
     return dup;
 }
 
+void
+STARCH_initializeInputBuffer(StarchInputBuffer *in, FILE *fp)
+{
+    in->fp = fp;
+    in->length = 0U;
+    in->position = 0U;
+}
+
+int
+STARCH_readInputLine(StarchInputBuffer *in, char *line, const size_t lineCapacity, size_t *lineLength)
+{
+    /*
+       Copies the next line of input into line, without its newline and
+       unterminated, and sets its length. Input is read a block at a time and
+       each block is searched for newlines with memchr(), rather than taking
+       one character at a time from the stream. Returns '\n' after a whole
+       line, EOF at the end of input (with any last line that has no newline
+       left in line), or 0 if the line does not fit within lineCapacity bytes.
+    */
+    const char *newline = NULL;
+    size_t spanLength = 0U;
+
+    *lineLength = 0U;
+    for (;;) {
+        if (in->position == in->length) {
+            in->length = fread(in->data, 1, STARCH_INPUT_BUFFER_MAX_LENGTH, in->fp);
+            in->position = 0U;
+            if (in->length == 0U)
+                return EOF;
+        }
+#ifdef __cplusplus
+        newline = static_cast<const char *>( memchr(in->data + in->position, '\n', in->length - in->position) );
+        spanLength = (newline) ? static_cast<size_t>( newline - (in->data + in->position) ) : in->length - in->position;
+#else
+        newline = (const char *) memchr(in->data + in->position, '\n', in->length - in->position);
+        spanLength = (newline) ? (size_t) (newline - (in->data + in->position)) : in->length - in->position;
+#endif
+        if (*lineLength + spanLength >= lineCapacity) {
+            fprintf(stderr, "ERROR: BED line is too long (must be less than %zu characters long)\n", lineCapacity);
+            return 0;
+        }
+        memcpy(line + *lineLength, in->data + in->position, spanLength);
+        *lineLength += spanLength;
+        in->position += spanLength;
+        if (newline) {
+            in->position++;
+            return '\n';
+        }
+    }
+}
+
 int 
 STARCH_compressFileWithGzip(const char *inFn, char **outFn, off_t *outFnSize)
 {
@@ -138,11 +189,9 @@ STARCH_compressFileWithBzip2(const char *inFn, char **outFn, off_t *outFnSize)
     FILE *inFnPtr = NULL;
     FILE *outFnPtr = NULL;
     BZFILE *bzFp = NULL;
-    int nBzBuf = STARCH_BZ_BUFFER_MAX_LENGTH;
     char bzBuf[STARCH_BZ_BUFFER_MAX_LENGTH];
     int bzError;
-    int c;
-    unsigned int idx = 0U;
+    size_t nRead = 0U;
     struct stat outSt;
 
     /* create output file handle */
@@ -175,35 +224,19 @@ STARCH_compressFileWithBzip2(const char *inFn, char **outFn, off_t *outFnSize)
         return STARCH_FATAL_ERROR;
     }
 
-    /* compress to bz stream */
-    while ((c = fgetc(inFnPtr)) != EOF) { 
+    /* compress to bz stream, a buffer at a time */
+    while ((nRead = fread(bzBuf, 1, STARCH_BZ_BUFFER_MAX_LENGTH, inFnPtr)) > 0) {
 #ifdef __cplusplus
-        bzBuf[idx++] = static_cast<char>( c );
+        BZ2_bzWrite(&bzError, bzFp, bzBuf, static_cast<int>( nRead ));
 #else
-        bzBuf[idx++] = (char) c;
+        BZ2_bzWrite(&bzError, bzFp, bzBuf, (int) nRead);
 #endif
-        if (idx == STARCH_BZ_BUFFER_MAX_LENGTH) {
-            BZ2_bzWrite( &bzError, bzFp, bzBuf, nBzBuf );
-            if (bzError == BZ_IO_ERROR) {
-                BZ2_bzWriteClose ( &bzError, bzFp, 0, NULL, NULL );
-                fprintf(stderr, "ERROR: Could not write to bzip2 file handle\n");
-                return STARCH_FATAL_ERROR;
-            }
-            idx = 0;
+        if (bzError == BZ_IO_ERROR) {
+            BZ2_bzWriteClose ( &bzError, bzFp, 0, NULL, NULL );
+            fprintf(stderr, "ERROR: Could not write to bzip2 file handle\n");
+            return STARCH_FATAL_ERROR;
         }
     }
-    /* write out remainder of bzip2 buffer to output */
-    bzBuf[idx] = '\0';
-#ifdef __cplusplus
-    BZ2_bzWrite(&bzError, bzFp, bzBuf, static_cast<int>( idx ));
-#else
-    BZ2_bzWrite(&bzError, bzFp, bzBuf, (int) idx);
-#endif
-    if (bzError == BZ_IO_ERROR) {   
-        BZ2_bzWriteClose ( &bzError, bzFp, 0, NULL, NULL );
-        fprintf(stderr, "ERROR: Could not write to bzip2 file handle\n");
-        return STARCH_FATAL_ERROR;
-    }
 
     /* close bzip2 stream */
     BZ2_bzWriteClose( &bzError, bzFp, 0, NULL, NULL );
@@ -665,9 +698,10 @@ STARCH_transformInput(Metadata **md, const FILE *fp, const CompressionType type,
     fprintf(stderr, "\n--- STARCH_transformInput() ---\n");
 #endif
     int c;
-    int cIdx = 0;
+    size_t cIdx = 0U;
     int recIdx = 0;
     char buffer[STARCH_BUFFER_MAX_LENGTH];
+    StarchInputBuffer input;
     char *outFn = NULL;
     FILE *outFnPtr = NULL;
 #ifdef __cplusplus
@@ -702,13 +736,9 @@ STARCH_transformInput(Metadata **md, const FILE *fp, const CompressionType type,
 
     if (!streamPtr)
         streamPtr = stdin;
+    STARCH_initializeInputBuffer(&input, streamPtr);
     
-    while ((c = fgetc(streamPtr)) != EOF) {
-#ifdef __cplusplus
-        buffer[cIdx] = static_cast<char>( c );
-#else
-        buffer[cIdx] = (char) c;
-#endif
+    while ((c = STARCH_readInputLine(&input, buffer, STARCH_BUFFER_MAX_LENGTH, &cIdx)) != EOF) {
         if (c == '\n') {
             lineIdx++;
             buffer[cIdx] = '\0';
@@ -961,7 +991,7 @@ STARCH_transformInput(Metadata **md, const FILE *fp, const CompressionType type,
             }
         }
         else
-            cIdx++;
+            return STARCH_FATAL_ERROR;
     }
     
     /* compress the remaining file */
@@ -1100,9 +1130,10 @@ STARCH_transformHeaderlessInput(Metadata **md, const FILE *fp, const Compression
     fprintf(stderr, "\n--- STARCH_transformHeaderlessInput() ---\n");
 #endif
     int c;
-    int cIdx = 0;
+    size_t cIdx = 0U;
     int recIdx = 0;
     char buffer[STARCH_BUFFER_MAX_LENGTH];
+    StarchInputBuffer input;
     char *outFn = NULL;
     FILE *outFnPtr = NULL;
 #ifdef __cplusplus
@@ -1134,13 +1165,9 @@ STARCH_transformHeaderlessInput(Metadata **md, const FILE *fp, const Compression
 
     if (!streamPtr)
         streamPtr = stdin;
+    STARCH_initializeInputBuffer(&input, streamPtr);
 
-    while ((c = fgetc(streamPtr)) != EOF) {
-#ifdef __cplusplus
-        buffer[cIdx] = static_cast<char>( c );
-#else
-        buffer[cIdx] = (char) c;
-#endif
+    while ((c = STARCH_readInputLine(&input, buffer, STARCH_BUFFER_MAX_LENGTH, &cIdx)) != EOF) {
         if (c == '\n') {
             lineIdx++;
             buffer[cIdx] = '\0';
@@ -1374,7 +1401,7 @@ STARCH_transformHeaderlessInput(Metadata **md, const FILE *fp, const Compression
             }
         }
         else
-            cIdx++;
+            return STARCH_FATAL_ERROR;
     }
     
     /* compress the remaining file */
@@ -1704,7 +1731,8 @@ STARCH2_transformHeaderedBEDInput(const FILE *inFp, Metadata **md, const Compres
     fprintf(stderr, "\n--- STARCH2_transformHeaderedBEDInput() ---\n");
 #endif
     int c;
-    unsigned int cIdx = 0;
+    size_t cIdx = 0U;
+    StarchInputBuffer input;
     char untransformedBuffer[STARCH_BUFFER_MAX_LENGTH];
     char intermediateBuffer[STARCH_BUFFER_MAX_LENGTH];
     char transformedBuffer[STARCH_BUFFER_MAX_LENGTH];
@@ -1848,12 +1876,11 @@ STARCH2_transformHeaderedBEDInput(const FILE *inFp, Metadata **md, const Compres
 
     /* fill up a "transformation" buffer with data and then compress it */
 #ifdef __cplusplus
-    while ((c = fgetc(const_cast<FILE *>( inFp ))) != EOF) {
-        untransformedBuffer[cIdx] = static_cast<char>( c );
+    STARCH_initializeInputBuffer(&input, const_cast<FILE *>( inFp ));
 #else
-    while ((c = fgetc((FILE *)inFp)) != EOF) {
-        untransformedBuffer[cIdx] = (char) c;
+    STARCH_initializeInputBuffer(&input, (FILE *) inFp);
 #endif
+    while ((c = STARCH_readInputLine(&input, untransformedBuffer, STARCH_BUFFER_MAX_LENGTH, &cIdx)) != EOF) {
         if (c == '\n') {
             lineIdx++;
             untransformedBuffer[cIdx] = '\0';
@@ -2469,7 +2496,7 @@ STARCH2_transformHeaderedBEDInput(const FILE *inFp, Metadata **md, const Compres
             }
         }
         else
-            cIdx++;
+            return STARCH_FATAL_ERROR;
     }
 
     /* if we don't have a trailing newline in BED input, then we have reached EOF before we can process a line, so we try that now */
@@ -2863,7 +2890,8 @@ STARCH2_transformHeaderlessBEDInput(const FILE *inFp, Metadata **md, const Compr
     fprintf(stderr, "\n--- STARCH2_transformHeaderlessBEDInput() ---\n");
 #endif
     int c;
-    unsigned int cIdx = 0;
+    size_t cIdx = 0U;
+    StarchInputBuffer input;
     char untransformedBuffer[STARCH_BUFFER_MAX_LENGTH + 1] = {0};
     char intermediateBuffer[STARCH_BUFFER_MAX_LENGTH + 1] = {0};
     char transformedBuffer[STARCH_BUFFER_MAX_LENGTH + 1] = {0};
@@ -3005,12 +3033,11 @@ STARCH2_transformHeaderlessBEDInput(const FILE *inFp, Metadata **md, const Compr
 
     /* fill up a "transformation" buffer with data and then compress it */
 #ifdef __cplusplus
-    while ((c = fgetc(const_cast<FILE *>( inFp ))) != EOF) {
-        untransformedBuffer[cIdx] = static_cast<char>( c );
+    STARCH_initializeInputBuffer(&input, const_cast<FILE *>( inFp ));
 #else
-    while ((c = fgetc((FILE *)inFp)) != EOF) {
-        untransformedBuffer[cIdx] = (char) c;
+    STARCH_initializeInputBuffer(&input, (FILE *) inFp);
 #endif
+    while ((c = STARCH_readInputLine(&input, untransformedBuffer, STARCH_BUFFER_MAX_LENGTH, &cIdx)) != EOF) {
         if (c == '\n') {
             lineIdx++;
             untransformedBuffer[cIdx] = '\0';
@@ -3612,7 +3639,7 @@ STARCH2_transformHeaderlessBEDInput(const FILE *inFp, Metadata **md, const Compr
             }
         }
         else
-            cIdx++;
+            return STARCH_FATAL_ERROR;
     }
 
     /* if we don't have a trailing newline in BED input, then we have reached EOF before we can process a line, so we try that now */
@@ -4036,6 +4063,1844 @@ STARCH2_transformHeaderlessBEDInput(const FILE *inFp, Metadata **md, const Compr
     return STARCH_EXIT_SUCCESS;
 }
 
+/*
+    Starch2Writer builds a rev. 2 archive from records handed to it one at a time, 
+    rather than from a BED file pointer. It follows the same transformation, 
+    per-chromosome compression, signature and metadata steps as 
+    STARCH2_transformHeaderlessBEDInput(), so that BEDOPS tools can write an archive 
+    from their own output without a round trip through 'starch -'.
+
+    Each chromosome stream is closed and its metadata record is completed as soon 
+    as a record from the next chromosome arrives.
+
+    A chromosome writer (STARCH2_openChromosomeWriter()) takes the records of a 
+    single chromosome and compresses them into a temporary file of its own, with the 
+    settings of the archive writer it is made for, so that several chromosomes can be 
+    compressed at once on separate threads. STARCH2_appendChromosomeWriter() then adds 
+    each one to that archive, in order.
+
+    A writer given a block pool (STARCH2_setWriterBlockPool()) instead cuts each 
+    chromosome's transformed stream into blocks, which the pool compresses on its own 
+    threads with STARCH2_compressBlock(). Blocks are written out in order, as one bzip2 
+    or zlib stream per chromosome, so that archives read as before:
+
+    - a bzip2 block is a run of bzip2 blocks of its own, each holding no more than a 
+      bzip2 block takes at level 9. These are cut from their streams, bit by bit, and 
+      joined under one stream header and one combined CRC.
+
+    - a gzip block is raw deflate data, primed with the last 32 kB of the block before 
+      it and ended by a sync flush, as in pigz. Blocks are joined under one zlib header 
+      and one Adler-32 checksum, combined from those of each block.
+
+    Up to maxBlocks blocks are held at once; the oldest is written out before another 
+    is cut. The size of a chromosome stream in its metadata record grows as its blocks 
+    are written.
+
+    Every indexLineCount records of a chromosome also start a block of its index 
+    (see MetadataBlock), which is read without the records before it: a bzip2 stream 
+    is ended and a new one started, while a zlib stream is fully flushed, or the next 
+    block of a pool is not primed with the data before it. As the records of an index 
+    block are still transformed against the stop coordinate of the record before it, 
+    the lastEnd of the index block before it is where a reader starts from. A 
+    compression block which starts an index block sets its offset as it is written.
+
+    A columnar writer (STARCH2_setWriterColumnar()) does not transform records into 
+    lines. Each index block is kept as three columns instead: the start of each 
+    record, less the start of the record before it in the block, and its length, 
+    both as unsigned LEB128 varints, and the rest of each line, ended by a newline. 
+    Each column is compressed as a complete bzip2 or zlib stream of its own, so that 
+    a reader which needs only coordinates can pass over the rest of each line. The 
+    index block is the compression block, handed to the block pool if one is set, or 
+    compressed as it is submitted otherwise.
+*/
+
+struct starch2Writer {
+    FILE *outFp;
+    CompressionType type;
+    char *tag;
+    char *note;
+    Boolean generatePerChrSignatureFlag;
+    Metadata *firstRecord;
+    Metadata *md;
+    char *chromosome;
+    char *compressedFn;
+    char *transformedBuffer;
+    size_t transformedBufferLength;
+    char *zBuffer;
+    char *pRemainder;
+    size_t pRemainderCapacity;
+    int64_t pStart;
+    int64_t pStop;
+    int64_t previousStop;
+    int64_t lastPosition;
+    int64_t lcDiff;
+    LineCountType lineCount;
+    BaseCountType totalNonUniqueBases;
+    BaseCountType totalUniqueBases;
+    Boolean duplicateElementExistsFlag;
+    Boolean nestedElementExistsFlag;
+    LineLengthType maxStringLength;
+    LineLengthType firstLineLength;
+    uint64_t cumulativeRecSize;
+    uint64_t currentRecSize;
+    Boolean streamOpenFlag;
+    Boolean chromosomeOnlyFlag;
+    BZFILE *bzFp;
+    z_stream zStream;
+    struct sha1_ctx perChromosomeHashCtx;
+    char lineChromosome[TOKEN_CHR_MAX_LENGTH + 1];
+    size_t bufferLength;
+    Starch2Block **blocks;
+    unsigned int maxBlocks;
+    uint64_t numBlocksSubmitted;
+    uint64_t numBlocksWritten;
+    Starch2BlockFunction submitBlock;
+    Starch2BlockFunction waitBlock;
+    void *blockPool;
+    Boolean blockStreamStartedFlag;
+    uint32_t blockStreamCheck;
+    unsigned char blockStreamBits; /* bzip2: leading bits of a byte not yet written */
+    unsigned int numBlockStreamBits;
+    unsigned char *dictionary;
+    size_t dictionaryLength;
+    LineCountType indexLineCount;
+    Boolean indexBlockPendingFlag;
+    Boolean columnarFlag;
+    unsigned char *columns[STARCH2_NUM_COLUMNS];
+    size_t columnLengths[STARCH2_NUM_COLUMNS];
+    size_t columnCapacities[STARCH2_NUM_COLUMNS];
+};
+
+struct starch2Block {
+    CompressionType type;
+    char *data;
+    size_t length;
+    unsigned char *dictionary;
+    size_t dictionaryLength;
+    Boolean firstFlag;
+    Boolean lastFlag;
+    Metadata *md;
+    unsigned char *out;
+    size_t outCapacity;
+    uint64_t numOutBits;
+    uint32_t check; /* combined CRC of numChecks bzip2 blocks, or Adler-32 of data */
+    unsigned int numChecks;
+    Boolean indexBlockFlag;
+    uint64_t indexBlockIdx;
+    Boolean columnarFlag;
+    unsigned char *columns[STARCH2_NUM_COLUMNS];
+    size_t columnLengths[STARCH2_NUM_COLUMNS];
+    size_t columnCapacities[STARCH2_NUM_COLUMNS];
+    size_t outColumnLengths[STARCH2_NUM_COLUMNS];
+};
+
+static uint32_t STARCH2_bzCrcTable[256];
+
+static int
+STARCH2_openWriterStream(Starch2Writer *w)
+{
+#ifdef DEBUG
+    fprintf(stderr, "\n--- STARCH2_openWriterStream() ---\n");
+#endif
+    int bzError = BZ_OK;
+    int zError = Z_OK;
+
+    if (w->blocks)
+        w->blockStreamStartedFlag = kStarchFalse;
+    else if (w->type == kBzip2) {
+        w->bzFp = BZ2_bzWriteOpen(&bzError, w->outFp, STARCH_BZ_COMPRESSION_LEVEL, STARCH_BZ_VERBOSITY, STARCH_BZ_WORKFACTOR);
+        if ((!w->bzFp) || (bzError != BZ_OK)) {
+            fprintf(stderr, "ERROR: Could not instantiate BZFILE pointer (err: %d)\n", bzError);
+            return STARCH_EXIT_FAILURE;
+        }
+    }
+    else if (w->type == kGzip) {
+        w->zStream.zalloc = Z_NULL;
+        w->zStream.zfree  = Z_NULL;
+        w->zStream.opaque = Z_NULL;
+        zError = deflateInit(&w->zStream, STARCH_Z_COMPRESSION_LEVEL);
+        if (zError != Z_OK) {
+            fprintf(stderr, "ERROR: Could not initialize z-stream (err: %d)\n", zError);
+            return STARCH_EXIT_FAILURE;
+        }
+    }
+    w->streamOpenFlag = kStarchTrue;
+
+    return STARCH_EXIT_SUCCESS;
+}
+
+static void
+STARCH2_abandonWriterStream(Starch2Writer *w)
+{
+#ifdef DEBUG
+    fprintf(stderr, "\n--- STARCH2_abandonWriterStream() ---\n");
+#endif
+    if (!w->streamOpenFlag)
+        return;
+    if (w->blocks)
+        w->blockStreamStartedFlag = kStarchFalse;
+    else if (w->type == kBzip2)
+        BZ2_bzWriteClose64(NULL, w->bzFp, 1, NULL, NULL, NULL, NULL);
+    else if (w->type == kGzip)
+        deflateEnd(&w->zStream);
+    w->bzFp = NULL;
+    w->streamOpenFlag = kStarchFalse;
+}
+
+static void
+STARCH2_initializeBzCrcTable()
+{
+    uint32_t crc = 0U;
+    unsigned int idx = 0U;
+    unsigned int bit = 0U;
+
+    for (idx = 0U; idx < 256U; idx++) {
+        crc = idx;
+        crc <<= 24;
+        for (bit = 0U; bit < 8U; bit++)
+            crc = (crc & 0x80000000U) ? ((crc << 1) ^ 0x04c11db7U) : (crc << 1);
+        STARCH2_bzCrcTable[idx] = crc;
+    }
+}
+
+/* the CRC that bzip2 puts in the header of a block holding data */
+static uint32_t
+STARCH2_bzCrc(const unsigned char *data, const size_t length)
+{
+    uint32_t crc = 0xffffffffU;
+    size_t idx = 0U;
+
+    for (idx = 0U; idx < length; idx++)
+        crc = (crc << 8) ^ STARCH2_bzCrcTable[(crc >> 24) ^ data[idx]];
+    return ~crc;
+}
+
+/* 
+    the longest start of data which bzip2 turns into no more than maxCost bytes with 
+    its first run-length encoding, where runs of 4 to 255 bytes take 5; *cost is set 
+    to what that start takes
+*/
+static size_t
+STARCH2_bzRunLengthPrefix(const unsigned char *data, const size_t length, const size_t maxCost, size_t *cost)
+{
+    size_t idx = 0U;
+    size_t runLength = 0U;
+    size_t byteCost = 0U;
+
+    *cost = 0U;
+    for (idx = 0U; idx < length; idx++) {
+        if ((idx > 0) && (data[idx] == data[idx - 1]) && (runLength < 255U))
+            runLength++;
+        else
+            runLength = 1U;
+        byteCost = (runLength < 4U) ? 1U : ((runLength == 4U) ? 2U : 0U);
+        if (*cost + byteCost > maxCost)
+            break;
+        *cost += byteCost;
+    }
+    return idx;
+}
+
+/* 
+    appends numBits bits of src, from bit fromBit on, to the *numDestBits bits of dest, 
+    leading bits first; the bits of dest after the last one written are left at zero 
+*/
+static void
+STARCH2_appendBits(unsigned char *dest, uint64_t *numDestBits, const unsigned char *src, const uint64_t fromBit, uint64_t numBits)
+{
+    const unsigned int srcShift = fromBit % 8;
+    const unsigned int destShift = *numDestBits % 8;
+    const unsigned char *s = src + fromBit / 8;
+    unsigned char *d = dest + *numDestBits / 8;
+    unsigned int byte = 0U;
+    unsigned int n = 0U;
+
+    *numDestBits += numBits;
+    while (numBits > 0) {
+        n = (numBits < 8) ? numBits : 8;
+        byte = s[0] << srcShift;
+        if (srcShift + n > 8)
+            byte |= s[1] >> (8 - srcShift);
+        byte &= (0xff00U >> n) & 0xffU;
+        d[0] = (destShift) ? (d[0] | (byte >> destShift)) : byte;
+        if (destShift + n > 8)
+            d[1] = (byte << (8 - destShift)) & 0xffU;
+        numBits -= n;
+        s++;
+        d++;
+    }
+}
+
+/* numBits (no more than 64) bits of src, from bit fromBit on */
+static uint64_t
+STARCH2_readBits(const unsigned char *src, const uint64_t fromBit, const unsigned int numBits)
+{
+    uint64_t bits = 0U;
+    uint64_t bit = 0U;
+
+    for (bit = fromBit; bit < fromBit + numBits; bit++)
+        bits = (bits << 1) | ((src[bit / 8] >> (7 - bit % 8)) & 1U);
+    return bits;
+}
+
+static int
+STARCH2_reserveBlockOutput(Starch2Block *b, const size_t length)
+{
+    unsigned char *out = NULL;
+
+    if (length <= b->outCapacity)
+        return STARCH_EXIT_SUCCESS;
+#ifdef __cplusplus
+    out = static_cast<unsigned char *>( realloc(b->out, length) );
+#else
+    out = realloc(b->out, length);
+#endif
+    if (!out) {
+        fprintf(stderr, "ERROR: Could not allocate space for compressed block\n");
+        return STARCH_EXIT_FAILURE;
+    }
+    b->out = out;
+    b->outCapacity = length;
+    return STARCH_EXIT_SUCCESS;
+}
+
+/*
+    Compresses the data of b into bzip2 blocks of roughly equal size, each as a stream 
+    of its own, and keeps the bits of each from the end of its stream header up to its 
+    end-of-stream marker.
+*/
+static int
+STARCH2_compressBzip2Block(Starch2Block *b)
+{
+#ifdef __cplusplus
+    const unsigned char *data = reinterpret_cast<const unsigned char *>( b->data );
+#else
+    const unsigned char *data = (const unsigned char *) b->data;
+#endif
+    const uint64_t blockMagic = 0x314159265359ULL;
+    const uint64_t streamMagic = 0x177245385090ULL;
+    unsigned char *piece = NULL;
+    unsigned int pieceCapacity = 0U;
+    unsigned int pieceLength = 0U;
+    size_t cost = 0U;
+    size_t maxCost = 0U;
+    size_t numPieces = 0U;
+    size_t offset = 0U;
+    size_t length = 0U;
+    uint64_t endBit = 0U;
+    unsigned int pad = 0U;
+    uint32_t crc = 0U;
+    int bzError = BZ_OK;
+    int result = STARCH_EXIT_SUCCESS;
+
+    b->numOutBits = 0U;
+    b->check = 0U;
+    b->numChecks = 0U;
+    if (b->length == 0)
+        return STARCH_EXIT_SUCCESS;
+
+    /* even pieces, rather than full ones and a short one at the end */
+    STARCH2_bzRunLengthPrefix(data, b->length, b->length * 2, &cost);
+    numPieces = (cost + STARCH_BZ_BLOCK_CAPACITY - 2) / (STARCH_BZ_BLOCK_CAPACITY - 1);
+    maxCost = cost / numPieces + 64;
+    if (maxCost > STARCH_BZ_BLOCK_CAPACITY - 1)
+        maxCost = STARCH_BZ_BLOCK_CAPACITY - 1;
+
+    pieceCapacity = STARCH_BZ_BLOCK_CAPACITY + STARCH_BZ_BLOCK_CAPACITY / 100 + 600;
+#ifdef __cplusplus
+    piece = static_cast<unsigned char *>( malloc(pieceCapacity) );
+#else
+    piece = malloc(pieceCapacity);
+#endif
+    if ((!piece) || (STARCH2_reserveBlockOutput(b, b->length + b->length / 100 + 600 * (numPieces + 2)) != STARCH_EXIT_SUCCESS)) {
+        fprintf(stderr, "ERROR: Could not allocate space for compressed block\n");
+        free(piece);
+        return STARCH_EXIT_FAILURE;
+    }
+
+    for (offset = 0U; (result == STARCH_EXIT_SUCCESS) && (offset < b->length); offset += length) {
+        length = STARCH2_bzRunLengthPrefix(data + offset, b->length - offset, maxCost, &cost);
+        crc = STARCH2_bzCrc(data + offset, length);
+        pieceLength = pieceCapacity;
+#ifdef __cplusplus
+        bzError = BZ2_bzBuffToBuffCompress(reinterpret_cast<char *>( piece ), &pieceLength, b->data + offset, static_cast<unsigned int>( length ), STARCH_BZ_COMPRESSION_LEVEL, STARCH_BZ_VERBOSITY, STARCH_BZ_WORKFACTOR);
+#else
+        bzError = BZ2_bzBuffToBuffCompress((char *) piece, &pieceLength, b->data + offset, (unsigned int) length, STARCH_BZ_COMPRESSION_LEVEL, STARCH_BZ_VERBOSITY, STARCH_BZ_WORKFACTOR);
+#endif
+        if (bzError != BZ_OK) {
+            fprintf(stderr, "ERROR: Could not compress block with bzip2 (err: %d)\n", bzError);
+            result = STARCH_EXIT_FAILURE;
+            break;
+        }
+
+        /* a single block: its CRC is the stream's, ahead of the zero bits that pad the stream */
+        for (pad = 0U; (pieceLength >= 22) && (pad < 8U); pad++) {
+            endBit = pieceLength;
+            endBit = 8 * endBit - pad - 80;
+            if ((STARCH2_readBits(piece, endBit, 48) == streamMagic) && (STARCH2_readBits(piece, endBit + 48, 32) == crc))
+                break;
+        }
+        if ((pieceLength < 22) || (pad == 8U) || (STARCH2_readBits(piece, 32, 48) != blockMagic) || (STARCH2_readBits(piece, 80, 32) != crc)) {
+            fprintf(stderr, "ERROR: Could not find the bzip2 block in a compressed stream\n");
+            result = STARCH_EXIT_FAILURE;
+            break;
+        }
+        if (STARCH2_reserveBlockOutput(b, b->numOutBits / 8 + pieceLength + 2) != STARCH_EXIT_SUCCESS) {
+            result = STARCH_EXIT_FAILURE;
+            break;
+        }
+        STARCH2_appendBits(b->out, &b->numOutBits, piece, 32, endBit - 32);
+        b->check = ((b->check << 1) | (b->check >> 31)) ^ crc;
+        b->numChecks++;
+    }
+
+    free(piece);
+    return result;
+}
+
+/* compresses the data of b as raw deflate data, which the data before it can be read from */
+static int
+STARCH2_compressGzipBlock(Starch2Block *b)
+{
+    z_stream zStream;
+    size_t outLength = 0U;
+    int zError = Z_OK;
+
+    memset(&zStream, 0, sizeof(zStream));
+    zStream.zalloc = Z_NULL;
+    zStream.zfree = Z_NULL;
+    zStream.opaque = Z_NULL;
+    zError = deflateInit2(&zStream, STARCH_Z_COMPRESSION_LEVEL, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY); /* raw, otherwise as deflateInit() */
+    if (zError != Z_OK) {
+        fprintf(stderr, "ERROR: Could not initialize z-stream (err: %d)\n", zError);
+        return STARCH_EXIT_FAILURE;
+    }
+#ifdef __cplusplus
+    if ((b->dictionaryLength > 0) && (deflateSetDictionary(&zStream, b->dictionary, static_cast<unsigned int>( b->dictionaryLength )) != Z_OK)) {
+#else
+    if ((b->dictionaryLength > 0) && (deflateSetDictionary(&zStream, b->dictionary, (unsigned int) b->dictionaryLength) != Z_OK)) {
+#endif
+        fprintf(stderr, "ERROR: Could not set z-stream dictionary\n");
+        deflateEnd(&zStream);
+        return STARCH_EXIT_FAILURE;
+    }
+
+    /* deflateBound() allows for Z_FINISH; a sync flush adds an empty stored block */
+    if (STARCH2_reserveBlockOutput(b, deflateBound(&zStream, b->length) + 64) != STARCH_EXIT_SUCCESS) {
+        deflateEnd(&zStream);
+        return STARCH_EXIT_FAILURE;
+    }
+#ifdef __cplusplus
+    zStream.next_in = reinterpret_cast<unsigned char *>( b->data );
+    zStream.avail_in = static_cast<unsigned int>( b->length );
+    zStream.avail_out = static_cast<unsigned int>( b->outCapacity );
+#else
+    zStream.next_in = (unsigned char *) b->data;
+    zStream.avail_in = (unsigned int) b->length;
+    zStream.avail_out = (unsigned int) b->outCapacity;
+#endif
+    zStream.next_out = b->out;
+    zError = deflate(&zStream, (b->lastFlag) ? Z_FINISH : Z_SYNC_FLUSH);
+    outLength = b->outCapacity - zStream.avail_out;
+    deflateEnd(&zStream);
+    if ((zError != ((b->lastFlag) ? Z_STREAM_END : Z_OK)) || (zStream.avail_in > 0) || (zStream.avail_out == 0)) {
+        fprintf(stderr, "ERROR: Could not compress block with gzip (err: %d)\n", zError);
+        return STARCH_EXIT_FAILURE;
+    }
+
+    b->numOutBits = outLength;
+    b->numOutBits *= 8;
+#ifdef __cplusplus
+    b->check = static_cast<uint32_t>( adler32(adler32(0L, Z_NULL, 0), reinterpret_cast<unsigned char *>( b->data ), static_cast<unsigned int>( b->length )) );
+#else
+    b->check = (uint32_t) adler32(adler32(0L, Z_NULL, 0), (unsigned char *) b->data, (unsigned int) b->length);
+#endif
+    b->numChecks = 1U;
+    return STARCH_EXIT_SUCCESS;
+}
+
+/*
+    Compresses each column of a columnar block as a complete stream of its own, one 
+    after the other.
+*/
+static int
+STARCH2_compressColumnarBlock(Starch2Block *b)
+{
+    z_stream zStream;
+    unsigned int bzLength = 0U;
+    size_t outLength = 0U;
+    size_t bound = 0U;
+    unsigned int col = 0U;
+    int bzError = BZ_OK;
+    int zError = Z_OK;
+
+    for (col = 0U; col < STARCH2_NUM_COLUMNS; col++) {
+        if (b->type == kBzip2) {
+            /* the bound given by the bzip2 manual for BZ2_bzBuffToBuffCompress() */
+            bound = b->columnLengths[col] + b->columnLengths[col] / 100 + 600;
+            if (STARCH2_reserveBlockOutput(b, outLength + bound) != STARCH_EXIT_SUCCESS)
+                return STARCH_EXIT_FAILURE;
+#ifdef __cplusplus
+            bzLength = static_cast<unsigned int>( bound );
+            bzError = BZ2_bzBuffToBuffCompress(reinterpret_cast<char *>( b->out + outLength ), &bzLength, reinterpret_cast<char *>( b->columns[col] ), static_cast<unsigned int>( b->columnLengths[col] ), STARCH_BZ_COMPRESSION_LEVEL, STARCH_BZ_VERBOSITY, STARCH_BZ_WORKFACTOR);
+#else
+            bzLength = (unsigned int) bound;
+            bzError = BZ2_bzBuffToBuffCompress((char *) (b->out + outLength), &bzLength, (char *) b->columns[col], (unsigned int) b->columnLengths[col], STARCH_BZ_COMPRESSION_LEVEL, STARCH_BZ_VERBOSITY, STARCH_BZ_WORKFACTOR);
+#endif
+            if (bzError != BZ_OK) {
+                fprintf(stderr, "ERROR: Could not compress column with bzip2 (err: %d)\n", bzError);
+                return STARCH_EXIT_FAILURE;
+            }
+            b->outColumnLengths[col] = bzLength;
+        }
+        else if (b->type == kGzip) {
+            memset(&zStream, 0, sizeof(zStream));
+            zStream.zalloc = Z_NULL;
+            zStream.zfree = Z_NULL;
+            zStream.opaque = Z_NULL;
+            zError = deflateInit(&zStream, STARCH_Z_COMPRESSION_LEVEL);
+            if (zError != Z_OK) {
+                fprintf(stderr, "ERROR: Could not initialize z-stream (err: %d)\n", zError);
+                return STARCH_EXIT_FAILURE;
+            }
+            bound = deflateBound(&zStream, b->columnLengths[col]);
+            if (STARCH2_reserveBlockOutput(b, outLength + bound) != STARCH_EXIT_SUCCESS) {
+                deflateEnd(&zStream);
+                return STARCH_EXIT_FAILURE;
+            }
+            zStream.next_in = b->columns[col];
+            zStream.next_out = b->out + outLength;
+#ifdef __cplusplus
+            zStream.avail_in = static_cast<unsigned int>( b->columnLengths[col] );
+            zStream.avail_out = static_cast<unsigned int>( bound );
+#else
+            zStream.avail_in = (unsigned int) b->columnLengths[col];
+            zStream.avail_out = (unsigned int) bound;
+#endif
+            zError = deflate(&zStream, Z_FINISH);
+            b->outColumnLengths[col] = bound - zStream.avail_out;
+            deflateEnd(&zStream);
+            if (zError != Z_STREAM_END) {
+                fprintf(stderr, "ERROR: Could not compress column with gzip (err: %d)\n", zError);
+                return STARCH_EXIT_FAILURE;
+            }
+        }
+        outLength += b->outColumnLengths[col];
+    }
+
+    return STARCH_EXIT_SUCCESS;
+}
+
+static int
+STARCH2_writeBlockOutput(Starch2Writer *w, const Starch2Block *b, const unsigned char *out, const size_t length)
+{
+    if (fwrite(out, 1, length, w->outFp) != length) {
+        fprintf(stderr, "ERROR: Could not write compressed data to output file pointer\n");
+        return STARCH_EXIT_FAILURE;
+    }
+    w->cumulativeRecSize += length;
+    w->currentRecSize += length;
+    if (b->md)
+        b->md->size += length;
+    return STARCH_EXIT_SUCCESS;
+}
+
+static int
+STARCH2_writeBzip2Block(Starch2Writer *w, const Starch2Block *b)
+{
+#ifdef __cplusplus
+    unsigned char *buffer = reinterpret_cast<unsigned char *>( w->zBuffer );
+#else
+    unsigned char *buffer = (unsigned char *) w->zBuffer;
+#endif
+    const uint64_t maxBits = 8 * (STARCH_Z_BUFFER_MAX_LENGTH - 16);
+    unsigned char trailer[10] = { 0x17, 0x72, 0x45, 0x38, 0x50, 0x90, 0, 0, 0, 0 };
+    uint64_t numBits = 0U;
+    uint64_t fromBit = 0U;
+    uint64_t n = 0U;
+    unsigned int idx = 0U;
+
+    if (b->firstFlag) {
+        buffer[0] = 'B';
+        buffer[1] = 'Z';
+        buffer[2] = 'h';
+        buffer[3] = '0' + STARCH_BZ_COMPRESSION_LEVEL;
+        numBits = 32U;
+        w->blockStreamCheck = 0U;
+    }
+    else {
+        buffer[0] = w->blockStreamBits;
+        numBits = w->numBlockStreamBits;
+    }
+    for (idx = 0U; idx < b->numChecks; idx++)
+        w->blockStreamCheck = (w->blockStreamCheck << 1) | (w->blockStreamCheck >> 31);
+    w->blockStreamCheck ^= b->check;
+
+    for (fromBit = 0U; fromBit < b->numOutBits; fromBit += n) {
+        n = (b->numOutBits - fromBit < maxBits - numBits) ? b->numOutBits - fromBit : maxBits - numBits;
+        STARCH2_appendBits(buffer, &numBits, b->out, fromBit, n);
+        if (numBits == maxBits) {
+            if (STARCH2_writeBlockOutput(w, b, buffer, numBits / 8) != STARCH_EXIT_SUCCESS)
+                return STARCH_EXIT_FAILURE;
+            numBits = 0U;
+        }
+    }
+
+    if (b->lastFlag) {
+        for (idx = 0U; idx < 4U; idx++)
+            trailer[6 + idx] = (w->blockStreamCheck >> (24 - 8 * idx)) & 0xffU;
+        STARCH2_appendBits(buffer, &numBits, trailer, 0, 80);
+        numBits = (numBits + 7) / 8 * 8;
+    }
+    if (STARCH2_writeBlockOutput(w, b, buffer, numBits / 8) != STARCH_EXIT_SUCCESS)
+        return STARCH_EXIT_FAILURE;
+    w->blockStreamBits = buffer[numBits / 8];
+    w->numBlockStreamBits = numBits % 8;
+
+    return STARCH_EXIT_SUCCESS;
+}
+
+static int
+STARCH2_writeGzipBlock(Starch2Writer *w, const Starch2Block *b)
+{
+    const unsigned int levelFlags = (STARCH_Z_COMPRESSION_LEVEL < 2) ? 0U : ((STARCH_Z_COMPRESSION_LEVEL < 6) ? 1U : ((STARCH_Z_COMPRESSION_LEVEL == 6) ? 2U : 3U));
+    unsigned int header = ((Z_DEFLATED + ((MAX_WBITS - 8) << 4)) << 8) | (levelFlags << 6);
+    unsigned char bytes[4] = {0};
+    unsigned int idx = 0U;
+
+    if (b->firstFlag) {
+        header += 31 - header % 31;
+        bytes[0] = (header >> 8) & 0xffU;
+        bytes[1] = header & 0xffU;
+        if (STARCH2_writeBlockOutput(w, b, bytes, 2) != STARCH_EXIT_SUCCESS)
+            return STARCH_EXIT_FAILURE;
+#ifdef __cplusplus
+        w->blockStreamCheck = static_cast<uint32_t>( adler32(0L, Z_NULL, 0) );
+#else
+        w->blockStreamCheck = (uint32_t) adler32(0L, Z_NULL, 0);
+#endif
+    }
+#ifdef __cplusplus
+    if (STARCH2_writeBlockOutput(w, b, b->out, static_cast<size_t>( b->numOutBits / 8 )) != STARCH_EXIT_SUCCESS)
+        return STARCH_EXIT_FAILURE;
+    w->blockStreamCheck = static_cast<uint32_t>( adler32_combine(w->blockStreamCheck, b->check, static_cast<z_off_t>( b->length )) );
+#else
+    if (STARCH2_writeBlockOutput(w, b, b->out, (size_t) (b->numOutBits / 8)) != STARCH_EXIT_SUCCESS)
+        return STARCH_EXIT_FAILURE;
+    w->blockStreamCheck = (uint32_t) adler32_combine(w->blockStreamCheck, b->check, (z_off_t) b->length);
+#endif
+
+    if (b->lastFlag) {
+        for (idx = 0U; idx < 4U; idx++)
+            bytes[idx] = (w->blockStreamCheck >> (24 - 8 * idx)) & 0xffU;
+        if (STARCH2_writeBlockOutput(w, b, bytes, 4) != STARCH_EXIT_SUCCESS)
+            return STARCH_EXIT_FAILURE;
+    }
+
+    return STARCH_EXIT_SUCCESS;
+}
+
+static int
+STARCH2_writeColumnarBlock(Starch2Writer *w, const Starch2Block *b)
+{
+    MetadataBlock *block = ((b->indexBlockFlag) && (b->md)) ? b->md->blocks + b->indexBlockIdx : NULL;
+    size_t outOffset = 0U;
+    unsigned int col = 0U;
+
+    for (col = 0U; col < STARCH2_NUM_COLUMNS; col++) {
+        if ((block) && (col == STARCH2_START_COLUMN))
+            block->offset = b->md->size;
+        else if ((block) && (col == STARCH2_LENGTH_COLUMN))
+            block->lengthOffset = b->md->size;
+        else if (block)
+            block->restOffset = b->md->size;
+        if (STARCH2_writeBlockOutput(w, b, b->out + outOffset, b->outColumnLengths[col]) != STARCH_EXIT_SUCCESS)
+            return STARCH_EXIT_FAILURE;
+        outOffset += b->outColumnLengths[col];
+    }
+
+    return STARCH_EXIT_SUCCESS;
+}
+
+/* waits for the oldest block held, and writes it out if writeFlag is set */
+static int
+STARCH2_writeWriterBlock(Starch2Writer *w, const Boolean writeFlag)
+{
+#ifdef DEBUG
+    fprintf(stderr, "\n--- STARCH2_writeWriterBlock() ---\n");
+#endif
+    Starch2Block *b = w->blocks[w->numBlocksWritten % w->maxBlocks];
+    int result = w->waitBlock(w->blockPool, b);
+
+    w->numBlocksWritten++;
+    if ((result != STARCH_EXIT_SUCCESS) || (!writeFlag))
+        return result;
+    if (b->columnarFlag)
+        return STARCH2_writeColumnarBlock(w, b);
+    if ((b->indexBlockFlag) && (b->md))
+        b->md->blocks[b->indexBlockIdx].offset = b->md->size;
+    return (b->type == kBzip2) ? STARCH2_writeBzip2Block(w, b) : STARCH2_writeGzipBlock(w, b);
+}
+
+static int
+STARCH2_writeWriterBlocks(Starch2Writer *w, const Boolean writeFlag)
+{
+    int result = STARCH_EXIT_SUCCESS;
+
+    while ((w->blocks) && (w->numBlocksWritten < w->numBlocksSubmitted))
+        if ((STARCH2_writeWriterBlock(w, writeFlag) != STARCH_EXIT_SUCCESS) && (result == STARCH_EXIT_SUCCESS))
+            result = STARCH_EXIT_FAILURE;
+    return result;
+}
+
+/* hands the transformed buffer, or the columns, to the block pool, which ends the chromosome stream if finalizeFlag is set */
+static int
+STARCH2_submitWriterBlock(Starch2Writer *w, const Boolean finalizeFlag)
+{
+#ifdef DEBUG
+    fprintf(stderr, "\n--- STARCH2_submitWriterBlock() ---\n");
+#endif
+    const unsigned int slot = w->numBlocksSubmitted % w->maxBlocks;
+    Starch2Block *b = NULL;
+    char *data = NULL;
+    size_t kept = 0U;
+    unsigned char *column = NULL;
+    size_t columnCapacity = 0U;
+    unsigned int col = 0U;
+
+    if ((w->transformedBufferLength == 0) && (w->columnLengths[STARCH2_START_COLUMN] == 0) && (!finalizeFlag))
+        return STARCH_EXIT_SUCCESS;
+    if ((w->numBlocksSubmitted - w->numBlocksWritten == w->maxBlocks) && (STARCH2_writeWriterBlock(w, kStarchTrue) != STARCH_EXIT_SUCCESS))
+        return STARCH_EXIT_FAILURE;
+
+    if (!w->blocks[slot]) {
+#ifdef __cplusplus
+        b = static_cast<Starch2Block *>( calloc(1, sizeof(Starch2Block)) );
+        if (b) {
+            b->data = static_cast<char *>( malloc(w->bufferLength + 1) );
+            b->dictionary = static_cast<unsigned char *>( malloc(STARCH2_Z_DICTIONARY_LENGTH) );
+        }
+#else
+        b = calloc(1, sizeof(Starch2Block));
+        if (b) {
+            b->data = malloc(w->bufferLength + 1);
+            b->dictionary = malloc(STARCH2_Z_DICTIONARY_LENGTH);
+        }
+#endif
+        if ((!b) || (!b->data) || (!b->dictionary)) {
+            fprintf(stderr, "ERROR: Could not allocate space for compressed block\n");
+            if (b) {
+                free(b->data);
+                free(b->dictionary);
+                free(b);
+            }
+            return STARCH_EXIT_FAILURE;
+        }
+        w->blocks[slot] = b;
+    }
+    b = w->blocks[slot];
+
+    /* the block takes the buffer, and its old data buffer is filled next */
+    data = b->data;
+    b->data = w->transformedBuffer;
+    w->transformedBuffer = data;
+    b->type = w->type;
+    b->length = w->transformedBufferLength;
+    b->firstFlag = (w->blockStreamStartedFlag) ? kStarchFalse : kStarchTrue;
+    b->lastFlag = finalizeFlag;
+    b->md = w->md;
+    b->indexBlockFlag = w->indexBlockPendingFlag;
+    b->indexBlockIdx = ((w->md) && (w->md->numBlocks > 0)) ? w->md->numBlocks - 1 : 0;
+    w->indexBlockPendingFlag = kStarchFalse;
+    b->columnarFlag = w->columnarFlag;
+    for (col = 0U; (w->columnarFlag) && (col < STARCH2_NUM_COLUMNS); col++) {
+        column = b->columns[col];
+        columnCapacity = b->columnCapacities[col];
+        b->columns[col] = w->columns[col];
+        b->columnCapacities[col] = w->columnCapacities[col];
+        b->columnLengths[col] = w->columnLengths[col];
+        w->columns[col] = column;
+        w->columnCapacities[col] = columnCapacity;
+        w->columnLengths[col] = 0U;
+    }
+    b->dictionaryLength = 0U;
+    if ((w->type == kGzip) && (!w->columnarFlag)) {
+        memcpy(b->dictionary, w->dictionary, w->dictionaryLength);
+        b->dictionaryLength = w->dictionaryLength;
+        if (b->length >= STARCH2_Z_DICTIONARY_LENGTH) {
+            memcpy(w->dictionary, b->data + b->length - STARCH2_Z_DICTIONARY_LENGTH, STARCH2_Z_DICTIONARY_LENGTH);
+            w->dictionaryLength = STARCH2_Z_DICTIONARY_LENGTH;
+        }
+        else {
+            kept = (w->dictionaryLength < STARCH2_Z_DICTIONARY_LENGTH - b->length) ? w->dictionaryLength : STARCH2_Z_DICTIONARY_LENGTH - b->length;
+            memmove(w->dictionary, w->dictionary + w->dictionaryLength - kept, kept);
+            memcpy(w->dictionary + kept, b->data, b->length);
+            w->dictionaryLength = kept + b->length;
+        }
+    }
+    w->blockStreamStartedFlag = (finalizeFlag) ? kStarchFalse : kStarchTrue;
+    if (finalizeFlag)
+        w->dictionaryLength = 0U;
+
+    if (w->submitBlock(w->blockPool, b) != STARCH_EXIT_SUCCESS) {
+        fprintf(stderr, "ERROR: Could not hand block to the block pool\n");
+        return STARCH_EXIT_FAILURE;
+    }
+    w->numBlocksSubmitted++;
+
+    return STARCH_EXIT_SUCCESS;
+}
+
+/* 
+   compresses the transformed buffer, and ends the chromosome stream if finalizeFlag 
+   is set, or the index block in progress if indexBlockEndFlag is set; a columnar 
+   writer compresses its columns only at the end of an index block
+*/
+static int
+STARCH2_compressWriterBuffer(Starch2Writer *w, const Boolean finalizeFlag, const Boolean indexBlockEndFlag)
+{
+#ifdef DEBUG
+    fprintf(stderr, "\n--- STARCH2_compressWriterBuffer() ---\n");
+#endif
+    int bzError = BZ_OK;
+    int zError = Z_OK;
+    unsigned int bzBytesConsumedLo32 = 0U;
+    unsigned int bzBytesConsumedHi32 = 0U;
+    unsigned int bzBytesWrittenLo32 = 0U;
+    unsigned int bzBytesWrittenHi32 = 0U;
+    uint64_t bzBytesWritten = 0;
+    size_t zHave = 0;
+
+    unsigned int col = 0U;
+
+    if (w->columnarFlag) {
+        /* the columns are an index block, which is only ended once it holds records */
+        if (w->columnLengths[STARCH2_START_COLUMN] == 0)
+            return STARCH_EXIT_SUCCESS;
+        for (col = 0U; (w->generatePerChrSignatureFlag) && (col < STARCH2_NUM_COLUMNS); col++)
+            sha1_process_bytes(w->columns[col], w->columnLengths[col], &w->perChromosomeHashCtx);
+        if (STARCH2_submitWriterBlock(w, finalizeFlag) != STARCH_EXIT_SUCCESS)
+            return STARCH_EXIT_FAILURE;
+        if (finalizeFlag)
+            w->streamOpenFlag = kStarchFalse;
+        return STARCH_EXIT_SUCCESS;
+    }
+
+    if (w->generatePerChrSignatureFlag)
+        sha1_process_bytes(w->transformedBuffer, w->transformedBufferLength, &w->perChromosomeHashCtx);
+
+    if (w->blocks) {
+        if (STARCH2_submitWriterBlock(w, (finalizeFlag || (indexBlockEndFlag && (w->type == kBzip2)))) != STARCH_EXIT_SUCCESS)
+            return STARCH_EXIT_FAILURE;
+        if (indexBlockEndFlag)
+            w->dictionaryLength = 0U;
+        if (finalizeFlag)
+            w->streamOpenFlag = kStarchFalse;
+    }
+    else if (w->type == kBzip2) {
+        if (w->transformedBufferLength > 0) {
+#ifdef __cplusplus
+            BZ2_bzWrite(&bzError, w->bzFp, w->transformedBuffer, static_cast<int>( w->transformedBufferLength ));
+#else
+            BZ2_bzWrite(&bzError, w->bzFp, w->transformedBuffer, (int) w->transformedBufferLength);
+#endif
+            if (bzError != BZ_OK) {
+                fprintf(stderr, "ERROR: Could not write compressed data to the bz stream (err: %d)\n", bzError);
+                return STARCH_EXIT_FAILURE;
+            }
+        }
+        if (finalizeFlag || indexBlockEndFlag) {
+            BZ2_bzWriteClose64(&bzError, w->bzFp, STARCH_BZ_ABANDON, &bzBytesConsumedLo32, &bzBytesConsumedHi32, &bzBytesWrittenLo32, &bzBytesWrittenHi32);
+            if (bzError != BZ_OK) {
+                fprintf(stderr, "ERROR: Could not close the bz stream (err: %d)\n", bzError);
+                return STARCH_EXIT_FAILURE;
+            }
+#ifdef __cplusplus
+            bzBytesWritten = static_cast<uint64_t>( bzBytesWrittenHi32 ) << 32 | bzBytesWrittenLo32;
+#else
+            bzBytesWritten = (uint64_t) bzBytesWrittenHi32 << 32 | bzBytesWrittenLo32;
+#endif
+            w->cumulativeRecSize += bzBytesWritten;
+            w->currentRecSize += bzBytesWritten;
+            w->bzFp = NULL;
+            w->streamOpenFlag = kStarchFalse;
+            if ((!finalizeFlag) && (STARCH2_openWriterStream(w) != STARCH_EXIT_SUCCESS))
+                return STARCH_EXIT_FAILURE;
+        }
+    }
+    else if (w->type == kGzip) {
+#ifdef __cplusplus
+        w->zStream.next_in = reinterpret_cast<unsigned char *>( w->transformedBuffer );
+        w->zStream.avail_in = static_cast<unsigned int>( w->transformedBufferLength );
+#else
+        w->zStream.next_in = (unsigned char *) w->transformedBuffer;
+        w->zStream.avail_in = (unsigned int) w->transformedBufferLength;
+#endif
+        do {
+            w->zStream.avail_out = STARCH_Z_BUFFER_MAX_LENGTH;
+#ifdef __cplusplus
+            w->zStream.next_out = reinterpret_cast<unsigned char *>( w->zBuffer );
+#else
+            w->zStream.next_out = (unsigned char *) w->zBuffer;
+#endif
+            zError = deflate(&w->zStream, (finalizeFlag ? Z_FINISH : (indexBlockEndFlag ? Z_FULL_FLUSH : Z_NO_FLUSH)));
+            if (zError == Z_MEM_ERROR) {
+                fprintf(stderr, "ERROR: Not enough memory to compress data\n");
+                return STARCH_FATAL_ERROR;
+            }
+            zHave = STARCH_Z_BUFFER_MAX_LENGTH - w->zStream.avail_out;
+            w->cumulativeRecSize += zHave;
+            w->currentRecSize += zHave;
+            if (fwrite(w->zBuffer, 1, zHave, w->outFp) != zHave) {
+                fprintf(stderr, "ERROR: Could not write compressed data to output file pointer\n");
+                return STARCH_EXIT_FAILURE;
+            }
+        } while (w->zStream.avail_out == 0);
+        if (finalizeFlag) {
+            deflateEnd(&w->zStream);
+            w->streamOpenFlag = kStarchFalse;
+        }
+    }
+
+    w->transformedBufferLength = 0;
+    w->transformedBuffer[0] = '\0';
+
+    return STARCH_EXIT_SUCCESS;
+}
+
+static int
+STARCH2_finishWriterChromosome(Starch2Writer *w)
+{
+#ifdef DEBUG
+    fprintf(stderr, "\n--- STARCH2_finishWriterChromosome() ---\n");
+#endif
+    unsigned char sha1Digest[STARCH2_MD_FOOTER_SHA1_LENGTH] = {0};
+    char *base64EncodedSha1Digest = NULL;
+    int result = STARCH_EXIT_SUCCESS;
+
+    if (STARCH2_compressWriterBuffer(w, kStarchTrue, kStarchFalse) != STARCH_EXIT_SUCCESS)
+        return STARCH_EXIT_FAILURE;
+
+    if (w->generatePerChrSignatureFlag) {
+        sha1_finish_ctx(&w->perChromosomeHashCtx, sha1Digest);
+#ifdef __cplusplus
+        STARCH_encodeBase64(&base64EncodedSha1Digest, 
+                            static_cast<size_t>( STARCH2_MD_FOOTER_BASE64_ENCODED_SHA1_LENGTH ), 
+                            reinterpret_cast<const unsigned char *>( sha1Digest ), 
+                            static_cast<size_t>( STARCH2_MD_FOOTER_SHA1_LENGTH ) );
+#else
+        STARCH_encodeBase64(&base64EncodedSha1Digest, 
+                            (const size_t) STARCH2_MD_FOOTER_BASE64_ENCODED_SHA1_LENGTH, 
+                            (const unsigned char *) sha1Digest, 
+                            (const size_t) STARCH2_MD_FOOTER_SHA1_LENGTH);
+#endif
+    }
+
+    sprintf(w->compressedFn, "%s.%s", w->chromosome, w->tag);
+    if (STARCH_updateMetadataForChromosome(&w->md, 
+                                           w->chromosome, 
+                                           w->compressedFn, 
+                                           (w->blocks) ? w->md->size : w->currentRecSize, /* blocks still to write add to it */
+                                           w->lineCount, 
+                                           w->totalNonUniqueBases, 
+                                           w->totalUniqueBases, 
+                                           w->duplicateElementExistsFlag, 
+                                           w->nestedElementExistsFlag,
+                                           base64EncodedSha1Digest,
+                                           w->maxStringLength) != STARCH_EXIT_SUCCESS) {
+        fprintf(stderr, "ERROR: Could not update metadata %s\n", w->compressedFn);
+        result = STARCH_FATAL_ERROR;
+    }
+
+    if (base64EncodedSha1Digest)
+        free(base64EncodedSha1Digest);
+
+    return result;
+}
+
+/* chr may follow the chromosomes already in the archive only if it sorts after all of them */
+static int
+STARCH2_startWriterChromosome(const Starch2Writer *w, const char *chr)
+{
+#ifdef DEBUG
+    fprintf(stderr, "\n--- STARCH2_startWriterChromosome() ---\n");
+#endif
+    if (!w->firstRecord)
+        return STARCH_EXIT_SUCCESS;
+    if (STARCH_chromosomeInMetadataRecords(w->firstRecord, chr) == STARCH_EXIT_SUCCESS) {
+        fprintf(stderr, "ERROR: Found same chromosome in earlier portion of file. Possible interleaving issue?\nBe sure to first sort input with sort-bed.\n");
+        return STARCH_FATAL_ERROR;
+    }
+    if (STARCH_chromosomePositionedBeforeExistingMetadataRecord(w->firstRecord, chr) == STARCH_EXIT_SUCCESS) {
+        fprintf(stderr, "ERROR: Chromosome name not ordered lexicographically. Possible sorting issue?\nBe sure to first sort input with sort-bed.\n");
+        return STARCH_FATAL_ERROR;
+    }
+    return STARCH_EXIT_SUCCESS;
+}
+
+static int
+STARCH2_allocateWriter(Starch2Writer **w, FILE *outFp, const CompressionType type, const char *tag, const char *note, const Boolean generatePerChrSignatureFlag)
+{
+#ifdef DEBUG
+    fprintf(stderr, "\n--- STARCH2_allocateWriter() ---\n");
+#endif
+    Starch2Writer *nw = NULL;
+
+    *w = NULL;
+    if (!outFp) {
+        fprintf(stderr, "ERROR: No output file pointer available to write archive.\n");
+        return STARCH_EXIT_FAILURE;
+    }
+
+#ifdef __cplusplus
+    nw = static_cast<Starch2Writer *>( calloc(1, sizeof(Starch2Writer)) );
+#else
+    nw = calloc(1, sizeof(Starch2Writer));
+#endif
+    if (!nw) {
+        fprintf(stderr, "ERROR: Could not allocate space for archive writer\n");
+        return STARCH_EXIT_FAILURE;
+    }
+    nw->outFp = outFp;
+    nw->type = type;
+    nw->generatePerChrSignatureFlag = generatePerChrSignatureFlag;
+    nw->tag = STARCH_strdup(tag);
+    nw->note = (note) ? STARCH_strdup(note) : NULL;
+#ifdef __cplusplus
+    nw->compressedFn = static_cast<char *>( malloc(STARCH_STREAM_METADATA_FILENAME_MAX_LENGTH) );
+    nw->transformedBuffer = static_cast<char *>( malloc(STARCH_BUFFER_MAX_LENGTH + 1) );
+    nw->zBuffer = static_cast<char *>( malloc(STARCH_Z_BUFFER_MAX_LENGTH) );
+#else
+    nw->compressedFn = malloc(STARCH_STREAM_METADATA_FILENAME_MAX_LENGTH);
+    nw->transformedBuffer = malloc(STARCH_BUFFER_MAX_LENGTH + 1);
+    nw->zBuffer = malloc(STARCH_Z_BUFFER_MAX_LENGTH);
+#endif
+    if ((!nw->tag) || (note && !nw->note) || (!nw->compressedFn) || (!nw->transformedBuffer) || (!nw->zBuffer)) {
+        fprintf(stderr, "ERROR: Could not allocate space for archive writer buffers\n");
+        STARCH2_closeWriter(&nw, kStarchFalse);
+        return STARCH_EXIT_FAILURE;
+    }
+    nw->transformedBuffer[0] = '\0';
+    nw->bufferLength = STARCH_BUFFER_MAX_LENGTH;
+    nw->indexLineCount = STARCH2_DEFAULT_INDEX_LINE_COUNT;
+    nw->pStart = -1;
+    nw->pStop = -1;
+    nw->maxStringLength = STARCH_DEFAULT_LINE_STRING_LENGTH;
+    nw->duplicateElementExistsFlag = STARCH_DEFAULT_DUPLICATE_ELEMENT_FLAG_VALUE;
+    nw->nestedElementExistsFlag = STARCH_DEFAULT_NESTED_ELEMENT_FLAG_VALUE;
+    if (generatePerChrSignatureFlag)
+        sha1_init_ctx(&nw->perChromosomeHashCtx);
+
+    *w = nw;
+    return STARCH_EXIT_SUCCESS;
+}
+
+int
+STARCH2_openWriter(Starch2Writer **w, FILE *outFp, const CompressionType type, const char *tag, const char *note, const Boolean generatePerChrSignatureFlag)
+{
+#ifdef DEBUG
+    fprintf(stderr, "\n--- STARCH2_openWriter() ---\n");
+#endif
+    unsigned char *header = NULL;
+    Starch2Writer *nw = NULL;
+
+    *w = NULL;
+    if (STARCH2_allocateWriter(&nw, outFp, type, tag, note, generatePerChrSignatureFlag) != STARCH_EXIT_SUCCESS)
+        return STARCH_EXIT_FAILURE;
+
+    if ((STARCH2_initializeStarchHeader(&header) != STARCH_EXIT_SUCCESS) ||
+#ifdef __cplusplus
+        (STARCH2_writeStarchHeaderToOutputFp(header, reinterpret_cast<const FILE *>( outFp )) != STARCH_EXIT_SUCCESS)) {
+#else
+        (STARCH2_writeStarchHeaderToOutputFp(header, (const FILE *) outFp) != STARCH_EXIT_SUCCESS)) {
+#endif
+        fprintf(stderr, "ERROR: Could not write archive header to output file pointer.\n");
+        if (header)
+            free(header);
+        STARCH2_closeWriter(&nw, kStarchFalse);
+        return STARCH_EXIT_FAILURE;
+    }
+    free(header);
+    nw->cumulativeRecSize += STARCH2_MD_HEADER_BYTE_LENGTH;
+
+    if (STARCH2_openWriterStream(nw) != STARCH_EXIT_SUCCESS) {
+        STARCH2_closeWriter(&nw, kStarchFalse);
+        return STARCH_EXIT_FAILURE;
+    }
+
+    *w = nw;
+    return STARCH_EXIT_SUCCESS;
+}
+
+int
+STARCH2_openChromosomeWriter(Starch2Writer **w, const Starch2Writer *archive)
+{
+#ifdef DEBUG
+    fprintf(stderr, "\n--- STARCH2_openChromosomeWriter() ---\n");
+#endif
+    Starch2Writer *nw = NULL;
+    FILE *partFp = tmpfile();
+
+    *w = NULL;
+    if (!partFp) {
+        fprintf(stderr, "ERROR: Could not create a temporary file for a chromosome stream.\n");
+        return STARCH_EXIT_FAILURE;
+    }
+    if (STARCH2_allocateWriter(&nw, partFp, archive->type, archive->tag, NULL, archive->generatePerChrSignatureFlag) != STARCH_EXIT_SUCCESS) {
+        fclose(partFp);
+        return STARCH_EXIT_FAILURE;
+    }
+    nw->chromosomeOnlyFlag = kStarchTrue; /* owns partFp */
+    nw->indexLineCount = archive->indexLineCount;
+    if ((archive->columnarFlag) && (STARCH2_setWriterColumnar(nw) != STARCH_EXIT_SUCCESS)) {
+        STARCH2_closeWriter(&nw, kStarchFalse);
+        return STARCH_EXIT_FAILURE;
+    }
+
+    if (STARCH2_openWriterStream(nw) != STARCH_EXIT_SUCCESS) {
+        STARCH2_closeWriter(&nw, kStarchFalse);
+        return STARCH_EXIT_FAILURE;
+    }
+
+    *w = nw;
+    return STARCH_EXIT_SUCCESS;
+}
+
+static int
+STARCH2_appendToColumn(Starch2Writer *w, const unsigned int col, const unsigned char *data, const size_t length)
+{
+    unsigned char *column = NULL;
+    size_t capacity = (w->columnCapacities[col] > 0) ? w->columnCapacities[col] : STARCH_BUFFER_MAX_LENGTH;
+
+    while (w->columnLengths[col] + length > capacity)
+        capacity *= 2;
+    if (capacity > w->columnCapacities[col]) {
+#ifdef __cplusplus
+        column = static_cast<unsigned char *>( realloc(w->columns[col], capacity) );
+#else
+        column = realloc(w->columns[col], capacity);
+#endif
+        if (!column) {
+            fprintf(stderr, "ERROR: Ran out of memory while extending column\n");
+            return STARCH_FATAL_ERROR;
+        }
+        w->columns[col] = column;
+        w->columnCapacities[col] = capacity;
+    }
+    memcpy(w->columns[col] + w->columnLengths[col], data, length);
+    w->columnLengths[col] += length;
+
+    return STARCH_EXIT_SUCCESS;
+}
+
+/* unsigned LEB128: seven bits at a time, low bits first, with the high bit set on all bytes but the last */
+static int
+STARCH2_appendVarintToColumn(Starch2Writer *w, const unsigned int col, uint64_t value)
+{
+    unsigned char bytes[10] = {0};
+    size_t length = 0U;
+
+    do {
+#ifdef __cplusplus
+        bytes[length] = static_cast<unsigned char>( value & 0x7fU );
+#else
+        bytes[length] = (unsigned char) (value & 0x7fU);
+#endif
+        value >>= 7;
+        if (value > 0)
+            bytes[length] |= 0x80U;
+        length++;
+    } while (value > 0);
+
+    return STARCH2_appendToColumn(w, col, bytes, length);
+}
+
+int
+STARCH2_addRecordToWriter(Starch2Writer *w, const char *chr, const int64_t start, const int64_t stop, const char *remainder)
+{
+#ifdef DEBUG
+    fprintf(stderr, "\n--- STARCH2_addRecordToWriter() ---\n");
+#endif
+    char coordBuffer[64] = {0};
+    size_t remainderLength = (remainder) ? strlen(remainder) : 0;
+    size_t recordLength = 0;
+    size_t needed = 0;
+    int written = 0;
+    char *resized = NULL;
+    Boolean firstLineFlag = kStarchFalse;
+
+    /* 
+       line length as unstarch will print it; as in STARCH2_transformHeaderlessBEDInput(), 
+       the first line of a chromosome counts toward the maximum of the chromosome before 
+       it, rather than its own 
+    */
+    written = sprintf(coordBuffer, "%" PRId64 "\t%" PRId64, start, stop);
+#ifdef __cplusplus
+    needed = strlen(chr) + 1 + static_cast<size_t>( written ) + ((remainder) ? remainderLength + 1 : 0);
+#else
+    needed = strlen(chr) + 1 + (size_t) written + ((remainder) ? remainderLength + 1 : 0);
+#endif
+    written = 0;
+
+    /* a new chromosome closes the previous chromosome's stream */
+    if ((!w->chromosome) || (strcmp(chr, w->chromosome) != 0)) {
+        if ((w->chromosome) && (w->chromosomeOnlyFlag)) {
+            fprintf(stderr, "ERROR: A chromosome writer takes the records of one chromosome only.\n");
+            return STARCH_FATAL_ERROR;
+        }
+        if (STARCH2_startWriterChromosome(w, chr) != STARCH_EXIT_SUCCESS)
+            return STARCH_FATAL_ERROR;
+        firstLineFlag = kStarchTrue;
+        if (w->chromosome) {
+#ifdef __cplusplus
+            if (needed > static_cast<size_t>( w->maxStringLength ))
+                w->maxStringLength = static_cast<LineLengthType>( needed );
+#else
+            if (needed > (size_t) w->maxStringLength)
+                w->maxStringLength = (LineLengthType) needed;
+#endif
+            if (STARCH2_finishWriterChromosome(w) != STARCH_EXIT_SUCCESS)
+                return STARCH_EXIT_FAILURE;
+            free(w->chromosome);
+            w->chromosome = NULL;
+        }
+        if ((!w->streamOpenFlag) && (STARCH2_openWriterStream(w) != STARCH_EXIT_SUCCESS))
+            return STARCH_EXIT_FAILURE;
+        if (w->generatePerChrSignatureFlag)
+            sha1_init_ctx(&w->perChromosomeHashCtx);
+        w->chromosome = STARCH_strdup(chr);
+        if (!w->chromosome) {
+            fprintf(stderr, "ERROR: Could not allocate space for chromosome marker.\n");
+            return STARCH_FATAL_ERROR;
+        }
+
+        /* create placeholder record at current chromosome */
+        sprintf(w->compressedFn, "%s.%s", w->chromosome, w->tag);
+        if (!w->firstRecord) {
+            w->md = STARCH_createMetadata(w->chromosome, 
+                                          w->compressedFn, 
+                                          0, 
+                                          0UL, 
+                                          0UL, 
+                                          0UL, 
+                                          STARCH_DEFAULT_DUPLICATE_ELEMENT_FLAG_VALUE, 
+                                          STARCH_DEFAULT_NESTED_ELEMENT_FLAG_VALUE,
+                                          NULL,
+                                          STARCH_DEFAULT_LINE_STRING_LENGTH);
+            w->firstRecord = w->md;
+        }
+        else
+            w->md = STARCH_addMetadata(w->md, 
+                                       w->chromosome, 
+                                       w->compressedFn, 
+                                       0, 
+                                       0UL, 
+                                       0UL, 
+                                       0UL, 
+                                       STARCH_DEFAULT_DUPLICATE_ELEMENT_FLAG_VALUE,
+                                       STARCH_DEFAULT_NESTED_ELEMENT_FLAG_VALUE,
+                                       NULL,
+                                       STARCH_DEFAULT_LINE_STRING_LENGTH);
+        if (!w->md) {
+            fprintf(stderr, "ERROR: Not enough memory is available\n");
+            return STARCH_EXIT_FAILURE;
+        }
+
+        w->lastPosition = 0;
+        w->pStart = -1;
+        w->pStop = -1;
+        w->previousStop = 0;
+        w->lcDiff = 0;
+        w->lineCount = 0UL;
+        w->totalNonUniqueBases = 0UL;
+        w->totalUniqueBases = 0UL;
+        w->duplicateElementExistsFlag = STARCH_DEFAULT_DUPLICATE_ELEMENT_FLAG_VALUE;
+        w->nestedElementExistsFlag = STARCH_DEFAULT_NESTED_ELEMENT_FLAG_VALUE;
+        w->currentRecSize = 0UL;
+        w->maxStringLength = STARCH_DEFAULT_LINE_STRING_LENGTH;
+        if (w->pRemainder)
+            w->pRemainder[0] = '\0';
+    }
+
+    /* test for corrupt or out-of-order element */
+    if (stop <= start) {
+        fprintf(stderr, "ERROR: BED data is corrupt at line %lu (stop: %" PRId64 ", start: %" PRId64 ")\n", (unsigned long) w->lineCount + 1, stop, start);
+        return STARCH_FATAL_ERROR;
+    }
+    if (w->pStart > start) {
+        fprintf(stderr, "ERROR: BED data is not properly sorted by start coordinates at line %lu [ pStart: %" PRId64 " | start: %" PRId64 " ]\n", (unsigned long) w->lineCount + 1, w->pStart, start);
+        return STARCH_FATAL_ERROR;
+    }
+    else if ((w->pStart == start) && (w->pStop > stop)) {
+        fprintf(stderr, "ERROR: BED data is not properly sorted by end coordinates (when start coordinates are equal) at line %lu\n", (unsigned long) w->lineCount + 1);
+        return STARCH_FATAL_ERROR;
+    }
+    else if ((w->pStart == start) && (w->pStop == stop) && (w->pRemainder) && (strcmp((remainder) ? remainder : "", w->pRemainder) < 0)) {
+        fprintf(stderr, "ERROR: Elements with same start and stop coordinates have remainders in wrong sort order.\nBe sure to first sort input with sort-bed.\n");
+        return STARCH_FATAL_ERROR;
+    }
+
+    /* every indexLineCount records start a block of the chromosome's index */
+    if ((w->indexLineCount > 0) && (w->lineCount % w->indexLineCount == 0)) {
+        if ((w->lineCount > 0) && (STARCH2_compressWriterBuffer(w, kStarchFalse, kStarchTrue) != STARCH_EXIT_SUCCESS))
+            return STARCH_EXIT_FAILURE;
+        if (!STARCH_addMetadataBlock(w->md, (w->blocks) ? 0 : w->currentRecSize, start))
+            return STARCH_FATAL_ERROR;
+        w->indexBlockPendingFlag = (w->blocks) ? kStarchTrue : kStarchFalse;
+        w->lcDiff = 0; /* the block opens with its own element length */
+    }
+
+    /* columns: the first start of an index block is kept as is, and those after it as differences */
+    if (w->columnarFlag) {
+#ifdef __cplusplus
+        if ((STARCH2_appendVarintToColumn(w, STARCH2_START_COLUMN, static_cast<uint64_t>( (w->lineCount % w->indexLineCount == 0) ? start : start - w->pStart ) ) != STARCH_EXIT_SUCCESS) ||
+            (STARCH2_appendVarintToColumn(w, STARCH2_LENGTH_COLUMN, static_cast<uint64_t>( stop - start )) != STARCH_EXIT_SUCCESS) ||
+            ((remainder) && (STARCH2_appendToColumn(w, STARCH2_REST_COLUMN, reinterpret_cast<const unsigned char *>( remainder ), remainderLength) != STARCH_EXIT_SUCCESS)) ||
+            (STARCH2_appendToColumn(w, STARCH2_REST_COLUMN, reinterpret_cast<const unsigned char *>( "\n" ), 1) != STARCH_EXIT_SUCCESS))
+#else
+        if ((STARCH2_appendVarintToColumn(w, STARCH2_START_COLUMN, (uint64_t) ((w->lineCount % w->indexLineCount == 0) ? start : start - w->pStart)) != STARCH_EXIT_SUCCESS) ||
+            (STARCH2_appendVarintToColumn(w, STARCH2_LENGTH_COLUMN, (uint64_t) (stop - start)) != STARCH_EXIT_SUCCESS) ||
+            ((remainder) && (STARCH2_appendToColumn(w, STARCH2_REST_COLUMN, (const unsigned char *) remainder, remainderLength) != STARCH_EXIT_SUCCESS)) ||
+            (STARCH2_appendToColumn(w, STARCH2_REST_COLUMN, (const unsigned char *) "\n", 1) != STARCH_EXIT_SUCCESS))
+#endif
+            return STARCH_FATAL_ERROR;
+    }
+
+    /* transform */
+    else {
+        if (stop - start != w->lcDiff) {
+            w->lcDiff = stop - start;
+            written += sprintf(coordBuffer + written, "p%" PRId64 "\n", w->lcDiff);
+        }
+        written += sprintf(coordBuffer + written, "%" PRId64, (w->lastPosition != 0) ? (start - w->lastPosition) : start);
+#ifdef __cplusplus
+        recordLength = static_cast<size_t>( written ) + ((remainder) ? remainderLength + 1 : 0) + 1;
+#else
+        recordLength = (size_t) written + ((remainder) ? remainderLength + 1 : 0) + 1;
+#endif
+        if (w->transformedBufferLength + recordLength >= w->bufferLength) {
+            if (STARCH2_compressWriterBuffer(w, kStarchFalse, kStarchFalse) != STARCH_EXIT_SUCCESS)
+                return STARCH_EXIT_FAILURE;
+            if (recordLength >= STARCH_BUFFER_MAX_LENGTH) {
+                fprintf(stderr, "ERROR: BED record is too long to transform at line %lu\n", (unsigned long) w->lineCount + 1);
+                return STARCH_FATAL_ERROR;
+            }
+        }
+        memcpy(w->transformedBuffer + w->transformedBufferLength, coordBuffer, written);
+        w->transformedBufferLength += written;
+        if (remainder) {
+            w->transformedBuffer[w->transformedBufferLength++] = '\t';
+            memcpy(w->transformedBuffer + w->transformedBufferLength, remainder, remainderLength);
+            w->transformedBufferLength += remainderLength;
+        }
+        w->transformedBuffer[w->transformedBufferLength++] = '\n';
+        w->transformedBuffer[w->transformedBufferLength] = '\0';
+    }
+
+    /* statistics */
+    w->lineCount++;
+    w->lastPosition = stop;
+#ifdef __cplusplus
+    w->totalNonUniqueBases += static_cast<BaseCountType>( stop - start );
+    if (w->previousStop <= start)
+        w->totalUniqueBases += static_cast<BaseCountType>( stop - start );
+    else if (w->previousStop < stop)
+        w->totalUniqueBases += static_cast<BaseCountType>( stop - w->previousStop );
+#else
+    w->totalNonUniqueBases += (BaseCountType) (stop - start);
+    if (w->previousStop <= start)
+        w->totalUniqueBases += (BaseCountType) (stop - start);
+    else if (w->previousStop < stop)
+        w->totalUniqueBases += (BaseCountType) (stop - w->previousStop);
+#endif
+    w->previousStop = (stop > w->previousStop) ? stop : w->previousStop;
+    if (w->indexLineCount > 0) {
+        w->md->blocks[w->md->numBlocks - 1].lastEnd = stop;
+        w->md->blocks[w->md->numBlocks - 1].maxEnd = w->previousStop;
+        w->md->blocks[w->md->numBlocks - 1].lineCount++;
+    }
+    if ((w->pStart == start) && (w->pStop == stop))
+        w->duplicateElementExistsFlag = kStarchTrue;
+    if ((w->pStart < start) && (w->pStop > stop))
+        w->nestedElementExistsFlag = kStarchTrue;
+
+    /* line length, counted above */
+#ifdef __cplusplus
+    if (firstLineFlag)
+        w->firstLineLength = static_cast<LineLengthType>( needed );
+    else if (needed > static_cast<size_t>( w->maxStringLength ))
+        w->maxStringLength = static_cast<LineLengthType>( needed );
+#else
+    if (firstLineFlag)
+        w->firstLineLength = (LineLengthType) needed;
+    else if (needed > (size_t) w->maxStringLength)
+        w->maxStringLength = (LineLengthType) needed;
+#endif
+
+    /* set pElement values */
+    w->pStart = start;
+    w->pStop = stop;
+    if (remainderLength + 1 > w->pRemainderCapacity) {
+#ifdef __cplusplus
+        resized = static_cast<char *>( realloc(w->pRemainder, 2 * (remainderLength + 1)) );
+#else
+        resized = realloc(w->pRemainder, 2 * (remainderLength + 1));
+#endif
+        if (!resized) {
+            fprintf(stderr, "ERROR: Ran out of memory while copying remainder token\n");
+            return STARCH_FATAL_ERROR;
+        }
+        w->pRemainder = resized;
+        w->pRemainderCapacity = 2 * (remainderLength + 1);
+    }
+    memcpy(w->pRemainder, (remainder) ? remainder : "", remainderLength + 1);
+
+    return STARCH_EXIT_SUCCESS;
+}
+
+int
+STARCH2_addBEDLineToWriter(Starch2Writer *w, const char *line)
+{
+#ifdef DEBUG
+    fprintf(stderr, "\n--- STARCH2_addBEDLineToWriter() ---\n");
+#endif
+    const char *p = line;
+    const char *q = NULL;
+    char *end = NULL;
+    size_t chrLength = 0;
+    size_t idLength = 0;
+    int64_t start = 0;
+    int64_t stop = 0;
+
+    /* chromosome */
+    while ((*p != '\t') && (*p != '\0'))
+        ++p;
+#ifdef __cplusplus
+    chrLength = static_cast<size_t>( p - line );
+#else
+    chrLength = (size_t) (p - line);
+#endif
+    if ((chrLength == 0) || (*p != '\t')) {
+        fprintf(stderr, "ERROR: BED data is missing chromosome and/or coordinate data at line %lu of chromosome [%s]\n", (unsigned long) w->lineCount + 1, (w->chromosome) ? w->chromosome : line);
+        return STARCH_FATAL_ERROR;
+    }
+    if (chrLength > TOKEN_CHR_MAX_LENGTH) {
+        fprintf(stderr, "ERROR: Chromosome field length is too long (must be no longer than %lu characters)\n", TOKEN_CHR_MAX_LENGTH);
+        return STARCH_FATAL_ERROR;
+    }
+    memcpy(w->lineChromosome, line, chrLength);
+    w->lineChromosome[chrLength] = '\0';
+
+    /* coordinates must be tab-delimited integers */
+    q = ++p;
+#ifdef __cplusplus
+    start = static_cast<int64_t>( strtoll(q, &end, STARCH_RADIX) );
+#else
+    start = (int64_t) strtoll(q, &end, STARCH_RADIX);
+#endif
+    if ((end == q) || (*end != '\t') || (*q == '-') || (*q == '+')) {
+        fprintf(stderr, "ERROR: BED start coordinate is not a non-negative integer in line [%s]\n", line);
+        return STARCH_FATAL_ERROR;
+    }
+    q = end + 1;
+#ifdef __cplusplus
+    stop = static_cast<int64_t>( strtoll(q, &end, STARCH_RADIX) );
+#else
+    stop = (int64_t) strtoll(q, &end, STARCH_RADIX);
+#endif
+    /* a carriage return may end a DOS-style line, as with the legacy transform */
+    if ((end != q) && (*end == '\r') && (*(end + 1) == '\0'))
+        ++end;
+    if ((end == q) || ((*end != '\t') && (*end != '\0')) || (*q == '-') || (*q == '+')) {
+        fprintf(stderr, "ERROR: BED stop coordinate is not a non-negative integer in line [%s]\n", line);
+        return STARCH_FATAL_ERROR;
+    }
+#ifdef __cplusplus
+    if ((start > static_cast<int64_t>( MAX_COORD_VALUE )) || (stop > static_cast<int64_t>( MAX_COORD_VALUE ))) {
+        fprintf(stderr, "ERROR: Coordinate field value is too great (must be less than %" PRId64 ")\n", static_cast<int64_t>( MAX_COORD_VALUE ));
+#else
+    if ((start > (int64_t) MAX_COORD_VALUE) || (stop > (int64_t) MAX_COORD_VALUE)) {
+        fprintf(stderr, "ERROR: Coordinate field value is too great (must be less than %" PRId64 ")\n", (int64_t) MAX_COORD_VALUE);
+#endif
+        return STARCH_FATAL_ERROR;
+    }
+    if (*end == '\0')
+        return STARCH2_addRecordToWriter(w, w->lineChromosome, start, stop, NULL);
+
+    /* test id field length */
+    for (p = end + 1; (*p != '\t') && (*p != '\0'); ++p)
+        ++idLength;
+    if (idLength >= TOKEN_ID_MAX_LENGTH) {
+        fprintf(stderr, "ERROR: Id field is too long (must be less than %lu characters long)\n", TOKEN_ID_MAX_LENGTH);
+        return STARCH_FATAL_ERROR;
+    }
+
+    return STARCH2_addRecordToWriter(w, w->lineChromosome, start, stop, end + 1);
+}
+
+int
+STARCH2_appendChromosomeWriter(Starch2Writer *w, Starch2Writer **chromosomeWriter)
+{
+#ifdef DEBUG
+    fprintf(stderr, "\n--- STARCH2_appendChromosomeWriter() ---\n");
+#endif
+    Starch2Writer *cw = *chromosomeWriter;
+    Metadata *part = NULL;
+    size_t nRead = 0;
+    int result = STARCH_EXIT_SUCCESS;
+
+    if (!cw)
+        return STARCH_EXIT_SUCCESS;
+    if ((w->chromosomeOnlyFlag) || (!cw->chromosomeOnlyFlag)) {
+        fprintf(stderr, "ERROR: Only a chromosome writer may be appended to an archive writer.\n");
+        STARCH2_closeWriter(chromosomeWriter, kStarchFalse);
+        return STARCH_FATAL_ERROR;
+    }
+    if (!cw->chromosome) /* no records */
+        return STARCH2_closeWriter(chromosomeWriter, kStarchFalse);
+    if (STARCH2_writeWriterBlocks(w, kStarchTrue) != STARCH_EXIT_SUCCESS) {
+        STARCH2_closeWriter(chromosomeWriter, kStarchFalse);
+        return STARCH_EXIT_FAILURE;
+    }
+
+    if ((STARCH2_finishWriterChromosome(cw) != STARCH_EXIT_SUCCESS) || 
+        (STARCH2_writeWriterBlocks(cw, kStarchTrue) != STARCH_EXIT_SUCCESS) || 
+        (STARCH2_startWriterChromosome(w, cw->chromosome) != STARCH_EXIT_SUCCESS)) {
+        STARCH2_closeWriter(chromosomeWriter, kStarchFalse);
+        return STARCH_FATAL_ERROR;
+    }
+
+    /* close the chromosome in progress; the stream opened ahead of its records is not needed */
+    if (w->chromosome) {
+        if (cw->firstLineLength > w->maxStringLength)
+            w->maxStringLength = cw->firstLineLength;
+        result = STARCH2_finishWriterChromosome(w);
+        free(w->chromosome);
+        w->chromosome = NULL;
+    }
+    else {
+        STARCH2_abandonWriterStream(w);
+        if ((w->md) && (cw->firstLineLength > w->md->lineMaxStringLength))
+            w->md->lineMaxStringLength = cw->firstLineLength; /* see STARCH2_addRecordToWriter() */
+    }
+
+    /* copy the compressed stream */
+    if ((result == STARCH_EXIT_SUCCESS) && ((fflush(cw->outFp) != 0) || (STARCH_fseeko(cw->outFp, 0, SEEK_SET) != 0)))
+        result = STARCH_EXIT_FAILURE;
+    while ((result == STARCH_EXIT_SUCCESS) && ((nRead = fread(w->zBuffer, 1, STARCH_Z_BUFFER_MAX_LENGTH, cw->outFp)) > 0))
+        if (fwrite(w->zBuffer, 1, nRead, w->outFp) != nRead)
+            result = STARCH_EXIT_FAILURE;
+    if ((result == STARCH_EXIT_SUCCESS) && (ferror(cw->outFp)))
+        result = STARCH_EXIT_FAILURE;
+    if (result != STARCH_EXIT_SUCCESS) {
+        fprintf(stderr, "ERROR: Could not copy chromosome stream to output file pointer\n");
+        STARCH2_closeWriter(chromosomeWriter, kStarchFalse);
+        return STARCH_EXIT_FAILURE;
+    }
+    w->cumulativeRecSize += cw->currentRecSize;
+
+    /* the chromosome writer's metadata record, under this archive's tag */
+    part = cw->firstRecord;
+    sprintf(w->compressedFn, "%s.%s", part->chromosome, w->tag);
+    if (!w->firstRecord) {
+        w->md = STARCH_createMetadata(part->chromosome, 
+                                      w->compressedFn, 
+                                      part->size, 
+                                      part->lineCount, 
+                                      part->totalNonUniqueBases, 
+                                      part->totalUniqueBases, 
+                                      part->duplicateElementExists, 
+                                      part->nestedElementExists,
+                                      part->signature,
+                                      part->lineMaxStringLength);
+        w->firstRecord = w->md;
+    }
+    else
+        w->md = STARCH_addMetadata(w->md, 
+                                   part->chromosome, 
+                                   w->compressedFn, 
+                                   part->size, 
+                                   part->lineCount, 
+                                   part->totalNonUniqueBases, 
+                                   part->totalUniqueBases, 
+                                   part->duplicateElementExists, 
+                                   part->nestedElementExists,
+                                   part->signature,
+                                   part->lineMaxStringLength);
+    if ((!w->md) || (STARCH_setMetadataBlocks(w->md, part->blocks, part->numBlocks) != STARCH_EXIT_SUCCESS)) {
+        fprintf(stderr, "ERROR: Not enough memory is available\n");
+        result = STARCH_EXIT_FAILURE;
+    }
+
+    STARCH2_closeWriter(chromosomeWriter, kStarchFalse);
+    return result;
+}
+
+int
+STARCH2_closeWriter(Starch2Writer **w, const Boolean finalizeFlag)
+{
+#ifdef DEBUG
+    fprintf(stderr, "\n--- STARCH2_closeWriter() ---\n");
+#endif
+    Starch2Writer *cw = *w;
+    CompressionType type;
+    unsigned char sha1Digest[STARCH2_MD_FOOTER_SHA1_LENGTH] = {0};
+    char *base64EncodedSha1Digest = NULL;
+    char footerCumulativeRecordSizeBuffer[STARCH2_MD_FOOTER_CUMULATIVE_RECORD_SIZE_LENGTH + 1] = {0};
+    char footerRemainderBuffer[STARCH2_MD_FOOTER_REMAINDER_LENGTH] = {0};
+    char footerBuffer[STARCH2_MD_FOOTER_LENGTH] = {0};
+    char nullChr[] = "null";
+    char nullCompressedFn[] = "null";
+    char nullSig[] = "null";
+    char *json = NULL;
+    unsigned int blockIdx = 0U;
+    unsigned int col = 0U;
+    int result = STARCH_EXIT_SUCCESS;
+
+    if (!cw)
+        return STARCH_EXIT_SUCCESS;
+
+    /* finish the last chromosome, or put in a stub record if there were no records */
+    if ((!finalizeFlag) || (cw->chromosomeOnlyFlag)) {
+        /* abandon the archive, e.g., after an error upstream */
+        STARCH2_abandonWriterStream(cw);
+    }
+    else {
+        if (cw->chromosome) {
+            result = STARCH2_finishWriterChromosome(cw);
+        }
+        else if (!cw->firstRecord) {
+            if (cw->type == kBzip2) {
+                result = STARCH2_compressWriterBuffer(cw, kStarchTrue, kStarchFalse);
+            }
+            else if (cw->type == kGzip) {
+                if (!cw->blocks)
+                    deflateEnd(&cw->zStream);
+                cw->streamOpenFlag = kStarchFalse;
+            }
+            if (result == STARCH_EXIT_SUCCESS)
+                result = STARCH2_writeWriterBlocks(cw, kStarchTrue);
+            cw->firstRecord = STARCH_createMetadata(nullChr, 
+                                                    nullCompressedFn, 
+                                                    cw->currentRecSize, 
+                                                    0UL, 
+                                                    0UL, 
+                                                    0UL,
+                                                    STARCH_DEFAULT_DUPLICATE_ELEMENT_FLAG_VALUE,
+                                                    STARCH_DEFAULT_NESTED_ELEMENT_FLAG_VALUE,
+                                                    nullSig,
+                                                    0UL);
+        }
+
+        /* write metadata and its signature, after the blocks still held */
+        if (result == STARCH_EXIT_SUCCESS)
+            result = STARCH2_writeWriterBlocks(cw, kStarchTrue);
+        if ((result == STARCH_EXIT_SUCCESS) && (cw->firstRecord)) {
+            type = cw->type;
+            STARCH_writeJSONMetadata(cw->firstRecord, &json, &type, 0, cw->note);
+#ifdef __cplusplus
+            STARCH_SHA1_All(reinterpret_cast<const unsigned char *>( json ), strlen(json), sha1Digest);
+            STARCH_encodeBase64(&base64EncodedSha1Digest, 
+                                static_cast<size_t>( STARCH2_MD_FOOTER_BASE64_ENCODED_SHA1_LENGTH ), 
+                                reinterpret_cast<const unsigned char *>( sha1Digest ), 
+                                static_cast<size_t>( STARCH2_MD_FOOTER_SHA1_LENGTH ) );
+            sprintf(footerCumulativeRecordSizeBuffer, "%020llu", static_cast<unsigned long long>( cw->cumulativeRecSize ));
+            memset(footerRemainderBuffer, STARCH2_MD_FOOTER_REMAINDER_UNUSED_CHAR, static_cast<size_t>( STARCH2_MD_FOOTER_REMAINDER_LENGTH ));
+#else
+            STARCH_SHA1_All((const unsigned char *) json, strlen(json), sha1Digest);
+            STARCH_encodeBase64(&base64EncodedSha1Digest, 
+                                (const size_t) STARCH2_MD_FOOTER_BASE64_ENCODED_SHA1_LENGTH, 
+                                (const unsigned char *) sha1Digest, 
+                                (const size_t) STARCH2_MD_FOOTER_SHA1_LENGTH);
+            sprintf(footerCumulativeRecordSizeBuffer, "%020llu", (unsigned long long) cw->cumulativeRecSize);
+            memset(footerRemainderBuffer, STARCH2_MD_FOOTER_REMAINDER_UNUSED_CHAR, (size_t) STARCH2_MD_FOOTER_REMAINDER_LENGTH);
+#endif
+            memcpy(footerBuffer, footerCumulativeRecordSizeBuffer, strlen(footerCumulativeRecordSizeBuffer));
+            memcpy(footerBuffer + STARCH2_MD_FOOTER_CUMULATIVE_RECORD_SIZE_LENGTH, base64EncodedSha1Digest, STARCH2_MD_FOOTER_BASE64_ENCODED_SHA1_LENGTH - 1); /* strip trailing null */
+            memcpy(footerBuffer + STARCH2_MD_FOOTER_CUMULATIVE_RECORD_SIZE_LENGTH + STARCH2_MD_FOOTER_BASE64_ENCODED_SHA1_LENGTH - 1, footerRemainderBuffer, STARCH2_MD_FOOTER_REMAINDER_LENGTH);
+            footerBuffer[STARCH2_MD_FOOTER_CUMULATIVE_RECORD_SIZE_LENGTH + STARCH2_MD_FOOTER_BASE64_ENCODED_SHA1_LENGTH - 1 + STARCH2_MD_FOOTER_REMAINDER_LENGTH - 1] = '\0';
+            footerBuffer[STARCH2_MD_FOOTER_CUMULATIVE_RECORD_SIZE_LENGTH + STARCH2_MD_FOOTER_BASE64_ENCODED_SHA1_LENGTH - 1 + STARCH2_MD_FOOTER_REMAINDER_LENGTH - 2] = '\n';
+            if ((fwrite(json, 1, strlen(json), cw->outFp) != strlen(json)) ||
+                (fputs(footerBuffer, cw->outFp) == EOF) ||
+                (fflush(cw->outFp) != 0)) {
+                fprintf(stderr, "ERROR: Could not write archive metadata to output file pointer\n");
+                result = STARCH_EXIT_FAILURE;
+            }
+        }
+    }
+
+    /* the block pool may still be compressing blocks of an abandoned archive */
+    STARCH2_writeWriterBlocks(cw, kStarchFalse);
+    for (blockIdx = 0U; (cw->blocks) && (blockIdx < cw->maxBlocks); blockIdx++) {
+        if (!cw->blocks[blockIdx])
+            continue;
+        free(cw->blocks[blockIdx]->data);
+        free(cw->blocks[blockIdx]->dictionary);
+        free(cw->blocks[blockIdx]->out);
+        for (col = 0U; col < STARCH2_NUM_COLUMNS; col++)
+            free(cw->blocks[blockIdx]->columns[col]);
+        free(cw->blocks[blockIdx]);
+    }
+    free(cw->blocks);
+    free(cw->dictionary);
+    for (col = 0U; col < STARCH2_NUM_COLUMNS; col++)
+        free(cw->columns[col]);
+
+    if (json)
+        free(json);
+    if (base64EncodedSha1Digest)
+        free(base64EncodedSha1Digest);
+    if (cw->firstRecord)
+        STARCH_freeMetadata(&cw->firstRecord);
+    if (cw->chromosomeOnlyFlag)
+        fclose(cw->outFp);
+    free(cw->chromosome);
+    free(cw->compressedFn);
+    free(cw->transformedBuffer);
+    free(cw->zBuffer);
+    free(cw->pRemainder);
+    free(cw->tag);
+    free(cw->note);
+    free(cw);
+    *w = NULL;
+
+    return result;
+}
+
+int
+STARCH2_setWriterBlockPool(Starch2Writer *w, const unsigned int maxBlocks, Starch2BlockFunction submitBlock, Starch2BlockFunction waitBlock, void *pool)
+{
+#ifdef DEBUG
+    fprintf(stderr, "\n--- STARCH2_setWriterBlockPool() ---\n");
+#endif
+    const size_t bufferLength = (w->type == kBzip2) ? STARCH2_BZ_BLOCK_LENGTH : STARCH2_Z_BLOCK_LENGTH;
+    const Boolean streamOpenFlag = w->streamOpenFlag;
+    char *buffer = NULL;
+    Starch2Block **blocks = NULL;
+    unsigned char *dictionary = NULL;
+
+    if (((w->blocks) && (w->blockPool != w)) || (w->chromosome) || (w->firstRecord) || (maxBlocks == 0) || (!submitBlock) || (!waitBlock)) {
+        fprintf(stderr, "ERROR: A block pool must be set once, before any records are added to the writer.\n");
+        return STARCH_FATAL_ERROR;
+    }
+
+#ifdef __cplusplus
+    buffer = static_cast<char *>( realloc(w->transformedBuffer, bufferLength + 1) );
+    blocks = static_cast<Starch2Block **>( calloc(maxBlocks, sizeof(Starch2Block *)) );
+    dictionary = static_cast<unsigned char *>( malloc(STARCH2_Z_DICTIONARY_LENGTH) );
+#else
+    buffer = realloc(w->transformedBuffer, bufferLength + 1);
+    blocks = calloc(maxBlocks, sizeof(Starch2Block *));
+    dictionary = malloc(STARCH2_Z_DICTIONARY_LENGTH);
+#endif
+    if (buffer)
+        w->transformedBuffer = buffer;
+    if ((!buffer) || (!blocks) || (!dictionary)) {
+        fprintf(stderr, "ERROR: Could not allocate space for archive writer blocks\n");
+        free(blocks);
+        free(dictionary);
+        return STARCH_EXIT_FAILURE;
+    }
+
+    /* the stream opened with the writer is compressed in blocks instead */
+    STARCH2_abandonWriterStream(w);
+    if (w->blocks) {
+        /* a columnar writer's own pool, which holds no blocks as yet */
+        free(w->blocks);
+        free(w->dictionary);
+    }
+    w->bufferLength = bufferLength;
+    w->blocks = blocks;
+    w->maxBlocks = maxBlocks;
+    w->submitBlock = submitBlock;
+    w->waitBlock = waitBlock;
+    w->blockPool = pool;
+    w->dictionary = dictionary;
+    w->dictionaryLength = 0U;
+    w->blockStreamStartedFlag = kStarchFalse;
+    w->streamOpenFlag = streamOpenFlag;
+    STARCH2_initializeBzCrcTable();
+
+    return STARCH_EXIT_SUCCESS;
+}
+
+int
+STARCH2_setWriterIndexLineCount(Starch2Writer *w, const LineCountType indexLineCount)
+{
+#ifdef DEBUG
+    fprintf(stderr, "\n--- STARCH2_setWriterIndexLineCount() ---\n");
+#endif
+    if ((w->chromosome) || (w->firstRecord)) {
+        fprintf(stderr, "ERROR: The records of an index block must be set before any records are added to the writer.\n");
+        return STARCH_FATAL_ERROR;
+    }
+    if ((w->columnarFlag) && (indexLineCount == 0)) {
+        fprintf(stderr, "ERROR: A columnar writer needs index blocks of one or more records.\n");
+        return STARCH_FATAL_ERROR;
+    }
+    w->indexLineCount = indexLineCount;
+
+    return STARCH_EXIT_SUCCESS;
+}
+
+/* a columnar writer without a block pool compresses each block as it is submitted */
+static int
+STARCH2_compressWriterBlock(void *pool, Starch2Block *block)
+{
+    (void) pool;
+    return STARCH2_compressBlock(block);
+}
+
+static int
+STARCH2_waitWriterBlock(void *pool, Starch2Block *block)
+{
+    (void) pool;
+    (void) block;
+    return STARCH_EXIT_SUCCESS;
+}
+
+int
+STARCH2_setWriterColumnar(Starch2Writer *w)
+{
+#ifdef DEBUG
+    fprintf(stderr, "\n--- STARCH2_setWriterColumnar() ---\n");
+#endif
+    if ((w->chromosome) || (w->firstRecord)) {
+        fprintf(stderr, "ERROR: A writer must be made columnar before any records are added to it.\n");
+        return STARCH_FATAL_ERROR;
+    }
+    if (w->indexLineCount == 0) {
+        fprintf(stderr, "ERROR: A columnar writer needs index blocks of one or more records.\n");
+        return STARCH_FATAL_ERROR;
+    }
+    if ((!w->blocks) && (STARCH2_setWriterBlockPool(w, 1U, STARCH2_compressWriterBlock, STARCH2_waitWriterBlock, w) != STARCH_EXIT_SUCCESS))
+        return STARCH_EXIT_FAILURE;
+    w->columnarFlag = kStarchTrue;
+
+    return STARCH_EXIT_SUCCESS;
+}
+
+/*
+    STARCH2_compressBlock() is called by a block pool, on any thread, for each block it 
+    is handed; a block is compressed independently of any other.
+*/
+
+int
+STARCH2_compressBlock(Starch2Block *block)
+{
+#ifdef DEBUG
+    fprintf(stderr, "\n--- STARCH2_compressBlock() ---\n");
+#endif
+    if (block->columnarFlag)
+        return STARCH2_compressColumnarBlock(block);
+    else if (block->type == kBzip2)
+        return STARCH2_compressBzip2Block(block);
+    else if (block->type == kGzip)
+        return STARCH2_compressGzipBlock(block);
+    fprintf(stderr, "ERROR: Unknown compression type for block\n");
+    return STARCH_EXIT_FAILURE;
+}
+
 int
 STARCH2_writeStarchHeaderToOutputFp(const unsigned char *header, const FILE *outFp)
 {
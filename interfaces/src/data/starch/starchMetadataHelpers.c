@@ -135,6 +135,8 @@ STARCH_createMetadata(char const *chr,
         newMetadata->totalUniqueBases = totalUniqueBases;
         newMetadata->duplicateElementExists = duplicateElementExists;
         newMetadata->nestedElementExists = nestedElementExists;
+        newMetadata->blocks = NULL;
+        newMetadata->numBlocks = 0;
         newMetadata->next = NULL;
     }
     else {
@@ -206,6 +208,7 @@ STARCH_copyMetadata(const Metadata *md)
                                  md->nestedElementExists,
                                  md->signature,
                                  md->lineMaxStringLength);
+    STARCH_setMetadataBlocks(copy, md->blocks, md->numBlocks);
     firstRec = copy;
     md = md->next;
 
@@ -222,6 +225,7 @@ STARCH_copyMetadata(const Metadata *md)
                                   iter->nestedElementExists,
                                   iter->signature,
                                   iter->lineMaxStringLength);
+        STARCH_setMetadataBlocks(copy, iter->blocks, iter->numBlocks);
     }
 
     if (!firstRec) {
@@ -232,6 +236,74 @@ STARCH_copyMetadata(const Metadata *md)
     return firstRec;
 }
 
+MetadataBlock *
+STARCH_addMetadataBlock(Metadata *md, 
+                        uint64_t offset, 
+                        SignedCoordType firstStart)
+{
+#ifdef DEBUG
+    fprintf(stderr, "\n--- STARCH_addMetadataBlock() ---\n");
+#endif
+    MetadataBlock *blocks = NULL;
+    MetadataBlock *block = NULL;
+
+    /* the array doubles in size whenever it is full */
+    if ((md->numBlocks & (md->numBlocks - 1)) == 0) {
+#ifdef __cplusplus
+        blocks = static_cast<MetadataBlock *>( realloc(md->blocks, sizeof(MetadataBlock) * static_cast<size_t>( (md->numBlocks > 0) ? 2 * md->numBlocks : 1 )) );
+#else
+        blocks = realloc(md->blocks, sizeof(MetadataBlock) * (size_t) ((md->numBlocks > 0) ? 2 * md->numBlocks : 1));
+#endif
+        if (!blocks) {
+            fprintf(stderr, "ERROR: Could not allocate space for metadata block record\n");
+            return NULL;
+        }
+        md->blocks = blocks;
+    }
+
+    block = md->blocks + md->numBlocks++;
+    block->offset = offset;
+    block->firstStart = firstStart;
+    block->lastEnd = firstStart;
+    block->maxEnd = firstStart;
+    block->lineCount = 0;
+    block->lengthOffset = 0;
+    block->restOffset = 0;
+
+    return block;
+}
+
+int
+STARCH_setMetadataBlocks(Metadata *md, 
+                         const MetadataBlock *blocks, 
+                         uint64_t numBlocks)
+{
+#ifdef DEBUG
+    fprintf(stderr, "\n--- STARCH_setMetadataBlocks() ---\n");
+#endif
+    uint64_t blockIdx = 0;
+
+    if (md->blocks)
+        free(md->blocks);
+    md->blocks = NULL;
+    md->numBlocks = 0;
+
+    for (blockIdx = 0; blockIdx < numBlocks; blockIdx++) {
+        if (!STARCH_addMetadataBlock(md, blocks[blockIdx].offset, blocks[blockIdx].firstStart))
+            return STARCH_EXIT_FAILURE;
+        md->blocks[blockIdx] = blocks[blockIdx];
+    }
+
+    return STARCH_EXIT_SUCCESS;
+}
+
+Boolean
+STARCH_isColumnarStream(const Metadata *md)
+{
+    /* the rest column of a block never starts a stream, as the start and length columns come before it */
+    return ((md) && (md->numBlocks > 0) && (md->blocks[0].restOffset > 0)) ? kStarchTrue : kStarchFalse;
+}
+
 int 
 STARCH_updateMetadataForChromosome(Metadata **md, 
                                    char *chr, 
@@ -447,6 +519,8 @@ STARCH_freeMetadata(Metadata **md)
             free(iter->filename);
         if (iter->signature != NULL)
             free(iter->signature);
+        if (iter->blocks != NULL)
+            free(iter->blocks);
         if (prev != NULL)
             free(prev);
         
@@ -513,6 +587,8 @@ STARCH_generateJSONMetadata(const Metadata *md,
     json_t *streamDuplicateElementExistsFlag = NULL;
     json_t *streamNestedElementExistsFlag = NULL;
     json_t *streamSignature = NULL;
+    json_t *streamBlocks = NULL;
+    json_t *streamBlock = NULL;
     json_t *streamArchive = NULL;
     json_t *streamArchiveType = NULL;
     json_t *streamArchiveNote = NULL;
@@ -532,6 +608,7 @@ STARCH_generateJSONMetadata(const Metadata *md,
     uint64_t filenameSize = 0;
     LineCountType filenameLineCount = 0;
     LineLengthType filenameLineMaxStringLength = 0UL;
+    uint64_t blockIdx = 0;
     BaseCountType totalNonUniqueBases = 0;
     BaseCountType totalUniqueBases = 0;
     time_t creationTime;
@@ -739,6 +816,46 @@ STARCH_generateJSONMetadata(const Metadata *md,
             }
         }
 
+        /* 2.3+ archive */
+        if (((json_integer_value(streamArchiveVersionMajor) > 2) || ((json_integer_value(streamArchiveVersionMajor) == 2) && (json_integer_value(streamArchiveVersionMinor) >= 3))) && (iter->numBlocks > 0)) {
+            /* block index */
+            streamBlocks = json_array();
+            if (!streamBlocks) {
+                fprintf(stderr, "ERROR: Could not instantiate stream blocks object\n");
+                return NULL;
+            }
+            for (blockIdx = 0; blockIdx < iter->numBlocks; blockIdx++) {
+                streamBlock = json_object();
+                if (!streamBlock) {
+                    fprintf(stderr, "ERROR: Could not instantiate stream block object\n");
+                    return NULL;
+                }
+#ifdef __cplusplus
+                json_object_set_new(streamBlock, STARCH_METADATA_STREAM_BLOCK_OFFSET_KEY, json_integer(static_cast<json_int_t>(iter->blocks[blockIdx].offset)));
+                json_object_set_new(streamBlock, STARCH_METADATA_STREAM_BLOCK_FIRSTSTART_KEY, json_integer(static_cast<json_int_t>(iter->blocks[blockIdx].firstStart)));
+                json_object_set_new(streamBlock, STARCH_METADATA_STREAM_BLOCK_LASTEND_KEY, json_integer(static_cast<json_int_t>(iter->blocks[blockIdx].lastEnd)));
+                json_object_set_new(streamBlock, STARCH_METADATA_STREAM_BLOCK_MAXEND_KEY, json_integer(static_cast<json_int_t>(iter->blocks[blockIdx].maxEnd)));
+                json_object_set_new(streamBlock, STARCH_METADATA_STREAM_BLOCK_LINECOUNT_KEY, json_integer(static_cast<json_int_t>(iter->blocks[blockIdx].lineCount)));
+                if (STARCH_isColumnarStream(iter)) {
+                    json_object_set_new(streamBlock, STARCH_METADATA_STREAM_BLOCK_LENGTHOFFSET_KEY, json_integer(static_cast<json_int_t>(iter->blocks[blockIdx].lengthOffset)));
+                    json_object_set_new(streamBlock, STARCH_METADATA_STREAM_BLOCK_RESTOFFSET_KEY, json_integer(static_cast<json_int_t>(iter->blocks[blockIdx].restOffset)));
+                }
+#else
+                json_object_set_new(streamBlock, STARCH_METADATA_STREAM_BLOCK_OFFSET_KEY, json_integer((json_int_t)iter->blocks[blockIdx].offset));
+                json_object_set_new(streamBlock, STARCH_METADATA_STREAM_BLOCK_FIRSTSTART_KEY, json_integer((json_int_t)iter->blocks[blockIdx].firstStart));
+                json_object_set_new(streamBlock, STARCH_METADATA_STREAM_BLOCK_LASTEND_KEY, json_integer((json_int_t)iter->blocks[blockIdx].lastEnd));
+                json_object_set_new(streamBlock, STARCH_METADATA_STREAM_BLOCK_MAXEND_KEY, json_integer((json_int_t)iter->blocks[blockIdx].maxEnd));
+                json_object_set_new(streamBlock, STARCH_METADATA_STREAM_BLOCK_LINECOUNT_KEY, json_integer((json_int_t)iter->blocks[blockIdx].lineCount));
+                if (STARCH_isColumnarStream(iter)) {
+                    json_object_set_new(streamBlock, STARCH_METADATA_STREAM_BLOCK_LENGTHOFFSET_KEY, json_integer((json_int_t)iter->blocks[blockIdx].lengthOffset));
+                    json_object_set_new(streamBlock, STARCH_METADATA_STREAM_BLOCK_RESTOFFSET_KEY, json_integer((json_int_t)iter->blocks[blockIdx].restOffset));
+                }
+#endif
+                json_array_append_new(streamBlocks, streamBlock);
+            }
+            json_object_set_new(stream, STARCH_METADATA_STREAM_BLOCKS_KEY, streamBlocks);
+        }
+
         json_array_append_new(streams, stream);
     }
 
@@ -892,7 +1009,11 @@ STARCH_readJSONMetadata(json_t **metadataJSON,
     json_t *streamDuplicateElementExistsFlag = NULL;
     json_t *streamNestedElementExistsFlag = NULL;
     json_t *streamsCompressionType = NULL;
+    json_t *streamBlocks = NULL;
+    json_t *streamBlock = NULL;
+    MetadataBlock *block = NULL;
     size_t streamIdx;
+    size_t streamBlockIdx;
     char *streamChr = NULL;
     char *streamFn = NULL;
     char *streamCTime = NULL;
@@ -1642,6 +1763,43 @@ STARCH_readJSONMetadata(json_t **metadataJSON,
                                           streamNestedElementExistsValue, 
                                           streamSig, 
                                           streamLineMaxStringLengthValue);
+
+            /* v2.3+ block index */
+            streamBlocks = NULL;
+            if (((*version)->major > 2) || (((*version)->major == 2) && ((*version)->minor >= 3)))
+                streamBlocks = json_object_get(stream, STARCH_METADATA_STREAM_BLOCKS_KEY);
+            for (streamBlockIdx = 0; (streamBlocks) && (streamBlockIdx < json_array_size(streamBlocks)); streamBlockIdx++) {
+                streamBlock = json_array_get(streamBlocks, streamBlockIdx);
+                block = (streamBlock) ? STARCH_addMetadataBlock(*rec, 0, 0) : NULL;
+                if (!block) {
+                    if (suppressErrorMsgs == kStarchFalse)
+                        fprintf(stderr, "ERROR: Could not retrieve stream block object\n");
+                    return STARCH_EXIT_FAILURE;
+                }
+#ifdef __cplusplus
+                block->offset = static_cast<uint64_t>( json_integer_value(json_object_get(streamBlock, STARCH_METADATA_STREAM_BLOCK_OFFSET_KEY)) );
+                block->firstStart = static_cast<SignedCoordType>( json_integer_value(json_object_get(streamBlock, STARCH_METADATA_STREAM_BLOCK_FIRSTSTART_KEY)) );
+                block->lastEnd = static_cast<SignedCoordType>( json_integer_value(json_object_get(streamBlock, STARCH_METADATA_STREAM_BLOCK_LASTEND_KEY)) );
+                block->maxEnd = static_cast<SignedCoordType>( json_integer_value(json_object_get(streamBlock, STARCH_METADATA_STREAM_BLOCK_MAXEND_KEY)) );
+                block->lineCount = static_cast<LineCountType>( json_integer_value(json_object_get(streamBlock, STARCH_METADATA_STREAM_BLOCK_LINECOUNT_KEY)) );
+                if (((*version)->major > 2) || ((*version)->minor >= 4)) {
+                    /* absent keys give zero, as in streams of transformed lines */
+                    block->lengthOffset = static_cast<uint64_t>( json_integer_value(json_object_get(streamBlock, STARCH_METADATA_STREAM_BLOCK_LENGTHOFFSET_KEY)) );
+                    block->restOffset = static_cast<uint64_t>( json_integer_value(json_object_get(streamBlock, STARCH_METADATA_STREAM_BLOCK_RESTOFFSET_KEY)) );
+                }
+#else
+                block->offset = (uint64_t) json_integer_value(json_object_get(streamBlock, STARCH_METADATA_STREAM_BLOCK_OFFSET_KEY));
+                block->firstStart = (SignedCoordType) json_integer_value(json_object_get(streamBlock, STARCH_METADATA_STREAM_BLOCK_FIRSTSTART_KEY));
+                block->lastEnd = (SignedCoordType) json_integer_value(json_object_get(streamBlock, STARCH_METADATA_STREAM_BLOCK_LASTEND_KEY));
+                block->maxEnd = (SignedCoordType) json_integer_value(json_object_get(streamBlock, STARCH_METADATA_STREAM_BLOCK_MAXEND_KEY));
+                block->lineCount = (LineCountType) json_integer_value(json_object_get(streamBlock, STARCH_METADATA_STREAM_BLOCK_LINECOUNT_KEY));
+                if (((*version)->major > 2) || ((*version)->minor >= 4)) {
+                    /* absent keys give zero, as in streams of transformed lines */
+                    block->lengthOffset = (uint64_t) json_integer_value(json_object_get(streamBlock, STARCH_METADATA_STREAM_BLOCK_LENGTHOFFSET_KEY));
+                    block->restOffset = (uint64_t) json_integer_value(json_object_get(streamBlock, STARCH_METADATA_STREAM_BLOCK_RESTOFFSET_KEY));
+                }
+#endif
+            }
         }
 
         /* reset Metadata record pointer to first record */
@@ -1684,7 +1842,8 @@ STARCH_mergeMetadataWithCompressedFiles(const Metadata *md,
     const Metadata *iter = NULL;
     FILE *outPtr = NULL;
     FILE *chrFnPtr = NULL;
-    int c;
+    char buffer[STARCH_INPUT_BUFFER_MAX_LENGTH];
+    size_t nBuffer = 0U;
 
     if ((outPtr = freopen(NULL, "wb", stdout)) != NULL) {
         fwrite(mdHeader, strlen(mdHeader), 1, outPtr);
@@ -1694,9 +1853,10 @@ STARCH_mergeMetadataWithCompressedFiles(const Metadata *md,
                 fprintf(stderr, "ERROR: Could not open per-chromosome data file %s\n", iter->filename);
                 return STARCH_EXIT_FAILURE;
             }
-            while ((c = fgetc(chrFnPtr)) != EOF) {
-                if (fputc(c, outPtr) == EOF) {
+            while ((nBuffer = fread(buffer, 1, STARCH_INPUT_BUFFER_MAX_LENGTH, chrFnPtr)) > 0) {
+                if (fwrite(buffer, 1, nBuffer, outPtr) != nBuffer) {
                     fprintf(stderr, "ERROR: Could not write to standard output stream\n");
+                    break;
                 }
             }
             fclose(chrFnPtr);
@@ -53,6 +53,321 @@
 namespace starch {
 #endif
 
+static int
+UNSTARCH_reserveColumnarBuffer(unsigned char **buffer, size_t *capacity, const size_t length)
+{
+    unsigned char *resized = NULL;
+    size_t newCapacity = (*capacity > 0) ? *capacity : UNSTARCH_COMPRESSED_BUFFER_MAX_LENGTH;
+
+    if ((*buffer) && (length <= *capacity))
+        return 0;
+    while (newCapacity < length)
+        newCapacity *= 2;
+#ifdef __cplusplus
+    resized = static_cast<unsigned char *>( realloc(*buffer, newCapacity) );
+#else
+    resized = realloc(*buffer, newCapacity);
+#endif
+    if (!resized) {
+        fprintf(stderr, "ERROR: Ran out of memory while extending column buffer\n");
+        return UNSTARCH_FATAL_ERROR;
+    }
+    *buffer = resized;
+    *capacity = newCapacity;
+
+    return 0;
+}
+
+/* decompresses one column, a complete bzip2 or zlib stream of its own */
+static int
+UNSTARCH_decompressColumn(const CompressionType type, unsigned char *in, const size_t inLength, unsigned char **out, size_t *outLength, size_t *outCapacity)
+{
+    bz_stream bzStream;
+    z_stream zStream;
+    int bzError = BZ_OK;
+    int zError = Z_OK;
+
+    *outLength = 0;
+    if (UNSTARCH_reserveColumnarBuffer(out, outCapacity, 4 * inLength) != 0)
+        return UNSTARCH_FATAL_ERROR;
+
+    switch (type) {
+        case kBzip2: {
+            memset(&bzStream, 0, sizeof(bzStream));
+            if (BZ2_bzDecompressInit(&bzStream, 0, 0) != BZ_OK) {
+                fprintf(stderr, "ERROR: Bzip2 column could not be opened\n");
+                return UNSTARCH_FATAL_ERROR;
+            }
+#ifdef __cplusplus
+            bzStream.next_in = reinterpret_cast<char *>( in );
+            bzStream.avail_in = static_cast<unsigned int>( inLength );
+#else
+            bzStream.next_in = (char *) in;
+            bzStream.avail_in = (unsigned int) inLength;
+#endif
+            do {
+                if ((*outLength == *outCapacity) && (UNSTARCH_reserveColumnarBuffer(out, outCapacity, 2 * *outCapacity) != 0)) {
+                    BZ2_bzDecompressEnd(&bzStream);
+                    return UNSTARCH_FATAL_ERROR;
+                }
+#ifdef __cplusplus
+                bzStream.next_out = reinterpret_cast<char *>( *out + *outLength );
+                bzStream.avail_out = static_cast<unsigned int>( *outCapacity - *outLength );
+#else
+                bzStream.next_out = (char *) (*out + *outLength);
+                bzStream.avail_out = (unsigned int) (*outCapacity - *outLength);
+#endif
+                bzError = BZ2_bzDecompress(&bzStream);
+                *outLength = *outCapacity - bzStream.avail_out;
+            } while ((bzError == BZ_OK) && ((bzStream.avail_in > 0) || (bzStream.avail_out == 0)));
+            BZ2_bzDecompressEnd(&bzStream);
+            if (bzError != BZ_STREAM_END) {
+                fprintf(stderr, "ERROR: Bzip2 column could not be decompressed (err: %d)\n", bzError);
+                return UNSTARCH_FATAL_ERROR;
+            }
+            break;
+        }
+        case kGzip: {
+            memset(&zStream, 0, sizeof(zStream));
+            zStream.zalloc = Z_NULL;
+            zStream.zfree = Z_NULL;
+            zStream.opaque = Z_NULL;
+            if (inflateInit(&zStream) != Z_OK) {
+                fprintf(stderr, "ERROR: Could not initialize z-stream\n");
+                return UNSTARCH_FATAL_ERROR;
+            }
+            zStream.next_in = in;
+#ifdef __cplusplus
+            zStream.avail_in = static_cast<unsigned int>( inLength );
+#else
+            zStream.avail_in = (unsigned int) inLength;
+#endif
+            do {
+                if ((*outLength == *outCapacity) && (UNSTARCH_reserveColumnarBuffer(out, outCapacity, 2 * *outCapacity) != 0)) {
+                    inflateEnd(&zStream);
+                    return UNSTARCH_FATAL_ERROR;
+                }
+                zStream.next_out = *out + *outLength;
+#ifdef __cplusplus
+                zStream.avail_out = static_cast<unsigned int>( *outCapacity - *outLength );
+#else
+                zStream.avail_out = (unsigned int) (*outCapacity - *outLength);
+#endif
+                zError = inflate(&zStream, Z_NO_FLUSH);
+                *outLength = *outCapacity - zStream.avail_out;
+            } while ((zError == Z_OK) && ((zStream.avail_in > 0) || (zStream.avail_out == 0)));
+            inflateEnd(&zStream);
+            if (zError != Z_STREAM_END) {
+                fprintf(stderr, "ERROR: Z-stream column could not be decompressed (err: %d)\n", zError);
+                return UNSTARCH_FATAL_ERROR;
+            }
+            break;
+        }
+        case kUndefined: {
+            fprintf(stderr, "ERROR: Archive compression type is undefined\n");
+            return UNSTARCH_FATAL_ERROR;
+        }
+    }
+
+    return 0;
+}
+
+int
+UNSTARCH_readColumnarBlock(FILE *inFp, const Metadata *md, const uint64_t streamOffset, const uint64_t blockIdx, const CompressionType type, const Boolean restFlag, StarchColumnarBlock *block)
+{
+#ifdef DEBUG
+    fprintf(stderr, "\n--- UNSTARCH_readColumnarBlock() ---\n");
+#endif
+    const MetadataBlock *b = NULL;
+    uint64_t offsets[STARCH2_NUM_COLUMNS + 1] = {0};
+    size_t length = 0;
+    unsigned int col = 0;
+
+    /* 
+       the columns of a block are complete streams, one after the other, and the
+       block ends where the next one starts, or with the chromosome stream
+    */
+
+    if ((!md) || (blockIdx >= md->numBlocks))
+        return UNSTARCH_FATAL_ERROR;
+    b = md->blocks + blockIdx;
+    offsets[STARCH2_START_COLUMN] = b->offset;
+    offsets[STARCH2_LENGTH_COLUMN] = b->lengthOffset;
+    offsets[STARCH2_REST_COLUMN] = b->restOffset;
+    offsets[STARCH2_NUM_COLUMNS] = (blockIdx + 1 < md->numBlocks) ? md->blocks[blockIdx + 1].offset : md->size;
+    if ((offsets[STARCH2_START_COLUMN] > offsets[STARCH2_LENGTH_COLUMN]) || (offsets[STARCH2_LENGTH_COLUMN] > offsets[STARCH2_REST_COLUMN]) || (offsets[STARCH2_REST_COLUMN] > offsets[STARCH2_NUM_COLUMNS])) {
+        fprintf(stderr, "ERROR: Columns of block are out of order in archive\n");
+        return UNSTARCH_FATAL_ERROR;
+    }
+
+#ifdef __cplusplus
+    length = static_cast<size_t>( offsets[(restFlag) ? STARCH2_NUM_COLUMNS : STARCH2_REST_COLUMN] - offsets[STARCH2_START_COLUMN] );
+    if (STARCH_fseeko(inFp, static_cast<off_t>( streamOffset + offsets[STARCH2_START_COLUMN] ), SEEK_SET) != 0) {
+#else
+    length = (size_t) (offsets[(restFlag) ? STARCH2_NUM_COLUMNS : STARCH2_REST_COLUMN] - offsets[STARCH2_START_COLUMN]);
+    if (STARCH_fseeko(inFp, (off_t) (streamOffset + offsets[STARCH2_START_COLUMN]), SEEK_SET) != 0) {
+#endif
+        fprintf(stderr, "ERROR: Could not seek block in archive\n");
+        return UNSTARCH_FATAL_ERROR;
+    }
+    if (UNSTARCH_reserveColumnarBuffer(&block->compressed, &block->compressedCapacity, length) != 0)
+        return UNSTARCH_FATAL_ERROR;
+    if (fread(block->compressed, 1, length, inFp) != length) {
+        fprintf(stderr, "ERROR: Could not read block from archive\n");
+        return UNSTARCH_FATAL_ERROR;
+    }
+
+    for (col = 0; col < STARCH2_NUM_COLUMNS; col++) {
+        block->positions[col] = 0;
+        block->columnLengths[col] = 0;
+        if ((col == STARCH2_REST_COLUMN) && (!restFlag))
+            continue;
+#ifdef __cplusplus
+        if (UNSTARCH_decompressColumn(type, block->compressed + (offsets[col] - offsets[STARCH2_START_COLUMN]), static_cast<size_t>( offsets[col + 1] - offsets[col] ), &block->columns[col], &block->columnLengths[col], &block->columnCapacities[col]) != 0)
+#else
+        if (UNSTARCH_decompressColumn(type, block->compressed + (offsets[col] - offsets[STARCH2_START_COLUMN]), (size_t) (offsets[col + 1] - offsets[col]), &block->columns[col], &block->columnLengths[col], &block->columnCapacities[col]) != 0)
+#endif
+            return UNSTARCH_FATAL_ERROR;
+    }
+    block->start = 0;
+    block->restFlag = restFlag;
+
+    return 0;
+}
+
+static int
+UNSTARCH_readColumnVarint(StarchColumnarBlock *block, const unsigned int col, uint64_t *value)
+{
+    unsigned int shift = 0;
+    unsigned char byte = 0;
+
+    *value = 0;
+    do {
+        if ((block->positions[col] >= block->columnLengths[col]) || (shift > 63))
+            return UNSTARCH_FATAL_ERROR;
+        byte = block->columns[col][block->positions[col]++];
+#ifdef __cplusplus
+        *value |= static_cast<uint64_t>( byte & 0x7f ) << shift;
+#else
+        *value |= (uint64_t) (byte & 0x7f) << shift;
+#endif
+        shift += 7;
+    } while (byte & 0x80);
+
+    return 0;
+}
+
+int
+UNSTARCH_nextColumnarRecord(StarchColumnarBlock *block, SignedCoordType *start, SignedCoordType *stop, char **rest, size_t *restLength)
+{
+    /* 0 for a record, 1 at the end of the block; the rest is ended in place, and is empty unless restFlag was set */
+    uint64_t startValue = 0;
+    uint64_t lengthValue = 0;
+    unsigned char *restStart = NULL;
+    unsigned char *restEnd = NULL;
+
+    if (block->positions[STARCH2_START_COLUMN] >= block->columnLengths[STARCH2_START_COLUMN])
+        return 1;
+    if ((UNSTARCH_readColumnVarint(block, STARCH2_START_COLUMN, &startValue) != 0) || (UNSTARCH_readColumnVarint(block, STARCH2_LENGTH_COLUMN, &lengthValue) != 0)) {
+        fprintf(stderr, "ERROR: Columns of block are corrupt\n");
+        return UNSTARCH_FATAL_ERROR;
+    }
+    /* the first start of a block is kept as is, and those after it as differences */
+#ifdef __cplusplus
+    block->start += static_cast<SignedCoordType>( startValue );
+    *start = block->start;
+    *stop = block->start + static_cast<SignedCoordType>( lengthValue );
+#else
+    block->start += (SignedCoordType) startValue;
+    *start = block->start;
+    *stop = block->start + (SignedCoordType) lengthValue;
+#endif
+
+    *rest = NULL;
+    *restLength = 0;
+    if (!block->restFlag)
+        return 0;
+    restStart = block->columns[STARCH2_REST_COLUMN] + block->positions[STARCH2_REST_COLUMN];
+#ifdef __cplusplus
+    restEnd = static_cast<unsigned char *>( memchr(restStart, '\n', block->columnLengths[STARCH2_REST_COLUMN] - block->positions[STARCH2_REST_COLUMN]) );
+#else
+    restEnd = memchr(restStart, '\n', block->columnLengths[STARCH2_REST_COLUMN] - block->positions[STARCH2_REST_COLUMN]);
+#endif
+    if (!restEnd) {
+        fprintf(stderr, "ERROR: Columns of block are corrupt\n");
+        return UNSTARCH_FATAL_ERROR;
+    }
+    *restEnd = '\0';
+#ifdef __cplusplus
+    *rest = reinterpret_cast<char *>( restStart );
+    *restLength = static_cast<size_t>( restEnd - restStart );
+#else
+    *rest = (char *) restStart;
+    *restLength = (size_t) (restEnd - restStart);
+#endif
+    block->positions[STARCH2_REST_COLUMN] += *restLength + 1;
+
+    return 0;
+}
+
+void
+UNSTARCH_freeColumnarBlock(StarchColumnarBlock *block)
+{
+    unsigned int col = 0;
+
+    free(block->compressed);
+    block->compressed = NULL;
+    block->compressedCapacity = 0;
+    for (col = 0; col < STARCH2_NUM_COLUMNS; col++) {
+        free(block->columns[col]);
+        block->columns[col] = NULL;
+        block->columnLengths[col] = 0;
+        block->columnCapacities[col] = 0;
+        block->positions[col] = 0;
+    }
+}
+
+/* 
+   prints the records of a columnar stream from block firstBlockIdx onwards that
+   overlap [regionStart, regionEnd), or all of them if regionFlag is not set
+*/
+static int
+UNSTARCH_printColumnarStream(FILE *inFp, FILE *outFp, const Metadata *md, const uint64_t streamOffset, const CompressionType type, const uint64_t firstBlockIdx, const Boolean regionFlag, const SignedCoordType regionStart, const SignedCoordType regionEnd)
+{
+    StarchColumnarBlock block;
+    uint64_t blockIdx = 0;
+    SignedCoordType start = 0;
+    SignedCoordType stop = 0;
+    char *rest = NULL;
+    size_t restLength = 0;
+    int res = 0;
+
+    memset(&block, 0, sizeof(block));
+    for (blockIdx = firstBlockIdx; blockIdx < md->numBlocks; blockIdx++) {
+        if ((regionFlag) && (md->blocks[blockIdx].firstStart >= regionEnd))
+            break;
+        if ((res = UNSTARCH_readColumnarBlock(inFp, md, streamOffset, blockIdx, type, kStarchTrue, &block)) != 0)
+            break;
+        while ((res = UNSTARCH_nextColumnarRecord(&block, &start, &stop, &rest, &restLength)) == 0) {
+            if ((regionFlag) && (start >= regionEnd))
+                break;
+            if ((regionFlag) && (stop <= regionStart))
+                continue;
+            if (restLength > 0)
+                fprintf(outFp, "%s\t%" PRId64 "\t%" PRId64 "\t%s\n", md->chromosome, start, stop, rest);
+            else
+                fprintf(outFp, "%s\t%" PRId64 "\t%" PRId64 "\n", md->chromosome, start, stop);
+        }
+        if (res == 1)
+            res = 0;
+        else
+            break;
+    }
+    UNSTARCH_freeColumnarBlock(&block);
+
+    return res;
+}
+
 int 
 UNSTARCH_extractDataWithGzip(FILE **inFp, FILE *outFp, const char *whichChr, const Metadata *md, const uint64_t mdOffset, const Boolean headerFlag) 
 {
@@ -128,6 +443,15 @@ UNSTARCH_extractDataWithGzip(FILE **inFp, FILE *outFp, const char *whichChr, con
             /* we have found at least one chromosome */
             chrFound = kStarchTrue;
 
+            /* the columns of a columnar stream are read block by block */
+            if (STARCH_isColumnarStream(iter)) {
+                if (UNSTARCH_printColumnarStream(*inFp, outFp, iter, cumulativeSize - size + mdOffset, kGzip, 0, kStarchFalse, 0, 0) != 0)
+                    return UNSTARCH_FATAL_ERROR;
+                if (strcmp(whichChr, chromosome) == 0)
+                    break;
+                continue;
+            }
+
             /* initialized and open gzip stream */
             zStream.zalloc = Z_NULL;
             zStream.zfree = Z_NULL;
@@ -310,6 +634,7 @@ UNSTARCH_extractDataWithBzip2(FILE **inFp, FILE *outFp, const char *whichChr, co
     int bzError;
     unsigned char *bzOutput;
     size_t bzOutputLength = UNSTARCH_COMPRESSED_BUFFER_MAX_LENGTH;
+    uint64_t blockIdx = 0;
     /* unsigned char chrFound = UNSTARCH_FALSE; */
 
     if (!outFp)
@@ -359,6 +684,15 @@ UNSTARCH_extractDataWithBzip2(FILE **inFp, FILE *outFp, const char *whichChr, co
 
             /* chrFound = UNSTARCH_TRUE; */
 
+            /* the columns of a columnar stream are read block by block */
+            if (STARCH_isColumnarStream(iter)) {
+                if (UNSTARCH_printColumnarStream(*inFp, outFp, iter, cumulativeSize - size + mdOffset, kBzip2, 0, kStarchFalse, 0, 0) != 0)
+                    return UNSTARCH_FATAL_ERROR;
+                if (strcmp(whichChr, chromosome) == 0)
+                    break;
+                continue;
+            }
+
             bzFp = BZ2_bzReadOpen( &bzError, *inFp, 0, 0, NULL, 0 ); /* http://www.bzip.org/1.0.5/bzip2-manual-1.0.5.html#bzcompress-init */
             if (bzError != BZ_OK) {
                 BZ2_bzReadClose( &bzError, bzFp );
@@ -372,8 +706,9 @@ UNSTARCH_extractDataWithBzip2(FILE **inFp, FILE *outFp, const char *whichChr, co
             bzOutput = malloc(bzOutputLength);
 #endif
 
+            blockIdx = 0;
             do {
-                UNSTARCH_bzReadLine(bzFp, &bzOutput);                
+                UNSTARCH_bzReadBlockLine(&bzFp, *inFp, iter, cumulativeSize - size + mdOffset, &blockIdx, &bzOutput);
                 if (bzOutput) {
                     (!headerFlag) ? \
                         UNSTARCH_reverseTransformHeaderlessInput(chromosome, bzOutput, '\t', &start, &pLength, &lastEnd, firstInputToken, secondInputToken, outFp): \
@@ -473,6 +808,332 @@ UNSTARCH_bzReadLine(BZFILE *input, unsigned char **output)
     }
 }
 
+int 
+UNSTARCH_bzOpenNextBlock(BZFILE **input, FILE *inFp, const Metadata *md, const uint64_t streamOffset, uint64_t *blockIdx) 
+{
+#ifdef DEBUG
+    fprintf(stderr, "\n--- UNSTARCH_bzOpenNextBlock() ---\n");
+#endif
+    int bzError = BZ_OK;
+
+    /* each block of a chromosome stream is a bzip2 stream of its own, which ends with its last line */
+    if ((!md) || (*blockIdx + 1 >= md->numBlocks))
+        return UNSTARCH_FATAL_ERROR;
+
+    (*blockIdx)++;
+    if (*input)
+        BZ2_bzReadClose(&bzError, *input);
+    *input = NULL;
+#ifdef __cplusplus
+    if (STARCH_fseeko(inFp, static_cast<off_t>( streamOffset + md->blocks[*blockIdx].offset ), SEEK_SET) != 0) {
+#else
+    if (STARCH_fseeko(inFp, (off_t) (streamOffset + md->blocks[*blockIdx].offset), SEEK_SET) != 0) {
+#endif
+        fprintf(stderr, "ERROR: Could not seek block in archive\n");
+        return UNSTARCH_FATAL_ERROR;
+    }
+    *input = BZ2_bzReadOpen(&bzError, inFp, 0, 0, NULL, 0);
+    if (bzError != BZ_OK) {
+        BZ2_bzReadClose(&bzError, *input);
+        *input = NULL;
+        fprintf(stderr, "ERROR: Bzip2 data stream of block could not be opened\n");
+        return UNSTARCH_FATAL_ERROR;
+    }
+
+    return 0;
+}
+
+void 
+UNSTARCH_bzReadBlockLine(BZFILE **input, FILE *inFp, const Metadata *md, const uint64_t streamOffset, uint64_t *blockIdx, unsigned char **output) 
+{
+#ifdef DEBUG
+    fprintf(stderr, "\n--- UNSTARCH_bzReadBlockLine() ---\n");
+#endif
+    UNSTARCH_bzReadLine(*input, output);
+
+    while ((!*output) && (*input) && (*blockIdx + 1 < md->numBlocks)) {
+        if (UNSTARCH_bzOpenNextBlock(input, inFp, md, streamOffset, blockIdx) != 0)
+            return;
+#ifdef __cplusplus
+        *output = static_cast<unsigned char *>( malloc(UNSTARCH_COMPRESSED_BUFFER_MAX_LENGTH) );
+#else
+        *output = malloc(UNSTARCH_COMPRESSED_BUFFER_MAX_LENGTH);
+#endif
+        if (!*output) {
+            fprintf(stderr, "ERROR: Could not allocate space for compressed buffer.\n");
+            return;
+        }
+        UNSTARCH_bzReadLine(*input, output);
+    }
+}
+
+uint64_t
+UNSTARCH_firstBlockOfRegion(const Metadata *md, const SignedCoordType regionStart)
+{
+#ifdef DEBUG
+    fprintf(stderr, "\n--- UNSTARCH_firstBlockOfRegion() ---\n");
+#endif
+    uint64_t lo = 0;
+    uint64_t hi = 0;
+    uint64_t mid = 0;
+
+    /* 
+       the maxEnd of a block is the greatest stop coordinate up to and including 
+       that block, so it never decreases: no record of any block before the first 
+       block with a maxEnd past regionStart can overlap the region, however long
+    */
+
+    if ((!md) || (md->numBlocks == 0))
+        return 0;
+
+    hi = md->numBlocks;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (md->blocks[mid].maxEnd > regionStart)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+
+    return lo;
+}
+
+static int
+UNSTARCH_printRegionRecord(const char *chr, const unsigned char *str, const SignedCoordType regionStart, const SignedCoordType regionEnd, SignedCoordType *start, SignedCoordType *pLength, SignedCoordType *lastEnd, char *elemTok1, char *elemTok2, char **currentChr, size_t *currentChrLen, SignedCoordType *currentStart, SignedCoordType *currentStop, char **currentRemainder, size_t *currentRemainderLen, FILE *outFp)
+{
+    /* 0 to go on reading, 1 once a record starts at or past regionEnd */
+    int res = UNSTARCH_sReverseTransformIgnoringHeaderedInput(chr, str, '\t', start, pLength, lastEnd, elemTok1, elemTok2, currentChr, currentChrLen, currentStart, currentStop, currentRemainder, currentRemainderLen);
+
+    if (res != 0)
+        return 0; /* header line */
+    if (elemTok1[0] == 'p')
+        return 0;
+    if (*currentStart >= regionEnd)
+        return 1;
+    if (*currentStop > regionStart) {
+        if ((*currentRemainder) && ((*currentRemainder)[0] != '\0'))
+            fprintf(outFp, "%s\t%" PRId64 "\t%" PRId64 "\t%s\n", chr, *currentStart, *currentStop, *currentRemainder);
+        else
+            fprintf(outFp, "%s\t%" PRId64 "\t%" PRId64 "\n", chr, *currentStart, *currentStop);
+    }
+
+    return 0;
+}
+
+int
+UNSTARCH_extractRegion(FILE **inFp, FILE *outFp, const char *whichChr, const SignedCoordType regionStart, const SignedCoordType regionEnd, const Metadata *md, const uint64_t mdOffset, const CompressionType type)
+{
+#ifdef DEBUG
+    fprintf(stderr, "\n--- UNSTARCH_extractRegion() ---\n");
+#endif
+    const Metadata *iter = NULL;
+    uint64_t streamOffset = mdOffset;
+    uint64_t blockIdx = 0;
+    SignedCoordType start = 0;
+    SignedCoordType pLength = 0;
+    SignedCoordType lastEnd = 0;
+    SignedCoordType currentStart = 0;
+    SignedCoordType currentStop = 0;
+    char *currentChr = NULL;
+    size_t currentChrLen = 0;
+    char *currentRemainder = NULL;
+    size_t currentRemainderLen = 0;
+    char firstInputToken[UNSTARCH_FIRST_TOKEN_MAX_LENGTH] = {0};
+    char secondInputToken[UNSTARCH_SECOND_TOKEN_MAX_LENGTH] = {0};
+    int done = 0;
+    int res = 0;
+
+    /*
+        Prints the records of whichChr that overlap [regionStart, regionEnd). 
+        When the chromosome stream is block-indexed, decompression starts at 
+        the first block that can hold an overlapping record and stops at the 
+        first record that starts at or past regionEnd; otherwise, the stream 
+        is read from its start. A chromosome not in the archive gives no 
+        records.
+    */
+
+    if (!outFp)
+        outFp = stdout;
+
+    for (iter = md; iter != NULL; iter = iter->next) {
+        if (strcmp(whichChr, iter->chromosome) == 0)
+            break;
+        streamOffset += iter->size;
+    }
+    if ((!iter) || (regionStart >= regionEnd))
+        return 0;
+
+    if (iter->numBlocks > 0) {
+        blockIdx = UNSTARCH_firstBlockOfRegion(iter, regionStart);
+        if (blockIdx == iter->numBlocks)
+            return 0;
+        /* blocks go on from where the stop coordinate of the previous block left off */
+        lastEnd = (blockIdx > 0) ? iter->blocks[blockIdx - 1].lastEnd : 0;
+    }
+    if (STARCH_isColumnarStream(iter))
+        return UNSTARCH_printColumnarStream(*inFp, outFp, iter, streamOffset, type, blockIdx, kStarchTrue, regionStart, regionEnd);
+
+#ifdef __cplusplus
+    if (STARCH_fseeko(*inFp, static_cast<off_t>( streamOffset + ((iter->numBlocks > 0) ? iter->blocks[blockIdx].offset : 0) ), SEEK_SET) != 0) {
+#else
+    if (STARCH_fseeko(*inFp, (off_t) (streamOffset + ((iter->numBlocks > 0) ? iter->blocks[blockIdx].offset : 0)), SEEK_SET) != 0) {
+#endif
+        fprintf(stderr, "ERROR: Could not seek data in archive\n");
+        return UNSTARCH_FATAL_ERROR;
+    }
+
+#ifdef __cplusplus
+    currentChr = static_cast<char *>( malloc(TOKEN_CHR_MAX_LENGTH) );
+#else
+    currentChr = malloc(TOKEN_CHR_MAX_LENGTH);
+#endif
+    if (!currentChr) {
+        fprintf(stderr, "ERROR: Could not allocate space for chromosome token\n");
+        return UNSTARCH_FATAL_ERROR;
+    }
+    currentChrLen = TOKEN_CHR_MAX_LENGTH;
+
+    switch (type) {
+        case kBzip2: {
+            BZFILE *bzFp = NULL;
+            int bzError = BZ_OK;
+#ifdef __cplusplus
+            unsigned char *bzOutput = static_cast<unsigned char *>( malloc(UNSTARCH_COMPRESSED_BUFFER_MAX_LENGTH) );
+#else
+            unsigned char *bzOutput = malloc(UNSTARCH_COMPRESSED_BUFFER_MAX_LENGTH);
+#endif
+            if (!bzOutput) {
+                fprintf(stderr, "ERROR: Could not allocate space for compressed buffer.\n");
+                res = UNSTARCH_FATAL_ERROR;
+                break;
+            }
+            bzFp = BZ2_bzReadOpen(&bzError, *inFp, 0, 0, NULL, 0);
+            if (bzError != BZ_OK) {
+                BZ2_bzReadClose(&bzError, bzFp);
+                free(bzOutput);
+                fprintf(stderr, "ERROR: Bzip2 data stream could not be opened\n");
+                res = UNSTARCH_FATAL_ERROR;
+                break;
+            }
+            while (!done) {
+                UNSTARCH_bzReadBlockLine(&bzFp, *inFp, iter, streamOffset, &blockIdx, &bzOutput);
+                if (!bzOutput)
+                    break;
+                done = UNSTARCH_printRegionRecord(iter->chromosome, bzOutput, regionStart, regionEnd, &start, &pLength, &lastEnd, firstInputToken, secondInputToken, &currentChr, &currentChrLen, &currentStart, &currentStop, &currentRemainder, &currentRemainderLen, outFp);
+            }
+            if (bzOutput)
+                free(bzOutput);
+            if (bzFp)
+                BZ2_bzReadClose(&bzError, bzFp);
+            break;
+        }
+        case kGzip: {
+            z_stream zStream;
+            int zError = Z_OK;
+            unsigned char zInBuf[STARCH_Z_CHUNK];
+            unsigned char zOutBuf[STARCH_Z_CHUNK];
+            unsigned char *zLineBuf = NULL;
+            unsigned char *zLineBufCopy = NULL;
+            size_t zLineLen = 0;
+            size_t zLineBufLen = UNSTARCH_COMPRESSED_BUFFER_MAX_LENGTH;
+            unsigned int zHave = 0;
+            unsigned int zOutBufIdx = 0;
+
+            zStream.zalloc = Z_NULL;
+            zStream.zfree = Z_NULL;
+            zStream.opaque = Z_NULL;
+            zStream.avail_in = 0;
+            zStream.next_in = Z_NULL;
+
+            /* 
+               a chromosome stream is one z-stream, flushed at each block boundary: 
+               a block past the first starts with raw deflate data, without the 
+               zlib header (and its trailing checksum is not needed)
+            */
+            zError = inflateInit2(&zStream, (blockIdx > 0) ? -MAX_WBITS : (15+32));
+            if (zError != Z_OK) {
+                fprintf(stderr, "ERROR: Could not initialize z-stream\n");
+                res = UNSTARCH_FATAL_ERROR;
+                break;
+            }
+#ifdef __cplusplus
+            zLineBuf = static_cast<unsigned char *>( malloc(zLineBufLen) );
+#else
+            zLineBuf = malloc(zLineBufLen);
+#endif
+            if (!zLineBuf) {
+                inflateEnd(&zStream);
+                fprintf(stderr, "ERROR: Could not allocate space for line buffer\n");
+                res = UNSTARCH_FATAL_ERROR;
+                break;
+            }
+
+            do {
+#ifdef __cplusplus
+                zStream.avail_in = static_cast<unsigned int>( fread(zInBuf, 1, STARCH_Z_CHUNK, *inFp) );
+#else
+                zStream.avail_in = (unsigned int) fread(zInBuf, 1, STARCH_Z_CHUNK, *inFp);
+#endif
+                if (zStream.avail_in == 0)
+                    break;
+                zStream.next_in = zInBuf;
+                do {
+                    zStream.avail_out = STARCH_Z_CHUNK;
+                    zStream.next_out = zOutBuf;
+                    zError = inflate(&zStream, Z_NO_FLUSH);
+                    switch (zError) {
+                        case Z_NEED_DICT:  { fprintf(stderr, "ERROR: Z-stream needs dictionary\n");      res = UNSTARCH_FATAL_ERROR; break; }
+                        case Z_DATA_ERROR: { fprintf(stderr, "ERROR: Z-stream suffered data error\n");   res = UNSTARCH_FATAL_ERROR; break; }
+                        case Z_MEM_ERROR:  { fprintf(stderr, "ERROR: Z-stream suffered memory error\n"); res = UNSTARCH_FATAL_ERROR; break; }
+                    };
+                    if (res != 0)
+                        break;
+                    zHave = STARCH_Z_CHUNK - zStream.avail_out;
+                    for (zOutBufIdx = 0; (zOutBufIdx < zHave) && (!done); zOutBufIdx++) {
+                        if (zOutBuf[zOutBufIdx] == '\n') {
+                            zLineBuf[zLineLen] = '\0';
+                            zLineLen = 0;
+                            done = UNSTARCH_printRegionRecord(iter->chromosome, zLineBuf, regionStart, regionEnd, &start, &pLength, &lastEnd, firstInputToken, secondInputToken, &currentChr, &currentChrLen, &currentStart, &currentStop, &currentRemainder, &currentRemainderLen, outFp);
+                            continue;
+                        }
+                        if (zLineLen + 1 >= zLineBufLen) {
+#ifdef __cplusplus
+                            zLineBufCopy = static_cast<unsigned char *>( realloc(zLineBuf, zLineBufLen * 2) );
+#else
+                            zLineBufCopy = realloc(zLineBuf, zLineBufLen * 2);
+#endif
+                            if (!zLineBufCopy) {
+                                fprintf(stderr, "ERROR: Ran out of memory while extending line buffer\n");
+                                res = UNSTARCH_FATAL_ERROR;
+                                break;
+                            }
+                            zLineBuf = zLineBufCopy;
+                            zLineBufLen *= 2;
+                        }
+                        zLineBuf[zLineLen++] = zOutBuf[zOutBufIdx];
+                    }
+                } while ((zStream.avail_out == 0) && (!done) && (res == 0));
+            } while ((zError != Z_STREAM_END) && (!done) && (res == 0));
+
+            free(zLineBuf);
+            inflateEnd(&zStream);
+            break;
+        }
+        case kUndefined: {
+            fprintf(stderr, "ERROR: Archive compression type is undefined\n");
+            res = UNSTARCH_FATAL_ERROR;
+            break;
+        }
+    }
+
+    if (currentChr)
+        free(currentChr);
+    if (currentRemainder)
+        free(currentRemainder);
+
+    return res;
+}
+
 int 
 UNSTARCH_reverseTransformInput(const char *chr, const unsigned char *str, char delim, SignedCoordType *start, SignedCoordType *pLength, SignedCoordType *lastEnd, char *elemTok1, char *elemTok2, FILE *outFp) 
 {
@@ -2214,168 +2875,189 @@ UNSTARCH_observedSignatureForChromosome(FILE **inFp, const Metadata *md, const u
             // initialize hash context
             sha1_init_ctx (&perChromosomeHashCtx);
 
-            switch (compType) {
-                case kBzip2: {
-                    BZFILE *bzFp = NULL;
-                    int bzError = 0;
-                    unsigned char *bzOutput = NULL;
-                    size_t bzOutputLength = UNSTARCH_COMPRESSED_BUFFER_MAX_LENGTH;
-                    bzFp = BZ2_bzReadOpen( &bzError, *inFp, 0, 0, NULL, 0 ); /* http://www.bzip.org/1.0.5/bzip2-manual-1.0.5.html#bzcompress-init */
-                    if (bzError != BZ_OK) {
-                        BZ2_bzReadClose( &bzError, bzFp );
-                        fprintf(stderr, "ERROR: Bzip2 data stream could not be opened\n");
+            // a columnar stream signs its columns, block by block, as they were
+            // before compression
+
+            if (STARCH_isColumnarStream(iter)) {
+                StarchColumnarBlock block;
+                uint64_t blockIdx = 0;
+                unsigned int col = 0;
+                memset(&block, 0, sizeof(block));
+                for (blockIdx = 0; blockIdx < iter->numBlocks; blockIdx++) {
+                    if (UNSTARCH_readColumnarBlock(*inFp, iter, cumulativeSize - size + mdOffset, blockIdx, compType, kStarchTrue, &block) != 0) {
+                        UNSTARCH_freeColumnarBlock(&block);
                         return NULL;
                     }
+                    for (col = 0; col < STARCH2_NUM_COLUMNS; col++)
+                        sha1_process_bytes( block.columns[col], block.columnLengths[col], &perChromosomeHashCtx );
+                }
+                UNSTARCH_freeColumnarBlock(&block);
+            }
+            else {
+                switch (compType) {
+                    case kBzip2: {
+                        BZFILE *bzFp = NULL;
+                        int bzError = 0;
+                        unsigned char *bzOutput = NULL;
+                        size_t bzOutputLength = UNSTARCH_COMPRESSED_BUFFER_MAX_LENGTH;
+                        uint64_t blockIdx = 0;
+                        bzFp = BZ2_bzReadOpen( &bzError, *inFp, 0, 0, NULL, 0 ); /* http://www.bzip.org/1.0.5/bzip2-manual-1.0.5.html#bzcompress-init */
+                        if (bzError != BZ_OK) {
+                            BZ2_bzReadClose( &bzError, bzFp );
+                            fprintf(stderr, "ERROR: Bzip2 data stream could not be opened\n");
+                            return NULL;
+                        }
 #ifdef __cplusplus
-                    bzOutput = static_cast<unsigned char *>( malloc(bzOutputLength) );
+                        bzOutput = static_cast<unsigned char *>( malloc(bzOutputLength) );
 #else
-                    bzOutput = malloc(bzOutputLength);
+                        bzOutput = malloc(bzOutputLength);
 #endif
-                    do {
-                        UNSTARCH_bzReadLine(bzFp, &bzOutput); 
-                        if (bzOutput) {
-                            /*
-                                The output of UNSTARCH_bzReadLine strips the newline character, because 
-                                the transformation tokens do not need a newline when being turned back 
-                                into raw BED. 
+                        do {
+                            UNSTARCH_bzReadBlockLine(&bzFp, *inFp, iter, cumulativeSize - size + mdOffset, &blockIdx, &bzOutput);
+                            if (bzOutput) {
+                                /*
+                                    The output of UNSTARCH_bzReadLine strips the newline character, because 
+                                    the transformation tokens do not need a newline when being turned back 
+                                    into raw BED. 
 
-                                When the raw BED was originally turned into tranform tokens, the so-called
-                                "transformation" buffer contained these newline characters. So we put them
-                                back in the bzOutput buffer and add one byte to the string length. 
+                                    When the raw BED was originally turned into tranform tokens, the so-called
+                                    "transformation" buffer contained these newline characters. So we put them
+                                    back in the bzOutput buffer and add one byte to the string length. 
 
-                                This modified buffer is what goes into sha1_process_bytes().
-                            */
+                                    This modified buffer is what goes into sha1_process_bytes().
+                                */
 #ifdef __cplusplus
-                            size_t len = strlen(reinterpret_cast<const char *>( bzOutput ));
+                                size_t len = strlen(reinterpret_cast<const char *>( bzOutput ));
 #else
-                            size_t len = strlen((const char *)bzOutput);
+                                size_t len = strlen((const char *)bzOutput);
 #endif
-                            bzOutput[len] = '\n';
-                            bzOutput[++len] = '\0';
-                            sha1_process_bytes( bzOutput, len, &perChromosomeHashCtx );
-                        }
-                    } while (bzOutput != NULL);
-                    /* cleanup */
-                    if (bzOutput)
-                        free(bzOutput);
-                    BZ2_bzReadClose(&bzError, bzFp);
-                    break;
-                }
-                case kGzip: {
-                    z_stream zStream;
-                    unsigned int zHave, zOutBufIdx;
-                    size_t zBufIdx, zBufOffset;
-                    int zError;
-                    unsigned char *zRemainderBuf = NULL;
-                    unsigned char zInBuf[STARCH_Z_CHUNK];
-                    unsigned char zOutBuf[STARCH_Z_CHUNK];
-                    unsigned char zLineBuf[STARCH_Z_CHUNK];
-
-                    zStream.zalloc = Z_NULL;
-                    zStream.zfree = Z_NULL;
-                    zStream.opaque = Z_NULL;
-                    zStream.avail_in = 0;
-                    zStream.next_in = Z_NULL;
-
-                    zError = inflateInit2(&zStream, (15+32)); /* cf. http://www.zlib.net/manual.html */
-                    if (zError != Z_OK) {
-                        fprintf(stderr, "ERROR: Could not initialize z-stream\n");
-                        return NULL;
+                                bzOutput[len] = '\n';
+                                bzOutput[++len] = '\0';
+                                sha1_process_bytes( bzOutput, len, &perChromosomeHashCtx );
+                            }
+                        } while (bzOutput != NULL);
+                        /* cleanup */
+                        if (bzOutput)
+                            free(bzOutput);
+                        BZ2_bzReadClose(&bzError, bzFp);
+                        break;
                     }
+                    case kGzip: {
+                        z_stream zStream;
+                        unsigned int zHave, zOutBufIdx;
+                        size_t zBufIdx, zBufOffset;
+                        int zError;
+                        unsigned char *zRemainderBuf = NULL;
+                        unsigned char zInBuf[STARCH_Z_CHUNK];
+                        unsigned char zOutBuf[STARCH_Z_CHUNK];
+                        unsigned char zLineBuf[STARCH_Z_CHUNK];
+
+                        zStream.zalloc = Z_NULL;
+                        zStream.zfree = Z_NULL;
+                        zStream.opaque = Z_NULL;
+                        zStream.avail_in = 0;
+                        zStream.next_in = Z_NULL;
+
+                        zError = inflateInit2(&zStream, (15+32)); /* cf. http://www.zlib.net/manual.html */
+                        if (zError != Z_OK) {
+                            fprintf(stderr, "ERROR: Could not initialize z-stream\n");
+                            return NULL;
+                        }
 
 #ifdef __cplusplus
-                    zRemainderBuf = static_cast<unsigned char *>( malloc(1) );
+                        zRemainderBuf = static_cast<unsigned char *>( malloc(1) );
 #else
-                    zRemainderBuf = (unsigned char *) malloc(1);
+                        zRemainderBuf = (unsigned char *) malloc(1);
 #endif
-                    *zRemainderBuf = '\0';
+                        *zRemainderBuf = '\0';
 
-                    do {
-#ifdef __cplusplus
-                        zStream.avail_in = static_cast<unsigned int>( fread(zInBuf, 1, STARCH_Z_CHUNK, *inFp) );
-#else
-                        zStream.avail_in = (unsigned int) fread(zInBuf, 1, STARCH_Z_CHUNK, *inFp);
-#endif
-                        if (zStream.avail_in == 0)
-                            break;
-                        zStream.next_in = zInBuf;
                         do {
-                            zStream.avail_out = STARCH_Z_CHUNK;
-                            zStream.next_out = zOutBuf;
-                            zError = inflate(&zStream, Z_NO_FLUSH);
-                            switch (zError) {
-                                case Z_NEED_DICT:  { fprintf(stderr, "ERROR: Z-stream needs dictionary\n");      return NULL; }
-                                case Z_DATA_ERROR: { fprintf(stderr, "ERROR: Z-stream suffered data error\n");   return NULL; }
-                                case Z_MEM_ERROR:  { fprintf(stderr, "ERROR: Z-stream suffered memory error\n"); return NULL; }
-                            };
-                            zHave = STARCH_Z_CHUNK - zStream.avail_out;
-                            zOutBuf[zHave] = '\0';
-                            /* copy remainder buffer onto line buffer, if not NULL */
-#ifdef __cplusplus
-                            if (zRemainderBuf) {
-                                strncpy(reinterpret_cast<char *>( zLineBuf ), reinterpret_cast<const char *>( zRemainderBuf ), strlen(reinterpret_cast<const char *>( zRemainderBuf )));
-                                zBufOffset = strlen(reinterpret_cast<const char *>( zRemainderBuf ));
-                            }
+#ifdef __cplusplus
+                            zStream.avail_in = static_cast<unsigned int>( fread(zInBuf, 1, STARCH_Z_CHUNK, *inFp) );
+#else
+                            zStream.avail_in = (unsigned int) fread(zInBuf, 1, STARCH_Z_CHUNK, *inFp);
+#endif
+                            if (zStream.avail_in == 0)
+                                break;
+                            zStream.next_in = zInBuf;
+                            do {
+                                zStream.avail_out = STARCH_Z_CHUNK;
+                                zStream.next_out = zOutBuf;
+                                zError = inflate(&zStream, Z_NO_FLUSH);
+                                switch (zError) {
+                                    case Z_NEED_DICT:  { fprintf(stderr, "ERROR: Z-stream needs dictionary\n");      return NULL; }
+                                    case Z_DATA_ERROR: { fprintf(stderr, "ERROR: Z-stream suffered data error\n");   return NULL; }
+                                    case Z_MEM_ERROR:  { fprintf(stderr, "ERROR: Z-stream suffered memory error\n"); return NULL; }
+                                };
+                                zHave = STARCH_Z_CHUNK - zStream.avail_out;
+                                zOutBuf[zHave] = '\0';
+                                /* copy remainder buffer onto line buffer, if not NULL */
+#ifdef __cplusplus
+                                if (zRemainderBuf) {
+                                    strncpy(reinterpret_cast<char *>( zLineBuf ), reinterpret_cast<const char *>( zRemainderBuf ), strlen(reinterpret_cast<const char *>( zRemainderBuf )));
+                                    zBufOffset = strlen(reinterpret_cast<const char *>( zRemainderBuf ));
+                                }
 #else
-                            if (zRemainderBuf) {    
-                                strncpy((char *) zLineBuf, (const char *) zRemainderBuf, strlen((const char *) zRemainderBuf));
-                                zBufOffset = strlen((const char *) zRemainderBuf);
-                            }
+                                if (zRemainderBuf) {    
+                                    strncpy((char *) zLineBuf, (const char *) zRemainderBuf, strlen((const char *) zRemainderBuf));
+                                    zBufOffset = strlen((const char *) zRemainderBuf);
+                                }
 #endif                                
-                            else {
-                                zBufOffset = 0;
-                            }
-                            /* read through zOutBuf for newlines */                    
-                            for (zBufIdx = zBufOffset, zOutBufIdx = 0; zOutBufIdx < zHave; zBufIdx++, zOutBufIdx++) {
-                                zLineBuf[zBufIdx] = zOutBuf[zOutBufIdx];
-                                if (zLineBuf[zBufIdx] == '\n') {
-                                    zLineBuf[zBufIdx + 1] = '\0';
-                                    sha1_process_bytes( zLineBuf, zBufIdx + 1, &perChromosomeHashCtx );
+                                else {
+                                    zBufOffset = 0;
+                                }
+                                /* read through zOutBuf for newlines */                    
+                                for (zBufIdx = zBufOffset, zOutBufIdx = 0; zOutBufIdx < zHave; zBufIdx++, zOutBufIdx++) {
+                                    zLineBuf[zBufIdx] = zOutBuf[zOutBufIdx];
+                                    if (zLineBuf[zBufIdx] == '\n') {
+                                        zLineBuf[zBufIdx + 1] = '\0';
+                                        sha1_process_bytes( zLineBuf, zBufIdx + 1, &perChromosomeHashCtx );
 #ifdef __cplusplus
-                                    zBufIdx = static_cast<size_t>( -1 );
+                                        zBufIdx = static_cast<size_t>( -1 );
 #else
-                                    zBufIdx = (size_t) -1;
+                                        zBufIdx = (size_t) -1;
 #endif                                    
+                                    }
                                 }
-                            }
 #ifdef __cplusplus
-                            if (strlen(reinterpret_cast<const char *>( zLineBuf )) > 0) {
-                                if (strlen(reinterpret_cast<const char *>( zLineBuf )) > strlen(reinterpret_cast<const char *>( zRemainderBuf ))) {
-                                    free(zRemainderBuf);
-                                    zRemainderBuf = reinterpret_cast<unsigned char *>( malloc(strlen(reinterpret_cast<const char *>( zLineBuf )) * 2) );
+                                if (strlen(reinterpret_cast<const char *>( zLineBuf )) > 0) {
+                                    if (strlen(reinterpret_cast<const char *>( zLineBuf )) > strlen(reinterpret_cast<const char *>( zRemainderBuf ))) {
+                                        free(zRemainderBuf);
+                                        zRemainderBuf = reinterpret_cast<unsigned char *>( malloc(strlen(reinterpret_cast<const char *>( zLineBuf )) * 2) );
+                                    }
+                                    strncpy(reinterpret_cast<char *>( zRemainderBuf ), reinterpret_cast<const char *>( zLineBuf ), zBufIdx);
+                                    zRemainderBuf[zBufIdx] = '\0';
                                 }
-                                strncpy(reinterpret_cast<char *>( zRemainderBuf ), reinterpret_cast<const char *>( zLineBuf ), zBufIdx);
-                                zRemainderBuf[zBufIdx] = '\0';
-                            }
 #else
-                            if (strlen((const char *) zLineBuf) > 0) {
-                                if (strlen((const char *) zLineBuf) > strlen((const char *) zRemainderBuf)) {
-                                    free(zRemainderBuf);
-                                    zRemainderBuf = (unsigned char *) malloc(strlen((const char *) zLineBuf) * 2);
+                                if (strlen((const char *) zLineBuf) > 0) {
+                                    if (strlen((const char *) zLineBuf) > strlen((const char *) zRemainderBuf)) {
+                                        free(zRemainderBuf);
+                                        zRemainderBuf = (unsigned char *) malloc(strlen((const char *) zLineBuf) * 2);
+                                    }
+                                    strncpy((char *) zRemainderBuf, (const char *) zLineBuf, zBufIdx);
+                                    zRemainderBuf[zBufIdx] = '\0';
                                 }
-                                strncpy((char *) zRemainderBuf, (const char *) zLineBuf, zBufIdx);
-                                zRemainderBuf[zBufIdx] = '\0';
-                            }
 #endif
-                        } while (zStream.avail_out == 0);
-                    } while (zError != Z_STREAM_END);
+                            } while (zStream.avail_out == 0);
+                        } while (zError != Z_STREAM_END);
 
-                    /* cleanup */
-                    if (zRemainderBuf) {
-                        free(zRemainderBuf);
-                        zRemainderBuf = NULL;
+                        /* cleanup */
+                        if (zRemainderBuf) {
+                            free(zRemainderBuf);
+                            zRemainderBuf = NULL;
+                        }
+                        /* close gzip stream */
+                        zError = inflateEnd(&zStream);
+                        if (zError != Z_OK) {
+                            fprintf(stderr, "ERROR: Could not close z-stream (%d)\n", zError);
+                            return NULL;
+                        }
+                        break;
                     }
-                    /* close gzip stream */
-                    zError = inflateEnd(&zStream);
-                    if (zError != Z_OK) {
-                        fprintf(stderr, "ERROR: Could not close z-stream (%d)\n", zError);
+                    case kUndefined: {
+                        fprintf(stderr, "ERROR: Archive compression type is undefined\n");
                         return NULL;
                     }
-                    break;
-                }
-                case kUndefined: {
-                    fprintf(stderr, "ERROR: Archive compression type is undefined\n");
-                    return NULL;
                 }
             }
             